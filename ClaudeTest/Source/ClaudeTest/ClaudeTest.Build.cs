@@ -10,6 +10,7 @@ public class ClaudeTest : ModuleRules
 			"Core", 
 			"CoreUObject", 
 			"Engine", 
+			"NetCore",
 			"InputCore",
 			"EnhancedInput",
 			"UMG",
@@ -19,7 +20,8 @@ public class ClaudeTest : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new string[] { 
 			"Slate", 
-			"SlateCore" 
+			"SlateCore",
+			"RenderCore"
 		});
 		
 		// Uncomment if you are using online features
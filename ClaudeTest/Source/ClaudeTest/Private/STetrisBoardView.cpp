@@ -0,0 +1,416 @@
+#include "STetrisBoardView.h"
+#include "TetrisBoard.h"
+#include "TetrisPieceTables.h"
+#include "Styling/CoreStyle.h"
+#include "Rendering/DrawElements.h"
+#include "Widgets/SLeafWidget.h"
+#include "Widgets/SInvalidationPanel.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/SCanvas.h"
+
+// 1枠（ボードまたはプレビュー）。同じ色が横に連続するセルを1つの箱で描く
+// 内容が変わったときだけ自分の Paint を無効化する（インバリデーションパネルの中では、他の枠は描き直されない）
+class STetrisBoardViewEntry : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(STetrisBoardViewEntry) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs)
+	{
+	}
+
+	void SetBoard(const TWeakObjectPtr<ATetrisBoard>& InBoard)
+	{
+		Board = InBoard;
+		bIsBoard = true;
+		bNeedsRefresh = true;
+		Refresh();
+	}
+
+	void SetPreviewPiece(EPieceType PieceType)
+	{
+		PreviewPiece = PieceType;
+		bIsBoard = false;
+		BuildPreview();
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+
+	EPieceType GetPreviewPiece() const { return PreviewPiece; }
+
+	void SetStyle(float InCellSize, const FLinearColor& InBackgroundColor)
+	{
+		if (CellSize != InCellSize || BackgroundColor != InBackgroundColor)
+		{
+			CellSize = InCellSize;
+			BackgroundColor = InBackgroundColor;
+			Invalidate(EInvalidateWidgetReason::Layout);
+		}
+	}
+
+	FVector2D GetSize() const { return FVector2D(Width * CellSize, Height * CellSize); }
+
+	// ボードの番号を比べ、変わっていれば描画データを作り直して再描画を要求する。枠の大きさが変わったら true
+	bool Refresh()
+	{
+		const int32 OldWidth = Width;
+		const int32 OldHeight = Height;
+		const ATetrisBoard* BoardPtr = Board.Get();
+		if (!BoardPtr)
+		{
+			// 破棄されたボードは空枠にする
+			if (Spans.Num() > 0 || PieceSpans.Num() > 0 || bNeedsRefresh)
+			{
+				Spans.Reset();
+				PieceSpans.Reset();
+				bNeedsRefresh = false;
+				Invalidate(EInvalidateWidgetReason::Paint);
+			}
+			return false;
+		}
+
+		const uint32 Revision = BoardPtr->GetCellRevision();
+		const uint32 PieceRevision = BoardPtr->GetActivePieceRevision();
+		const bool bCellsChanged = bNeedsRefresh || CachedRevision != Revision;
+		const bool bPieceChanged = bNeedsRefresh || CachedPieceRevision != PieceRevision;
+		if (!bCellsChanged && !bPieceChanged)
+		{
+			return false;
+		}
+
+		Width = FMath::Min(BoardPtr->GetBoardWidth(), TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+		Height = BoardPtr->GetBoardHeight();
+		if (bCellsChanged)
+		{
+			CachedRevision = Revision;
+			Spans.Reset();
+			for (int32 Y = 0; Y < Height; Y++)
+			{
+				AppendRowSpans(Spans, Y, BoardPtr->GetPackedRow(Y));
+			}
+		}
+		if (bPieceChanged)
+		{
+			CachedPieceRevision = PieceRevision;
+			BuildPieceSpans(*BoardPtr);
+		}
+		bNeedsRefresh = false;
+
+		Invalidate(EInvalidateWidgetReason::Paint);
+		return Width != OldWidth || Height != OldHeight;
+	}
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+		FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override
+	{
+		const FSlateBrush* Brush = FCoreStyle::Get().GetBrush("GenericWhiteBox");
+		const FLinearColor Tint = InWidgetStyle.GetColorAndOpacityTint();
+
+		// 背景（ボードのみ）
+		if (bIsBoard)
+		{
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(GetSize(), FSlateLayoutTransform()),
+				Brush, ESlateDrawEffect::None, BackgroundColor * Tint);
+		}
+
+		// 操作中のピースは固定セルの上に重ねる
+		PaintSpans(Spans, AllottedGeometry, OutDrawElements, LayerId + 1, Brush, Tint);
+		PaintSpans(PieceSpans, AllottedGeometry, OutDrawElements, LayerId + 2, Brush, Tint);
+		return LayerId + 2;
+	}
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override
+	{
+		return GetSize();
+	}
+
+private:
+	struct FCellSpan
+	{
+		uint8 X;
+		uint8 Y;
+		uint8 Length;
+		uint8 CellValue;
+	};
+
+	TWeakObjectPtr<ATetrisBoard> Board;
+	EPieceType PreviewPiece = EPieceType::None;
+	bool bIsBoard = false;
+	bool bNeedsRefresh = true;
+	uint32 CachedRevision = 0;
+	uint32 CachedPieceRevision = 0;
+	int32 Width = 0;
+	int32 Height = 0;
+	float CellSize = 8.0f;
+	FLinearColor BackgroundColor = FLinearColor::Black;
+	TArray<FCellSpan> Spans;
+	TArray<FCellSpan, TInlineAllocator<4>> PieceSpans;
+
+	void BuildPreview()
+	{
+		// 出現向きの形状を 4x2 の枠に描く（形状は上2行に収まる）
+		Width = TetrisConstants::PIECE_SIZE;
+		Height = 2;
+		Spans.Reset();
+		PieceSpans.Reset();
+
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PreviewPiece, 0);
+		const uint8 CellValue = TetrisCellPacking::PackCell(true, PreviewPiece);
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			uint64 PackedRow = 0;
+			for (int32 X = 0; X < Width; X++)
+			{
+				if (TetrisPieceTables::IsShapeCellSet(ShapeMask, X, Y))
+				{
+					PackedRow = TetrisCellPacking::SetPackedCell(PackedRow, X, CellValue);
+				}
+			}
+			AppendRowSpans(Spans, Y, PackedRow);
+		}
+	}
+
+	// 操作中のピースは4セルを1つずつ（盤面の外に出ているセルは描かない）
+	void BuildPieceSpans(const ATetrisBoard& BoardRef)
+	{
+		PieceSpans.Reset();
+		const uint8 CellValue = TetrisCellPacking::PackCell(true, BoardRef.GetActivePieceType());
+		for (const FTetrisCoordinate& Cell : BoardRef.GetActivePieceCells())
+		{
+			if (Cell.X >= 0 && Cell.X < Width && Cell.Y >= 0 && Cell.Y < Height)
+			{
+				PieceSpans.Add({ static_cast<uint8>(Cell.X), static_cast<uint8>(Cell.Y), 1, CellValue });
+			}
+		}
+	}
+
+	template<typename AllocatorType>
+	void AppendRowSpans(TArray<FCellSpan, AllocatorType>& OutSpans, int32 Y, uint64 PackedRow) const
+	{
+		int32 X = 0;
+		while (X < Width)
+		{
+			const uint8 CellValue = TetrisCellPacking::GetPackedCell(PackedRow, X);
+			int32 EndX = X + 1;
+			while (EndX < Width && TetrisCellPacking::GetPackedCell(PackedRow, EndX) == CellValue)
+			{
+				EndX++;
+			}
+
+			if (TetrisCellPacking::IsCellOccupied(CellValue))
+			{
+				OutSpans.Add({ static_cast<uint8>(X), static_cast<uint8>(Y), static_cast<uint8>(EndX - X), CellValue });
+			}
+			X = EndX;
+		}
+	}
+
+	template<typename AllocatorType>
+	void PaintSpans(const TArray<FCellSpan, AllocatorType>& InSpans, const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements,
+		int32 LayerId, const FSlateBrush* Brush, const FLinearColor& Tint) const
+	{
+		const float Gap = CellSize >= 4.0f ? 1.0f : 0.0f;
+		for (const FCellSpan& Span : InSpans)
+		{
+			const FVector2D SpanOffset(Span.X * CellSize, Span.Y * CellSize);
+			const FVector2D SpanSize(Span.Length * CellSize - Gap, CellSize - Gap);
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId,
+				AllottedGeometry.ToPaintGeometry(SpanSize, FSlateLayoutTransform(SpanOffset)),
+				Brush, ESlateDrawEffect::None, GetCellColor(Span.CellValue) * Tint);
+		}
+	}
+
+	static FLinearColor GetCellColor(uint8 CellValue)
+	{
+		// 種類なしの占有セル（せり上がりなど）は灰色
+		if (CellValue == TetrisCellPacking::CELL_UNTYPED)
+		{
+			return FLinearColor(0.4f, 0.4f, 0.4f, 1.0f);
+		}
+		return TetrisPieceTables::GetPieceColor(TetrisCellPacking::GetCellPieceType(CellValue));
+	}
+};
+
+void STetrisBoardView::Construct(const FArguments& InArgs)
+{
+	CellSize = InArgs._CellSize;
+	BoardSpacing = InArgs._BoardSpacing;
+	Columns = FMath::Max(InArgs._Columns, 1);
+	BackgroundColor = InArgs._BackgroundColor;
+
+	ChildSlot
+	[
+		SAssignNew(SizeBox, SBox)
+		[
+			SNew(SInvalidationPanel)
+			[
+				SAssignNew(Canvas, SCanvas)
+			]
+		]
+	];
+	UpdateLayout();
+}
+
+TSharedRef<STetrisBoardViewEntry> STetrisBoardView::MakeEntry() const
+{
+	TSharedRef<STetrisBoardViewEntry> Entry = SNew(STetrisBoardViewEntry);
+	Entry->SetStyle(CellSize, BackgroundColor);
+	return Entry;
+}
+
+void STetrisBoardView::SetBoards(const TArray<TWeakObjectPtr<ATetrisBoard>>& InBoards)
+{
+	// プレビューは残してボード部分だけ差し替える
+	Entries.RemoveAt(0, NumBoardEntries);
+	for (int32 Index = 0; Index < InBoards.Num(); Index++)
+	{
+		TSharedRef<STetrisBoardViewEntry> Entry = MakeEntry();
+		Entry->SetBoard(InBoards[Index]);
+		Entries.Insert(Entry, Index);
+	}
+	NumBoardEntries = InBoards.Num();
+
+	UpdateLayout();
+}
+
+void STetrisBoardView::AddBoard(ATetrisBoard* Board)
+{
+	TSharedRef<STetrisBoardViewEntry> Entry = MakeEntry();
+	Entry->SetBoard(Board);
+	Entries.Insert(Entry, NumBoardEntries++);
+	UpdateLayout();
+}
+
+void STetrisBoardView::ClearBoards()
+{
+	SetBoards(TArray<TWeakObjectPtr<ATetrisBoard>>());
+}
+
+void STetrisBoardView::SetPreviewPieces(const TArray<EPieceType>& InPieces)
+{
+	// 同じ並びなら何もしない
+	const int32 NumPreviews = Entries.Num() - NumBoardEntries;
+	if (NumPreviews == InPieces.Num())
+	{
+		bool bSame = true;
+		for (int32 i = 0; i < NumPreviews; i++)
+		{
+			bSame &= Entries[NumBoardEntries + i]->GetPreviewPiece() == InPieces[i];
+		}
+		if (bSame)
+		{
+			return;
+		}
+	}
+
+	// 数が同じなら枠を使い回し、変わった枠だけ描き直す
+	if (NumPreviews == InPieces.Num())
+	{
+		for (int32 i = 0; i < NumPreviews; i++)
+		{
+			if (Entries[NumBoardEntries + i]->GetPreviewPiece() != InPieces[i])
+			{
+				Entries[NumBoardEntries + i]->SetPreviewPiece(InPieces[i]);
+			}
+		}
+		return;
+	}
+
+	Entries.SetNum(NumBoardEntries);
+	for (EPieceType PieceType : InPieces)
+	{
+		TSharedRef<STetrisBoardViewEntry> Entry = MakeEntry();
+		Entry->SetPreviewPiece(PieceType);
+		Entries.Add(Entry);
+	}
+
+	UpdateLayout();
+}
+
+void STetrisBoardView::SetCellSize(float InCellSize)
+{
+	CellSize = InCellSize;
+	UpdateLayout();
+}
+
+void STetrisBoardView::SetBoardSpacing(float InBoardSpacing)
+{
+	BoardSpacing = InBoardSpacing;
+	UpdateLayout();
+}
+
+void STetrisBoardView::SetColumns(int32 InColumns)
+{
+	Columns = FMath::Max(InColumns, 1);
+	UpdateLayout();
+}
+
+void STetrisBoardView::SetBackgroundColor(const FLinearColor& InBackgroundColor)
+{
+	BackgroundColor = InBackgroundColor;
+	for (const TSharedRef<STetrisBoardViewEntry>& Entry : Entries)
+	{
+		Entry->SetStyle(CellSize, BackgroundColor);
+	}
+}
+
+void STetrisBoardView::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	// 変わっていないボードは番号の比較だけ（再描画もしない）
+	bool bSizeChanged = false;
+	for (int32 Index = 0; Index < NumBoardEntries; Index++)
+	{
+		bSizeChanged |= Entries[Index]->Refresh();
+	}
+
+	if (bSizeChanged)
+	{
+		UpdateLayout();
+	}
+}
+
+void STetrisBoardView::UpdateLayout()
+{
+	if (!Canvas.IsValid())
+	{
+		return;
+	}
+
+	// 左から順に並べ、Columns 個ごとに折り返す（行の高さは最も高い枠に合わせる）
+	FVector2D Cursor = FVector2D::ZeroVector;
+	float RowHeight = 0.0f;
+	FVector2D LayoutSize = FVector2D::ZeroVector;
+
+	Canvas->ClearChildren();
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		// ボードとプレビューの間でも折り返す
+		const bool bNewRow = Index > 0 && (Index == NumBoardEntries || (Index < NumBoardEntries ? Index : Index - NumBoardEntries) % Columns == 0);
+		if (bNewRow)
+		{
+			Cursor.X = 0.0f;
+			Cursor.Y += RowHeight + BoardSpacing;
+			RowHeight = 0.0f;
+		}
+
+		const TSharedRef<STetrisBoardViewEntry>& Entry = Entries[Index];
+		Entry->SetStyle(CellSize, BackgroundColor);
+		const FVector2D EntrySize = Entry->GetSize();
+		Canvas->AddSlot()
+			.Position(Cursor)
+			.Size(EntrySize)
+			[
+				Entry
+			];
+
+		Cursor.X += EntrySize.X + BoardSpacing;
+		RowHeight = FMath::Max(RowHeight, EntrySize.Y);
+		LayoutSize.X = FMath::Max(LayoutSize.X, Cursor.X - BoardSpacing);
+		LayoutSize.Y = FMath::Max(LayoutSize.Y, Cursor.Y + EntrySize.Y);
+	}
+
+	// キャンバスは希望サイズを持たないので外側の箱で大きさを決める
+	SizeBox->SetWidthOverride(LayoutSize.X);
+	SizeBox->SetHeightOverride(LayoutSize.Y);
+}
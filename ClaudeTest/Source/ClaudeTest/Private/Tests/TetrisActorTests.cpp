@@ -0,0 +1,434 @@
+#include "TetrisTestUtils.h"
+#include "TetrisBoard.h"
+#include "TetrisPiece.h"
+#include "TetrisGameMode.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 1行を全部埋めた TetrisCellPacking 形式の行
+	uint64 MakeFullPackedRow(int32 Width, EPieceType PieceType)
+	{
+		uint64 PackedCells = 0;
+		for (int32 X = 0; X < Width; X++)
+		{
+			PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::PackCell(true, PieceType));
+		}
+		return PackedCells;
+	}
+}
+
+// ATetrisBoard::ClearLines：離れた複数行の消去で行インデックスがずれないこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardClearLinesTest, "ClaudeTest.Tetris.Board.ClearLines", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardClearLinesTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	if (!TestNotNull(TEXT("Board spawned"), Board))
+	{
+		return false;
+	}
+
+	const int32 Width = Board->GetBoardWidth();
+	const int32 Bottom = Board->GetBoardHeight() - 1;
+
+	Board->SetBlock(5, Bottom - 3, true, EPieceType::T_Piece);
+	Board->SetPackedRow(Bottom - 2, MakeFullPackedRow(Width, EPieceType::I_Piece), false);
+	Board->SetBlock(0, Bottom - 1, true, EPieceType::J_Piece);
+	Board->SetPackedRow(Bottom, MakeFullPackedRow(Width, EPieceType::L_Piece), false);
+
+	const TArray<int32> Lines = Board->CheckCompleteLines();
+	TestEqual(TEXT("Complete lines found"), Lines.Num(), 2);
+
+	Board->ClearLines(Lines);
+
+	TestTrue(TEXT("Gap row moved to bottom"), Board->GetBlockState(0, Bottom));
+	TestEqual(TEXT("Gap row keeps piece type"), Board->GetBlockPieceType(0, Bottom), EPieceType::J_Piece);
+	TestTrue(TEXT("Top partial row moved down by two"), Board->GetBlockState(5, Bottom - 1));
+	TestEqual(TEXT("Top partial row keeps piece type"), Board->GetBlockPieceType(5, Bottom - 1), EPieceType::T_Piece);
+	TestFalse(TEXT("Moved cell left its old row"), Board->GetBlockState(5, Bottom - 3));
+
+	int32 OccupiedCells = 0;
+	for (int32 Y = 0; Y <= Bottom; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			OccupiedCells += Board->GetBlockState(X, Y) ? 1 : 0;
+		}
+	}
+	TestEqual(TEXT("Only the two partial cells remain"), OccupiedCells, 2);
+	TestEqual(TEXT("Incremental hash matches full hash"), Board->GetBoardHash(), Board->ComputeBoardHash());
+	return true;
+}
+
+// ATetrisBoard::ClearLines の速度（4行消去を繰り返す）
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardClearSpeedTest, "ClaudeTest.Tetris.Board.ClearSpeed", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardClearSpeedTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	if (!TestNotNull(TEXT("Board spawned"), Board))
+	{
+		return false;
+	}
+
+	const int32 Bottom = Board->GetBoardHeight() - 1;
+	const uint64 FullRow = MakeFullPackedRow(Board->GetBoardWidth(), EPieceType::I_Piece);
+	const TArray<int32> Lines = { Bottom - 3, Bottom - 2, Bottom - 1, Bottom };
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < 200; Iteration++)
+	{
+		for (int32 Y : Lines)
+		{
+			Board->SetPackedRow(Y, FullRow, false);
+		}
+		Board->ClearLines(Lines);
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	TestEqual(TEXT("Board empty after clears"), Board->GetBoardHash(), Board->ComputeBoardHash());
+	TestFalse(TEXT("Bottom row cleared"), Board->GetBlockState(0, Bottom));
+	TetrisTestBudgets::CheckBudget(*this, TEXT("200 board 4-line clears"), Elapsed, TetrisTestBudgets::BOARD_CLEAR_SECONDS);
+	return true;
+}
+
+// ATetrisPiece：壁までの移動と Wall Kick
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPieceMovementTest, "ClaudeTest.Tetris.Piece.MovementAndKicks", TETRIS_TEST_FLAGS)
+
+bool FTetrisPieceMovementTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	ATetrisPiece* Piece = TestWorld.Spawn<ATetrisPiece>();
+	if (!TestNotNull(TEXT("Board spawned"), Board) || !TestNotNull(TEXT("Piece spawned"), Piece))
+	{
+		return false;
+	}
+
+	// T（回転0は列0-2を使う）
+	Piece->InitializePiece(EPieceType::T_Piece, Board);
+	int32 LeftMoves = 0;
+	while (Piece->MovePiece(EMoveDirection::Left))
+	{
+		LeftMoves++;
+	}
+	TestEqual(TEXT("T left moves"), LeftMoves, TetrisRules::SPAWN_X);
+	TestEqual(TEXT("T at left wall"), Piece->GetBoardPosition().X, 0);
+
+	while (Piece->MovePiece(EMoveDirection::Right))
+	{
+	}
+	TestEqual(TEXT("T at right wall"), Piece->GetBoardPosition().X, Board->GetBoardWidth() - 3);
+
+	// 下のブロックで止まる
+	Board->SetBlock(Piece->GetBoardPosition().X + 1, 5, true, EPieceType::O_Piece);
+	while (Piece->MovePiece(EMoveDirection::Down))
+	{
+	}
+	TestEqual(TEXT("T stops on block"), Piece->GetBoardPosition().Y, 3);
+
+	// 右壁際の縦 I を回すと左にずれる
+	Piece->InitializePiece(EPieceType::I_Piece, Board);
+	TestTrue(TEXT("Rotate I to vertical"), Piece->RotatePiece(true));
+	while (Piece->MovePiece(EMoveDirection::Right))
+	{
+	}
+	TestEqual(TEXT("Vertical I at right wall"), Piece->GetBoardPosition().X, 7);
+	TestTrue(TEXT("Rotate with kick"), Piece->RotatePiece(true));
+	TestEqual(TEXT("Rotation after kick"), Piece->GetCurrentRotation(), 2);
+	TestEqual(TEXT("X after kick"), Piece->GetBoardPosition().X, 6);
+
+	// 両側が埋まった縦穴では横向きにできない
+	Piece->InitializePiece(EPieceType::I_Piece, Board);
+	Piece->RotatePiece(true);
+	for (int32 Y = 0; Y < Board->GetBoardHeight(); Y++)
+	{
+		Board->SetBlock(4, Y, true, EPieceType::O_Piece);
+		Board->SetBlock(6, Y, true, EPieceType::O_Piece);
+	}
+	TestFalse(TEXT("Rotation blocked in a well"), Piece->RotatePiece(true));
+	TestEqual(TEXT("Rotation unchanged when blocked"), Piece->GetCurrentRotation(), 1);
+	return true;
+}
+
+// ATetrisPiece：壁・障害物まで一度に動かし、床までのソフトドロップでは固定しない
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPieceInstantShiftTest, "ClaudeTest.Tetris.Piece.InstantShift", TETRIS_TEST_FLAGS)
+
+bool FTetrisPieceInstantShiftTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	ATetrisPiece* Piece = TestWorld.Spawn<ATetrisPiece>();
+	if (!TestNotNull(TEXT("Board spawned"), Board) || !TestNotNull(TEXT("Piece spawned"), Piece))
+	{
+		return false;
+	}
+
+	// T（回転0は列0-2を使う）
+	Piece->InitializePiece(EPieceType::T_Piece, Board);
+	TestEqual(TEXT("T left shift distance"), Piece->ShiftToWall(EMoveDirection::Left), TetrisRules::SPAWN_X);
+	TestEqual(TEXT("T at left wall"), Piece->GetBoardPosition().X, 0);
+	TestEqual(TEXT("No further shift at the wall"), Piece->ShiftToWall(EMoveDirection::Left), 0);
+	Piece->ShiftToWall(EMoveDirection::Right);
+	TestEqual(TEXT("T at right wall"), Piece->GetBoardPosition().X, Board->GetBoardWidth() - 3);
+
+	// 障害物の手前で止まる
+	Piece->InitializePiece(EPieceType::T_Piece, Board);
+	Board->SetBlock(1, Piece->GetBoardPosition().Y + 1, true, EPieceType::O_Piece);
+	Piece->ShiftToWall(EMoveDirection::Left);
+	TestEqual(TEXT("T stops next to the block"), Piece->GetBoardPosition().X, 2);
+
+	// 床まで落としても固定しない
+	const int32 StartY = Piece->GetBoardPosition().Y;
+	const int32 DropDistance = Piece->SoftDropToFloor();
+	TestTrue(TEXT("Soft drop to floor moves"), DropDistance > 0);
+	TestEqual(TEXT("Y after soft drop to floor"), Piece->GetBoardPosition().Y, StartY + DropDistance);
+	TestFalse(TEXT("Piece is not fixed"), Piece->IsFixed());
+	TestFalse(TEXT("Cannot move further down"), Piece->MovePiece(EMoveDirection::Down));
+	TestEqual(TEXT("Hard drop from the floor"), Piece->HardDrop(), 0);
+	TestTrue(TEXT("Hard drop fixes the piece"), Piece->IsFixed());
+	return true;
+}
+
+// ATetrisBoard：ピースとゴーストは予約済みのインスタンスをその場で書き換える
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardUnifiedInstancesTest, "ClaudeTest.Tetris.Board.UnifiedInstances", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardUnifiedInstancesTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	ATetrisPiece* Piece = TestWorld.Spawn<ATetrisPiece>();
+	if (!TestNotNull(TEXT("Board spawned"), Board) || !TestNotNull(TEXT("Piece spawned"), Piece))
+	{
+		return false;
+	}
+
+	UInstancedStaticMeshComponent* Mesh = Board->GetBlockMeshComponent();
+	auto GetInstanceLocation = [Mesh](int32 InstanceIndex)
+	{
+		FTransform Transform;
+		Mesh->GetInstanceTransform(InstanceIndex, Transform);
+		return Transform.GetLocation();
+	};
+	auto IsInstanceHidden = [Mesh](int32 InstanceIndex)
+	{
+		FTransform Transform;
+		Mesh->GetInstanceTransform(InstanceIndex, Transform);
+		return Transform.GetScale3D().IsNearlyZero();
+	};
+
+	TestEqual(TEXT("Empty board has only reserved instances"), Mesh->GetInstanceCount(), ATetrisBoard::RESERVED_INSTANCES);
+
+	Piece->InitializePiece(EPieceType::T_Piece, Board);
+	Piece->MovePiece(EMoveDirection::Left);
+	Piece->RotatePiece(true);
+	TestEqual(TEXT("Moving does not add instances"), Mesh->GetInstanceCount(), ATetrisBoard::RESERVED_INSTANCES);
+
+	// ピースの各ブロックと、その真下の床に接するゴースト
+	const TArray<FTetrisCoordinate> Cells = Piece->GetCurrentBlockPositions();
+	int32 LowestY = 0;
+	for (const FTetrisCoordinate& Cell : Cells)
+	{
+		LowestY = FMath::Max(LowestY, Cell.Y);
+	}
+	const int32 DropDistance = Board->GetBoardHeight() - 1 - LowestY;
+	for (int32 Index = 0; Index < Cells.Num(); Index++)
+	{
+		TestEqual(TEXT("Active instance at piece cell"), GetInstanceLocation(ATetrisBoard::ACTIVE_PIECE_INSTANCE + Index),
+			FVector(Cells[Index].X * 100.0f, Cells[Index].Y * 100.0f, 0.0f));
+		TestEqual(TEXT("Ghost instance on the floor"), GetInstanceLocation(ATetrisBoard::GHOST_INSTANCE + Index),
+			FVector(Cells[Index].X * 100.0f, (Cells[Index].Y + DropDistance) * 100.0f, 0.0f));
+	}
+
+	Board->SetGhostEnabled(false);
+	TestTrue(TEXT("Ghost hidden when disabled"), IsInstanceHidden(ATetrisBoard::GHOST_INSTANCE));
+
+	// 固定すると予約分は隠れ、固定セルが後ろに増える
+	Piece->HardDrop();
+	TestTrue(TEXT("Piece fixed"), Piece->IsFixed());
+	TestEqual(TEXT("Locked cells appended"), Mesh->GetInstanceCount(), ATetrisBoard::RESERVED_INSTANCES + Cells.Num());
+	for (int32 Index = 0; Index < ATetrisBoard::RESERVED_INSTANCES; Index++)
+	{
+		TestTrue(TEXT("Reserved instance hidden after lock"), IsInstanceHidden(Index));
+	}
+	return true;
+}
+
+// ATetrisGameMode：中央に落とし続けるとゲームオーバーになる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisGameModeGameOverTest, "ClaudeTest.Tetris.GameMode.GameOver", TETRIS_TEST_FLAGS)
+
+bool FTetrisGameModeGameOverTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisGameMode* GameMode = TestWorld.Spawn<ATetrisGameMode>();
+	if (!TestNotNull(TEXT("Game mode spawned"), GameMode) || !TestNotNull(TEXT("Board created"), GameMode->GetTetrisBoard()))
+	{
+		return false;
+	}
+
+	GameMode->StartNewGame();
+	TestEqual(TEXT("Playing after start"), GameMode->GetGameState(), ETetrisGameState::Playing);
+	TestNotNull(TEXT("First piece spawned"), GameMode->GetCurrentPiece());
+
+	int32 Drops = 0;
+	while (GameMode->GetGameState() == ETetrisGameState::Playing && Drops < 100)
+	{
+		GameMode->HandleHardDrop();
+		Drops++;
+	}
+
+	TestEqual(TEXT("Game over reached"), GameMode->GetGameState(), ETetrisGameState::GameOver);
+	TestTrue(TEXT("Stack fills before the board could be cleared"), Drops <= GameMode->GetTetrisBoard()->GetBoardHeight());
+	TestTrue(TEXT("Hard drops scored"), GameMode->GetGameStats().Score > 0);
+	TestEqual(TEXT("No lines cleared"), GameMode->GetGameStats().LinesCleared, 0);
+
+	// 入力はゲームオーバー後は無視される
+	const int32 FinalScore = GameMode->GetGameStats().Score;
+	GameMode->HandleHardDrop();
+	TestEqual(TEXT("Score unchanged after game over"), GameMode->GetGameStats().Score, FinalScore);
+	return true;
+}
+
+// ATetrisGameMode：スナップショットをバイト列にして戻すと状態ハッシュが一致し、ライン消去の演出中に取ったものからも再開できること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisGameModeSnapshotTest, "ClaudeTest.Tetris.GameMode.Snapshot", TETRIS_TEST_FLAGS)
+
+bool FTetrisGameModeSnapshotTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisGameMode* GameMode = TestWorld.Spawn<ATetrisGameMode>();
+	if (!TestNotNull(TEXT("Game mode spawned"), GameMode) || !TestNotNull(TEXT("Board created"), GameMode->GetTetrisBoard()))
+	{
+		return false;
+	}
+	ATetrisBoard* Board = GameMode->GetTetrisBoard();
+
+	// 取得 → バイト列 → 読み込み
+	auto CaptureThroughBytes = [this, GameMode](FTetrisGameSnapshot& OutSnapshot)
+	{
+		FTetrisGameSnapshot Captured;
+		GameMode->CaptureSnapshot(Captured);
+		TArray<uint8> Bytes;
+		Captured.ToBytes(Bytes);
+		return TestTrue(TEXT("Snapshot bytes read back"), OutSnapshot.FromBytes(Bytes));
+	};
+
+	// 操作中のピースがある状態
+	GameMode->StartNewGame();
+	GameMode->HandleMoveLeft();
+	GameMode->HandleRotate();
+	GameMode->HandleHardDrop();
+	GameMode->HandleMoveRight();
+
+	const uint64 MidGameHash = GameMode->GetStateHash();
+	const int32 MidGameScore = GameMode->GetGameStats().Score;
+	FTetrisGameSnapshot MidGame;
+	if (!CaptureThroughBytes(MidGame))
+	{
+		return false;
+	}
+
+	GameMode->HandleHardDrop();
+	GameMode->HandleHardDrop();
+	TestNotEqual(TEXT("State moved on"), GameMode->GetStateHash(), MidGameHash);
+	TestTrue(TEXT("Mid-game snapshot restored"), GameMode->RestoreSnapshot(MidGame));
+	TestEqual(TEXT("Mid-game hash restored"), GameMode->GetStateHash(), MidGameHash);
+	TestEqual(TEXT("Mid-game score restored"), GameMode->GetGameStats().Score, MidGameScore);
+
+	// ライン消去の演出中（操作中のピースなし）
+	const int32 Bottom = Board->GetBoardHeight() - 1;
+	Board->SetPackedRow(Bottom, MakeFullPackedRow(Board->GetBoardWidth(), EPieceType::I_Piece));
+	GameMode->HandleHardDrop();
+	if (!TestNull(TEXT("No active piece during the clear delay"), GameMode->GetCurrentPiece()))
+	{
+		return false;
+	}
+
+	const uint64 ClearingHash = GameMode->GetStateHash();
+	FTetrisGameSnapshot Clearing;
+	if (!CaptureThroughBytes(Clearing))
+	{
+		return false;
+	}
+
+	GameMode->TickSimulation(1.0f);
+	TestNotNull(TEXT("Next piece after the clear"), GameMode->GetCurrentPiece());
+	const uint64 AfterClearHash = GameMode->GetStateHash();
+
+	GameMode->HandleHardDrop();
+	TestTrue(TEXT("Clearing snapshot restored"), GameMode->RestoreSnapshot(Clearing));
+	TestEqual(TEXT("Clearing hash restored"), GameMode->GetStateHash(), ClearingHash);
+	TestEqual(TEXT("Still playing"), GameMode->GetGameState(), ETetrisGameState::Playing);
+
+	GameMode->TickSimulation(1.0f);
+	if (TestNotNull(TEXT("Restored game spawns the next piece"), GameMode->GetCurrentPiece()))
+	{
+		TestEqual(TEXT("Restored game resumes like the original"), GameMode->GetStateHash(), AfterClearHash);
+	}
+	return true;
+}
+
+// ATetrisGameMode：範囲外の列挙値（ピース・状態・ランダマイザー）を持つスナップショットは読み込みで弾くこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisGameModeCorruptSnapshotTest, "ClaudeTest.Tetris.GameMode.CorruptSnapshot", TETRIS_TEST_FLAGS)
+
+bool FTetrisGameModeCorruptSnapshotTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisGameMode* GameMode = TestWorld.Spawn<ATetrisGameMode>();
+	if (!TestNotNull(TEXT("Game mode spawned"), GameMode))
+	{
+		return false;
+	}
+
+	GameMode->StartNewGame();
+	GameMode->HandleHardDrop();
+	FTetrisGameSnapshot Valid;
+	GameMode->CaptureSnapshot(Valid);
+
+	auto Loads = [](const FTetrisGameSnapshot& Snapshot)
+	{
+		TArray<uint8> Bytes;
+		Snapshot.ToBytes(Bytes);
+		FTetrisGameSnapshot Loaded;
+		return Loaded.FromBytes(Bytes);
+	};
+	if (!TestTrue(TEXT("Valid snapshot loads"), Loads(Valid)))
+	{
+		return false;
+	}
+
+	struct FCorruption
+	{
+		const TCHAR* Name;
+		TFunction<void(FTetrisGameSnapshot&)> Apply;
+	};
+	const FCorruption Corruptions[] =
+	{
+		{ TEXT("Active piece out of range"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.ActivePieceType = static_cast<EPieceType>(200); } },
+		{ TEXT("Game state out of range"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.GameState = static_cast<ETetrisGameState>(9); } },
+		{ TEXT("Randomizer out of range"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.PieceQueue.RandomizerType = static_cast<ETetrisRandomizerType>(9); } },
+		{ TEXT("Next piece out of range"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.PieceQueue.Ring[0] = static_cast<EPieceType>(8); } },
+		{ TEXT("Next piece is None"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.PieceQueue.Ring[0] = EPieceType::None; } },
+		{ TEXT("History out of range"), [](FTetrisGameSnapshot& Snapshot) { Snapshot.PieceQueue.RandomizerState.History[0] = static_cast<EPieceType>(255); } },
+	};
+	for (const FCorruption& Corruption : Corruptions)
+	{
+		FTetrisGameSnapshot Corrupt = Valid;
+		Corruption.Apply(Corrupt);
+		TestFalse(Corruption.Name, Loads(Corrupt));
+	}
+
+	// 7-bag のプールは残りがある時だけ書かれる
+	if (Valid.PieceQueue.RandomizerState.PoolCount > 0)
+	{
+		FTetrisGameSnapshot Corrupt = Valid;
+		Corrupt.PieceQueue.RandomizerState.Pool[0] = EPieceType::None;
+		TestFalse(TEXT("Bag piece is None"), Loads(Corrupt));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "TetrisTestUtils.h"
+#include "TetrisArena.h"
+#include "TetrisSimulation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 移動と回転を多めに、たまに落とす
+	ETetrisInputCommand PickRandomInput(FRandomStream& Random)
+	{
+		static const ETetrisInputCommand Commands[] =
+		{
+			ETetrisInputCommand::MoveLeft, ETetrisInputCommand::MoveLeft,
+			ETetrisInputCommand::MoveRight, ETetrisInputCommand::MoveRight,
+			ETetrisInputCommand::Rotate, ETetrisInputCommand::Rotate,
+			ETetrisInputCommand::MoveDown,
+			ETetrisInputCommand::HardDrop,
+			ETetrisInputCommand::ShiftLeft,
+			ETetrisInputCommand::ShiftRight,
+			ETetrisInputCommand::SoftDropToFloor
+		};
+		return Commands[Random.RandRange(0, UE_ARRAY_COUNT(Commands) - 1)];
+	}
+}
+
+// 並列に進めたアリーナの各ゲームが、同じシード・同じ入力を与えた FTetrisSimGame と全ルールセットで一致すること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisArenaMatchesSimulationTest, "ClaudeTest.Tetris.Arena.MatchesSimulation", TETRIS_TEST_FLAGS)
+
+bool FTetrisArenaMatchesSimulationTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_GAMES = FTetrisArena::CHUNK_GAMES * 2 + 5;
+	constexpr int32 NUM_STEPS = 3000;
+	constexpr int64 STEP_MICROSECONDS = 16667;
+
+	for (ETetrisRuleset Ruleset : { ETetrisRuleset::Modern, ETetrisRuleset::Classic, ETetrisRuleset::TGM })
+	{
+		FTetrisSimConfig Config;
+		Config.Seed = 100;
+		Config.LineClearDelayMicroseconds = 50000;
+		Config.Ruleset = Ruleset;
+
+		FTetrisArena Arena;
+		Arena.Initialize(Config, NUM_GAMES);
+
+		TArray<FTetrisSimGame> Games;
+		TArray<FRandomStream> Randoms;
+		Games.SetNum(NUM_GAMES);
+		for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+		{
+			FTetrisSimConfig GameConfig = Config;
+			GameConfig.Seed = Config.Seed + GameIndex;
+			Games[GameIndex].Reset(GameConfig);
+			Randoms.Emplace(GameIndex);
+		}
+
+		for (int32 StepIndex = 0; StepIndex < NUM_STEPS; StepIndex++)
+		{
+			for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+			{
+				const int32 NumInputs = Randoms[GameIndex].RandRange(0, 2);
+				for (int32 InputIndex = 0; InputIndex < NumInputs; InputIndex++)
+				{
+					const ETetrisInputCommand Command = PickRandomInput(Randoms[GameIndex]);
+					Arena.QueueInput(GameIndex, Command);
+					Games[GameIndex].ApplyInput(Command);
+				}
+				Games[GameIndex].Advance(STEP_MICROSECONDS);
+			}
+			Arena.Step(STEP_MICROSECONDS, 4);
+
+			for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+			{
+				const FTetrisSimGame& Game = Games[GameIndex];
+				const FTetrisSimBoard& Board = Game.GetBoard();
+				const FTetrisGameStats ArenaStats = Arena.GetStats(GameIndex);
+				bool bMatches = Arena.IsGameOver(GameIndex) == Game.IsGameOver()
+					&& Arena.GetActivePiece(GameIndex) == Game.GetActivePiece()
+					&& Arena.GetActiveRotation(GameIndex) == Game.GetActiveRotation()
+					&& Arena.GetActiveX(GameIndex) == Game.GetActiveX()
+					&& Arena.GetActiveY(GameIndex) == Game.GetActiveY()
+					&& Arena.GetElapsedMicroseconds(GameIndex) == Game.GetElapsedMicroseconds()
+					&& ArenaStats.Score == Game.GetStats().Score
+					&& ArenaStats.Level == Game.GetStats().Level
+					&& ArenaStats.LinesCleared == Game.GetStats().LinesCleared
+					&& ArenaStats.PiecesPlaced == Game.GetStats().PiecesPlaced
+					&& FMemory::Memcmp(Arena.GetRows(GameIndex), Board.Rows, Board.Height * sizeof(uint16)) == 0
+					&& FMemory::Memcmp(Arena.GetPackedRows(GameIndex), Board.PackedRows, Board.Height * sizeof(uint64)) == 0;
+				for (int32 Slot = 0; Slot < Game.GetQueue().GetPreviewCount(); Slot++)
+				{
+					bMatches &= Arena.GetQueue(GameIndex).Peek(Slot) == Game.GetQueue().Peek(Slot);
+				}
+				if (!bMatches)
+				{
+					AddError(FString::Printf(TEXT("Ruleset %d game %d diverged from the simulation at step %d"), int32(Ruleset), GameIndex, StepIndex));
+					return false;
+				}
+			}
+		}
+
+		int32 TotalLines = 0;
+		for (const FTetrisSimGame& Game : Games)
+		{
+			TotalLines += Game.GetStats().LinesCleared;
+		}
+		AddInfo(FString::Printf(TEXT("Arena ruleset %d: %d games, %d lines, %d alive"), int32(Ruleset), NUM_GAMES, TotalLines, Arena.GetArenaStats().NumAlive));
+	}
+	return true;
+}
+
+// 1000 ゲームで1ゲームあたり 1 KB 未満、1ステップが予算内に収まること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisArenaScaleTest, "ClaudeTest.Tetris.Arena.Scale", TETRIS_TEST_FLAGS)
+
+bool FTetrisArenaScaleTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_GAMES = 1000;
+	constexpr int32 NUM_STEPS = 200;
+
+	FTetrisSimConfig Config;
+	FTetrisArena Arena;
+	Arena.Initialize(Config, NUM_GAMES);
+
+	FRandomStream Random(7);
+	double SlowestStepSeconds = 0.0;
+	for (int32 StepIndex = 0; StepIndex < NUM_STEPS; StepIndex++)
+	{
+		for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+		{
+			Arena.QueueInput(GameIndex, PickRandomInput(Random));
+		}
+		Arena.Step(16667);
+		SlowestStepSeconds = FMath::Max(SlowestStepSeconds, Arena.GetArenaStats().StepSecondsPer1000Games);
+	}
+
+	const FTetrisArenaStats Stats = Arena.GetArenaStats();
+	AddInfo(FString::Printf(TEXT("Arena: %d bytes per game, %lld bytes allocated, %d alive"), Stats.BytesPerGame, Stats.AllocatedBytes, Stats.NumAlive));
+	TestTrue(TEXT("Under 1 KB per game"), Stats.BytesPerGame < 1024);
+	TestTrue(TEXT("One allocation holds every column"), Stats.AllocatedBytes < int64(Stats.BytesPerGame + 64) * NUM_GAMES);
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Slowest arena step per 1000 games"), SlowestStepSeconds, TetrisTestBudgets::ARENA_STEP_1000_SECONDS);
+	return true;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include "TetrisTestUtils.h"
+#include "TetrisBeamSearch.h"
+#include "TetrisSimulation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 入力列をゲームに適用する（最後のハードドロップで固定され、次のピースが出る）
+	void ApplyInputs(FTetrisSimGame& Game, const TArray<ETetrisInputCommand>& Inputs)
+	{
+		for (ETetrisInputCommand Command : Inputs)
+		{
+			Game.ApplyInput(Command);
+		}
+	}
+}
+
+// 列挙した全ての固定位置に、復元した入力列で実際に置けること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisInputPathTest, "ClaudeTest.Tetris.BeamSearch.InputPath", TETRIS_TEST_FLAGS)
+
+bool FTetrisInputPathTest::RunTest(const FString& Parameters)
+{
+	for (int32 TypeIndex = 1; TypeIndex <= 7; TypeIndex++)
+	{
+		const EPieceType PieceType = static_cast<EPieceType>(TypeIndex);
+		FTetrisSimGame Game;
+		if (!TestTrue(TEXT("Found seed for piece"), TetrisTestUtils::ResetWithFirstPiece(Game, PieceType)))
+		{
+			continue;
+		}
+
+		TArray<FTetrisSimPlacement> Placements;
+		TetrisMoveGen::GenerateLockPlacements(Game.GetBoard(), PieceType, Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(), Placements);
+
+		for (const FTetrisSimPlacement& Placement : Placements)
+		{
+			TArray<ETetrisInputCommand> Inputs;
+			if (!TestTrue(TEXT("Input path found"), TetrisMoveGen::FindInputPath(Game.GetBoard(), PieceType,
+				Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(), Placement, Inputs)))
+			{
+				return false;
+			}
+			TestEqual(TEXT("Path ends with hard drop"), Inputs.Last(), ETetrisInputCommand::HardDrop);
+
+			FTetrisSimBoard Expected = Game.GetBoard();
+			Expected.Place(PieceType, Placement.Rotation, Placement.X, Placement.Y);
+
+			FTetrisSimGame Played = Game;
+			ApplyInputs(Played, Inputs);
+			for (int32 Y = 0; Y < Expected.Height; Y++)
+			{
+				if (Played.GetBoard().Rows[Y] != Expected.Rows[Y])
+				{
+					AddError(FString::Printf(TEXT("Piece %d rotation %d at (%d, %d): row %d differs"),
+						TypeIndex, Placement.Rotation, Placement.X, Placement.Y, Y));
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// スレッド数によらず同じ手を選び、時間切れでも最初の段の最良手を返すこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBeamSearchDeterminismTest, "ClaudeTest.Tetris.BeamSearch.Determinism", TETRIS_TEST_FLAGS)
+
+bool FTetrisBeamSearchDeterminismTest::RunTest(const FString& Parameters)
+{
+	FTetrisBeamSearchSettings Settings;
+	Settings.BeamWidth = 32;
+	Settings.MaxDepth = 3;
+	Settings.TimeBudgetSeconds = 0.0;
+
+	FTetrisBeamSearchSettings ParallelSettings = Settings;
+	ParallelSettings.MaxThreads = 4;
+
+	FTetrisBeamSearch SingleThreaded(Settings);
+	FTetrisBeamSearch Parallel(ParallelSettings);
+
+	FTetrisSimConfig Config;
+	Config.Seed = 7;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	for (int32 Piece = 0; Piece < 30 && !Game.IsGameOver(); Piece++)
+	{
+		FTetrisBeamSearchResult SingleResult;
+		FTetrisBeamSearchResult ParallelResult;
+		TestTrue(TEXT("Single-threaded search found a move"), SingleThreaded.FindBestMove(Game, SingleResult));
+		TestTrue(TEXT("Parallel search found a move"), Parallel.FindBestMove(Game, ParallelResult));
+
+		TestEqual(TEXT("Depth completed"), SingleResult.DepthCompleted, 3);
+		TestEqual(TEXT("Same rotation"), ParallelResult.Placement.Rotation, SingleResult.Placement.Rotation);
+		TestEqual(TEXT("Same X"), ParallelResult.Placement.X, SingleResult.Placement.X);
+		TestEqual(TEXT("Same Y"), ParallelResult.Placement.Y, SingleResult.Placement.Y);
+		TestEqual(TEXT("Same score"), ParallelResult.Score, SingleResult.Score);
+
+		ApplyInputs(Game, SingleResult.Inputs);
+	}
+
+	// 予算を使い切った状態から呼んでも、深さ1の結果で手を返す
+	Settings.TimeBudgetSeconds = 1e-9;
+	FTetrisBeamSearch Hurried(Settings);
+	FTetrisBeamSearchResult HurriedResult;
+	TestTrue(TEXT("Timed-out search still returns a move"), Hurried.FindBestMove(Game, HurriedResult));
+	TestTrue(TEXT("Timed out"), HurriedResult.bTimedOut);
+	TestEqual(TEXT("Timed-out depth"), HurriedResult.DepthCompleted, 1);
+	TestTrue(TEXT("Timed-out inputs"), HurriedResult.Inputs.Num() > 0);
+	return true;
+}
+
+// 先読みするボットが 200 ピース生き残り、1手が予算内に収まること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBeamSearchPlayTest, "ClaudeTest.Tetris.BeamSearch.Play", TETRIS_TEST_FLAGS)
+
+bool FTetrisBeamSearchPlayTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_PIECES = 200;
+
+	FTetrisBeamSearchSettings Settings;
+	Settings.TimeBudgetSeconds = TetrisTestBudgets::BEAM_MOVE_SECONDS;
+	FTetrisBeamSearch BeamSearch(Settings);
+
+	FTetrisSimConfig Config;
+	Config.Seed = 3;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	double SlowestMoveSeconds = 0.0;
+	while (!Game.IsGameOver() && Game.GetStats().PiecesPlaced < NUM_PIECES)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FTetrisBeamSearchResult Result;
+		if (!TestTrue(TEXT("Beam search found a move"), BeamSearch.FindBestMove(Game, Result)))
+		{
+			return false;
+		}
+		SlowestMoveSeconds = FMath::Max(SlowestMoveSeconds, FPlatformTime::Seconds() - StartTime);
+
+		ApplyInputs(Game, Result.Inputs);
+	}
+
+	TestFalse(TEXT("Beam bot survives"), Game.IsGameOver());
+	AddInfo(FString::Printf(TEXT("Beam bot: %d lines in %d pieces"), Game.GetStats().LinesCleared, Game.GetStats().PiecesPlaced));
+
+	// 時間切れは親を展開する前に見るので、最後の1つの展開と絞り込みの分だけはみ出す
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Slowest beam search move"), SlowestMoveSeconds, TetrisTestBudgets::BEAM_MOVE_SECONDS * 2.0);
+	return true;
+}
+
+#endif
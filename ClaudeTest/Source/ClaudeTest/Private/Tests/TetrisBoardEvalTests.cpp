@@ -0,0 +1,216 @@
+#include "TetrisTestUtils.h"
+#include "TetrisBoardEval.h"
+#include "TetrisSimulation.h"
+#include "TetrisBoard.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// ランダムな行から下をランダムな密度で埋めた盤面
+	FTetrisSimBoard MakeRandomBoard(FRandomStream& Random, int32 Width, int32 Height)
+	{
+		FTetrisSimBoard Board;
+		Board.Reset(Width, Height);
+
+		const float Density = Random.FRand();
+		for (int32 Y = Random.RandRange(0, Board.Height); Y < Board.Height; Y++)
+		{
+			uint64 PackedCells = 0;
+			for (int32 X = 0; X < Board.Width; X++)
+			{
+				if (Random.FRand() < Density)
+				{
+					PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::CELL_UNTYPED);
+				}
+			}
+			Board.SetPackedRow(Y, PackedCells);
+		}
+		return Board;
+	}
+}
+
+// ベクタ版と参照実装が全ての特徴量で一致すること（盤面サイズ・端数レーン・容量超過を含む）
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardEvalMatchTest, "ClaudeTest.Tetris.BoardEval.MatchesScalar", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardEvalMatchTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1234);
+	const FIntPoint Sizes[] = { { 10, 20 }, { 4, 4 }, { 16, 24 }, { 7, 13 } };
+
+	for (const FIntPoint& Size : Sizes)
+	{
+		// 容量 8 から始めて 103 個（4 の倍数でない）まで追加する
+		FTetrisBoardBatch Batch;
+		Batch.Reset(Size.X, Size.Y, 8);
+
+		TArray<FTetrisSimBoard> Boards;
+		for (int32 i = 0; i < 103; i++)
+		{
+			Boards.Add(MakeRandomBoard(Random, Size.X, Size.Y));
+			TestEqual(TEXT("Batch index"), Batch.Add(Boards.Last()), i);
+		}
+
+		TArray<FTetrisBoardFeatures> Features;
+		TetrisBoardEval::ComputeFeaturesBatch(Batch, Features);
+		TestEqual(TEXT("Feature count"), Features.Num(), Boards.Num());
+
+		for (int32 i = 0; i < Boards.Num(); i++)
+		{
+			FTetrisBoardFeatures Expected;
+			TetrisBoardEval::ComputeFeatures(Boards[i], Expected);
+			if (!(Features[i] == Expected))
+			{
+				AddError(FString::Printf(TEXT("%dx%d board %d: batch (h %d, max %d, holes %d, bump %d, trans %d, wells %d) != scalar (h %d, max %d, holes %d, bump %d, trans %d, wells %d)"),
+					Size.X, Size.Y, i,
+					Features[i].AggregateHeight, Features[i].MaxHeight, Features[i].Holes, Features[i].Bumpiness, Features[i].RowTransitions, Features[i].WellDepth,
+					Expected.AggregateHeight, Expected.MaxHeight, Expected.Holes, Expected.Bumpiness, Expected.RowTransitions, Expected.WellDepth));
+				return false;
+			}
+		}
+	}
+
+	// 既知の盤面（列1の2段目が穴、列3と列5の最下段が井戸）
+	const FTetrisSimBoard Known = TetrisTestUtils::MakeSimBoard({
+		TEXT("XX.......X"),
+		TEXT("X.X.....XX"),
+		TEXT("XXX.X.XXXX"),
+	});
+	FTetrisBoardFeatures KnownFeatures;
+	TetrisBoardEval::ComputeFeatures(Known, KnownFeatures);
+	TestEqual(TEXT("Known aggregate height"), KnownFeatures.AggregateHeight, 3 + 3 + 2 + 0 + 1 + 0 + 1 + 1 + 2 + 3);
+	TestEqual(TEXT("Known max height"), KnownFeatures.MaxHeight, 3);
+	TestEqual(TEXT("Known holes"), KnownFeatures.Holes, 1);
+	TestEqual(TEXT("Known bumpiness"), KnownFeatures.Bumpiness, 8);
+	TestEqual(TEXT("Known wells"), KnownFeatures.WellDepth, 2);
+	return true;
+}
+
+// スループット：ゲームの盤面（ATetrisBoard::GetBlockState）を1盤面ずつセル単位で評価するより 10 倍以上速いこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardEvalSpeedTest, "ClaudeTest.Tetris.BoardEval.Throughput", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardEvalSpeedTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_BOARDS = 4096;
+	constexpr int32 NUM_ACTOR_BOARDS = 64;
+	constexpr int32 BATCH_PASSES = 20;
+	constexpr int32 CELL_PASSES = 16;
+	constexpr int32 REPEATS = 3;
+
+	// ATetrisBoard は 64 個だけ作り、バッチ側は同じ 64 盤面を繰り返して並べる（チェックサムを比べられる）
+	FTetrisTestWorld TestWorld;
+	FRandomStream Random(42);
+	TArray<FTetrisSimBoard> Boards;
+	TArray<ATetrisBoard*> ActorBoards;
+	for (int32 i = 0; i < NUM_ACTOR_BOARDS; i++)
+	{
+		ATetrisBoard* ActorBoard = TestWorld.Spawn<ATetrisBoard>();
+		if (!TestNotNull(TEXT("Board spawned"), ActorBoard) || !TestEqual(TEXT("Board width"), ActorBoard->GetBoardWidth(), int32(TetrisConstants::BOARD_WIDTH)))
+		{
+			return false;
+		}
+		Boards.Add(MakeRandomBoard(Random, ActorBoard->GetBoardWidth(), ActorBoard->GetBoardHeight()));
+		for (int32 Y = 0; Y < Boards.Last().Height; Y++)
+		{
+			uint64 PackedCells = 0;
+			for (int32 X = 0; X < Boards.Last().Width; X++)
+			{
+				if (Boards.Last().IsCellOccupied(X, Y))
+				{
+					PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::CELL_UNTYPED);
+				}
+			}
+			ActorBoard->SetPackedRow(Y, PackedCells, false);
+		}
+		ActorBoards.Add(ActorBoard);
+	}
+
+	FTetrisBoardBatch Batch;
+	Batch.Reset(Boards[0].Width, Boards[0].Height, NUM_BOARDS);
+	for (int32 i = 0; i < NUM_BOARDS; i++)
+	{
+		Batch.Add(Boards[i % NUM_ACTOR_BOARDS]);
+	}
+
+	// 最適化で消えないよう結果を足し合わせる。タイマーのぶれを避けるため各方式とも最速の回を使う
+	auto SumFeatures = [](const FTetrisBoardFeatures& Features)
+	{
+		return int64(Features.AggregateHeight + Features.Holes + Features.Bumpiness + Features.RowTransitions + Features.WellDepth);
+	};
+	auto MeasureBest = [](TFunctionRef<void()> Body)
+	{
+		double BestSeconds = TNumericLimits<double>::Max();
+		for (int32 Repeat = 0; Repeat < REPEATS; Repeat++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Body();
+			BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+		}
+		return BestSeconds;
+	};
+
+	int64 CellChecksum = 0;
+	const double CellSeconds = MeasureBest([&]()
+	{
+		CellChecksum = 0;
+		for (int32 Pass = 0; Pass < CELL_PASSES; Pass++)
+		{
+			for (const ATetrisBoard* ActorBoard : ActorBoards)
+			{
+				FTetrisBoardFeatures Features;
+				TetrisBoardEval::ComputeFeaturesFromCells(ActorBoard->GetBoardWidth(), ActorBoard->GetBoardHeight(),
+					[ActorBoard](int32 X, int32 Y) { return ActorBoard->GetBlockState(X, Y); }, Features);
+				CellChecksum += SumFeatures(Features);
+			}
+		}
+	});
+
+	int64 SimChecksum = 0;
+	const double SimSeconds = MeasureBest([&]()
+	{
+		SimChecksum = 0;
+		for (int32 Pass = 0; Pass < CELL_PASSES; Pass++)
+		{
+			for (const FTetrisSimBoard& Board : Boards)
+			{
+				FTetrisBoardFeatures Features;
+				TetrisBoardEval::ComputeFeatures(Board, Features);
+				SimChecksum += SumFeatures(Features);
+			}
+		}
+	});
+
+	int64 BatchChecksum = 0;
+	TArray<FTetrisBoardFeatures> BatchFeatures;
+	const double BatchSeconds = MeasureBest([&]()
+	{
+		BatchChecksum = 0;
+		for (int32 Pass = 0; Pass < BATCH_PASSES; Pass++)
+		{
+			TetrisBoardEval::ComputeFeaturesBatch(Batch, BatchFeatures);
+			for (const FTetrisBoardFeatures& Features : BatchFeatures)
+			{
+				BatchChecksum += SumFeatures(Features);
+			}
+		}
+	});
+
+	// バッチは 64 盤面を NUM_BOARDS / 64 回繰り返しているので、1回分に揃えて比べる
+	const int64 CellEvaluations = int64(NUM_ACTOR_BOARDS) * CELL_PASSES;
+	const int64 BatchEvaluations = int64(NUM_BOARDS) * BATCH_PASSES;
+	TestEqual(TEXT("Sim reference checksum matches GetBlockState"), SimChecksum, CellChecksum);
+	TestEqual(TEXT("Batch checksum matches GetBlockState"), BatchChecksum, CellChecksum * BatchEvaluations / CellEvaluations);
+
+	const double CellNanoseconds = CellSeconds * 1.0e9 / CellEvaluations;
+	const double SimNanoseconds = SimSeconds * 1.0e9 / CellEvaluations;
+	const double BatchNanoseconds = BatchSeconds * 1.0e9 / BatchEvaluations;
+	const double Speedup = CellNanoseconds / FMath::Max(BatchNanoseconds, 1e-3);
+	AddInfo(FString::Printf(TEXT("Board features per board: GetBlockState %.1f ns, sim board %.1f ns, batch %.1f ns (%.1fx over GetBlockState, %.1fx over sim board)"),
+		CellNanoseconds, SimNanoseconds, BatchNanoseconds, Speedup, SimNanoseconds / FMath::Max(BatchNanoseconds, 1e-3)));
+
+	TestTrue(TEXT("Batch evaluation is at least 10x faster than a GetBlockState loop"), Speedup >= 10.0);
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Batch board features"), BatchSeconds, TetrisTestBudgets::BOARD_EVAL_SECONDS);
+	return true;
+}
+
+#endif
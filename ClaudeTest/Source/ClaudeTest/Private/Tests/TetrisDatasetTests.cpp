@@ -0,0 +1,304 @@
+#include "TetrisTestUtils.h"
+#include "TetrisDatasetExporter.h"
+#include "TetrisSimulation.h"
+#include "TetrisBot.h"
+#include "TetrisGameMode.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "UObject/UnrealType.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 記録の占有ビットから盤面を作る
+	FTetrisSimBoard MakeBoardFromRecord(const FTetrisDatasetHeader& Header, const FTetrisDecisionRecord& Record)
+	{
+		FTetrisSimBoard Board;
+		Board.Reset(Header.BoardWidth, Header.BoardHeight);
+		for (int32 Y = 0; Y < Board.Height; Y++)
+		{
+			uint64 PackedCells = 0;
+			for (int32 X = 0; X < Board.Width; X++)
+			{
+				if ((Record.BoardRows[Y] >> X) & 1)
+				{
+					PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::CELL_UNTYPED);
+				}
+			}
+			Board.SetPackedRow(Y, PackedCells);
+		}
+		return Board;
+	}
+
+	// エディタで設定するゲームモードのプロパティをテストから変える
+	template<typename PropertyType, typename ValueType>
+	void SetGameModeProperty(ATetrisGameMode* GameMode, const TCHAR* Name, const ValueType& Value)
+	{
+		PropertyType* Property = FindFProperty<PropertyType>(ATetrisGameMode::StaticClass(), Name);
+		check(Property);
+		Property->SetPropertyValue_InContainer(GameMode, Value);
+	}
+}
+
+// ボット対戦を書き出して読み戻し、各判断点の「状態 + 行動」が次の判断点の状態になること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisDatasetRoundTripTest, "ClaudeTest.Tetris.Dataset.RoundTrip", TETRIS_TEST_FLAGS)
+
+bool FTetrisDatasetRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TetrisDatasetRoundTrip.tdset"));
+
+	FTetrisSimConfig Config;
+	Config.Seed = 11;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	// チャンクを小さくして入れ替えを何度も起こす
+	FTetrisDatasetExporter Exporter;
+	if (!TestTrue(TEXT("Exporter opened"), Exporter.Open(Path, Config.BoardWidth, Config.BoardHeight, Config.PreviewCount, 64)))
+	{
+		return false;
+	}
+	Game.SetDatasetExporter(&Exporter);
+
+	const FTetrisBotWeights Weights;
+	TArray<ETetrisInputCommand> Inputs;
+	while (!Game.IsGameOver() && Game.GetStats().PiecesPlaced < 1000)
+	{
+		if (!TetrisBot::FindBestPlacement(Game, Weights, Inputs))
+		{
+			break;
+		}
+		for (ETetrisInputCommand Command : Inputs)
+		{
+			Game.ApplyInput(Command);
+		}
+	}
+
+	Game.SetDatasetExporter(nullptr);
+	Exporter.Close();
+
+	FTetrisDatasetHeader Header;
+	TArray<FTetrisDecisionRecord> Records;
+	if (!TestTrue(TEXT("Dataset read back"), FTetrisDatasetExporter::ReadFile(Path, Header, Records)))
+	{
+		return false;
+	}
+	IFileManager::Get().Delete(*Path);
+
+	const int32 PiecesLocked = Game.GetStats().PiecesPlaced - (Game.HasActivePiece() ? 1 : 0);
+	TestEqual(TEXT("One record per locked piece"), Records.Num(), PiecesLocked);
+	TestEqual(TEXT("Header record count"), Header.NumRecords, int64(Records.Num()));
+	TestEqual(TEXT("Header preview count"), Header.PreviewCount, Config.PreviewCount);
+
+	int32 TotalLines = 0;
+	for (int32 Index = 0; Index < Records.Num(); Index++)
+	{
+		const FTetrisDecisionRecord& Record = Records[Index];
+		TotalLines += Record.LinesCleared;
+		TestEqual(TEXT("Game id"), Record.GameId, uint32(Config.Seed));
+		TestEqual(TEXT("Piece index"), Record.PieceIndex, uint32(Index));
+
+		if (Index + 1 == Records.Num())
+		{
+			break;
+		}
+
+		const FTetrisDecisionRecord& Next = Records[Index + 1];
+		FTetrisSimBoard Board = MakeBoardFromRecord(Header, Record);
+		Board.Place(Record.Piece, Record.Rotation, Record.X, Record.Y);
+		const int32 LinesCleared = Board.ClearFullRows();
+
+		if (LinesCleared != Record.LinesCleared || FMemory::Memcmp(Board.Rows, Next.BoardRows, Board.Height * sizeof(uint16)) != 0)
+		{
+			AddError(FString::Printf(TEXT("Record %d: state + action does not produce the next state"), Index));
+			return false;
+		}
+		TestEqual(TEXT("Next piece comes from the queue"), Next.Piece, Record.Queue[0]);
+		TestEqual(TEXT("Reward is the line clear score"), Record.Reward > 0, LinesCleared > 0);
+	}
+	TestEqual(TEXT("Lines cleared"), TotalLines, Game.GetStats().LinesCleared);
+	return true;
+}
+
+// 表のチャンクが途中まで埋まった状態で閉じても、全件が読み戻せること
+// 直前に渡したチャンクの書き込みと停止が重なるよう、チャンクを渡した直後に閉じる回を繰り返す
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisDatasetCloseTest, "ClaudeTest.Tetris.Dataset.Close", TETRIS_TEST_FLAGS)
+
+bool FTetrisDatasetCloseTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 CHUNK_RECORDS = 8;
+	constexpr int32 ITERATIONS = 64;
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TetrisDatasetClose.tdset"));
+
+	FTetrisDecisionRecord Record;
+	Record.Piece = EPieceType::S_Piece;
+
+	for (int32 Iteration = 0; Iteration < ITERATIONS; Iteration++)
+	{
+		// 0〜3 チャンク分 + 端数 1〜7 件（0 件の回も混ぜる）
+		const int32 NumRecords = (Iteration % 4) * CHUNK_RECORDS + Iteration % CHUNK_RECORDS;
+
+		FTetrisDatasetExporter Exporter;
+		if (!TestTrue(TEXT("Exporter opened"), Exporter.Open(Path, TetrisConstants::BOARD_WIDTH, TetrisConstants::BOARD_HEIGHT, 5, CHUNK_RECORDS)))
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < NumRecords; Index++)
+		{
+			Record.PieceIndex = Index;
+			Exporter.Add(Record);
+		}
+		Exporter.Close();
+
+		FTetrisDatasetHeader Header;
+		TArray<FTetrisDecisionRecord> Records;
+		if (!TestTrue(TEXT("Dataset read back"), FTetrisDatasetExporter::ReadFile(Path, Header, Records)))
+		{
+			return false;
+		}
+		if (Records.Num() != NumRecords || Header.NumRecords != NumRecords)
+		{
+			AddError(FString::Printf(TEXT("Iteration %d: wrote %d records, header says %lld, read %d"), Iteration, NumRecords, Header.NumRecords, Records.Num()));
+			break;
+		}
+		for (int32 Index = 0; Index < Records.Num(); Index++)
+		{
+			if (Records[Index].PieceIndex != uint32(Index))
+			{
+				AddError(FString::Printf(TEXT("Iteration %d: record %d has piece index %u"), Iteration, Index, Records[Index].PieceIndex));
+				break;
+			}
+		}
+	}
+
+	IFileManager::Get().Delete(*Path);
+	return true;
+}
+
+// ゲームモード（アクター）の書き出し：接地・ハードドロップのどちらで固定しても、記録の盤面は固定前（ピースのセルを含まない）で、
+// 「状態 + 行動」が次の判断点の状態になること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisDatasetGameModeTest, "ClaudeTest.Tetris.Dataset.GameMode", TETRIS_TEST_FLAGS)
+
+bool FTetrisDatasetGameModeTest::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TetrisDatasetGameMode"));
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	FTetrisTestWorld TestWorld;
+	ATetrisGameMode* GameMode = TestWorld.Spawn<ATetrisGameMode>();
+	if (!TestNotNull(TEXT("Game mode spawned"), GameMode) || !TestNotNull(TEXT("Board created"), GameMode->GetTetrisBoard()))
+	{
+		return false;
+	}
+	SetGameModeProperty<FBoolProperty>(GameMode, TEXT("bExportDataset"), true);
+	SetGameModeProperty<FStrProperty>(GameMode, TEXT("DatasetDirectory"), Directory);
+	SetGameModeProperty<FFloatProperty>(GameMode, TEXT("LineClearDelay"), 0.0f);
+
+	GameMode->StartNewGame();
+	for (int32 Piece = 0; Piece < 16 && GameMode->GetGameState() == ETetrisGameState::Playing; Piece++)
+	{
+		// 置く列をばらし、偶数番目はハードドロップ、奇数番目は接地するまで下移動で固定する
+		for (int32 Move = 0; Move < Piece % 5; Move++)
+		{
+			if (Piece % 2)
+			{
+				GameMode->HandleMoveLeft();
+			}
+			else
+			{
+				GameMode->HandleMoveRight();
+			}
+		}
+		if (Piece % 2 == 0)
+		{
+			GameMode->HandleHardDrop();
+			continue;
+		}
+
+		const int32 PiecesPlaced = GameMode->GetGameStats().PiecesPlaced;
+		for (int32 Step = 0; Step <= GameMode->GetTetrisBoard()->GetBoardHeight() && GameMode->GetGameState() == ETetrisGameState::Playing
+			&& GameMode->GetGameStats().PiecesPlaced == PiecesPlaced; Step++)
+		{
+			GameMode->HandleMoveDown();
+		}
+	}
+	GameMode->EndGame();
+
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("*.tdset")), true, false);
+	if (!TestEqual(TEXT("One dataset file"), Files.Num(), 1))
+	{
+		return false;
+	}
+
+	FTetrisDatasetHeader Header;
+	TArray<FTetrisDecisionRecord> Records;
+	const bool bRead = FTetrisDatasetExporter::ReadFile(FPaths::Combine(Directory, Files[0]), Header, Records);
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	if (!TestTrue(TEXT("Dataset read back"), bRead) || !TestTrue(TEXT("Pieces recorded"), Records.Num() >= 4))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Records.Num(); Index++)
+	{
+		const FTetrisDecisionRecord& Record = Records[Index];
+		FTetrisSimBoard Board = MakeBoardFromRecord(Header, Record);
+		if (!Board.CanPlace(Record.Piece, Record.Rotation, Record.X, Record.Y))
+		{
+			AddError(FString::Printf(TEXT("Record %d: board already contains the locked piece"), Index));
+			return false;
+		}
+		if (Index + 1 == Records.Num())
+		{
+			break;
+		}
+
+		Board.Place(Record.Piece, Record.Rotation, Record.X, Record.Y);
+		Board.ClearFullRows();
+		if (FMemory::Memcmp(Board.Rows, Records[Index + 1].BoardRows, Board.Height * sizeof(uint16)) != 0)
+		{
+			AddError(FString::Printf(TEXT("Record %d: state + action does not produce the next state"), Index));
+			return false;
+		}
+	}
+	return true;
+}
+
+// 生産者側のコスト：大量の判断点を追加しても、書き込みを待たずにコピーだけで済むこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisDatasetThroughputTest, "ClaudeTest.Tetris.Dataset.Throughput", TETRIS_TEST_FLAGS)
+
+bool FTetrisDatasetThroughputTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_RECORDS = 200000;
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TetrisDatasetThroughput.tdset"));
+
+	FTetrisDatasetExporter Exporter;
+	if (!TestTrue(TEXT("Exporter opened"), Exporter.Open(Path, TetrisConstants::BOARD_WIDTH, TetrisConstants::BOARD_HEIGHT, 6)))
+	{
+		return false;
+	}
+
+	FTetrisDecisionRecord Record;
+	Record.Piece = EPieceType::T_Piece;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NUM_RECORDS; Index++)
+	{
+		Record.PieceIndex = Index;
+		Record.BoardRows[TetrisConstants::BOARD_HEIGHT - 1] = static_cast<uint16>(Index);
+		Exporter.Add(Record);
+	}
+	const double AddSeconds = FPlatformTime::Seconds() - StartTime;
+
+	Exporter.Close();
+	AddInfo(FString::Printf(TEXT("Dataset: %d records, %lld bytes, %lld stalls"), NUM_RECORDS, Exporter.GetBytesWritten(), Exporter.GetNumStalls()));
+	TestEqual(TEXT("Records counted"), Exporter.GetNumRecords(), int64(NUM_RECORDS));
+	IFileManager::Get().Delete(*Path);
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Dataset add"), AddSeconds, TetrisTestBudgets::DATASET_ADD_SECONDS);
+	return true;
+}
+
+#endif
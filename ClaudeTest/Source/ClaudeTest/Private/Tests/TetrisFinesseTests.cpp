@@ -0,0 +1,165 @@
+#include "TetrisTestUtils.h"
+#include "TetrisFinesse.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 空の盤面で真下に落として固定したセル
+	TArray<FTetrisCoordinate> GetDroppedCells(const FTetrisSimBoard& Board, EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+	{
+		TArray<FTetrisCoordinate> Cells;
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Rotation);
+		const int32 DropY = Board.GetDropY(PieceType, Rotation, X, Y);
+		for (int32 CellY = 0; CellY < TetrisConstants::PIECE_SIZE; CellY++)
+		{
+			for (int32 CellX = 0; CellX < TetrisConstants::PIECE_SIZE; CellX++)
+			{
+				if (TetrisPieceTables::IsShapeCellSet(ShapeMask, CellX, CellY))
+				{
+					Cells.Add(FTetrisCoordinate(X + CellX, DropY + CellY));
+				}
+			}
+		}
+		return Cells;
+	}
+}
+
+// 表のキー列をゲームの入力で再生すると目標の位置に届き、最短の入力列よりキーが多くならないこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisFinesseTableTest, "ClaudeTest.Tetris.Finesse.Table", TETRIS_TEST_FLAGS)
+
+bool FTetrisFinesseTableTest::RunTest(const FString& Parameters)
+{
+	// 既知の値
+	TestEqual(TEXT("T at spawn needs no keys"), int32(TetrisFinesse::GetEntry(EPieceType::T_Piece, 0, TetrisRules::SPAWN_X).NumKeys), 0);
+	TestEqual(TEXT("O to the left wall is one hold"), int32(TetrisFinesse::GetEntry(EPieceType::O_Piece, 0, -1).NumKeys), 1);
+	TestEqual(TEXT("O one column left is one tap"), int32(TetrisFinesse::GetEntry(EPieceType::O_Piece, 0, TetrisRules::SPAWN_X - 1).NumKeys), 1);
+	TestFalse(TEXT("Columns past the wall are unreachable"), TetrisFinesse::GetEntry(EPieceType::O_Piece, 0, -2).bReachable);
+
+	for (int32 TypeIndex = 1; TypeIndex <= 7; TypeIndex++)
+	{
+		const EPieceType PieceType = static_cast<EPieceType>(TypeIndex);
+		FTetrisSimGame Game;
+		if (!TestTrue(TEXT("Seed for first piece"), TetrisTestUtils::ResetWithFirstPiece(Game, PieceType)))
+		{
+			return false;
+		}
+		const FTetrisSimBoard& EmptyBoard = Game.GetBoard();
+
+		int32 NumReachable = 0;
+		for (int32 Rotation = 0; Rotation < TetrisPieceTables::NUM_ROTATIONS; Rotation++)
+		{
+			for (int32 X = TetrisFinesse::MIN_X; X < TetrisFinesse::MIN_X + TetrisFinesse::NUM_COLUMNS; X++)
+			{
+				const FTetrisFinesseEntry& Entry = TetrisFinesse::GetEntry(PieceType, Rotation, X);
+				if (!Entry.bReachable)
+				{
+					continue;
+				}
+				NumReachable++;
+				const FString What = FString::Printf(TEXT("Piece %d rotation %d X %d"), TypeIndex, Rotation, X);
+
+				FTetrisSimGame Replay;
+				TetrisTestUtils::ResetWithFirstPiece(Replay, PieceType);
+				for (int32 Index = 0; Index < Entry.NumKeys; Index++)
+				{
+					switch (Entry.Keys[Index])
+					{
+					case ETetrisFinesseKey::Left:
+						Replay.ApplyInput(ETetrisInputCommand::MoveLeft);
+						break;
+					case ETetrisFinesseKey::Right:
+						Replay.ApplyInput(ETetrisInputCommand::MoveRight);
+						break;
+					case ETetrisFinesseKey::DasLeft:
+						while (Replay.ApplyInput(ETetrisInputCommand::MoveLeft)) {}
+						break;
+					case ETetrisFinesseKey::DasRight:
+						while (Replay.ApplyInput(ETetrisInputCommand::MoveRight)) {}
+						break;
+					case ETetrisFinesseKey::Rotate:
+						Replay.ApplyInput(ETetrisInputCommand::Rotate);
+						break;
+					}
+				}
+				TestTrue(What + TEXT(": replayed keys reach the target cells"),
+					GetDroppedCells(EmptyBoard, PieceType, Replay.GetActiveRotation(), Replay.GetActiveX(), Replay.GetActiveY())
+					== GetDroppedCells(EmptyBoard, PieceType, Rotation, X, TetrisRules::SPAWN_Y));
+
+				// 1入力ずつの最短経路（ハードドロップを除く）以下のキー数
+				FTetrisSimPlacement Target;
+				Target.PieceType = PieceType;
+				Target.Rotation = static_cast<uint8>(Rotation);
+				Target.X = static_cast<int8>(X);
+				Target.Y = static_cast<int8>(EmptyBoard.GetDropY(PieceType, Rotation, X, TetrisRules::SPAWN_Y));
+				TArray<ETetrisInputCommand> Inputs;
+				if (TestTrue(What + TEXT(": input path exists"), TetrisMoveGen::FindInputPath(EmptyBoard, PieceType,
+					Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(), Target, Inputs)))
+				{
+					TestTrue(What + TEXT(": no more keys than single inputs"), Entry.NumKeys <= Inputs.Num() - 1);
+				}
+			}
+		}
+		TestTrue(FString::Printf(TEXT("Piece %d has reachable columns"), TypeIndex), NumReachable >= TetrisConstants::BOARD_WIDTH - 3);
+	}
+	return true;
+}
+
+// 押したキー数を数えて判定し、判定が表引きだけで済むこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisFinesseTrackerTest, "ClaudeTest.Tetris.Finesse.Tracker", TETRIS_TEST_FLAGS)
+
+bool FTetrisFinesseTrackerTest::RunTest(const FString& Parameters)
+{
+	FTetrisFinesseTracker Tracker;
+
+	// 左・右・左で1列左へ（最少は1キー）
+	Tracker.BeginPiece();
+	Tracker.AddKeyPress(ETetrisInputCommand::MoveLeft);
+	Tracker.AddKeyPress(ETetrisInputCommand::MoveRight);
+	Tracker.AddKeyPress(ETetrisInputCommand::MoveLeft);
+	Tracker.AddKeyPress(ETetrisInputCommand::HardDrop);
+	FTetrisFinesseResult Result = Tracker.EndPiece(EPieceType::T_Piece, 0, TetrisRules::SPAWN_X - 1);
+	TestTrue(TEXT("Judged"), Result.bJudged);
+	TestEqual(TEXT("Keys used"), Result.KeysUsed, 3);
+	TestEqual(TEXT("Keys minimal"), Result.KeysMinimal, 1);
+	TestTrue(TEXT("Fault"), Result.IsFault());
+
+	// 最少どおり
+	Tracker.BeginPiece();
+	Tracker.AddKeyPress(ETetrisInputCommand::MoveLeft);
+	Result = Tracker.EndPiece(EPieceType::T_Piece, 0, TetrisRules::SPAWN_X - 1);
+	TestFalse(TEXT("Minimal keys are not a fault"), Result.IsFault());
+
+	// ソフトドロップを使ったピースと、出現位置から始めていないピースは判定しない
+	Tracker.BeginPiece();
+	Tracker.AddKeyPress(ETetrisInputCommand::MoveDown);
+	Tracker.AddKeyPress(ETetrisInputCommand::Rotate);
+	TestFalse(TEXT("Soft drop is not judged"), Tracker.EndPiece(EPieceType::T_Piece, 0, TetrisRules::SPAWN_X).bJudged);
+	Tracker.BeginPiece(false);
+	TestFalse(TEXT("Restored piece is not judged"), Tracker.EndPiece(EPieceType::T_Piece, 0, TetrisRules::SPAWN_X).bJudged);
+
+	TestEqual(TEXT("Pieces judged"), Tracker.GetPiecesJudged(), 2);
+	TestEqual(TEXT("Faults"), Tracker.GetFaults(), 1);
+	TestEqual(TEXT("Extra keys"), Tracker.GetExtraKeys(), 2);
+
+	// ピースごとの判定のコスト
+	constexpr int32 NUM_PIECES = 100000;
+	TetrisFinesse::Prebuild();
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NUM_PIECES; Index++)
+	{
+		Tracker.BeginPiece();
+		Tracker.AddKeyPress(ETetrisInputCommand::Rotate);
+		Tracker.AddKeyPress(ETetrisInputCommand::MoveRight);
+		Tracker.EndPiece(static_cast<EPieceType>(Index % 7 + 1), Index % 4, Index % TetrisConstants::BOARD_WIDTH);
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("100000 finesse judgements"), Elapsed, TetrisTestBudgets::FINESSE_100K_SECONDS);
+	return true;
+}
+
+#endif
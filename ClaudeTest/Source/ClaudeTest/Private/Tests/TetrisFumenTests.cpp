@@ -0,0 +1,205 @@
+#include "TetrisTestUtils.h"
+#include "TetrisFumen.h"
+#include "TetrisBoard.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 左から Count セルを CellValue で埋めた行
+	uint64 MakeLeftRow(int32 Count, uint8 CellValue)
+	{
+		uint64 PackedCells = 0;
+		for (int32 X = 0; X < Count; X++)
+		{
+			PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, CellValue);
+		}
+		return PackedCells;
+	}
+
+	bool RowsEqual(const FTetrisFumenPage& A, const FTetrisFumenPage& B)
+	{
+		return FMemory::Memcmp(A.Rows, B.Rows, sizeof(A.Rows)) == 0 && A.GarbageRow == B.GarbageRow;
+	}
+}
+
+// fumen の既知の文字列を読めること、書き戻すと同じ文字列になること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisFumenDecodeTest, "ClaudeTest.Tetris.Fumen.Decode", TETRIS_TEST_FLAGS)
+
+bool FTetrisFumenDecodeTest::RunTest(const FString& Parameters)
+{
+	using namespace TetrisCellPacking;
+
+	TArray<FTetrisFumenPage> Pages;
+	FString Encoded;
+
+	// 空の盤面
+	if (!TestTrue(TEXT("Empty field decoded"), TetrisFumen::Decode(TEXT("v115@vhAAgH"), Pages)))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Empty field has one page"), Pages.Num(), 1);
+	TestTrue(TEXT("Empty field has no blocks"), RowsEqual(Pages[0], FTetrisFumenPage()));
+	TestEqual(TEXT("Empty field has no piece"), Pages[0].PieceType, EPieceType::None);
+	TetrisFumen::Encode(Pages, Encoded);
+	TestEqual(TEXT("Empty field encodes back"), Encoded, FString(TEXT("v115@vhAAgH")));
+
+	// 下4行の左6セルが灰色（URL ごと渡しても読める）
+	const TCHAR* Stack = TEXT("v115@9gF8DeF8DeF8DeF8NeAgH");
+	FTetrisFumenPage Page;
+	if (!TestTrue(TEXT("URL decoded"), TetrisFumen::DecodeFirstPage(TEXT("https://fumen.zui.jp/?v115@9gF8DeF8DeF8DeF8NeAgH"), Page)))
+	{
+		return false;
+	}
+	for (int32 Y = 0; Y < 4; Y++)
+	{
+		TestEqual(FString::Printf(TEXT("Row %d is six gray cells"), Y), Page.Rows[Y], MakeLeftRow(6, CELL_UNTYPED));
+	}
+	TestEqual(TEXT("Row 4 is empty"), Page.Rows[4], uint64(0));
+	TetrisFumen::Encode(MakeArrayView(&Page, 1), Encoded);
+	TestEqual(TEXT("Stack encodes back"), Encoded, FString(Stack));
+
+	// 2ページ目は1ページ目の T を置いた盤面。盤面が変わらないページは繰り返し数でまとめても同じ
+	const TCHAR* Repeated = TEXT("v115@vhBVQJAAA");
+	for (const TCHAR* Data : { TEXT("v115@vhAVQJvhAAAA"), Repeated })
+	{
+		if (!TestTrue(FString::Printf(TEXT("%s decoded"), Data), TetrisFumen::Decode(Data, Pages)) || !TestEqual(TEXT("Two pages"), Pages.Num(), 2))
+		{
+			return false;
+		}
+		TestEqual(TEXT("Page 1 piece"), Pages[0].PieceType, EPieceType::T_Piece);
+		TestEqual(TEXT("Page 1 rotation"), int32(Pages[0].Rotation), 0);
+		TestEqual(TEXT("Page 1 X"), int32(Pages[0].X), 4);
+		TestEqual(TEXT("Page 1 Y"), int32(Pages[0].Y), 0);
+		TestEqual(TEXT("Locked T bottom row"), Pages[1].Rows[0], MakeLeftRow(6, uint8(EPieceType::T_Piece)) & ~MakeLeftRow(3, 0xF));
+		TestEqual(TEXT("Locked T top cell"), GetPackedCell(Pages[1].Rows[1], 4), uint8(EPieceType::T_Piece));
+		TestEqual(TEXT("Page 2 has no piece"), Pages[1].PieceType, EPieceType::None);
+	}
+	TetrisFumen::Encode(Pages, Encoded);
+	TestEqual(TEXT("Unchanged pages use the repeat count"), Encoded, FString(Repeated));
+
+	// 縦 I で一番下の行を消すと残りの3セルが1行下がり、その盤面の次のページは「変わらない」で書かれる。コメントも往復する
+	TArray<FTetrisFumenPage> Source;
+	Source.AddDefaulted(2);
+	Source[0].Rows[0] = MakeLeftRow(9, CELL_UNTYPED);
+	Source[0].PieceType = EPieceType::I_Piece;
+	Source[0].Rotation = 1;
+	Source[0].X = 9;
+	Source[0].Y = 2;
+	Source[0].Comment = TEXT("PC 1/2 ?&%");
+	Source[1].Comment = Source[0].Comment;
+	for (int32 Y = 0; Y < 3; Y++)
+	{
+		Source[1].Rows[Y] = SetPackedCell(0, 9, uint8(EPieceType::I_Piece));
+	}
+	TetrisFumen::Encode(Source, Encoded);
+	TestTrue(TEXT("Cleared field written as unchanged"), Encoded.EndsWith(TEXT("vhAAAA")));
+	if (!TestTrue(TEXT("Line clear decoded"), TetrisFumen::Decode(*Encoded, Pages)) || !TestEqual(TEXT("Line clear pages"), Pages.Num(), 2))
+	{
+		return false;
+	}
+	TestTrue(TEXT("First page field kept"), RowsEqual(Pages[0], Source[0]));
+	TestTrue(TEXT("Second page field kept"), RowsEqual(Pages[1], Source[1]));
+	TestEqual(TEXT("Comment kept"), Pages[0].Comment, Source[0].Comment);
+	TestEqual(TEXT("Comment carried to the next page"), Pages[1].Comment, Source[0].Comment);
+
+	// 壊れた入力
+	TestFalse(TEXT("No version"), TetrisFumen::Decode(TEXT("vhAAgH"), Pages));
+	TestFalse(TEXT("Bad character"), TetrisFumen::Decode(TEXT("v115@vh!AgH"), Pages));
+	TestFalse(TEXT("Truncated"), TetrisFumen::Decode(TEXT("v115@vhAAg"), Pages));
+	return true;
+}
+
+// ATetrisBoard に fumen を読み込み、ASCII と fumen に書き戻せること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardFumenTest, "ClaudeTest.Tetris.Board.Fumen", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardFumenTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	if (!TestNotNull(TEXT("Board spawned"), Board))
+	{
+		return false;
+	}
+
+	const FString Stack = TEXT("v115@9gF8DeF8DeF8DeF8NeAgH");
+	if (!TestTrue(TEXT("Fumen loaded"), Board->LoadFumen(Stack)))
+	{
+		return false;
+	}
+
+	const int32 Bottom = Board->GetBoardHeight() - 1;
+	TestTrue(TEXT("Bottom left occupied"), Board->GetBlockState(0, Bottom));
+	TestFalse(TEXT("Bottom right empty"), Board->GetBlockState(6, Bottom));
+	TestFalse(TEXT("Fifth row empty"), Board->GetBlockState(0, Bottom - 4));
+	TestEqual(TEXT("Board encodes back"), Board->ToFumen(), Stack);
+
+	Board->SetBlock(9, Bottom, true, EPieceType::T_Piece);
+	TArray<FString> Lines;
+	Board->ToAsciiString().ParseIntoArrayLines(Lines);
+	if (TestEqual(TEXT("One line per row"), Lines.Num(), Board->GetBoardHeight()))
+	{
+		TestEqual(TEXT("Empty row"), Lines[0], FString(TEXT("..........")));
+		TestEqual(TEXT("Bottom row"), Lines[Bottom], FString(TEXT("######...T")));
+	}
+
+	// 2ページ目は1ページ目の T を置いた盤面
+	TestTrue(TEXT("Second page loaded"), Board->LoadFumen(TEXT("v115@vhBVQJAAA"), 1));
+	TestEqual(TEXT("Locked T loaded"), Board->GetBlockPieceType(4, Bottom - 1), EPieceType::T_Piece);
+	TestFalse(TEXT("Previous field replaced"), Board->GetBlockState(0, Bottom));
+	TestFalse(TEXT("Missing page rejected"), Board->LoadFumen(TEXT("v115@vhBVQJAAA"), 2));
+	return true;
+}
+
+// ランダムな盤面 1万個の書き出しと読み込みが往復し、それぞれ数 µs で済むこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisFumenRoundTripTest, "ClaudeTest.Tetris.Fumen.RoundTrip", TETRIS_TEST_FLAGS)
+
+bool FTetrisFumenRoundTripTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_BOARDS = 10000;
+
+	// 下から 0〜12 行を、空きの多い行とピースの色が混ざった行で埋める
+	FRandomStream Random(50);
+	TArray<FTetrisFumenPage> Boards;
+	Boards.SetNum(NUM_BOARDS);
+	for (FTetrisFumenPage& Board : Boards)
+	{
+		const int32 StackHeight = Random.RandRange(0, 12);
+		for (int32 Y = 0; Y < StackHeight; Y++)
+		{
+			for (int32 X = 0; X < FTetrisFumenPage::WIDTH; X++)
+			{
+				if (Random.FRand() < 0.7f)
+				{
+					Board.Rows[Y] = TetrisCellPacking::SetPackedCell(Board.Rows[Y], X, uint8(Random.RandRange(1, TetrisCellPacking::CELL_UNTYPED)));
+				}
+			}
+		}
+	}
+
+	TArray<FString> Encoded;
+	Encoded.SetNum(NUM_BOARDS);
+	FTetrisFumenPage Decoded;
+	int32 Mismatches = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NUM_BOARDS; Index++)
+	{
+		TetrisFumen::Encode(MakeArrayView(&Boards[Index], 1), Encoded[Index]);
+	}
+	for (int32 Index = 0; Index < NUM_BOARDS; Index++)
+	{
+		if (!TetrisFumen::DecodeFirstPage(*Encoded[Index], Decoded) || !RowsEqual(Decoded, Boards[Index]))
+		{
+			Mismatches++;
+		}
+	}
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo(FString::Printf(TEXT("%.2f us per encode + decode"), ElapsedSeconds * 1.0e6 / NUM_BOARDS));
+	TestEqual(TEXT("All boards round trip"), Mismatches, 0);
+	TetrisTestBudgets::CheckBudget(*this, TEXT("10k fumen encode + decode"), ElapsedSeconds, TetrisTestBudgets::FUMEN_10K_SECONDS);
+	return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "TetrisTestUtils.h"
+#include "TetrisLatency.h"
+#include "RenderingThread.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// パーセンタイルはバケットの上端で、範囲外の値は最大値として残る
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisLatencyHistogramTest, "ClaudeTest.Tetris.Latency.Histogram", TETRIS_TEST_FLAGS)
+
+bool FTetrisLatencyHistogramTest::RunTest(const FString& Parameters)
+{
+	FTetrisLatencyHistogram Histogram;
+	TestEqual(TEXT("Empty histogram"), Histogram.GetPercentile(0.5), 0.0);
+
+	// 0.5 ms, 1.5 ms, ..., 99.5 ms（バケット境界ちょうどなので上端は +0〜0.1 ms）
+	for (int32 Index = 0; Index < 100; Index++)
+	{
+		Histogram.Add((Index + 0.5) / 1000.0);
+	}
+	TestEqual(TEXT("Count"), Histogram.Count, int64(100));
+	TestEqual(TEXT("p50"), Histogram.GetPercentile(0.50) * 1000.0, 49.55, 0.06);
+	TestEqual(TEXT("p95"), Histogram.GetPercentile(0.95) * 1000.0, 94.55, 0.06);
+	TestEqual(TEXT("p99"), Histogram.GetPercentile(0.99) * 1000.0, 98.55, 0.06);
+	TestEqual(TEXT("p100 is the maximum"), Histogram.GetPercentile(1.0) * 1000.0, 99.5, 0.01);
+
+	Histogram.Add(1.0);
+	TestEqual(TEXT("Overflow keeps the maximum"), Histogram.GetPercentile(1.0), 1.0, 1e-9);
+
+	Histogram.Reset();
+	TestEqual(TEXT("Reset"), Histogram.Count, int64(0));
+	return true;
+}
+
+// 段階の進み方：表示まで届いた入力だけが描画スレッドで計測され、ワーカースレッドへ渡した入力は適用時に処理済みになる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisLatencyStagesTest, "ClaudeTest.Tetris.Latency.Stages", TETRIS_TEST_FLAGS)
+
+bool FTetrisLatencyStagesTest::RunTest(const FString& Parameters)
+{
+	auto GetCount = [](ETetrisLatencyStage Stage)
+	{
+		return TetrisLatency::GetHistogram(Stage).Count;
+	};
+
+	TetrisLatency::Reset();
+
+	// 表示が変わった入力
+	TetrisLatency::StampInput();
+	TetrisLatency::MarkHandled();
+	TetrisLatency::MarkDisplayUpdated();
+
+	// 壁に当たって表示が変わらなかった入力
+	TetrisLatency::StampInput();
+	TetrisLatency::MarkHandled();
+
+	TetrisLatency::EndFrame();
+	FlushRenderingCommands();
+
+	TestEqual(TEXT("Dispatched"), GetCount(ETetrisLatencyStage::Dispatch), int64(2));
+	TestEqual(TEXT("Handled"), GetCount(ETetrisLatencyStage::Handled), int64(2));
+	TestEqual(TEXT("Displayed"), GetCount(ETetrisLatencyStage::Display), int64(1));
+	TestEqual(TEXT("Rendered"), GetCount(ETetrisLatencyStage::Render), int64(1));
+
+	// ワーカースレッド：スタンプの無いキーリピート入力と並んでも順番どおりに対応する
+	TetrisLatency::DeferToSimulation();
+	TetrisLatency::StampInput();
+	TetrisLatency::DeferToSimulation();
+	TetrisLatency::MarkHandled();
+	TestEqual(TEXT("Deferred input is not handled yet"), GetCount(ETetrisLatencyStage::Handled), int64(2));
+
+	TetrisLatency::EndFrame();
+	TetrisLatency::MarkSimulationApplied(1);
+	TestEqual(TEXT("Unstamped input is skipped"), GetCount(ETetrisLatencyStage::Handled), int64(2));
+	TetrisLatency::MarkSimulationApplied(1);
+	TestEqual(TEXT("Deferred input handled"), GetCount(ETetrisLatencyStage::Handled), int64(3));
+
+	TetrisLatency::MarkDisplayUpdated();
+	TetrisLatency::EndFrame();
+	FlushRenderingCommands();
+	TestEqual(TEXT("Deferred input rendered"), GetCount(ETetrisLatencyStage::Render), int64(2));
+
+	TetrisLatency::Reset();
+	return true;
+}
+
+#endif
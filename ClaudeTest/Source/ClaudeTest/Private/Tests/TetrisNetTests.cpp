@@ -0,0 +1,183 @@
+#include "TetrisTestUtils.h"
+#include "TetrisNetTypes.h"
+#include "TetrisBoard.h"
+#include "UObject/CoreNet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// NetSerialize で書いて読み戻す（接続なしなので送信量カウンタには入らない）
+	template<typename StructType>
+	bool RoundTripNetSerialize(StructType& Source, StructType& OutLoaded, int64& OutNumBits)
+	{
+		bool bSaved = false;
+		FNetBitWriter Writer(nullptr, 256);
+		Source.NetSerialize(Writer, nullptr, bSaved);
+		OutNumBits = Writer.GetNumBits();
+
+		bool bLoaded = false;
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		OutLoaded.NetSerialize(Reader, nullptr, bLoaded);
+		return bSaved && bLoaded && Reader.GetPosBits() == OutNumBits;
+	}
+
+	FTetrisNetPieceState MakePieceState(EPieceType PieceType, uint8 Rotation, int8 X, int8 Y, bool bFixed)
+	{
+		FTetrisNetPieceState State;
+		State.PieceType = PieceType;
+		State.Rotation = Rotation;
+		State.X = X;
+		State.Y = Y;
+		State.bFixed = bFixed;
+		return State;
+	}
+
+	uint64 MakePackedRow(std::initializer_list<uint8> Cells)
+	{
+		uint64 PackedCells = 0;
+		int32 X = 0;
+		for (uint8 CellValue : Cells)
+		{
+			PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X++, CellValue);
+		}
+		return PackedCells;
+	}
+}
+
+// 行とピース状態が NetSerialize で往復し、想定したビット数に収まること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisNetSerializeTest, "ClaudeTest.Tetris.Net.Serialize", TETRIS_TEST_FLAGS)
+
+bool FTetrisNetSerializeTest::RunTest(const FString& Parameters)
+{
+	using namespace TetrisCellPacking;
+
+	struct FRowCase
+	{
+		const TCHAR* Name;
+		int32 RowIndex;
+		uint64 PackedCells;
+		int64 MaxBits;
+	};
+	const FRowCase RowCases[] = {
+		// 行番号 1バイト + 空のマスク 1バイト
+		{ TEXT("Empty row"), 0, 0, 16 },
+		// 行番号 + マスク 2バイト + 3bit × 9
+		{ TEXT("Mixed row"), 19, MakePackedRow({ 1, 2, 3, 4, 5, 6, 7, CELL_UNTYPED, 0, 1 }), 8 + 16 + 3 * 9 },
+		{ TEXT("Full row"), 7, MakePackedRow({ 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 }), 8 + 16 + 3 * 10 },
+		{ TEXT("16-wide row"), 130, MakePackedRow({ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 7 }), 16 + 24 + 3 * 16 },
+	};
+	for (const FRowCase& Case : RowCases)
+	{
+		FTetrisBoardRowItem Source;
+		Source.RowIndex = Case.RowIndex;
+		Source.PackedCells = Case.PackedCells;
+		FTetrisBoardRowItem Loaded;
+		int64 NumBits = 0;
+		if (!TestTrue(FString::Printf(TEXT("%s serialized"), Case.Name), RoundTripNetSerialize(Source, Loaded, NumBits)))
+		{
+			continue;
+		}
+		AddInfo(FString::Printf(TEXT("%s: %lld bits"), Case.Name, NumBits));
+		TestEqual(FString::Printf(TEXT("%s index"), Case.Name), Loaded.RowIndex, Case.RowIndex);
+		TestEqual(FString::Printf(TEXT("%s cells"), Case.Name), Loaded.PackedCells, Case.PackedCells);
+		TestTrue(FString::Printf(TEXT("%s within %lld bits"), Case.Name, Case.MaxBits), NumBits <= Case.MaxBits);
+	}
+
+	// 壁際・床下の負の座標も符号ごと届く
+	const FTetrisNetPieceState PieceCases[] = {
+		MakePieceState(EPieceType::T_Piece, 0, 3, 0, false),
+		MakePieceState(EPieceType::I_Piece, 3, -2, 18, false),
+		MakePieceState(EPieceType::L_Piece, 2, 7, -1, true),
+		MakePieceState(EPieceType::None, 0, 0, 0, false),
+	};
+	for (const FTetrisNetPieceState& Source : PieceCases)
+	{
+		FTetrisNetPieceState Copy = Source;
+		FTetrisNetPieceState Loaded;
+		int64 NumBits = 0;
+		if (TestTrue(TEXT("Piece serialized"), RoundTripNetSerialize(Copy, Loaded, NumBits)))
+		{
+			TestTrue(FString::Printf(TEXT("Piece %d at (%d, %d) round trips"), int32(Source.PieceType), Source.X, Source.Y), Loaded == Source);
+			TestEqual(TEXT("Piece bits"), NumBits, int64(FTetrisNetPieceState::SERIALIZED_BITS));
+		}
+	}
+	return true;
+}
+
+// サーバーのボードで変わった行だけが送信対象（ReplicationKey が進む）になること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisBoardReplicatedRowsTest, "ClaudeTest.Tetris.Board.ReplicatedRows", TETRIS_TEST_FLAGS)
+
+bool FTetrisBoardReplicatedRowsTest::RunTest(const FString& Parameters)
+{
+	FTetrisTestWorld TestWorld;
+	ATetrisBoard* Board = TestWorld.Spawn<ATetrisBoard>();
+	if (!TestNotNull(TEXT("Board spawned"), Board) || !TestTrue(TEXT("Board has authority"), Board->HasAuthority()))
+	{
+		return false;
+	}
+
+	const FTetrisBoardRowArray& Rows = Board->GetReplicatedRows();
+	if (!TestEqual(TEXT("One item per row"), Rows.Items.Num(), Board->GetBoardHeight()))
+	{
+		return false;
+	}
+
+	TArray<int32> Keys;
+	auto CaptureKeys = [&Rows, &Keys]()
+	{
+		Keys.Reset();
+		for (const FTetrisBoardRowItem& Item : Rows.Items)
+		{
+			Keys.Add(Item.ReplicationKey);
+		}
+	};
+	auto CountChangedRows = [&Rows, &Keys]()
+	{
+		int32 Changed = 0;
+		for (int32 Y = 0; Y < Rows.Items.Num(); Y++)
+		{
+			Changed += Rows.Items[Y].ReplicationKey != Keys[Y] ? 1 : 0;
+		}
+		return Changed;
+	};
+	auto RowsMatchBoard = [&Rows, Board]()
+	{
+		for (int32 Y = 0; Y < Rows.Items.Num(); Y++)
+		{
+			if (Rows.Items[Y].RowIndex != Y || Rows.Items[Y].PackedCells != Board->GetPackedRow(Y))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	const int32 Width = Board->GetBoardWidth();
+	const int32 Bottom = Board->GetBoardHeight() - 1;
+
+	// 1セル置くと1行だけ
+	CaptureKeys();
+	Board->SetBlock(2, Bottom, true, EPieceType::T_Piece);
+	TestEqual(TEXT("One cell dirties one row"), CountChangedRows(), 1);
+	TestTrue(TEXT("Rows match after a cell"), RowsMatchBoard());
+
+	// 同じ内容を書き直しても送らない
+	CaptureKeys();
+	Board->SetBlock(2, Bottom, true, EPieceType::T_Piece);
+	TestEqual(TEXT("Unchanged cell dirties nothing"), CountChangedRows(), 0);
+
+	// 一番下を埋めて消す：上の1行が下りてくるので、変わるのは2行だけ
+	Board->SetBlock(4, Bottom - 1, true, EPieceType::S_Piece);
+	for (int32 X = 0; X < Width; X++)
+	{
+		Board->SetBlock(X, Bottom, true, EPieceType::I_Piece);
+	}
+	CaptureKeys();
+	Board->ClearLines(Board->CheckCompleteLines());
+	TestEqual(TEXT("Clearing one line under one row dirties two rows"), CountChangedRows(), 2);
+	TestTrue(TEXT("Rows match after the clear"), RowsMatchBoard());
+	return true;
+}
+
+#endif
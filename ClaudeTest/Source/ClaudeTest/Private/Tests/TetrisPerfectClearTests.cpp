@@ -0,0 +1,177 @@
+#include "TetrisTestUtils.h"
+#include "TetrisPerfectClear.h"
+#include "TetrisRules.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 解の手を順に置き、盤面が空になるか
+	bool ClearsBoard(FTetrisSimBoard Board, TArrayView<const EPieceType> Pieces, const FTetrisPerfectClearResult& Result)
+	{
+		if (Result.Placements.Num() == 0 || Result.Placements.Num() > Pieces.Num())
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < Result.Placements.Num(); Index++)
+		{
+			const FTetrisSimPlacement& Placement = Result.Placements[Index];
+			if (Placement.PieceType != Pieces[Index] || !Board.CanPlace(Pieces[Index], Placement.Rotation, Placement.X, Placement.Y))
+			{
+				return false;
+			}
+			Board.Place(Pieces[Index], Placement.Rotation, Placement.X, Placement.Y);
+			Board.ClearFullRows();
+		}
+		for (int32 Y = 0; Y < Board.Height; Y++)
+		{
+			if (Board.Rows[Y] != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+// 探索だけで 2 ライン PC を見つけ、解けない列では見つけないこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPerfectClearSearchTest, "ClaudeTest.Tetris.PerfectClear.Search", TETRIS_TEST_FLAGS)
+
+bool FTetrisPerfectClearSearchTest::RunTest(const FString& Parameters)
+{
+	FTetrisPerfectClearSettings Settings;
+	Settings.TimeBudgetSeconds = 0.0;
+	const FTetrisPerfectClearSolver Solver(Settings);
+
+	const FTetrisSimBoard EmptyBoard = TetrisTestUtils::MakeSimBoard({});
+	const EPieceType Solvable[] = { EPieceType::I_Piece, EPieceType::I_Piece, EPieceType::O_Piece, EPieceType::I_Piece, EPieceType::I_Piece };
+	FTetrisPerfectClearResult Result;
+	if (TestTrue(TEXT("IIOII clears two lines"), Solver.Solve(EmptyBoard, Solvable, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Result)))
+	{
+		TestEqual(TEXT("Two line perfect clear"), Result.Height, 2);
+		TestTrue(TEXT("Placements empty the board"), ClearsBoard(EmptyBoard, Solvable, Result));
+		TestTrue(TEXT("Inputs end with a hard drop"), Result.Inputs.Num() > 0 && Result.Inputs.Last() == ETetrisInputCommand::HardDrop);
+	}
+
+	// S だけでは左下の角が埋まらない
+	const EPieceType Unsolvable[] = { EPieceType::S_Piece, EPieceType::S_Piece, EPieceType::S_Piece, EPieceType::S_Piece, EPieceType::S_Piece };
+	TestFalse(TEXT("Only S pieces never clear"), Solver.Solve(EmptyBoard, Unsolvable, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Result));
+	TestFalse(TEXT("Exhausted rather than timed out"), Result.bTimedOut);
+
+	// 途中の盤面（左下に L を置いた残り）からも解ける
+	const FTetrisSimBoard MidBoard = TetrisTestUtils::MakeSimBoard({
+		TEXT("#........."),
+		TEXT("###......."),
+	});
+	const EPieceType Rest[] = { EPieceType::J_Piece, EPieceType::I_Piece, EPieceType::I_Piece, EPieceType::O_Piece };
+	if (TestTrue(TEXT("Mid-game board clears"), Solver.Solve(MidBoard, Rest, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Result)))
+	{
+		TestTrue(TEXT("Mid-game placements empty the board"), ClearsBoard(MidBoard, Rest, Result));
+	}
+	return true;
+}
+
+// 生成した表（メモリ上・メモリマップ）が探索と同じ列で解け、表の手だけで盤面が空になること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPerfectClearTableTest, "ClaudeTest.Tetris.PerfectClear.Table", TETRIS_TEST_FLAGS)
+
+bool FTetrisPerfectClearTableTest::RunTest(const FString& Parameters)
+{
+	// 幅 8 の 2 ライン PC（4 ピース × 7^4 列）ならテストの中で作れる
+	constexpr int32 WIDTH = 8;
+	TArray<uint8> Bytes;
+	const int64 NumEntries = TetrisPerfectClear::BuildTable(WIDTH, 2, Bytes);
+	if (!TestTrue(TEXT("Table has entries"), NumEntries > 0))
+	{
+		return false;
+	}
+
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TetrisPerfectClear.tpct"));
+	TestTrue(TEXT("Table saved"), FFileHelper::SaveArrayToFile(Bytes, *Path));
+
+	FTetrisPerfectClearTable MappedTable;
+	TestTrue(TEXT("Table mapped"), MappedTable.Map(Path));
+	TestEqual(TEXT("Mapped entry count"), MappedTable.GetNumEntries(), NumEntries);
+
+	FTetrisPerfectClearTable OwnedTable;
+	TestTrue(TEXT("Table read from bytes"), OwnedTable.FromBytes(MoveTemp(Bytes)));
+	TestEqual(TEXT("Table width"), OwnedTable.GetWidth(), WIDTH);
+
+	FTetrisPerfectClearSettings Settings;
+	Settings.MaxHeight = 2;
+	Settings.TimeBudgetSeconds = 0.0;
+	const FTetrisPerfectClearSolver SearchSolver(Settings);
+	const FTetrisPerfectClearSolver MappedSolver(Settings, &MappedTable);
+	const FTetrisPerfectClearSolver OwnedSolver(Settings, &OwnedTable);
+
+	const FTetrisSimBoard EmptyBoard = TetrisTestUtils::MakeSimBoard({}, WIDTH);
+	FRandomStream Random(45);
+	int32 NumSolved = 0;
+	for (int32 Trial = 0; Trial < 200; Trial++)
+	{
+		EPieceType Pieces[4];
+		for (EPieceType& Piece : Pieces)
+		{
+			Piece = static_cast<EPieceType>(Random.RandRange(1, 7));
+		}
+
+		FTetrisPerfectClearResult Searched;
+		FTetrisPerfectClearResult Mapped;
+		FTetrisPerfectClearResult Owned;
+		const bool bSearched = SearchSolver.Solve(EmptyBoard, Pieces, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Searched);
+		const bool bMapped = MappedSolver.Solve(EmptyBoard, Pieces, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Mapped);
+		const bool bOwned = OwnedSolver.Solve(EmptyBoard, Pieces, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Owned);
+
+		TestEqual(FString::Printf(TEXT("Trial %d: table and search agree"), Trial), bMapped, bSearched);
+		TestEqual(FString::Printf(TEXT("Trial %d: mapped and owned agree"), Trial), bOwned, bMapped);
+		if (bMapped)
+		{
+			TestTrue(FString::Printf(TEXT("Trial %d: answered from the table"), Trial), Mapped.bFromTable && Owned.bFromTable);
+			TestTrue(FString::Printf(TEXT("Trial %d: table placements empty the board"), Trial), ClearsBoard(EmptyBoard, Pieces, Mapped));
+			NumSolved++;
+		}
+	}
+	TestTrue(TEXT("Some sequences are solvable"), NumSolved > 0);
+
+	MappedTable.Reset();
+	IFileManager::Get().Delete(*Path);
+	return true;
+}
+
+// 表にない 4 ライン PC でも、ヒントは時間予算内に返ること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPerfectClearBudgetTest, "ClaudeTest.Tetris.PerfectClear.Budget", TETRIS_TEST_FLAGS)
+
+bool FTetrisPerfectClearBudgetTest::RunTest(const FString& Parameters)
+{
+	const FTetrisSimBoard Board = TetrisTestUtils::MakeSimBoard({
+		TEXT("###......."),
+		TEXT("###......."),
+		TEXT("###......."),
+		TEXT("###......."),
+	});
+	const EPieceType Pieces[] = { EPieceType::T_Piece, EPieceType::I_Piece, EPieceType::L_Piece, EPieceType::J_Piece,
+		EPieceType::S_Piece, EPieceType::Z_Piece, EPieceType::O_Piece };
+
+	const FTetrisPerfectClearSolver Solver;
+	double SlowestSeconds = 0.0;
+	for (int32 Run = 0; Run < 10; Run++)
+	{
+		FTetrisPerfectClearResult Result;
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bSolved = Solver.Solve(Board, Pieces, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Result);
+		SlowestSeconds = FMath::Max(SlowestSeconds, FPlatformTime::Seconds() - StartTime);
+
+		if (bSolved)
+		{
+			TestTrue(TEXT("Hint placements empty the board"), ClearsBoard(Board, Pieces, Result));
+		}
+	}
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Slowest perfect clear hint"), SlowestSeconds, TetrisTestBudgets::PERFECT_CLEAR_HINT_SECONDS);
+	return true;
+}
+
+#endif
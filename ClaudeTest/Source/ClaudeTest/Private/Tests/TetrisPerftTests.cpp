@@ -0,0 +1,192 @@
+#include "TetrisTestUtils.h"
+#include "TetrisSimulation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 決まったピース列を Depth 個置いたときの固定位置の組み合わせ数（チェスの perft と同じ考え方）
+	// 出現時に最上段が埋まっていればゲームオーバーとして数えない
+	int64 Perft(const FTetrisSimBoard& Board, const EPieceType* Sequence, int32 Depth)
+	{
+		if (Depth == 0)
+		{
+			return 1;
+		}
+		if (Board.IsTopRowOccupied())
+		{
+			return 0;
+		}
+
+		TArray<FTetrisSimPlacement> Placements;
+		TetrisMoveGen::GenerateLockPlacements(Board, Sequence[0], Placements);
+		if (Depth == 1)
+		{
+			return Placements.Num();
+		}
+
+		int64 Count = 0;
+		for (const FTetrisSimPlacement& Placement : Placements)
+		{
+			FTetrisSimBoard Child = Board;
+			Child.Place(Placement.PieceType, Placement.Rotation, Placement.X, Placement.Y);
+			Child.ClearFullRows();
+			Count += Perft(Child, Sequence + 1, Depth - 1);
+		}
+		return Count;
+	}
+
+	struct FPerftCase
+	{
+		const TCHAR* Name;
+		FTetrisSimBoard Board;
+		TArray<EPieceType> Sequence;
+		TArray<int64> Expected;
+	};
+}
+
+// 局面ごとの到達可能な固定位置数。期待値はルールを別実装で数え直した値
+// 移動・回転・Wall Kick・ライン消去のどれかが変わると数がずれる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisPerftTest, "ClaudeTest.Tetris.Perft.Placements", TETRIS_TEST_FLAGS)
+
+bool FTetrisPerftTest::RunTest(const FString& Parameters)
+{
+	// 空の盤面での1手（同じセルになる回転はまとめる）
+	const FTetrisSimBoard EmptyBoard = TetrisTestUtils::MakeSimBoard({});
+	const struct { EPieceType PieceType; int32 Expected; } SinglePieceCases[] =
+	{
+		{ EPieceType::I_Piece, 17 },
+		{ EPieceType::O_Piece, 9 },
+		{ EPieceType::T_Piece, 34 },
+		{ EPieceType::S_Piece, 17 },
+		{ EPieceType::Z_Piece, 17 },
+		{ EPieceType::J_Piece, 34 },
+		{ EPieceType::L_Piece, 34 },
+	};
+	for (const auto& Case : SinglePieceCases)
+	{
+		TArray<FTetrisSimPlacement> Placements;
+		TestEqual(FString::Printf(TEXT("Empty board placements for piece %d"), static_cast<int32>(Case.PieceType)),
+			TetrisMoveGen::GenerateLockPlacements(EmptyBoard, Case.PieceType, Placements), Case.Expected);
+	}
+
+	const FPerftCase Cases[] =
+	{
+		{
+			TEXT("Empty TIO"),
+			EmptyBoard,
+			{ EPieceType::T_Piece, EPieceType::I_Piece, EPieceType::O_Piece },
+			{ 34, 596, 5542 }
+		},
+		{
+			// T スロットと右端の穴（消去を含む）
+			TEXT("T-slot TISZ"),
+			TetrisTestUtils::MakeSimBoard({
+				TEXT("XX........"),
+				TEXT("XXX...XXXX"),
+				TEXT("XXXX.XXXXX"),
+				TEXT("XXX...XXXX"),
+				TEXT("XXXX.XXXXX"),
+				TEXT("XXXXXXXXX."),
+			}),
+			{ EPieceType::T_Piece, EPieceType::I_Piece, EPieceType::S_Piece, EPieceType::Z_Piece },
+			{ 34, 593, 10641 }
+		},
+		{
+			// 浮いたブロックの下へ潜り込む位置（下移動の後の横移動でしか届かない）
+			TEXT("Overhang LJT"),
+			TetrisTestUtils::MakeSimBoard({
+				TEXT("....XXX..."),
+				TEXT(".........."),
+				TEXT("X.....XXXX"),
+				TEXT("XX.XXXXXXX"),
+				TEXT("XXXXXX.XXX"),
+			}),
+			{ EPieceType::L_Piece, EPieceType::J_Piece, EPieceType::T_Piece },
+			{ 43, 1643, 65452 }
+		},
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FPerftCase& Case : Cases)
+	{
+		for (int32 Depth = 1; Depth <= Case.Expected.Num(); Depth++)
+		{
+			TestEqual(FString::Printf(TEXT("%s perft(%d)"), Case.Name, Depth), Perft(Case.Board, Case.Sequence.GetData(), Depth), Case.Expected[Depth - 1]);
+		}
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Perft suite"), Elapsed, TetrisTestBudgets::PERFT_SECONDS);
+	return true;
+}
+
+// 当たり判定の速度
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisCollisionSpeedTest, "ClaudeTest.Tetris.Perft.CollisionSpeed", TETRIS_TEST_FLAGS)
+
+bool FTetrisCollisionSpeedTest::RunTest(const FString& Parameters)
+{
+	const FTetrisSimBoard Board = TetrisTestUtils::MakeSimBoard({
+		TEXT("X.X.X.X.X."),
+		TEXT(".X.X.X.X.X"),
+		TEXT("XX..XX..XX"),
+		TEXT("XXXX..XXXX"),
+	});
+
+	// 全種類・全回転・盤面全体を走査（最適化で消えないよう結果を数える）
+	int32 Placeable = 0;
+	int32 Checks = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Pass = 0; Pass < 100; Pass++)
+	{
+		for (int32 Type = 1; Type < 8; Type++)
+		{
+			for (int32 Rotation = 0; Rotation < 4; Rotation++)
+			{
+				for (int32 Y = -2; Y < Board.Height; Y++)
+				{
+					for (int32 X = -3; X < Board.Width; X++)
+					{
+						Placeable += Board.CanPlace(static_cast<EPieceType>(Type), Rotation, X, Y) ? 1 : 0;
+						Checks++;
+					}
+				}
+			}
+		}
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	TestTrue(TEXT("Some positions are placeable"), Placeable > 0 && Placeable < Checks);
+	TetrisTestBudgets::CheckBudget(*this, *FString::Printf(TEXT("%d collision checks"), Checks), Elapsed, TetrisTestBudgets::COLLISION_SECONDS);
+	return true;
+}
+
+// 盤面のライン消去の速度
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimClearSpeedTest, "ClaudeTest.Tetris.Perft.ClearSpeed", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimClearSpeedTest::RunTest(const FString& Parameters)
+{
+	const FTetrisSimBoard Source = TetrisTestUtils::MakeSimBoard({
+		TEXT("XXXXXXXXXX"),
+		TEXT("X.XXXXXXXX"),
+		TEXT("XXXXXXXXXX"),
+		TEXT("XXXXXXXX.X"),
+		TEXT("XXXXXXXXXX"),
+		TEXT("XXXXXXXXXX"),
+	});
+
+	int64 TotalCleared = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < 100000; Iteration++)
+	{
+		FTetrisSimBoard Board = Source;
+		TotalCleared += Board.ClearFullRows();
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	TestEqual(TEXT("Rows cleared"), TotalCleared, int64(4) * 100000);
+	TetrisTestBudgets::CheckBudget(*this, TEXT("100000 sim 4-line clears"), Elapsed, TetrisTestBudgets::SIM_CLEAR_SECONDS);
+	return true;
+}
+
+#endif
@@ -0,0 +1,423 @@
+#include "TetrisTestUtils.h"
+#include "TetrisReplay.h"
+#include "TetrisSimulation.h"
+#include "TetrisBot.h"
+#include "TetrisSerialization.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TArray<uint8> GetStateBytes(FTetrisSimGame& Game)
+	{
+		TArray<uint8> StateBytes;
+		FMemoryWriter Writer(StateBytes);
+		Game.SerializeState(Writer);
+		return StateBytes;
+	}
+
+	// 索引 = キーフレーム数 + (フレーム, 位置) の並び、フッター = 索引の位置 + "TRPI"
+	constexpr int64 REPLAY_FOOTER_SIZE = sizeof(uint64) + sizeof(uint32);
+
+	void ReadReplayIndex(const TArray<uint8>& FileBytes, uint64& OutIndexOffset, TArray<uint64>& OutFrames, TArray<uint64>& OutOffsets)
+	{
+		FMemoryReader Reader(FileBytes);
+		Reader.Seek(FileBytes.Num() - REPLAY_FOOTER_SIZE);
+		Reader << OutIndexOffset;
+
+		Reader.Seek(static_cast<int64>(OutIndexOffset));
+		int32 NumKeyframes = 0;
+		TetrisSerialization::SerializeVarInt(Reader, NumKeyframes);
+		OutFrames.SetNum(NumKeyframes);
+		OutOffsets.SetNum(NumKeyframes);
+		for (int32 Index = 0; Index < NumKeyframes; Index++)
+		{
+			TetrisSerialization::SerializeVarUInt(Reader, OutFrames[Index]);
+			TetrisSerialization::SerializeVarUInt(Reader, OutOffsets[Index]);
+		}
+	}
+
+	// 索引だけを差し替えたファイル（索引の前とフッターの印はそのまま）
+	TArray<uint8> ReplaceReplayIndex(const TArray<uint8>& FileBytes, uint64 IndexOffset, TArray<uint64> Frames, TArray<uint64> Offsets)
+	{
+		TArray<uint8> Result(FileBytes.GetData(), static_cast<int32>(IndexOffset));
+		FMemoryWriter Writer(Result, false, true);
+		int32 NumKeyframes = Frames.Num();
+		TetrisSerialization::SerializeVarInt(Writer, NumKeyframes);
+		for (int32 Index = 0; Index < NumKeyframes; Index++)
+		{
+			TetrisSerialization::SerializeVarUInt(Writer, Frames[Index]);
+			TetrisSerialization::SerializeVarUInt(Writer, Offsets[Index]);
+		}
+		Writer << IndexOffset;
+		Writer.Serialize(const_cast<uint8*>(FileBytes.GetData() + FileBytes.Num() - sizeof(uint32)), sizeof(uint32));
+		return Result;
+	}
+}
+
+// ボット対戦を1フレーム1入力で記録し、任意のフレームへのシークが先頭から進めた状態と一致すること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisReplaySeekTest, "ClaudeTest.Tetris.Replay.Seek", TETRIS_TEST_FLAGS)
+
+bool FTetrisReplaySeekTest::RunTest(const FString& Parameters)
+{
+	constexpr int64 NUM_FRAMES = 20000;
+	constexpr int32 KEYFRAME_INTERVAL = 600;
+	const int64 CheckFrames[] = { 0, 1, 599, 600, 601, 7777, 12000, NUM_FRAMES - 1, NUM_FRAMES };
+
+	FTetrisSimConfig Config;
+	Config.Seed = 5;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	FTetrisReplayRecorder Recorder;
+	Recorder.Begin(Game, FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS, KEYFRAME_INTERVAL);
+
+	// 確認するフレームの開始時点の状態
+	TMap<int64, TArray<uint8>> Expected;
+
+	const FTetrisBotWeights Weights;
+	TArray<ETetrisInputCommand> Inputs;
+	int32 NextInput = 0;
+	for (int64 Frame = 0; Frame <= NUM_FRAMES; Frame++)
+	{
+		for (int64 CheckFrame : CheckFrames)
+		{
+			if (CheckFrame == Frame)
+			{
+				Expected.Add(Frame, GetStateBytes(Game));
+			}
+		}
+		if (Frame == NUM_FRAMES)
+		{
+			break;
+		}
+
+		// 3フレームに1度ボットの入力を1つ（ピースの途中で自然落下も起きる）
+		if (Frame % 3 == 0 && !Game.IsGameOver())
+		{
+			if (NextInput >= Inputs.Num())
+			{
+				NextInput = 0;
+				TetrisBot::FindBestPlacement(Game, Weights, Inputs);
+			}
+			if (NextInput < Inputs.Num())
+			{
+				const ETetrisInputCommand Command = Inputs[NextInput++];
+				Game.ApplyInput(Command);
+				Recorder.RecordInput(Command);
+			}
+		}
+		// ARR 0 のシフトと床までのソフトドロップも混ぜる（3ビットのコードを読み替えて記録する）
+		else if (Frame % 97 == 1 && !Game.IsGameOver())
+		{
+			const ETetrisInputCommand Command = (Frame / 97 % 3 == 0) ? ETetrisInputCommand::ShiftLeft
+				: (Frame / 97 % 3 == 1) ? ETetrisInputCommand::ShiftRight : ETetrisInputCommand::SoftDropToFloor;
+			Game.ApplyInput(Command);
+			Recorder.RecordInput(Command);
+		}
+
+		Game.Advance(FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS);
+		Recorder.EndFrame(Game);
+	}
+
+	TArray<uint8> FileBytes;
+	Recorder.Finish(FileBytes);
+	AddInfo(FString::Printf(TEXT("Replay: %lld frames, %d inputs, %d bytes"), NUM_FRAMES, Recorder.GetNumInputs(), FileBytes.Num()));
+
+	// 版 2（コード 5-7 が無かった版）として読むと、フレーム 1 の ShiftLeft で再生が失敗する（別のコマンドに読み替えない）
+	{
+		TArray<uint8> OldVersionBytes = FileBytes;
+		OldVersionBytes[sizeof(uint32)] = 2;
+		FTetrisReplay OldVersionReplay;
+		FTetrisSimGame OldVersionGame;
+		TestTrue(TEXT("Version 2 header parsed"), OldVersionReplay.FromBytes(MoveTemp(OldVersionBytes)));
+		TestFalse(TEXT("Version 2 replay with shift codes does not seek"), OldVersionReplay.SeekToFrame(2, OldVersionGame));
+	}
+
+	FTetrisReplay Replay;
+	if (!TestTrue(TEXT("Replay parsed"), Replay.FromBytes(MoveTemp(FileBytes))))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Frame count"), Replay.GetNumFrames(), NUM_FRAMES);
+	TestEqual(TEXT("Input count"), Replay.GetNumInputs(), Recorder.GetNumInputs());
+	TestEqual(TEXT("Keyframe count"), Replay.GetNumKeyframes(), int32(NUM_FRAMES / KEYFRAME_INTERVAL) + 1);
+
+	// 後ろから順にシークしても状態は前のシークに依存しない
+	FTetrisSimGame Seeked;
+	double SlowestSeekSeconds = 0.0;
+	for (int32 Index = UE_ARRAY_COUNT(CheckFrames) - 1; Index >= 0; Index--)
+	{
+		const int64 Frame = CheckFrames[Index];
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bSeeked = Replay.SeekToFrame(Frame, Seeked);
+		SlowestSeekSeconds = FMath::Max(SlowestSeekSeconds, FPlatformTime::Seconds() - StartTime);
+
+		if (!bSeeked || GetStateBytes(Seeked) != Expected.FindChecked(Frame))
+		{
+			AddError(FString::Printf(TEXT("Seek to frame %lld does not match the recorded game"), Frame));
+			return false;
+		}
+	}
+
+	TetrisTestBudgets::CheckBudget(*this, TEXT("Slowest replay seek"), SlowestSeekSeconds, TetrisTestBudgets::REPLAY_SEEK_SECONDS);
+	return true;
+}
+
+// 壊れた索引（入力列や索引を指す位置、増えないフレーム）は読み込みで弾き、シークできないこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisReplayCorruptIndexTest, "ClaudeTest.Tetris.Replay.CorruptIndex", TETRIS_TEST_FLAGS)
+
+bool FTetrisReplayCorruptIndexTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_FRAMES = 50;
+	constexpr int32 KEYFRAME_INTERVAL = 10;
+
+	FTetrisSimConfig Config;
+	Config.Seed = 40;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	FTetrisReplayRecorder Recorder;
+	Recorder.Begin(Game, FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS, KEYFRAME_INTERVAL);
+	for (int32 Frame = 0; Frame < NUM_FRAMES; Frame++)
+	{
+		const ETetrisInputCommand Command = (Frame & 1) ? ETetrisInputCommand::MoveLeft : ETetrisInputCommand::Rotate;
+		Game.ApplyInput(Command);
+		Recorder.RecordInput(Command);
+		Game.Advance(FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS);
+		Recorder.EndFrame(Game);
+	}
+
+	TArray<uint8> FileBytes;
+	Recorder.Finish(FileBytes);
+
+	uint64 IndexOffset = 0;
+	TArray<uint64> Frames;
+	TArray<uint64> Offsets;
+	ReadReplayIndex(FileBytes, IndexOffset, Frames, Offsets);
+	if (!TestEqual(TEXT("Keyframe count"), Frames.Num(), NUM_FRAMES / KEYFRAME_INTERVAL + 1))
+	{
+		return false;
+	}
+
+	// 書き直しただけの索引は読める
+	FTetrisReplay Replay;
+	FTetrisSimGame Seeked;
+	TestTrue(TEXT("Rewritten index parsed"), Replay.FromBytes(ReplaceReplayIndex(FileBytes, IndexOffset, Frames, Offsets)));
+	TestTrue(TEXT("Rewritten index seeks"), Replay.SeekToFrame(NUM_FRAMES / 2, Seeked));
+
+	struct FCorruptCase
+	{
+		const TCHAR* Name;
+		int32 Entry;
+		uint64 Frame;
+		uint64 Offset;
+	};
+	const FCorruptCase Cases[] = {
+		{ TEXT("Offset in the header"), 2, Frames[2], 0 },
+		{ TEXT("Offset in the input stream"), 2, Frames[2], Offsets[0] - 1 },
+		{ TEXT("Offset at the index"), 2, Frames[2], IndexOffset },
+		{ TEXT("Offset past the end"), 2, Frames[2], static_cast<uint64>(FileBytes.Num()) + 1000 },
+		{ TEXT("Huge offset"), 2, Frames[2], MAX_uint64 },
+		{ TEXT("First frame not zero"), 0, 1, Offsets[0] },
+		{ TEXT("Repeated frame"), 3, Frames[2], Offsets[3] },
+		{ TEXT("Decreasing frame"), 3, Frames[1], Offsets[3] },
+		{ TEXT("Frame past the end"), Frames.Num() - 1, NUM_FRAMES + 1, Offsets.Last() },
+	};
+	for (const FCorruptCase& Case : Cases)
+	{
+		TArray<uint64> CorruptFrames = Frames;
+		TArray<uint64> CorruptOffsets = Offsets;
+		CorruptFrames[Case.Entry] = Case.Frame;
+		CorruptOffsets[Case.Entry] = Case.Offset;
+
+		TestFalse(FString::Printf(TEXT("%s rejected"), Case.Name), Replay.FromBytes(ReplaceReplayIndex(FileBytes, IndexOffset, CorruptFrames, CorruptOffsets)));
+		TestFalse(FString::Printf(TEXT("%s cannot seek"), Case.Name), Replay.SeekToFrame(Case.Frame, Seeked));
+	}
+	return true;
+}
+
+// 壊れたキーフレーム（範囲外の操作中ピース・ランダマイザー）や設定は、シーク・読み込みが失敗すること（無限ループに入らない）
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisReplayCorruptKeyframeTest, "ClaudeTest.Tetris.Replay.CorruptKeyframe", TETRIS_TEST_FLAGS)
+
+bool FTetrisReplayCorruptKeyframeTest::RunTest(const FString& Parameters)
+{
+	using namespace TetrisSerialization;
+
+	constexpr int32 NUM_FRAMES = 50;
+	constexpr int32 KEYFRAME_INTERVAL = 10;
+	constexpr int32 CORRUPT_KEYFRAME = 2;
+
+	FTetrisSimConfig Config;
+	Config.Seed = 41;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	// 壊すキーフレームの状態と、その中の操作中ピース・キューの位置（SerializeState の並び：盤面 → キュー → 統計 → 操作中ピース）
+	TArray<uint8> KeyframeState;
+	int32 QueueOffset = 0;
+	int32 ActivePieceOffset = 0;
+
+	FTetrisReplayRecorder Recorder;
+	Recorder.Begin(Game, FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS, KEYFRAME_INTERVAL);
+	for (int32 Frame = 0; Frame < NUM_FRAMES; Frame++)
+	{
+		const ETetrisInputCommand Command = (Frame & 1) ? ETetrisInputCommand::MoveRight : ETetrisInputCommand::Rotate;
+		Game.ApplyInput(Command);
+		Recorder.RecordInput(Command);
+		Game.Advance(FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS);
+		Recorder.EndFrame(Game);
+
+		if (Frame + 1 == CORRUPT_KEYFRAME * KEYFRAME_INTERVAL)
+		{
+			KeyframeState = GetStateBytes(Game);
+
+			TArray<uint8> Head;
+			FMemoryWriter Writer(Head);
+			const FTetrisSimBoard& Board = Game.GetBoard();
+			int32 BoardHeight = Board.Height;
+			SerializeVarInt(Writer, BoardHeight);
+			for (int32 Y = 0; Y < Board.Height; Y++)
+			{
+				uint64 PackedRow = Board.PackedRows[Y];
+				SerializeVarUInt(Writer, PackedRow);
+			}
+			QueueOffset = Head.Num();
+			FTetrisPieceQueue Queue = Game.GetQueue();
+			Queue.Serialize(Writer);
+			FTetrisGameStats Stats = Game.GetStats();
+			SerializeVarInt(Writer, Stats.Score);
+			SerializeVarInt(Writer, Stats.Level);
+			SerializeVarInt(Writer, Stats.LinesCleared);
+			SerializeVarInt(Writer, Stats.PiecesPlaced);
+			ActivePieceOffset = Head.Num();
+
+			if (!TestTrue(TEXT("Piece active at the keyframe"), Game.HasActivePiece())
+				|| !TestTrue(TEXT("State layout matches"), KeyframeState.Num() > ActivePieceOffset && FMemory::Memcmp(KeyframeState.GetData(), Head.GetData(), Head.Num()) == 0))
+			{
+				return false;
+			}
+		}
+	}
+
+	TArray<uint8> FileBytes;
+	Recorder.Finish(FileBytes);
+
+	uint64 IndexOffset = 0;
+	TArray<uint64> Frames;
+	TArray<uint64> Offsets;
+	ReadReplayIndex(FileBytes, IndexOffset, Frames, Offsets);
+	if (!TestEqual(TEXT("Keyframe count"), Frames.Num(), NUM_FRAMES / KEYFRAME_INTERVAL + 1))
+	{
+		return false;
+	}
+
+	// キーフレームの状態はフレーム番号・入力位置の後ろにある
+	int32 StateOffset = INDEX_NONE;
+	for (int32 Offset = static_cast<int32>(Offsets[CORRUPT_KEYFRAME]); Offset + KeyframeState.Num() <= static_cast<int32>(IndexOffset); Offset++)
+	{
+		if (FMemory::Memcmp(FileBytes.GetData() + Offset, KeyframeState.GetData(), KeyframeState.Num()) == 0)
+		{
+			StateOffset = Offset;
+			break;
+		}
+	}
+	if (!TestNotEqual(TEXT("Keyframe state found"), StateOffset, int32(INDEX_NONE)))
+	{
+		return false;
+	}
+
+	const int64 SeekFrame = CORRUPT_KEYFRAME * KEYFRAME_INTERVAL + KEYFRAME_INTERVAL / 2;
+	struct FCorruptCase
+	{
+		const TCHAR* Name;
+		int32 Offset;
+		uint8 Value;
+	};
+	const FCorruptCase Cases[] = {
+		{ TEXT("Active piece out of range"), StateOffset + ActivePieceOffset, 200 },
+		{ TEXT("Active piece just past L"), StateOffset + ActivePieceOffset, static_cast<uint8>(EPieceType::L_Piece) + 1 },
+		{ TEXT("Queue randomizer out of range"), StateOffset + QueueOffset, 9 },
+	};
+	for (const FCorruptCase& Case : Cases)
+	{
+		TArray<uint8> CorruptBytes = FileBytes;
+		CorruptBytes[Case.Offset] = Case.Value;
+
+		// 索引は正しいので読み込みは通り、壊れたキーフレームを使うシークだけが失敗する
+		FTetrisReplay Replay;
+		FTetrisSimGame Seeked;
+		if (!TestTrue(FString::Printf(TEXT("%s: index parsed"), Case.Name), Replay.FromBytes(MoveTemp(CorruptBytes))))
+		{
+			continue;
+		}
+		TestTrue(FString::Printf(TEXT("%s: earlier keyframe seeks"), Case.Name), Replay.SeekToFrame(KEYFRAME_INTERVAL / 2, Seeked));
+		TestFalse(FString::Printf(TEXT("%s: corrupt keyframe does not seek"), Case.Name), Replay.SeekToFrame(SeekFrame, Seeked));
+	}
+
+	// ヘッダーの設定：マジック・版の後の幅・高さに続くランダマイザー
+	{
+		TArray<uint8> ConfigPrefix;
+		FMemoryWriter Writer(ConfigPrefix);
+		int32 BoardWidth = Game.GetConfig().BoardWidth;
+		int32 BoardHeight = Game.GetConfig().BoardHeight;
+		SerializeVarInt(Writer, BoardWidth);
+		SerializeVarInt(Writer, BoardHeight);
+
+		const int32 RandomizerOffset = sizeof(uint32) + sizeof(uint8) + ConfigPrefix.Num();
+		TestEqual(TEXT("Header randomizer found"), FileBytes[RandomizerOffset], static_cast<uint8>(Game.GetConfig().RandomizerType));
+
+		TArray<uint8> CorruptBytes = FileBytes;
+		CorruptBytes[RandomizerOffset] = 9;
+		FTetrisReplay Replay;
+		TestFalse(TEXT("Header randomizer out of range rejected"), Replay.FromBytes(MoveTemp(CorruptBytes)));
+	}
+	return true;
+}
+
+// 入力の無いフレームはファイルを大きくしない
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisReplaySizeTest, "ClaudeTest.Tetris.Replay.Size", TETRIS_TEST_FLAGS)
+
+bool FTetrisReplaySizeTest::RunTest(const FString& Parameters)
+{
+	FTetrisSimConfig Config;
+	FTetrisSimGame Game;
+	Game.Reset(Config);
+
+	FTetrisReplayRecorder Recorder;
+	Recorder.Begin(Game, FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS, MAX_int32);
+
+	// 毎フレーム左右に往復し、10フレームに1度だけの区間も混ぜる
+	constexpr int32 NUM_FRAMES = 1000;
+	for (int32 Frame = 0; Frame < NUM_FRAMES; Frame++)
+	{
+		if (Frame < NUM_FRAMES / 2 || Frame % 10 == 0)
+		{
+			const ETetrisInputCommand Command = (Frame & 1) ? ETetrisInputCommand::MoveLeft : ETetrisInputCommand::MoveRight;
+			Game.ApplyInput(Command);
+			Recorder.RecordInput(Command);
+		}
+		Recorder.RecordInput(ETetrisInputCommand::Pause);
+		Recorder.EndFrame(Game);
+	}
+
+	TArray<uint8> FileBytes;
+	Recorder.Finish(FileBytes);
+
+	TArray<uint8> EmptyBytes;
+	FTetrisReplayRecorder EmptyRecorder;
+	EmptyRecorder.Begin(Game, FTetrisReplayRecorder::DEFAULT_FRAME_MICROSECONDS, MAX_int32);
+	EmptyRecorder.Finish(EmptyBytes);
+
+	TestEqual(TEXT("Pause is not recorded"), Recorder.GetNumInputs(), NUM_FRAMES / 2 + NUM_FRAMES / 20);
+
+	// フレーム差が 15 以下の入力は1バイト
+	const int32 InputBytes = FileBytes.Num() - EmptyBytes.Num();
+	AddInfo(FString::Printf(TEXT("Replay inputs: %d inputs, %d bytes"), Recorder.GetNumInputs(), InputBytes));
+	TestTrue(TEXT("One byte per input"), InputBytes <= Recorder.GetNumInputs() + 8);
+	return true;
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "TetrisTestUtils.h"
+#include "TetrisRollback.h"
+#include "TetrisPieceTables.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// 6フレームに1度くらい、プレイヤーとフレームで決まる入力を1つ
+	FTetrisFrameInput MakeTestInput(int32 Player, int64 Frame)
+	{
+		static const ETetrisInputCommand Commands[] = { ETetrisInputCommand::MoveLeft, ETetrisInputCommand::MoveRight,
+			ETetrisInputCommand::Rotate, ETetrisInputCommand::MoveDown, ETetrisInputCommand::ShiftLeft,
+			ETetrisInputCommand::ShiftRight, ETetrisInputCommand::SoftDropToFloor, ETetrisInputCommand::HardDrop };
+
+		FTetrisFrameInput Input;
+		const uint32 Hash = HashCombine(GetTypeHash(Frame), GetTypeHash(Player + 1));
+		if (Hash % 6 == 0)
+		{
+			Input.Add(Commands[(Hash / 6) % UE_ARRAY_COUNT(Commands)]);
+		}
+		return Input;
+	}
+}
+
+// ラインを消すと相手におじゃまブロックが届き、届いているぶんは相殺され、固定したときにせり上がること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRollbackGarbageTest, "ClaudeTest.Tetris.Rollback.Garbage", TETRIS_TEST_FLAGS)
+
+bool FTetrisRollbackGarbageTest::RunTest(const FString& Parameters)
+{
+	FTetrisSimGame Probe;
+	if (!TestTrue(TEXT("Found seed for I piece"), TetrisTestUtils::ResetWithFirstPiece(Probe, EPieceType::I_Piece)))
+	{
+		return false;
+	}
+
+	FTetrisVersusState State;
+	State.Reset(Probe.GetConfig());
+
+	// プレイヤー0：縦 I の列だけ空いた4行を作り、3行届いている状態でテトリス（4行送って3行相殺）
+	FTetrisSimGame& Game = State.Games[0];
+	Game.ApplyInput(ETetrisInputCommand::Rotate);
+	int32 MinX = 0;
+	int32 MaxX = 0;
+	TetrisTestUtils::GetShapeColumnRange(TetrisPieceTables::GetShapeMask(EPieceType::I_Piece, Game.GetActiveRotation()), MinX, MaxX);
+	Game.AddGarbageRows(4, Game.GetActiveX() + MinX);
+	TestFalse(TEXT("Garbage below the spawn is not game over"), Game.IsGameOver());
+	State.PendingGarbage[0] = 3;
+
+	FTetrisFrameInput Inputs[FTetrisVersusState::NUM_PLAYERS];
+	Inputs[0].Add(ETetrisInputCommand::HardDrop);
+	State.Step(Inputs, 1);
+	TestEqual(TEXT("Tetris cleared the garbage"), Game.GetStats().LinesCleared, 4);
+	TestEqual(TEXT("Own garbage cancelled"), State.PendingGarbage[0], 0);
+	TestEqual(TEXT("Remaining garbage sent"), State.PendingGarbage[1], 1);
+
+	// プレイヤー1：消さずに固定すると1行せり上がる
+	const FTetrisSimBoard& Board = State.Games[1].GetBoard();
+	Inputs[0] = FTetrisFrameInput();
+	Inputs[1].Add(ETetrisInputCommand::HardDrop);
+	State.Step(Inputs, 1);
+	TestEqual(TEXT("Garbage applied"), State.PendingGarbage[1], 0);
+	TestEqual(TEXT("Garbage row has one hole"), int32(FMath::CountBits(Board.Rows[Board.Height - 1])), Board.Width - 1);
+	TestEqual(TEXT("Locked piece pushed up"), int32(FMath::CountBits(Board.Rows[Board.Height - 2])), 4);
+	TestEqual(TEXT("Garbage cells are untyped"), TetrisCellPacking::GetPackedCell(Board.PackedRows[Board.Height - 1],
+		int32(FMath::CountTrailingZeros(uint32(Board.Rows[Board.Height - 1])))), TetrisCellPacking::CELL_UNTYPED);
+
+	// 盤面の高さぶんせり上がるとゲームオーバー
+	FTetrisSimGame Overflow;
+	Overflow.Reset(Probe.GetConfig());
+	Overflow.AddGarbageRows(Overflow.GetBoard().Height, 0);
+	TestTrue(TEXT("Overflow is game over"), Overflow.IsGameOver());
+	return true;
+}
+
+// 遅延・揺らぎ・パケットロスのある回線でも、両方のピアが遅延なしで進めた結果と同じ状態に収束すること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRollbackLoopbackTest, "ClaudeTest.Tetris.Rollback.Loopback", TETRIS_TEST_FLAGS)
+
+bool FTetrisRollbackLoopbackTest::RunTest(const FString& Parameters)
+{
+	constexpr int64 NUM_FRAMES = 1500;
+	constexpr int32 MAX_DRAIN_TICKS = 10000;
+
+	FTetrisSimConfig GameConfig;
+	GameConfig.Seed = 49;
+	const FTetrisRollbackConfig RollbackConfig;
+
+	// 遅延なしで両者の入力を適用した結果
+	FTetrisVersusState Reference;
+	Reference.Reset(GameConfig);
+	for (int64 Frame = 0; Frame < NUM_FRAMES; Frame++)
+	{
+		FTetrisFrameInput Inputs[FTetrisVersusState::NUM_PLAYERS];
+		if (Frame >= RollbackConfig.InputDelayFrames)
+		{
+			Inputs[0] = MakeTestInput(0, Frame);
+			Inputs[1] = MakeTestInput(1, Frame);
+		}
+		Reference.Step(Inputs, RollbackConfig.FrameMicroseconds);
+	}
+	const uint32 ExpectedChecksum = Reference.GetChecksum();
+
+	struct FScenario
+	{
+		const TCHAR* Name;
+		int64 LatencyMicroseconds;
+		int64 JitterMicroseconds;
+		float PacketLoss;
+	};
+	const FScenario Scenarios[] = {
+		{ TEXT("LAN"), 0, 0, 0.0f },
+		{ TEXT("50ms, 20% loss"), 50000, 20000, 0.2f },
+		{ TEXT("100ms, 40% loss"), 100000, 50000, 0.4f },
+	};
+
+	for (const FScenario& Scenario : Scenarios)
+	{
+		FTetrisLoopbackConfig NetConfig;
+		NetConfig.LatencyMicroseconds = Scenario.LatencyMicroseconds;
+		NetConfig.JitterMicroseconds = Scenario.JitterMicroseconds;
+		NetConfig.PacketLoss = Scenario.PacketLoss;
+
+		FTetrisRollbackLoopback Loopback;
+		Loopback.Start(GameConfig, RollbackConfig, NetConfig);
+
+		int32 Ticks = 0;
+		while (!Loopback.IsSynchronized(NUM_FRAMES) && Ticks < NUM_FRAMES + MAX_DRAIN_TICKS)
+		{
+			Loopback.Tick([](int32 Player, int64 Frame) { return MakeTestInput(Player, Frame); }, NUM_FRAMES);
+			Ticks++;
+		}
+		if (!TestTrue(FString::Printf(TEXT("%s: peers synchronized"), Scenario.Name), Loopback.IsSynchronized(NUM_FRAMES)))
+		{
+			return false;
+		}
+
+		const FTetrisLoopbackStats& NetStats = Loopback.GetStats();
+		for (int32 Player = 0; Player < FTetrisVersusState::NUM_PLAYERS; Player++)
+		{
+			const FTetrisRollbackSession& Peer = Loopback.GetPeer(Player);
+			const FTetrisRollbackStats& Stats = Peer.GetStats();
+			AddInfo(FString::Printf(TEXT("%s peer %d: %d rollbacks, %lld frames resimulated (max %d), %d/%d packets dropped, %lld bytes, %d stalls"),
+				Scenario.Name, Player, Stats.Rollbacks, Stats.FramesResimulated, Stats.MaxRollbackDepth,
+				NetStats.PacketsDropped, NetStats.PacketsSent, NetStats.BytesSent, NetStats.StalledFrames));
+
+			TestEqual(FString::Printf(TEXT("%s: peer %d matches the reference"), Scenario.Name, Player), Peer.GetState().GetChecksum(), ExpectedChecksum);
+			TestTrue(FString::Printf(TEXT("%s: rollback depth within limit"), Scenario.Name), Stats.MaxRollbackDepth <= RollbackConfig.MaxRollbackFrames);
+			if (Scenario.LatencyMicroseconds > 0)
+			{
+				TestTrue(FString::Printf(TEXT("%s: peer %d rolled back"), Scenario.Name, Player), Stats.Rollbacks > 0);
+			}
+		}
+	}
+	return true;
+}
+
+// 状態の保存と復元（値のコピー）が 1µs を十分下回ること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRollbackSnapshotTest, "ClaudeTest.Tetris.Rollback.Snapshot", TETRIS_TEST_FLAGS)
+
+bool FTetrisRollbackSnapshotTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NUM_SNAPSHOTS = 100000;
+	constexpr int32 RING_SIZE = 9;
+
+	FTetrisSimConfig Config;
+	Config.Seed = 7;
+	FTetrisVersusState State;
+	State.Reset(Config);
+	for (int64 Frame = 0; Frame < 600; Frame++)
+	{
+		const FTetrisFrameInput Inputs[FTetrisVersusState::NUM_PLAYERS] = { MakeTestInput(0, Frame), MakeTestInput(1, Frame) };
+		State.Step(Inputs, 16667);
+	}
+	const uint32 ExpectedChecksum = State.GetChecksum();
+
+	TArray<FTetrisVersusState> Ring;
+	Ring.Init(State, RING_SIZE);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NUM_SNAPSHOTS; Index++)
+	{
+		Ring[Index % RING_SIZE] = State;
+		State = Ring[(Index + 1) % RING_SIZE];
+	}
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo(FString::Printf(TEXT("Versus state: %d bytes, %.1f ns per save + restore"),
+		int32(sizeof(FTetrisVersusState)), ElapsedSeconds * 1.0e9 / NUM_SNAPSHOTS));
+	TestEqual(TEXT("Restored state matches"), State.GetChecksum(), ExpectedChecksum);
+	TetrisTestBudgets::CheckBudget(*this, TEXT("100k snapshot save + restore"), ElapsedSeconds, TetrisTestBudgets::ROLLBACK_SNAPSHOT_100K_SECONDS);
+	return true;
+}
+
+#endif
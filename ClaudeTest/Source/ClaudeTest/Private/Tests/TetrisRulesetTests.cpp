@@ -0,0 +1,144 @@
+#include "TetrisTestUtils.h"
+#include "TetrisRuleset.h"
+#include "TetrisArena.h"
+#include "TetrisSimulation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// 既定のルールセットは TetrisRules と同じ値で、実行時の選択はポリシーと同じ値を返すこと
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRulesetPoliciesTest, "ClaudeTest.Tetris.Ruleset.Policies", TETRIS_TEST_FLAGS)
+
+bool FTetrisRulesetPoliciesTest::RunTest(const FString& Parameters)
+{
+	const FTetrisRuleset& Modern = FTetrisRuleset::Get(ETetrisRuleset::Modern);
+	for (int32 Level = 1; Level <= 20; Level++)
+	{
+		for (int32 Lines = 1; Lines <= 4; Lines++)
+		{
+			TestEqual(TEXT("Modern line score"), Modern.GetLineClearScore(Lines, Level), TetrisRules::GetLineClearScore(Lines, Level));
+		}
+		TestEqual(TEXT("Modern fall interval"), Modern.GetFallInterval(1.0f, Level), TetrisRules::GetFallInterval(1.0f, Level));
+		TestEqual(TEXT("Modern fall interval (microseconds)"), Modern.GetFallIntervalMicroseconds(1000000, Level),
+			TetrisRules::GetFallIntervalMicroseconds(1000000, Level));
+	}
+	TestEqual(TEXT("Modern randomizer"), Modern.GetDefaultRandomizer(), ETetrisRandomizerType::SevenBag);
+	TestEqual(TEXT("Modern T kicks"), Modern.GetWallKickOffsets(EPieceType::T_Piece).Num(), TetrisRules::GetWallKickOffsets(EPieceType::T_Piece).Num());
+
+	// NES：レベル1（NES のレベル0）のテトリスは 1200 点、48 フレームで1行
+	const FTetrisRuleset& Classic = FTetrisRuleset::Get(ETetrisRuleset::Classic);
+	TestEqual(TEXT("Classic tetris at level 1"), Classic.GetLineClearScore(4, 1), 1200);
+	TestEqual(TEXT("Classic single at level 3"), Classic.GetLineClearScore(1, 3), 120);
+	TestEqual(TEXT("Classic level 1 gravity"), Classic.GetFallIntervalMicroseconds(1000000, 1), 48 * FTetrisClassicRules::FRAME_MICROSECONDS);
+	TestEqual(TEXT("Classic ignores the base fall speed"), Classic.GetFallIntervalMicroseconds(1, 10), Classic.GetFallIntervalMicroseconds(2000000, 10));
+	TestEqual(TEXT("Classic has no kicks"), Classic.GetWallKickOffsets(EPieceType::T_Piece).Num(), 0);
+	TestEqual(TEXT("Classic hard drop score"), Classic.GetHardDropScorePerRow(), 0);
+
+	// TGM：I は蹴らない、レベルが上がると 20G（1フレームに20行）
+	const FTetrisRuleset& TGM = FTetrisRuleset::Get(ETetrisRuleset::TGM);
+	TestEqual(TEXT("TGM randomizer"), TGM.GetDefaultRandomizer(), ETetrisRandomizerType::TGMHistory);
+	TestEqual(TEXT("TGM I kicks"), TGM.GetWallKickOffsets(EPieceType::I_Piece).Num(), 0);
+	TestEqual(TEXT("TGM T kicks"), TGM.GetWallKickOffsets(EPieceType::T_Piece).Num(), 2);
+	TestEqual(TEXT("TGM 20G"), TGM.GetFallIntervalMicroseconds(1000000, 15), FTetrisTGMRules::FRAME_MICROSECONDS / 20);
+
+	// 実行時の選択とポリシーの直接呼び出しが一致する
+	for (ETetrisRuleset Ruleset : { ETetrisRuleset::Modern, ETetrisRuleset::Classic, ETetrisRuleset::TGM })
+	{
+		const FTetrisRuleset& Runtime = FTetrisRuleset::Get(Ruleset);
+		TetrisRuleset::Visit(Ruleset, [&](auto Rules)
+		{
+			using RulesType = decltype(Rules);
+			TestEqual(TEXT("Visit picks the ruleset"), RulesType::RULESET, Ruleset);
+			for (int32 Level = 1; Level <= 20; Level++)
+			{
+				TestEqual(TEXT("Runtime line score"), Runtime.GetLineClearScore(4, Level), RulesType::GetLineClearScore(4, Level));
+				TestEqual(TEXT("Runtime fall interval"), Runtime.GetFallIntervalMicroseconds(500000, Level), RulesType::GetFallIntervalMicroseconds(500000, Level));
+			}
+		});
+	}
+	return true;
+}
+
+// ルールセットごとにインスタンス化したアリーナと FTetrisSimGame が一致し、Wall Kick の違いが結果に出ること
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRulesetSimulationTest, "ClaudeTest.Tetris.Ruleset.Simulation", TETRIS_TEST_FLAGS)
+
+bool FTetrisRulesetSimulationTest::RunTest(const FString& Parameters)
+{
+	// 右壁際の縦 I：既定のルールは左にずらして回せるが、NES・TGM は回せない
+	for (ETetrisRuleset Ruleset : { ETetrisRuleset::Modern, ETetrisRuleset::Classic, ETetrisRuleset::TGM })
+	{
+		FTetrisSimGame Game;
+		if (!TestTrue(TEXT("Found seed for I piece"), TetrisTestUtils::ResetWithFirstPiece(Game, EPieceType::I_Piece)))
+		{
+			return false;
+		}
+		FTetrisSimConfig Config = Game.GetConfig();
+		Config.Ruleset = Ruleset;
+		Game.Reset(Config);
+
+		Game.ApplyInput(ETetrisInputCommand::Rotate);
+		Game.ApplyInput(ETetrisInputCommand::ShiftRight);
+		TestEqual(TEXT("Rotation at the right wall"), Game.ApplyInput(ETetrisInputCommand::Rotate), Ruleset == ETetrisRuleset::Modern);
+	}
+
+	constexpr int32 NUM_GAMES = FTetrisArena::CHUNK_GAMES + 3;
+	constexpr int32 NUM_STEPS = 1500;
+	constexpr int64 STEP_MICROSECONDS = 16667;
+	const ETetrisInputCommand Commands[] = { ETetrisInputCommand::MoveLeft, ETetrisInputCommand::MoveRight,
+		ETetrisInputCommand::Rotate, ETetrisInputCommand::MoveDown, ETetrisInputCommand::HardDrop };
+
+	for (ETetrisRuleset Ruleset : { ETetrisRuleset::Classic, ETetrisRuleset::TGM })
+	{
+		FTetrisSimConfig Config;
+		Config.Seed = 48;
+		Config.Ruleset = Ruleset;
+		Config.RandomizerType = FTetrisRuleset::Get(Ruleset).GetDefaultRandomizer();
+
+		FTetrisArena Arena;
+		Arena.Initialize(Config, NUM_GAMES);
+
+		TArray<FTetrisSimGame> Games;
+		Games.SetNum(NUM_GAMES);
+		for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+		{
+			FTetrisSimConfig GameConfig = Config;
+			GameConfig.Seed = Config.Seed + GameIndex;
+			Games[GameIndex].Reset(GameConfig);
+		}
+
+		FRandomStream Random(static_cast<int32>(Ruleset));
+		for (int32 StepIndex = 0; StepIndex < NUM_STEPS; StepIndex++)
+		{
+			for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+			{
+				if (Random.RandRange(0, 1) == 1)
+				{
+					const ETetrisInputCommand Command = Commands[Random.RandRange(0, UE_ARRAY_COUNT(Commands) - 1)];
+					Arena.QueueInput(GameIndex, Command);
+					Games[GameIndex].ApplyInput(Command);
+				}
+				Games[GameIndex].Advance(STEP_MICROSECONDS);
+			}
+			Arena.Step(STEP_MICROSECONDS, 4);
+		}
+
+		for (int32 GameIndex = 0; GameIndex < NUM_GAMES; GameIndex++)
+		{
+			const FTetrisSimGame& Game = Games[GameIndex];
+			const bool bMatches = Arena.IsGameOver(GameIndex) == Game.IsGameOver()
+				&& Arena.GetActivePiece(GameIndex) == Game.GetActivePiece()
+				&& Arena.GetActiveX(GameIndex) == Game.GetActiveX()
+				&& Arena.GetActiveY(GameIndex) == Game.GetActiveY()
+				&& Arena.GetStats(GameIndex).Score == Game.GetStats().Score
+				&& Arena.GetStats(GameIndex).PiecesPlaced == Game.GetStats().PiecesPlaced
+				&& FMemory::Memcmp(Arena.GetPackedRows(GameIndex), Game.GetBoard().PackedRows, Game.GetBoard().Height * sizeof(uint64)) == 0;
+			if (!bMatches)
+			{
+				AddError(FString::Printf(TEXT("Ruleset %d game %d diverged from the simulation"), int32(Ruleset), GameIndex));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
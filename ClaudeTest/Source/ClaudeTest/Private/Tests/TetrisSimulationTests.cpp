@@ -0,0 +1,296 @@
+#include "TetrisTestUtils.h"
+#include "TetrisSimulation.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRandomizer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// 移動：壁まで動かせること・ソフトドロップの得点
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimMovementTest, "ClaudeTest.Tetris.Simulation.Movement", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimMovementTest::RunTest(const FString& Parameters)
+{
+	for (EPieceType PieceType : { EPieceType::I_Piece, EPieceType::O_Piece, EPieceType::T_Piece, EPieceType::L_Piece })
+	{
+		FTetrisSimGame Game;
+		if (!TestTrue(TEXT("Found seed for first piece"), TetrisTestUtils::ResetWithFirstPiece(Game, PieceType)))
+		{
+			return false;
+		}
+
+		int32 MinX = 0;
+		int32 MaxX = 0;
+		TetrisTestUtils::GetShapeColumnRange(TetrisPieceTables::GetShapeMask(PieceType, 0), MinX, MaxX);
+
+		while (Game.ApplyInput(ETetrisInputCommand::MoveLeft))
+		{
+		}
+		TestEqual(TEXT("Left wall X"), Game.GetActiveX(), -MinX);
+
+		while (Game.ApplyInput(ETetrisInputCommand::MoveRight))
+		{
+		}
+		TestEqual(TEXT("Right wall X"), Game.GetActiveX(), Game.GetBoard().Width - 1 - MaxX);
+
+		const int32 ScoreBefore = Game.GetStats().Score;
+		TestTrue(TEXT("Soft drop moves down"), Game.ApplyInput(ETetrisInputCommand::MoveDown));
+		TestEqual(TEXT("Soft drop Y"), Game.GetActiveY(), TetrisRules::SPAWN_Y + 1);
+		TestEqual(TEXT("Soft drop score"), Game.GetStats().Score, ScoreBefore + TetrisRules::SOFT_DROP_SCORE);
+	}
+	return true;
+}
+
+// ARR 0：一度のシフトが1マスずつの移動を繰り返した位置と同じで、床までのソフトドロップは固定しない
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimInstantShiftTest, "ClaudeTest.Tetris.Simulation.InstantShift", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimInstantShiftTest::RunTest(const FString& Parameters)
+{
+	for (EPieceType PieceType : { EPieceType::I_Piece, EPieceType::O_Piece, EPieceType::T_Piece, EPieceType::Z_Piece })
+	{
+		FTetrisSimGame Stepped;
+		FTetrisSimGame Shifted;
+		if (!TestTrue(TEXT("Found seed for first piece"), TetrisTestUtils::ResetWithFirstPiece(Stepped, PieceType)))
+		{
+			return false;
+		}
+		TetrisTestUtils::ResetWithFirstPiece(Shifted, PieceType);
+
+		while (Stepped.ApplyInput(ETetrisInputCommand::MoveLeft))
+		{
+		}
+		TestTrue(TEXT("Shift left moves"), Shifted.ApplyInput(ETetrisInputCommand::ShiftLeft));
+		TestEqual(TEXT("Shift left reaches the wall"), Shifted.GetActiveX(), Stepped.GetActiveX());
+		TestFalse(TEXT("Shift at the wall does not move"), Shifted.ApplyInput(ETetrisInputCommand::ShiftLeft));
+
+		while (Stepped.ApplyInput(ETetrisInputCommand::MoveRight))
+		{
+		}
+		TestTrue(TEXT("Shift right moves"), Shifted.ApplyInput(ETetrisInputCommand::ShiftRight));
+		TestEqual(TEXT("Shift right reaches the wall"), Shifted.GetActiveX(), Stepped.GetActiveX());
+
+		const int32 ScoreBefore = Shifted.GetStats().Score;
+		const int32 DropY = Shifted.GetBoard().GetDropY(PieceType, Shifted.GetActiveRotation(), Shifted.GetActiveX(), Shifted.GetActiveY());
+		TestTrue(TEXT("Soft drop to floor moves"), Shifted.ApplyInput(ETetrisInputCommand::SoftDropToFloor));
+		TestEqual(TEXT("Soft drop to floor Y"), Shifted.GetActiveY(), DropY);
+		TestEqual(TEXT("Soft drop to floor score"), Shifted.GetStats().Score, ScoreBefore + (DropY - TetrisRules::SPAWN_Y) * TetrisRules::SOFT_DROP_SCORE);
+		TestTrue(TEXT("Piece is not locked"), Shifted.HasActivePiece() && Shifted.GetActivePiece() == PieceType);
+
+		// 接地したまま横にずらせる
+		TestTrue(TEXT("Shift after landing"), Shifted.ApplyInput(ETetrisInputCommand::ShiftLeft));
+		TestEqual(TEXT("Landed piece stays on the floor"), Shifted.GetActiveY(), DropY);
+	}
+
+	// 障害物の手前で止まる
+	const FTetrisSimBoard Board = TetrisTestUtils::MakeSimBoard({
+		TEXT("##........"),
+		TEXT("##........"),
+	});
+	int32 MinX = 0;
+	int32 MaxX = 0;
+	TetrisTestUtils::GetShapeColumnRange(TetrisPieceTables::GetShapeMask(EPieceType::O_Piece, 0), MinX, MaxX);
+	const int32 FloorY = Board.GetDropY(EPieceType::O_Piece, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y);
+	TestEqual(TEXT("Stops next to the obstruction"), Board.GetShiftX(EPieceType::O_Piece, 0, TetrisRules::SPAWN_X, FloorY, -1), 2 - MinX);
+	TestEqual(TEXT("Stops at the right wall"), Board.GetShiftX(EPieceType::O_Piece, 0, TetrisRules::SPAWN_X, FloorY, 1), Board.Width - 1 - MaxX);
+	return true;
+}
+
+// 回転：右壁際の縦 I は左にずらして横向きになる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimWallKickTest, "ClaudeTest.Tetris.Simulation.WallKick", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimWallKickTest::RunTest(const FString& Parameters)
+{
+	FTetrisSimGame Game;
+	if (!TestTrue(TEXT("Found seed for I piece"), TetrisTestUtils::ResetWithFirstPiece(Game, EPieceType::I_Piece)))
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Rotate to vertical"), Game.ApplyInput(ETetrisInputCommand::Rotate));
+	while (Game.ApplyInput(ETetrisInputCommand::MoveRight))
+	{
+	}
+	TestEqual(TEXT("Vertical I at right wall"), Game.GetActiveX(), 7);
+
+	TestTrue(TEXT("Rotate with kick"), Game.ApplyInput(ETetrisInputCommand::Rotate));
+	TestEqual(TEXT("Rotation after kick"), Game.GetActiveRotation(), 2);
+	TestEqual(TEXT("X after kick"), Game.GetActiveX(), 6);
+	TestTrue(TEXT("Kicked position is placeable"), Game.GetBoard().CanPlace(EPieceType::I_Piece, 2, Game.GetActiveX(), Game.GetActiveY()));
+
+	// O は回転しても位置が変わらない
+	FTetrisSimGame OGame;
+	if (TetrisTestUtils::ResetWithFirstPiece(OGame, EPieceType::O_Piece))
+	{
+		const int32 X = OGame.GetActiveX();
+		OGame.ApplyInput(ETetrisInputCommand::Rotate);
+		TestEqual(TEXT("O piece X unchanged"), OGame.GetActiveX(), X);
+	}
+	return true;
+}
+
+// ライン消去：離れた2行を同時に消すと、間の行が正しく詰まる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimLineClearTest, "ClaudeTest.Tetris.Simulation.LineClear", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimLineClearTest::RunTest(const FString& Parameters)
+{
+	FTetrisSimBoard Board = TetrisTestUtils::MakeSimBoard({
+		TEXT(".....X...."),
+		TEXT("XXXXXXXXXX"),
+		TEXT("X........."),
+		TEXT("XXXXXXXXXX"),
+	});
+
+	TestEqual(TEXT("Cleared rows"), Board.ClearFullRows(), 2);
+	TestEqual(TEXT("Bottom row keeps the gap row"), Board.Rows[19], uint16(0x001));
+	TestEqual(TEXT("Next row keeps the top partial row"), Board.Rows[18], uint16(0x020));
+	for (int32 Y = 0; Y < 18; Y++)
+	{
+		TestEqual(FString::Printf(TEXT("Row %d empty"), Y), Board.Rows[Y], uint16(0));
+	}
+	TestEqual(TEXT("Packed cells move with rows"), TetrisCellPacking::GetPackedCell(Board.PackedRows[19], 0), TetrisCellPacking::CELL_UNTYPED);
+
+	// 4行同時（テトリス）は得点表どおり
+	FTetrisSimBoard Tetris = TetrisTestUtils::MakeSimBoard({
+		TEXT("XXXXXXXXX."),
+		TEXT("XXXXXXXXX."),
+		TEXT("XXXXXXXXX."),
+		TEXT("XXXXXXXXX."),
+	});
+	Tetris.Place(EPieceType::I_Piece, 1, 7, 16);
+	TestEqual(TEXT("Tetris rows"), Tetris.ClearFullRows(), 4);
+	TestEqual(TEXT("Tetris score"), TetrisRules::GetLineClearScore(4, 1), TetrisConstants::SCORE_TETRIS);
+	return true;
+}
+
+// ゲームオーバー：中央に落とし続けると出現位置が塞がって終わる
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimGameOverTest, "ClaudeTest.Tetris.Simulation.GameOver", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimGameOverTest::RunTest(const FString& Parameters)
+{
+	FTetrisSimGame Game;
+	Game.Reset(FTetrisSimConfig());
+
+	int32 Drops = 0;
+	while (!Game.IsGameOver() && Drops < 100)
+	{
+		Game.ApplyInput(ETetrisInputCommand::HardDrop);
+		Drops++;
+	}
+
+	TestTrue(TEXT("Game over reached"), Game.IsGameOver());
+	TestTrue(TEXT("Stack fills before the board could be cleared"), Drops <= Game.GetBoard().Height);
+	TestFalse(TEXT("No active piece after game over"), Game.HasActivePiece());
+	TestFalse(TEXT("Input ignored after game over"), Game.ApplyInput(ETetrisInputCommand::MoveLeft));
+	TestEqual(TEXT("No lines cleared"), Game.GetStats().LinesCleared, 0);
+	return true;
+}
+
+// ランダマイザー：バッグは区切りごとに全種類が同数出る
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisRandomizerFairnessTest, "ClaudeTest.Tetris.Simulation.BagFairness", TETRIS_TEST_FLAGS)
+
+bool FTetrisRandomizerFairnessTest::RunTest(const FString& Parameters)
+{
+	struct FBagCase
+	{
+		ETetrisRandomizerType Type;
+		int32 BagSize;
+	};
+
+	for (const FBagCase& BagCase : { FBagCase{ ETetrisRandomizerType::SevenBag, 7 }, FBagCase{ ETetrisRandomizerType::FourteenBag, 14 } })
+	{
+		for (int32 Seed = 1; Seed <= 50; Seed++)
+		{
+			FTetrisPieceQueue Queue;
+			Queue.Initialize(BagCase.Type, Seed, 6);
+
+			for (int32 Bag = 0; Bag < 20; Bag++)
+			{
+				int32 Counts[8] = {};
+				for (int32 i = 0; i < BagCase.BagSize; i++)
+				{
+					Counts[static_cast<int32>(Queue.Pop())]++;
+				}
+
+				for (int32 Type = 1; Type < 8; Type++)
+				{
+					if (Counts[Type] != BagCase.BagSize / 7)
+					{
+						AddError(FString::Printf(TEXT("Randomizer %d seed %d bag %d: piece %d appeared %d times"),
+							static_cast<int32>(BagCase.Type), Seed, Bag, Type, Counts[Type]));
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	// TGM 履歴式：最初は S/Z/O 以外、長期的には全種類がほぼ均等
+	int32 Counts[8] = {};
+	for (int32 Seed = 1; Seed <= 100; Seed++)
+	{
+		FTetrisPieceQueue Queue;
+		Queue.Initialize(ETetrisRandomizerType::TGMHistory, Seed, 1);
+
+		const EPieceType First = Queue.Pop();
+		TestTrue(TEXT("TGM first piece is not S/Z/O"), First != EPieceType::S_Piece && First != EPieceType::Z_Piece && First != EPieceType::O_Piece);
+
+		for (int32 i = 0; i < 700; i++)
+		{
+			Counts[static_cast<int32>(Queue.Pop())]++;
+		}
+	}
+	for (int32 Type = 1; Type < 8; Type++)
+	{
+		TestTrue(FString::Printf(TEXT("TGM piece %d frequency"), Type), Counts[Type] > 70000 / 10 && Counts[Type] < 70000 / 5);
+	}
+	return true;
+}
+
+// 決定性：同じシード・同じ入力なら同じ結果。先読みは後で取り出す順序と一致する
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetrisSimDeterminismTest, "ClaudeTest.Tetris.Simulation.Determinism", TETRIS_TEST_FLAGS)
+
+bool FTetrisSimDeterminismTest::RunTest(const FString& Parameters)
+{
+	FTetrisPieceQueue Queue;
+	Queue.Initialize(ETetrisRandomizerType::SevenBag, 1234, 6);
+	EPieceType Preview[6];
+	for (int32 i = 0; i < 6; i++)
+	{
+		Preview[i] = Queue.Peek(i);
+	}
+	for (int32 i = 0; i < 6; i++)
+	{
+		TestEqual(TEXT("Preview matches pop order"), Queue.Pop(), Preview[i]);
+	}
+
+	static const ETetrisInputCommand Pattern[] =
+	{
+		ETetrisInputCommand::MoveLeft, ETetrisInputCommand::Rotate, ETetrisInputCommand::MoveLeft, ETetrisInputCommand::HardDrop,
+		ETetrisInputCommand::MoveRight, ETetrisInputCommand::MoveRight, ETetrisInputCommand::MoveRight, ETetrisInputCommand::HardDrop,
+		ETetrisInputCommand::Rotate, ETetrisInputCommand::MoveDown, ETetrisInputCommand::HardDrop
+	};
+
+	FTetrisSimConfig Config;
+	Config.Seed = 42;
+	Config.LineClearDelayMicroseconds = 300000;
+
+	FTetrisSimGame GameA;
+	FTetrisSimGame GameB;
+	GameA.Reset(Config);
+	GameB.Reset(Config);
+	for (int32 Step = 0; Step < 2000 && !GameA.IsGameOver(); Step++)
+	{
+		const ETetrisInputCommand Command = Pattern[Step % UE_ARRAY_COUNT(Pattern)];
+		GameA.ApplyInput(Command);
+		GameB.ApplyInput(Command);
+		GameA.Advance(16667);
+		GameB.Advance(16667);
+	}
+
+	TestEqual(TEXT("Same score"), GameA.GetStats().Score, GameB.GetStats().Score);
+	TestEqual(TEXT("Same pieces"), GameA.GetStats().PiecesPlaced, GameB.GetStats().PiecesPlaced);
+	TestEqual(TEXT("Same elapsed time"), GameA.GetElapsedMicroseconds(), GameB.GetElapsedMicroseconds());
+	TestTrue(TEXT("Same board"), FMemory::Memcmp(GameA.GetBoard().PackedRows, GameB.GetBoard().PackedRows, sizeof(GameA.GetBoard().PackedRows)) == 0);
+	return true;
+}
+
+#endif
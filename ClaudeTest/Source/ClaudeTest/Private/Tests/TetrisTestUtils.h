@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "TetrisSimulation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// テスト共通のフラグ（ゲームプロジェクトのテストとしてどのコンテキストでも走らせる）
+#define TETRIS_TEST_FLAGS (EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// アクターのテスト用に一時ワールドを作る（スコープを抜けると破棄）
+// ゲームモードは使わず、WorldSettings から BeginPlay を開始するので以後のスポーンも BeginPlay される
+class FTetrisTestWorld
+{
+public:
+	FTetrisTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TetrisTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+
+	~FTetrisTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	UWorld* Get() const { return World; }
+
+	template<typename ActorType>
+	ActorType* Spawn()
+	{
+		return World->SpawnActor<ActorType>(ActorType::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator);
+	}
+
+private:
+	UWorld* World = nullptr;
+};
+
+namespace TetrisTestUtils
+{
+	// 下詰めの ASCII 盤面（'.' = 空、それ以外 = 占有）から盤面を作る
+	inline FTetrisSimBoard MakeSimBoard(std::initializer_list<const TCHAR*> BottomRows, int32 Width = TetrisConstants::BOARD_WIDTH, int32 Height = TetrisConstants::BOARD_HEIGHT)
+	{
+		FTetrisSimBoard Board;
+		Board.Reset(Width, Height);
+
+		int32 Y = Height - static_cast<int32>(BottomRows.size());
+		for (const TCHAR* Row : BottomRows)
+		{
+			uint64 PackedCells = 0;
+			for (int32 X = 0; X < Width && Row[X] != TEXT('\0'); X++)
+			{
+				if (Row[X] != TEXT('.'))
+				{
+					PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::PackCell(true, EPieceType::None));
+				}
+			}
+			Board.SetPackedRow(Y++, PackedCells);
+		}
+		return Board;
+	}
+
+	// 形状の占有列の範囲（壁際までの移動回数の期待値用）
+	inline void GetShapeColumnRange(uint16 ShapeMask, int32& OutMinX, int32& OutMaxX)
+	{
+		OutMinX = TetrisConstants::PIECE_SIZE;
+		OutMaxX = -1;
+		for (int32 Index = 0; Index < TetrisConstants::PIECE_SIZE * TetrisConstants::PIECE_SIZE; Index++)
+		{
+			if ((ShapeMask >> Index) & 1)
+			{
+				OutMinX = FMath::Min(OutMinX, Index % TetrisConstants::PIECE_SIZE);
+				OutMaxX = FMath::Max(OutMaxX, Index % TetrisConstants::PIECE_SIZE);
+			}
+		}
+	}
+
+	// 最初のピースが指定の種類になるシードでゲームを始める
+	inline bool ResetWithFirstPiece(FTetrisSimGame& Game, EPieceType PieceType)
+	{
+		FTetrisSimConfig Config;
+		for (Config.Seed = 1; Config.Seed < 1000; Config.Seed++)
+		{
+			Game.Reset(Config);
+			if (Game.GetActivePiece() == PieceType)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+// 性能テストの時間予算（秒）。Debug ビルドは最適化なしなので緩める
+namespace TetrisTestBudgets
+{
+#if UE_BUILD_DEBUG
+	constexpr double SCALE = 4.0;
+#else
+	constexpr double SCALE = 1.0;
+#endif
+
+	constexpr double COLLISION_SECONDS = 0.1;
+	constexpr double SIM_CLEAR_SECONDS = 0.1;
+	constexpr double BOARD_CLEAR_SECONDS = 0.5;
+	constexpr double PERFT_SECONDS = 1.0;
+	constexpr double BOARD_EVAL_SECONDS = 0.1;
+	constexpr double BEAM_MOVE_SECONDS = 0.02;
+	constexpr double DATASET_ADD_SECONDS = 0.25;
+	constexpr double REPLAY_SEEK_SECONDS = 0.01;
+	constexpr double ARENA_STEP_1000_SECONDS = 0.005;
+	constexpr double PERFECT_CLEAR_HINT_SECONDS = 0.008;
+	constexpr double FINESSE_100K_SECONDS = 0.01;
+	constexpr double ROLLBACK_SNAPSHOT_100K_SECONDS = 0.05;
+	constexpr double FUMEN_10K_SECONDS = 0.1;
+
+	// 経過時間を記録し、予算を超えたら失敗にする
+	inline bool CheckBudget(FAutomationTestBase& Test, const TCHAR* What, double ElapsedSeconds, double BudgetSeconds)
+	{
+		const double ScaledBudget = BudgetSeconds * SCALE;
+		Test.AddInfo(FString::Printf(TEXT("%s: %.2f ms (budget %.2f ms)"), What, ElapsedSeconds * 1000.0, ScaledBudget * 1000.0));
+		return Test.TestTrue(FString::Printf(TEXT("%s within time budget"), What), ElapsedSeconds <= ScaledBudget);
+	}
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "TetrisArena.h"
+#include "TetrisGameStep.h"
+#include "TetrisRuleset.h"
+#include "TetrisStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	// 列の先頭はキャッシュラインに揃える
+	const int64 COLUMN_ALIGNMENT = 64;
+
+	// 列のレイアウトを決める（Base = nullptr ならサイズの計算だけ）
+	struct FColumnLayout
+	{
+		uint8* Base = nullptr;
+		int64 Size = 0;
+
+		template<typename ElementType>
+		ElementType* Add(int64 NumElements)
+		{
+			Size = Align(Size, COLUMN_ALIGNMENT);
+			ElementType* Column = Base ? reinterpret_cast<ElementType*>(Base + Size) : nullptr;
+			Size += NumElements * sizeof(ElementType);
+			return Column;
+		}
+	};
+}
+
+FTetrisArena::~FTetrisArena()
+{
+	Release();
+}
+
+void FTetrisArena::Release()
+{
+	FMemory::Free(Arena);
+	DEC_MEMORY_STAT_BY(STAT_TetrisArenaMemory, AllocatedBytes);
+	Arena = nullptr;
+	NumGames = 0;
+	AllocatedBytes = 0;
+}
+
+void FTetrisArena::Initialize(const FTetrisSimConfig& InConfig, int32 InNumGames)
+{
+	Release();
+
+	Config = InConfig;
+	Config.BoardWidth = FMath::Clamp(Config.BoardWidth, 4, FTetrisSimBoard::MAX_WIDTH);
+	Config.BoardHeight = FMath::Clamp(Config.BoardHeight, 4, FTetrisSimBoard::MAX_HEIGHT);
+	FullRowMask = static_cast<uint16>((1u << Config.BoardWidth) - 1);
+	NumGames = FMath::Max(InNumGames, 0);
+
+	// 1回目でサイズを数え、確保してから2回目で列を割り当てる
+	FColumnLayout Layout;
+	for (int32 Pass = 0; Pass < 2; Pass++)
+	{
+		if (Pass == 1)
+		{
+			AllocatedBytes = Layout.Size;
+			Arena = static_cast<uint8*>(FMemory::Malloc(FMath::Max<int64>(AllocatedBytes, 1), COLUMN_ALIGNMENT));
+			INC_MEMORY_STAT_BY(STAT_TetrisArenaMemory, AllocatedBytes);
+			Layout = FColumnLayout();
+			Layout.Base = Arena;
+		}
+
+		Rows = Layout.Add<uint16>(int64(NumGames) * Config.BoardHeight);
+		PackedRows = Layout.Add<uint64>(int64(NumGames) * Config.BoardHeight);
+		Queues = Layout.Add<FTetrisPieceQueue>(NumGames);
+		ActivePieces = Layout.Add<EPieceType>(NumGames);
+		ActiveRotations = Layout.Add<uint8>(NumGames);
+		ActiveXs = Layout.Add<int8>(NumGames);
+		ActiveYs = Layout.Add<int8>(NumGames);
+		ElapsedTimes = Layout.Add<int64>(NumGames);
+		FallTimers = Layout.Add<int32>(NumGames);
+		LineClearTimers = Layout.Add<int32>(NumGames);
+		Scores = Layout.Add<int32>(NumGames);
+		Levels = Layout.Add<int32>(NumGames);
+		LinesCleared = Layout.Add<int32>(NumGames);
+		PiecesPlaced = Layout.Add<int32>(NumGames);
+		Flags = Layout.Add<uint8>(NumGames);
+		PendingInputs = Layout.Add<uint8>(int64(NumGames) * MAX_PENDING_INPUTS);
+		NumPendingInputs = Layout.Add<uint8>(NumGames);
+	}
+
+	BytesPerGame = Config.BoardHeight * (sizeof(uint16) + sizeof(uint64))
+		+ sizeof(FTetrisPieceQueue)
+		+ sizeof(EPieceType) + sizeof(uint8) + sizeof(int8) + sizeof(int8)
+		+ sizeof(int64) + sizeof(int32) * 2
+		+ sizeof(int32) * 4
+		+ sizeof(uint8)
+		+ MAX_PENDING_INPUTS + sizeof(uint8);
+
+	for (int32 GameIndex = 0; GameIndex < NumGames; GameIndex++)
+	{
+		new (&Queues[GameIndex]) FTetrisPieceQueue();
+		ResetGame(GameIndex, Config.Seed + GameIndex);
+	}
+}
+
+void FTetrisArena::ResetGame(int32 GameIndex, int32 Seed)
+{
+	check(GameIndex >= 0 && GameIndex < NumGames);
+
+	FMemory::Memzero(&Rows[GameIndex * Config.BoardHeight], Config.BoardHeight * sizeof(uint16));
+	FMemory::Memzero(&PackedRows[GameIndex * Config.BoardHeight], Config.BoardHeight * sizeof(uint64));
+	Queues[GameIndex].Initialize(Config.RandomizerType, Seed, Config.PreviewCount);
+
+	NumPendingInputs[GameIndex] = 0;
+
+	FTetrisGameState State;
+	TetrisGameStep::SpawnPiece(MakeStepContext(GameIndex), State);
+	StoreState(GameIndex, State);
+}
+
+bool FTetrisArena::QueueInput(int32 GameIndex, ETetrisInputCommand Command)
+{
+	if (Command == ETetrisInputCommand::Pause || Command == ETetrisInputCommand::Restart)
+	{
+		return false;
+	}
+
+	uint8& NumPending = NumPendingInputs[GameIndex];
+	if (NumPending >= MAX_PENDING_INPUTS)
+	{
+		return false;
+	}
+	PendingInputs[GameIndex * MAX_PENDING_INPUTS + NumPending++] = static_cast<uint8>(Command);
+	return true;
+}
+
+void FTetrisArena::Step(int64 DeltaMicroseconds, int32 MaxThreads)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TetrisArenaStep);
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumGames, CHUNK_GAMES);
+	TetrisRuleset::Visit(Config.Ruleset, [&](auto Rules)
+	{
+		using RulesType = decltype(Rules);
+		ParallelFor(TEXT("TetrisArenaStep"), NumChunks, 1, [&](int32 ChunkIndex)
+		{
+			const int32 FirstGame = ChunkIndex * CHUNK_GAMES;
+			StepChunk<RulesType>(FirstGame, FMath::Min(FirstGame + CHUNK_GAMES, NumGames), DeltaMicroseconds);
+		}, MaxThreads == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	});
+
+	LastStepSeconds = FPlatformTime::Seconds() - StartTime;
+
+	SET_DWORD_STAT(STAT_TetrisArenaBytesPerGame, BytesPerGame);
+	SET_FLOAT_STAT(STAT_TetrisArenaStepPer1000, NumGames > 0 ? LastStepSeconds * 1000.0 * 1000.0 / NumGames : 0.0);
+}
+
+FTetrisGameStats FTetrisArena::GetStats(int32 GameIndex) const
+{
+	FTetrisGameStats Stats;
+	Stats.Score = Scores[GameIndex];
+	Stats.Level = Levels[GameIndex];
+	Stats.LinesCleared = LinesCleared[GameIndex];
+	Stats.PiecesPlaced = PiecesPlaced[GameIndex];
+	return Stats;
+}
+
+FTetrisArenaStats FTetrisArena::GetArenaStats() const
+{
+	FTetrisArenaStats Stats;
+	Stats.NumGames = NumGames;
+	Stats.BytesPerGame = BytesPerGame;
+	Stats.AllocatedBytes = AllocatedBytes;
+	Stats.LastStepSeconds = LastStepSeconds;
+	Stats.StepSecondsPer1000Games = NumGames > 0 ? LastStepSeconds * 1000.0 / NumGames : 0.0;
+	for (int32 GameIndex = 0; GameIndex < NumGames; GameIndex++)
+	{
+		Stats.NumAlive += IsGameOver(GameIndex) ? 0 : 1;
+	}
+	return Stats;
+}
+
+// 各ゲームを列から FTetrisGameState に読み出し、FTetrisSimGame と同じ TetrisGameStep で進めて書き戻す
+
+FTetrisGameStepContext FTetrisArena::MakeStepContext(int32 GameIndex)
+{
+	return FTetrisGameStepContext{ Config, &Rows[GameIndex * Config.BoardHeight], &PackedRows[GameIndex * Config.BoardHeight],
+		Config.BoardWidth, Config.BoardHeight, FullRowMask, Queues[GameIndex], nullptr };
+}
+
+FTetrisGameState FTetrisArena::LoadState(int32 GameIndex) const
+{
+	FTetrisGameState State;
+	State.ActivePiece = ActivePieces[GameIndex];
+	State.ActiveRotation = ActiveRotations[GameIndex];
+	State.ActiveX = ActiveXs[GameIndex];
+	State.ActiveY = ActiveYs[GameIndex];
+	State.ElapsedMicroseconds = ElapsedTimes[GameIndex];
+	State.FallTimerMicroseconds = FallTimers[GameIndex];
+	State.LineClearTimerMicroseconds = LineClearTimers[GameIndex];
+	State.bLineClearPending = (Flags[GameIndex] & FLAG_LINE_CLEAR_PENDING) != 0;
+	State.bGameOver = (Flags[GameIndex] & FLAG_GAME_OVER) != 0;
+	State.Stats = GetStats(GameIndex);
+	return State;
+}
+
+void FTetrisArena::StoreState(int32 GameIndex, const FTetrisGameState& State)
+{
+	ActivePieces[GameIndex] = State.ActivePiece;
+	ActiveRotations[GameIndex] = static_cast<uint8>(State.ActiveRotation);
+	ActiveXs[GameIndex] = static_cast<int8>(State.ActiveX);
+	ActiveYs[GameIndex] = static_cast<int8>(State.ActiveY);
+	ElapsedTimes[GameIndex] = State.ElapsedMicroseconds;
+	FallTimers[GameIndex] = static_cast<int32>(State.FallTimerMicroseconds);
+	LineClearTimers[GameIndex] = static_cast<int32>(State.LineClearTimerMicroseconds);
+	Flags[GameIndex] = static_cast<uint8>((State.bLineClearPending ? FLAG_LINE_CLEAR_PENDING : 0) | (State.bGameOver ? FLAG_GAME_OVER : 0));
+	Scores[GameIndex] = State.Stats.Score;
+	Levels[GameIndex] = State.Stats.Level;
+	LinesCleared[GameIndex] = State.Stats.LinesCleared;
+	PiecesPlaced[GameIndex] = State.Stats.PiecesPlaced;
+}
+
+template<typename RulesType>
+void FTetrisArena::StepChunk(int32 FirstGame, int32 LastGame, int64 DeltaMicroseconds)
+{
+	for (int32 GameIndex = FirstGame; GameIndex < LastGame; GameIndex++)
+	{
+		const FTetrisGameStepContext Context = MakeStepContext(GameIndex);
+		FTetrisGameState State = LoadState(GameIndex);
+
+		const uint8* Inputs = &PendingInputs[GameIndex * MAX_PENDING_INPUTS];
+		for (int32 InputIndex = 0; InputIndex < NumPendingInputs[GameIndex]; InputIndex++)
+		{
+			TetrisGameStep::ApplyInput<RulesType>(Context, State, static_cast<ETetrisInputCommand>(Inputs[InputIndex]));
+		}
+		NumPendingInputs[GameIndex] = 0;
+
+		TetrisGameStep::Advance<RulesType>(Context, State, DeltaMicroseconds);
+		StoreState(GameIndex, State);
+	}
+}
@@ -0,0 +1,198 @@
+#include "TetrisBeamSearch.h"
+#include "TetrisBoardEval.h"
+#include "TetrisRules.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+FTetrisBeamSearch::FTetrisBeamSearch(const FTetrisBeamSearchSettings& InSettings)
+	: Settings(InSettings)
+{
+}
+
+bool FTetrisBeamSearch::FindBestMove(const FTetrisSimGame& Game, FTetrisBeamSearchResult& OutResult)
+{
+	OutResult = FTetrisBeamSearchResult();
+	if (!Game.HasActivePiece())
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = Settings.TimeBudgetSeconds > 0.0 ? StartTime + Settings.TimeBudgetSeconds : MAX_dbl;
+	const int32 MaxDepth = FMath::Clamp(Settings.MaxDepth, 1, 1 + Game.GetQueue().GetPreviewCount());
+
+	// 深さ1：操作中のピースを今の位置から（時間予算に関係なく読み切る）
+	FNode Root;
+	Root.Board = Game.GetBoard();
+
+	ChildrenPerParent.SetNum(1);
+	ExpandNode(Root, Game.GetActivePiece(), Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(), ChildrenPerParent[0], &RootPlacements);
+	OutResult.NodesExpanded = ChildrenPerParent[0].Num();
+
+	SelectBeam();
+	if (NextBeam.Num() == 0)
+	{
+		// どこに置いてもゲームオーバーなら、最初に見つけた位置に置く
+		if (RootPlacements.Num() == 0)
+		{
+			return false;
+		}
+		OutResult.Placement = RootPlacements[0];
+		OutResult.DepthCompleted = 1;
+		return TetrisMoveGen::FindInputPath(Game.GetBoard(), Game.GetActivePiece(), Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(),
+			OutResult.Placement, OutResult.Inputs);
+	}
+	Swap(Beam, NextBeam);
+	OutResult.DepthCompleted = 1;
+
+	// 深さ2以降：ネクストを出現位置から
+	for (int32 Depth = 1; Depth < MaxDepth; Depth++)
+	{
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			OutResult.bTimedOut = true;
+			break;
+		}
+
+		const EPieceType PieceType = Game.GetQueue().Peek(Depth - 1);
+		const int32 NumParents = Beam.Num();
+		ChildrenPerParent.SetNum(NumParents);
+
+		// ビームを MaxThreads 個以下のまとまりに分けて展開する。各親の子は別々の配列に書くのでロックは要らない
+		const int32 MinBatchSize = Settings.MaxThreads > 0 ? FMath::DivideAndRoundUp(NumParents, Settings.MaxThreads) : 1;
+		std::atomic<bool> bDeadlineReached { false };
+
+		ParallelFor(TEXT("TetrisBeamSearch"), NumParents, MinBatchSize, [&](int32 ParentIndex)
+		{
+			TArray<FNode>& Children = ChildrenPerParent[ParentIndex];
+			Children.Reset();
+			if (bDeadlineReached.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+			if (FPlatformTime::Seconds() >= Deadline)
+			{
+				bDeadlineReached.store(true, std::memory_order_relaxed);
+				return;
+			}
+			ExpandNode(Beam[ParentIndex], PieceType, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, Children, nullptr);
+		}, Settings.MaxThreads == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+		// 途中で打ち切った段は偏るので使わない
+		if (bDeadlineReached.load(std::memory_order_relaxed))
+		{
+			OutResult.bTimedOut = true;
+			break;
+		}
+
+		for (const TArray<FNode>& Children : ChildrenPerParent)
+		{
+			OutResult.NodesExpanded += Children.Num();
+		}
+
+		SelectBeam();
+		if (NextBeam.Num() == 0)
+		{
+			// この先は全てゲームオーバー
+			break;
+		}
+		Swap(Beam, NextBeam);
+		OutResult.DepthCompleted = Depth + 1;
+	}
+
+	// Beam は評価順に並んでいる
+	const FNode& Best = Beam[0];
+	OutResult.Placement = RootPlacements[Best.RootIndex];
+	OutResult.Score = Best.Score;
+	return TetrisMoveGen::FindInputPath(Game.GetBoard(), Game.GetActivePiece(), Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(),
+		OutResult.Placement, OutResult.Inputs);
+}
+
+void FTetrisBeamSearch::ExpandNode(const FNode& Parent, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY,
+	TArray<FNode>& OutChildren, TArray<FTetrisSimPlacement>* OutPlacements) const
+{
+	OutChildren.Reset();
+
+	TArray<FTetrisSimPlacement> Placements;
+	TetrisMoveGen::GenerateLockPlacements(Parent.Board, PieceType, StartRotation, StartX, StartY, Placements);
+	if (OutPlacements)
+	{
+		*OutPlacements = Placements;
+	}
+
+	FTetrisBoardBatch Batch;
+	Batch.Reset(Parent.Board.Width, Parent.Board.Height, Placements.Num());
+
+	for (int32 PlacementIndex = 0; PlacementIndex < Placements.Num(); PlacementIndex++)
+	{
+		const FTetrisSimPlacement& Placement = Placements[PlacementIndex];
+
+		FNode& Child = OutChildren.AddDefaulted_GetRef();
+		Child.Board = Parent.Board;
+		Child.Board.Place(PieceType, Placement.Rotation, Placement.X, Placement.Y);
+		const int32 Lines = Child.Board.ClearFullRows();
+
+		// 最上段に残ったら次のピースが出せない
+		if (Child.Board.IsTopRowOccupied())
+		{
+			OutChildren.Pop(EAllowShrinking::No);
+			continue;
+		}
+
+		Child.Hash = CityHash64(reinterpret_cast<const char*>(Child.Board.Rows), Child.Board.Height * sizeof(uint16));
+		Child.LineReward = Parent.LineReward + Settings.Weights.CompleteLines * Lines;
+		Child.RootIndex = Parent.RootIndex != INDEX_NONE ? Parent.RootIndex : PlacementIndex;
+
+		Batch.Add(Child.Board);
+	}
+
+	TArray<FTetrisBoardFeatures> Features;
+	TetrisBoardEval::ComputeFeaturesBatch(Batch, Features);
+	for (int32 Index = 0; Index < OutChildren.Num(); Index++)
+	{
+		FNode& Child = OutChildren[Index];
+		Child.Score = Child.LineReward + TetrisBot::ScoreFeatures(Features[Index], 0, Settings.Weights);
+	}
+}
+
+void FTetrisBeamSearch::SelectBeam()
+{
+	Candidates.Reset();
+	Transpositions.Reset();
+
+	// 盤面は大きいので、並べ替えは (評価値, 位置) だけで行い、残す分だけコピーする
+	// 親の順・子の順に見るので、スレッド数によらず結果は同じ。64bit ハッシュの衝突は無視する
+	for (int32 ParentIndex = 0; ParentIndex < ChildrenPerParent.Num(); ParentIndex++)
+	{
+		const TArray<FNode>& Children = ChildrenPerParent[ParentIndex];
+		for (int32 ChildIndex = 0; ChildIndex < Children.Num(); ChildIndex++)
+		{
+			const FNode& Child = Children[ChildIndex];
+			if (const int32* ExistingIndex = Transpositions.Find(Child.Hash))
+			{
+				FCandidate& Existing = Candidates[*ExistingIndex];
+				if (Child.Score > Existing.Score)
+				{
+					Existing = { Child.Score, ParentIndex, ChildIndex };
+				}
+				continue;
+			}
+
+			Transpositions.Add(Child.Hash, Candidates.Num());
+			Candidates.Add({ Child.Score, ParentIndex, ChildIndex });
+		}
+	}
+
+	// 同点は先に見つけた方を残す
+	Algo::StableSort(Candidates, [](const FCandidate& A, const FCandidate& B) { return A.Score > B.Score; });
+
+	const int32 NumKept = FMath::Min(Candidates.Num(), FMath::Max(Settings.BeamWidth, 1));
+	NextBeam.Reset(NumKept);
+	for (int32 Index = 0; Index < NumKept; Index++)
+	{
+		NextBeam.Add(ChildrenPerParent[Candidates[Index].ParentIndex][Candidates[Index].ChildIndex]);
+	}
+}
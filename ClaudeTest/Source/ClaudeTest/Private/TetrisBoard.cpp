@@ -5,15 +5,35 @@
 #include "UObject/ConstructorHelpers.h"
 #include "Materials/MaterialInterface.h"
 #include "Engine/Engine.h"
+#include "Net/UnrealNetwork.h"
+#include "TetrisZobrist.h"
+#include "TetrisFumen.h"
+#include "TetrisPieceTables.h"
+#include "TetrisWorldSubsystem.h"
+#include "TetrisLatency.h"
+#include "TetrisStats.h"
 
 ATetrisBoard::ATetrisBoard()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// 更新は UTetrisWorldSubsystem が行うので Tick しない
+	PrimaryActorTick.bCanEverTick = false;
+
+	// サーバー権威でボードをレプリケート
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SetReplicateMovement(false);
+	ReplicatedRows.OwnerBoard = this;
 
 	// デフォルトの寸法を設定
 	BoardWidth = TetrisConstants::BOARD_WIDTH;
 	BoardHeight = TetrisConstants::BOARD_HEIGHT;
 	BlockSize = 100.0f; // 100 Unreal units per block
+	BoardHash = 0;
+	CellRevision = 0;
+	ActivePieceType = EPieceType::None;
+	ActivePieceRevision = 0;
+	bDisplayDirty = false;
+	bShowGhost = true;
 
 	// ルートコンポーネントの設定
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
@@ -25,6 +45,7 @@ ATetrisBoard::ATetrisBoard()
 	// ブロック表示用のInstanced Static Mesh Component
 	BlockMeshComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BlockMeshComponent"));
 	BlockMeshComponent->SetupAttachment(RootComponent);
+	BlockMeshComponent->NumCustomDataFloats = 3; // [0][1] = ライン消去アニメーション、[2] = 種別（0 固定 / 1 操作中 / 2 ゴースト）
 
 	// デフォルトメッシュとマテリアルの設定（エディタで設定可能）
 	static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMeshAsset(TEXT("/Engine/BasicShapes/Cube"));
@@ -38,17 +59,53 @@ void ATetrisBoard::BeginPlay()
 {
 	Super::BeginPlay();
 	InitializeBoard();
+
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->RegisterBoard(this);
+	}
 }
 
-void ATetrisBoard::Tick(float DeltaTime)
+void ATetrisBoard::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->UnregisterBoard(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATetrisBoard::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ATetrisBoard, BoardWidth, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ATetrisBoard, BoardHeight, COND_InitialOnly);
+	DOREPLIFETIME(ATetrisBoard, ReplicatedRows);
 }
 
 void ATetrisBoard::InitializeBoard()
 {
+	// 行は uint64 にパックしてレプリケートするため幅に上限がある
+	if (BoardWidth > TetrisConstants::MAX_PACKED_BOARD_WIDTH)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BoardWidth %d exceeds max %d, clamping"), BoardWidth, TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+		BoardWidth = TetrisConstants::MAX_PACKED_BOARD_WIDTH;
+	}
+
 	// グリッド配列の初期化
 	InitializeGridArrays();
+
+	// クライアントは受信済みの行を反映、サーバーはレプリケーション用の行を構築
+	if (HasAuthority())
+	{
+		SyncAllReplicatedRows();
+	}
+	else
+	{
+		ApplyReplicatedRows(false);
+	}
 	
 	// ボードメッシュの作成
 	CreateBoardMesh();
@@ -67,6 +124,8 @@ void ATetrisBoard::InitializeGridArrays()
 
 	BoardGrid.SetNum(BoardHeight);
 	BoardPieceTypes.SetNum(BoardHeight);
+	BoardHash = 0; // 空ボード
+	CellRevision++;
 
 	for (int32 Y = 0; Y < BoardHeight; Y++)
 	{
@@ -117,6 +176,30 @@ bool ATetrisBoard::IsPositionValid(int32 X, int32 Y) const
 	return !BoardGrid[Y][X];
 }
 
+int32 ATetrisBoard::GetFreeDistance(TArrayView<const FTetrisCoordinate> Cells, int32 StepX, int32 StepY) const
+{
+	if (Cells.Num() == 0 || (StepX == 0 && StepY == 0))
+	{
+		return 0;
+	}
+
+	INC_DWORD_STAT(STAT_TetrisCollisionQueries);
+	int32 Distance = 0;
+	for (;;)
+	{
+		const int32 OffsetX = StepX * (Distance + 1);
+		const int32 OffsetY = StepY * (Distance + 1);
+		for (const FTetrisCoordinate& Cell : Cells)
+		{
+			if (!IsPositionValid(Cell.X + OffsetX, Cell.Y + OffsetY))
+			{
+				return Distance;
+			}
+		}
+		Distance++;
+	}
+}
+
 void ATetrisBoard::SetBlock(int32 X, int32 Y, bool bOccupied, EPieceType PieceType)
 {
 	if (X < 0 || X >= BoardWidth || Y < 0 || Y >= BoardHeight)
@@ -124,8 +207,14 @@ void ATetrisBoard::SetBlock(int32 X, int32 Y, bool bOccupied, EPieceType PieceTy
 		return;
 	}
 
+	const uint8 OldCellValue = TetrisCellPacking::PackCell(BoardGrid[Y][X], BoardPieceTypes[Y][X]);
+
 	BoardGrid[Y][X] = bOccupied;
 	BoardPieceTypes[Y][X] = bOccupied ? PieceType : EPieceType::None;
+	BoardHash ^= TetrisZobrist::GetCellKey(X, Y, OldCellValue)
+		^ TetrisZobrist::GetCellKey(X, Y, TetrisCellPacking::PackCell(bOccupied, BoardPieceTypes[Y][X]));
+	CellRevision++;
+	SyncReplicatedRow(Y);
 
 	// 表示を更新
 	UpdateBlockDisplay(X, Y);
@@ -163,38 +252,54 @@ void ATetrisBoard::ClearLine(int32 LineY)
 		return;
 	}
 
-	// 指定された行より上のすべての行を1つ下に移動
-	for (int32 Y = LineY; Y > 0; Y--)
+	ClearLines(TArray<int32>{ LineY });
+}
+
+void ATetrisBoard::ClearLines(const TArray<int32>& LinesToClear)
+{
+	TArray<bool> RowsToClear;
+	RowsToClear.Init(false, BoardHeight);
+	for (int32 LineY : LinesToClear)
 	{
-		for (int32 X = 0; X < BoardWidth; X++)
+		if (RowsToClear.IsValidIndex(LineY))
 		{
-			BoardGrid[Y][X] = BoardGrid[Y - 1][X];
-			BoardPieceTypes[Y][X] = BoardPieceTypes[Y - 1][X];
+			RowsToClear[LineY] = true;
 		}
 	}
 
-	// 最上行をクリア
-	for (int32 X = 0; X < BoardWidth; X++)
+	// 下から上へ1パスで詰める（複数行でも各行の移動は1回、表示更新も1回）
+	int32 WriteY = BoardHeight - 1;
+	for (int32 ReadY = BoardHeight - 1; ReadY >= 0; ReadY--)
 	{
-		BoardGrid[0][X] = false;
-		BoardPieceTypes[0][X] = EPieceType::None;
-	}
-
-	// 表示を更新
-	UpdateBoardDisplay();
-}
+		if (RowsToClear[ReadY])
+		{
+			continue;
+		}
 
-void ATetrisBoard::ClearLines(const TArray<int32>& LinesToClear)
-{
-	// 行を下から上の順序でソート
-	TArray<int32> SortedLines = LinesToClear;
-	SortedLines.Sort([](const int32& A, const int32& B) { return A > B; });
+		if (WriteY != ReadY)
+		{
+			BoardHash ^= TetrisZobrist::GetRowTransitionKey(WriteY, GetPackedRow(WriteY), GetPackedRow(ReadY));
+			BoardGrid[WriteY] = BoardGrid[ReadY];
+			BoardPieceTypes[WriteY] = BoardPieceTypes[ReadY];
+		}
+		WriteY--;
+	}
 
-	// 各行を削除
-	for (int32 LineY : SortedLines)
+	// 残った上部の行を空にする
+	for (; WriteY >= 0; WriteY--)
 	{
-		ClearLine(LineY);
+		BoardHash ^= TetrisZobrist::GetRowTransitionKey(WriteY, GetPackedRow(WriteY), 0);
+		for (int32 X = 0; X < BoardWidth; X++)
+		{
+			BoardGrid[WriteY][X] = false;
+			BoardPieceTypes[WriteY][X] = EPieceType::None;
+		}
 	}
+	CellRevision++;
+	SyncAllReplicatedRows();
+
+	// 表示を更新
+	MarkDisplayDirty();
 
 	UE_LOG(LogTemp, Warning, TEXT("Cleared %d lines"), LinesToClear.Num());
 }
@@ -202,7 +307,8 @@ void ATetrisBoard::ClearLines(const TArray<int32>& LinesToClear)
 void ATetrisBoard::ClearBoard()
 {
 	InitializeGridArrays();
-	UpdateBoardDisplay();
+	SyncAllReplicatedRows();
+	MarkDisplayDirty();
 }
 
 void ATetrisBoard::UpdateBoardDisplay()
@@ -212,20 +318,56 @@ void ATetrisBoard::UpdateBoardDisplay()
 		return;
 	}
 
-	// すべてのインスタンスをクリア
-	BlockMeshComponent->ClearInstances();
+	bDisplayDirty = false;
+
+	// 予約分（ピース・ゴースト）と固定セルを1回の追加で作り直す
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(RESERVED_INSTANCES + BoardWidth * BoardHeight);
+	GetReservedInstanceTransforms(Transforms);
 
-	// ボード全体を再描画
+	InstanceCells.Reset();
 	for (int32 Y = 0; Y < BoardHeight; Y++)
 	{
 		for (int32 X = 0; X < BoardWidth; X++)
 		{
 			if (BoardGrid[Y][X])
 			{
-				UpdateSingleBlockDisplay(X, Y, true, BoardPieceTypes[Y][X]);
+				Transforms.Add(GetCellTransform(X, Y));
+				InstanceCells.Add(Y * BoardWidth + X);
 			}
 		}
 	}
+
+	BlockMeshComponent->ClearInstances();
+	BlockMeshComponent->AddInstances(Transforms, false);
+	for (int32 InstanceIndex = 0; InstanceIndex < RESERVED_INSTANCES; InstanceIndex++)
+	{
+		BlockMeshComponent->SetCustomDataValue(InstanceIndex, 2, InstanceIndex < GHOST_INSTANCE ? 1.0f : 2.0f, false);
+	}
+	BlockMeshComponent->MarkRenderStateDirty();
+	INC_DWORD_STAT_BY(STAT_TetrisInstancesUpdated, Transforms.Num());
+
+	TetrisLatency::MarkDisplayUpdated();
+}
+
+void ATetrisBoard::MarkDisplayDirty()
+{
+	// サブシステムがないワールドでは即座に反映
+	if (!UTetrisWorldSubsystem::Get(this))
+	{
+		UpdateBoardDisplay();
+		return;
+	}
+
+	bDisplayDirty = true;
+}
+
+void ATetrisBoard::FlushDisplay()
+{
+	if (bDisplayDirty)
+	{
+		UpdateBoardDisplay();
+	}
 }
 
 void ATetrisBoard::UpdateBlockDisplay(int32 X, int32 Y)
@@ -236,6 +378,12 @@ void ATetrisBoard::UpdateBlockDisplay(int32 X, int32 Y)
 	}
 
 	UpdateSingleBlockDisplay(X, Y, BoardGrid[Y][X], BoardPieceTypes[Y][X]);
+
+	// 盤面が変わるとゴーストの位置も変わる
+	if (ActivePieceCells.Num() > 0)
+	{
+		UpdateReservedInstances();
+	}
 }
 
 void ATetrisBoard::UpdateSingleBlockDisplay(int32 X, int32 Y, bool bVisible, EPieceType PieceType)
@@ -245,39 +393,179 @@ void ATetrisBoard::UpdateSingleBlockDisplay(int32 X, int32 Y, bool bVisible, EPi
 		return;
 	}
 
-	FVector BlockPosition = GetWorldPositionFromGrid(X, Y);
-	FTransform BlockTransform(FRotator::ZeroRotator, BlockPosition, FVector(BlockSize / 100.0f));
+	// 予約分がまだ無ければ全体を作る（このセルも含まれる）
+	if (BlockMeshComponent->GetInstanceCount() < RESERVED_INSTANCES)
+	{
+		UpdateBoardDisplay();
+		return;
+	}
 
 	if (bVisible)
 	{
-		BlockMeshComponent->AddInstance(BlockTransform);
+		BlockMeshComponent->AddInstance(GetCellTransform(X, Y));
+		InstanceCells.Add(Y * BoardWidth + X);
+		INC_DWORD_STAT(STAT_TetrisInstancesUpdated);
 		// TODO: ピースタイプに基づいて色を設定する機能を追加
 	}
 }
 
-FLinearColor ATetrisBoard::GetColorForPieceType(EPieceType PieceType) const
+void ATetrisBoard::SetActivePieceCells(const TArray<FTetrisCoordinate>& Cells, EPieceType PieceType)
+{
+	ActivePieceCells = Cells;
+	ActivePieceType = PieceType;
+	ActivePieceRevision++;
+	UpdateReservedInstances();
+}
+
+void ATetrisBoard::ClearActivePieceCells()
+{
+	if (ActivePieceCells.Num() == 0)
+	{
+		return;
+	}
+
+	ActivePieceCells.Reset();
+	ActivePieceType = EPieceType::None;
+	ActivePieceRevision++;
+	UpdateReservedInstances();
+}
+
+void ATetrisBoard::SetGhostEnabled(bool bEnabled)
+{
+	bShowGhost = bEnabled;
+	UpdateReservedInstances();
+}
+
+void ATetrisBoard::UpdateReservedInstances()
+{
+	if (!BlockMeshComponent)
+	{
+		return;
+	}
+
+	if (BlockMeshComponent->GetInstanceCount() < RESERVED_INSTANCES)
+	{
+		UpdateBoardDisplay();
+		return;
+	}
+
+	// 予約分の8個をその場で書き換える（プロキシの作り直しは起きない）
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(RESERVED_INSTANCES);
+	GetReservedInstanceTransforms(Transforms);
+	BlockMeshComponent->BatchUpdateInstancesTransforms(ACTIVE_PIECE_INSTANCE, Transforms, false, true, true);
+	INC_DWORD_STAT_BY(STAT_TetrisInstancesUpdated, RESERVED_INSTANCES);
+}
+
+void ATetrisBoard::GetReservedInstanceTransforms(TArray<FTransform>& OutTransforms) const
 {
-	switch (PieceType)
+	const int32 First = OutTransforms.Num();
+	const FTransform Hidden(FRotator::ZeroRotator, FVector::ZeroVector, FVector::ZeroVector);
+	for (int32 Index = 0; Index < RESERVED_INSTANCES; Index++)
+	{
+		OutTransforms.Add(Hidden);
+	}
+
+	const int32 NumCells = FMath::Min(ActivePieceCells.Num(), GHOST_INSTANCE - ACTIVE_PIECE_INSTANCE);
+	for (int32 Index = 0; Index < NumCells; Index++)
+	{
+		OutTransforms[First + ACTIVE_PIECE_INSTANCE + Index] = GetCellTransform(ActivePieceCells[Index].X, ActivePieceCells[Index].Y);
+	}
+
+	if (!bShowGhost || NumCells == 0)
+	{
+		return;
+	}
+
+	// ゴースト = 置けなくなる直前まで下へずらした位置（ピースと重なる間は出さない）
+	const int32 DropDistance = GetFreeDistance(MakeArrayView(ActivePieceCells.GetData(), NumCells), 0, 1);
+	if (DropDistance == 0)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < NumCells; Index++)
 	{
-	case EPieceType::I_Piece:
-		return TetrisPieceColors::I_COLOR;
-	case EPieceType::O_Piece:
-		return TetrisPieceColors::O_COLOR;
-	case EPieceType::T_Piece:
-		return TetrisPieceColors::T_COLOR;
-	case EPieceType::S_Piece:
-		return TetrisPieceColors::S_COLOR;
-	case EPieceType::Z_Piece:
-		return TetrisPieceColors::Z_COLOR;
-	case EPieceType::J_Piece:
-		return TetrisPieceColors::J_COLOR;
-	case EPieceType::L_Piece:
-		return TetrisPieceColors::L_COLOR;
-	default:
-		return FLinearColor::White;
+		OutTransforms[First + GHOST_INSTANCE + Index] = GetCellTransform(ActivePieceCells[Index].X, ActivePieceCells[Index].Y + DropDistance);
 	}
 }
 
+FTransform ATetrisBoard::GetCellTransform(int32 X, int32 Y) const
+{
+	return FTransform(FRotator::ZeroRotator, GetWorldPositionFromGrid(X, Y), FVector(BlockSize / 100.0f));
+}
+
+void ATetrisBoard::BeginLineClearAnimation(const TArray<int32>& ClearedLines)
+{
+	if (!BlockMeshComponent)
+	{
+		return;
+	}
+
+	// インスタンスとセルの対応を最新にしておく
+	FlushDisplay();
+
+	// 各行の落下段数 = その行より下で消える行の数
+	TArray<float> RowDrop;
+	TArray<float> RowCleared;
+	RowDrop.Init(0.0f, BoardHeight);
+	RowCleared.Init(0.0f, BoardHeight);
+	for (int32 LineY : ClearedLines)
+	{
+		if (RowCleared.IsValidIndex(LineY))
+		{
+			RowCleared[LineY] = 1.0f;
+		}
+	}
+	float LinesBelow = 0.0f;
+	for (int32 Y = BoardHeight - 1; Y >= 0; Y--)
+	{
+		RowDrop[Y] = RowCleared[Y] > 0.0f ? 0.0f : LinesBelow;
+		LinesBelow += RowCleared[Y];
+	}
+
+	// 固定セルのインスタンスのカスタムデータだけを書き換える（トランスフォームは触らない）
+	for (int32 CellIndex = 0; CellIndex < InstanceCells.Num(); CellIndex++)
+	{
+		const int32 Y = InstanceCells[CellIndex] / BoardWidth;
+		BlockMeshComponent->SetCustomDataValue(RESERVED_INSTANCES + CellIndex, 0, RowCleared[Y], false);
+		BlockMeshComponent->SetCustomDataValue(RESERVED_INSTANCES + CellIndex, 1, RowDrop[Y], false);
+	}
+	INC_DWORD_STAT_BY(STAT_TetrisInstancesUpdated, InstanceCells.Num());
+	BlockMeshComponent->MarkRenderStateDirty();
+
+	SetLineClearAnimationPhase(0.0f, 0.0f);
+}
+
+void ATetrisBoard::SetLineClearAnimationPhase(float FlashAlpha, float FallAlpha)
+{
+	if (!BlockMeshComponent)
+	{
+		return;
+	}
+
+	// 毎フレーム書き込むのはこの2値のみ
+	BlockMeshComponent->SetCustomPrimitiveDataFloat(0, FlashAlpha);
+	BlockMeshComponent->SetCustomPrimitiveDataFloat(1, FallAlpha);
+}
+
+void ATetrisBoard::FinishLineClearAnimation(const TArray<int32>& ClearedLines)
+{
+	SetLineClearAnimationPhase(0.0f, 0.0f);
+	ClearLines(ClearedLines);
+}
+
+void ATetrisBoard::CancelLineClearAnimation()
+{
+	SetLineClearAnimationPhase(0.0f, 0.0f);
+	MarkDisplayDirty();
+}
+
+FLinearColor ATetrisBoard::GetColorForPieceType(EPieceType PieceType) const
+{
+	return TetrisPieceTables::GetPieceColor(PieceType);
+}
+
 FVector ATetrisBoard::GetWorldPositionFromGrid(int32 X, int32 Y) const
 {
 	return FVector(X * BlockSize, Y * BlockSize, 0.0f);
@@ -316,17 +604,224 @@ bool ATetrisBoard::IsGameOver() const
 
 void ATetrisBoard::DebugPrintBoard() const
 {
-	FString DebugString = TEXT("Board State:\n");
-	
-	for (int32 Y = 0; Y < BoardHeight; Y++)
+	UE_LOG(LogTemp, Warning, TEXT("Board State:\n%s"), *ToAsciiString());
+}
+
+FString ATetrisBoard::ToAsciiString() const
+{
+	// セル値（TetrisCellPacking）ごとの文字
+	static const TCHAR CELL_CHARS[] = TEXT(".IOTSZJL#");
+
+	const int32 Height = BoardGrid.Num();
+	if (Height == 0)
+	{
+		return FString();
+	}
+
+	// 確保は1回だけで、1セル1文字を直接書く
+	FString Text;
+	TArray<TCHAR>& Chars = Text.GetCharArray();
+	Chars.SetNumUninitialized(Height * (BoardWidth + 1) + 1);
+	TCHAR* Out = Chars.GetData();
+	for (int32 Y = 0; Y < Height; Y++)
 	{
-		FString LineString = TEXT("");
+		const TArray<bool>& Row = BoardGrid[Y];
+		const TArray<EPieceType>& RowTypes = BoardPieceTypes[Y];
 		for (int32 X = 0; X < BoardWidth; X++)
 		{
-			LineString += BoardGrid[Y][X] ? TEXT("■") : TEXT("□");
+			*Out++ = Row[X] ? CELL_CHARS[TetrisCellPacking::PackCell(true, RowTypes[X])] : TEXT('.');
 		}
-		DebugString += LineString + TEXT("\n");
+		*Out++ = TEXT('\n');
+	}
+	*Out = TEXT('\0');
+	return Text;
+}
+
+bool ATetrisBoard::LoadFumen(const FString& Fumen, int32 PageIndex)
+{
+	if (BoardWidth != FTetrisFumenPage::WIDTH || BoardGrid.Num() != BoardHeight)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Fumen needs a %d-wide board (board is %d wide)"), FTetrisFumenPage::WIDTH, BoardWidth);
+		return false;
+	}
+
+	// 1ページ目ならページの配列を作らない
+	FTetrisFumenPage Page;
+	bool bDecoded = false;
+	if (PageIndex == 0)
+	{
+		bDecoded = TetrisFumen::DecodeFirstPage(*Fumen, Page);
+	}
+	else
+	{
+		TArray<FTetrisFumenPage> Pages;
+		bDecoded = TetrisFumen::Decode(*Fumen, Pages) && Pages.IsValidIndex(PageIndex);
+		if (bDecoded)
+		{
+			Page = Pages[PageIndex];
+		}
+	}
+	if (!bDecoded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to decode fumen page %d: %s"), PageIndex, *Fumen);
+		return false;
+	}
+
+	TArray<uint64, TInlineAllocator<32>> Rows;
+	Rows.SetNumUninitialized(BoardHeight);
+	if (!Page.ToPackedRows(Rows.GetData(), BoardHeight))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Fumen field is taller than the board; rows above %d were dropped"), BoardHeight);
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("%s"), *DebugString);
-}
\ No newline at end of file
+	for (int32 Y = 0; Y < BoardHeight; Y++)
+	{
+		SetPackedRow(Y, Rows[Y], false);
+	}
+	MarkDisplayDirty();
+	return true;
+}
+
+FString ATetrisBoard::ToFumen() const
+{
+	FString Fumen;
+	if (BoardWidth != FTetrisFumenPage::WIDTH)
+	{
+		return Fumen;
+	}
+
+	TArray<uint64, TInlineAllocator<32>> Rows;
+	Rows.SetNumUninitialized(BoardGrid.Num());
+	for (int32 Y = 0; Y < BoardGrid.Num(); Y++)
+	{
+		Rows[Y] = GetPackedRow(Y);
+	}
+
+	FTetrisFumenPage Page;
+	if (!Page.FromPackedRows(Rows.GetData(), Rows.Num()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Board is taller than a fumen field; rows above %d were dropped"), FTetrisFumenPage::FIELD_HEIGHT);
+	}
+	TetrisFumen::Encode(MakeArrayView(&Page, 1), Fumen);
+	return Fumen;
+}
+
+uint64 ATetrisBoard::GetPackedRow(int32 Y) const
+{
+	if (Y < 0 || Y >= BoardGrid.Num())
+	{
+		return 0;
+	}
+
+	uint64 PackedCells = 0;
+	const int32 Width = FMath::Min(BoardWidth, TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+	for (int32 X = 0; X < Width; X++)
+	{
+		PackedCells = TetrisCellPacking::SetPackedCell(PackedCells, X, TetrisCellPacking::PackCell(BoardGrid[Y][X], BoardPieceTypes[Y][X]));
+	}
+	return PackedCells;
+}
+
+void ATetrisBoard::SetPackedRow(int32 Y, uint64 PackedCells, bool bUpdateDisplay)
+{
+	if (Y < 0 || Y >= BoardGrid.Num())
+	{
+		return;
+	}
+
+	BoardHash ^= TetrisZobrist::GetRowTransitionKey(Y, GetPackedRow(Y), PackedCells);
+	CellRevision++;
+
+	const int32 Width = FMath::Min(BoardWidth, TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+	for (int32 X = 0; X < Width; X++)
+	{
+		const uint8 CellValue = TetrisCellPacking::GetPackedCell(PackedCells, X);
+		BoardGrid[Y][X] = TetrisCellPacking::IsCellOccupied(CellValue);
+		BoardPieceTypes[Y][X] = TetrisCellPacking::GetCellPieceType(CellValue);
+	}
+	SyncReplicatedRow(Y);
+
+	if (bUpdateDisplay)
+	{
+		MarkDisplayDirty();
+	}
+}
+
+uint64 ATetrisBoard::ComputeBoardHash() const
+{
+	uint64 Hash = 0;
+	for (int32 Y = 0; Y < BoardGrid.Num(); Y++)
+	{
+		Hash ^= TetrisZobrist::HashPackedRow(Y, GetPackedRow(Y));
+	}
+	return Hash;
+}
+
+void ATetrisBoard::SyncReplicatedRow(int32 Y)
+{
+	if (!HasAuthority() || !ReplicatedRows.Items.IsValidIndex(Y))
+	{
+		return;
+	}
+
+	// 内容が変わった行だけを dirty にする
+	FTetrisBoardRowItem& Item = ReplicatedRows.Items[Y];
+	const uint64 PackedCells = GetPackedRow(Y);
+	if (Item.PackedCells != PackedCells)
+	{
+		Item.PackedCells = PackedCells;
+		ReplicatedRows.MarkItemDirty(Item);
+	}
+}
+
+void ATetrisBoard::SyncAllReplicatedRows()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	if (ReplicatedRows.Items.Num() != BoardHeight)
+	{
+		ReplicatedRows.Items.SetNum(BoardHeight);
+		for (int32 Y = 0; Y < BoardHeight; Y++)
+		{
+			ReplicatedRows.Items[Y].RowIndex = Y;
+		}
+		ReplicatedRows.MarkArrayDirty();
+	}
+
+	for (int32 Y = 0; Y < BoardHeight; Y++)
+	{
+		SyncReplicatedRow(Y);
+	}
+}
+
+void ATetrisBoard::ApplyReplicatedRows(bool bUpdateDisplay)
+{
+	bool bChanged = false;
+	for (const FTetrisBoardRowItem& Item : ReplicatedRows.Items)
+	{
+		if (BoardGrid.IsValidIndex(Item.RowIndex) && GetPackedRow(Item.RowIndex) != Item.PackedCells)
+		{
+			SetPackedRow(Item.RowIndex, Item.PackedCells, false);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged && bUpdateDisplay)
+	{
+		MarkDisplayDirty();
+	}
+}
+
+void ATetrisBoard::OnReplicatedRowsReceived()
+{
+	// BeginPlay 前に届いた行は InitializeBoard で反映する
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	ApplyReplicatedRows(true);
+}
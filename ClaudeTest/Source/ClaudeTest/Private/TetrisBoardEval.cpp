@@ -0,0 +1,143 @@
+#include "TetrisBoardEval.h"
+#include "TetrisSimulation.h"
+#include "Math/VectorRegister.h"
+
+// バッチ
+
+void FTetrisBoardBatch::Reset(int32 InWidth, int32 InHeight, int32 Capacity)
+{
+	Width = FMath::Clamp(InWidth, 2, FTetrisSimBoard::MAX_WIDTH);
+	Height = FMath::Clamp(InHeight, 1, FTetrisSimBoard::MAX_HEIGHT);
+	Num = 0;
+	Stride = Align(FMath::Max(Capacity, 1), LANES);
+	Rows.SetNumZeroed(Height * Stride);
+}
+
+int32 FTetrisBoardBatch::Add(const FTetrisSimBoard& Board)
+{
+	check(Board.Width == Width && Board.Height == Height);
+
+	if (Num == Stride)
+	{
+		Grow(Stride * 2);
+	}
+
+	for (int32 Y = 0; Y < Height; Y++)
+	{
+		Rows[Y * Stride + Num] = Board.Rows[Y];
+	}
+	return Num++;
+}
+
+void FTetrisBoardBatch::Grow(int32 NewStride)
+{
+	TArray<uint32> NewRows;
+	NewRows.SetNumZeroed(Height * NewStride);
+	for (int32 Y = 0; Y < Height; Y++)
+	{
+		FMemory::Memcpy(&NewRows[Y * NewStride], &Rows[Y * Stride], Num * sizeof(uint32));
+	}
+
+	Rows = MoveTemp(NewRows);
+	Stride = NewStride;
+}
+
+// 参照実装
+
+void TetrisBoardEval::ComputeFeatures(const FTetrisSimBoard& Board, FTetrisBoardFeatures& OutFeatures)
+{
+	ComputeFeaturesFromCells(Board.Width, Board.Height, [&Board](int32 X, int32 Y) { return Board.IsCellOccupied(X, Y); }, OutFeatures);
+}
+
+// ベクタ版
+// 各特徴量は「行ごとのビットマスクの popcount の合計」で表せるので、4盤面分の同じ行をまとめて処理する
+// popcount は 32bit レーンの上下16bitに別々の特徴量を入れて2つ同時に数える（幅は最大16）
+
+namespace
+{
+	// 上下16bitそれぞれの立っているビット数
+	FORCEINLINE VectorRegister4Int PopCount16x2(const VectorRegister4Int& Value)
+	{
+		const VectorRegister4Int Mask1 = VectorIntSet1(0x55555555);
+		const VectorRegister4Int Mask2 = VectorIntSet1(0x33333333);
+		const VectorRegister4Int Mask4 = VectorIntSet1(0x0F0F0F0F);
+		const VectorRegister4Int Mask8 = VectorIntSet1(0x001F001F);
+
+		VectorRegister4Int Count = VectorIntSubtract(Value, VectorIntAnd(VectorShiftRightImmLogical(Value, 1), Mask1));
+		Count = VectorIntAdd(VectorIntAnd(Count, Mask2), VectorIntAnd(VectorShiftRightImmLogical(Count, 2), Mask2));
+		Count = VectorIntAnd(VectorIntAdd(Count, VectorShiftRightImmLogical(Count, 4)), Mask4);
+		return VectorIntAnd(VectorIntAdd(Count, VectorShiftRightImmLogical(Count, 8)), Mask8);
+	}
+}
+
+void TetrisBoardEval::ComputeFeaturesBatch(const FTetrisBoardBatch& Batch, TArray<FTetrisBoardFeatures>& OutFeatures)
+{
+	OutFeatures.SetNumUninitialized(Batch.Num);
+
+	const uint32 FullMask = (1u << Batch.Width) - 1;
+	const VectorRegister4Int Zero = VectorIntSet1(0);
+	const VectorRegister4Int One = VectorIntSet1(1);
+	const VectorRegister4Int Full = VectorIntSet1(static_cast<int32>(FullMask));
+	const VectorRegister4Int PairMask = VectorIntSet1(static_cast<int32>(FullMask >> 1));
+	const VectorRegister4Int LeftWall = One;
+	const VectorRegister4Int RightWall = VectorIntSet1(static_cast<int32>(1u << (Batch.Width - 1)));
+	const VectorRegister4Int Walls = VectorIntOr(LeftWall, RightWall);
+
+	for (int32 Base = 0; Base < Batch.Num; Base += FTetrisBoardBatch::LANES)
+	{
+		VectorRegister4Int Seen = Zero;
+		VectorRegister4Int HeightAndHoles = Zero;
+		VectorRegister4Int BumpinessAndTransitions = Zero;
+		VectorRegister4Int WellsAndWallTransitions = Zero;
+		VectorRegister4Int NonEmptyRows = Zero;
+
+		const uint32* RowData = Batch.Rows.GetData() + Base;
+		for (int32 Y = 0; Y < Batch.Height; Y++, RowData += Batch.Stride)
+		{
+			const VectorRegister4Int Row = VectorIntLoad(RowData);
+
+			// 上から見て一度でも埋まった列（列の高さの内側）
+			Seen = VectorIntOr(Seen, Row);
+
+			// 下16bit: 高さ（内側のセル数）/ 上16bit: 穴
+			const VectorRegister4Int HoleBits = VectorIntAndNot(Row, Seen);
+			HeightAndHoles = VectorIntAdd(HeightAndHoles, PopCount16x2(VectorIntOr(Seen, VectorShiftLeftImm(HoleBits, 16))));
+
+			// 下16bit: 隣の列と高さが食い違う行 / 上16bit: 行内の隣り合うセルの切り替わり
+			const VectorRegister4Int SeenEdges = VectorIntAnd(VectorIntXor(Seen, VectorShiftRightImmLogical(Seen, 1)), PairMask);
+			const VectorRegister4Int RowEdges = VectorIntAnd(VectorIntXor(Row, VectorShiftRightImmLogical(Row, 1)), PairMask);
+			BumpinessAndTransitions = VectorIntAdd(BumpinessAndTransitions, PopCount16x2(VectorIntOr(SeenEdges, VectorShiftLeftImm(RowEdges, 16))));
+
+			// 下16bit: 上が開いていて左右が埋まった空セル / 上16bit: 壁と隣り合う空セル
+			const VectorRegister4Int LeftFilled = VectorIntOr(VectorShiftLeftImm(Row, 1), LeftWall);
+			const VectorRegister4Int RightFilled = VectorIntOr(VectorShiftRightImmLogical(Row, 1), RightWall);
+			const VectorRegister4Int WellBits = VectorIntAndNot(Seen, VectorIntAnd(VectorIntAnd(LeftFilled, RightFilled), Full));
+			const VectorRegister4Int WallEdges = VectorIntAndNot(Row, Walls);
+			WellsAndWallTransitions = VectorIntAdd(WellsAndWallTransitions, PopCount16x2(VectorIntOr(WellBits, VectorShiftLeftImm(WallEdges, 16))));
+
+			// 一番高い列の上端より下の行数 = 最大の高さ
+			NonEmptyRows = VectorIntAdd(NonEmptyRows, VectorIntAndNot(VectorIntCompareEQ(Seen, Zero), One));
+		}
+
+		alignas(16) int32 HeightAndHolesLanes[FTetrisBoardBatch::LANES];
+		alignas(16) int32 BumpinessAndTransitionsLanes[FTetrisBoardBatch::LANES];
+		alignas(16) int32 WellsAndWallTransitionsLanes[FTetrisBoardBatch::LANES];
+		alignas(16) int32 MaxHeightLanes[FTetrisBoardBatch::LANES];
+		VectorIntStoreAligned(HeightAndHoles, HeightAndHolesLanes);
+		VectorIntStoreAligned(BumpinessAndTransitions, BumpinessAndTransitionsLanes);
+		VectorIntStoreAligned(WellsAndWallTransitions, WellsAndWallTransitionsLanes);
+		VectorIntStoreAligned(NonEmptyRows, MaxHeightLanes);
+
+		const int32 NumLanes = FMath::Min(FTetrisBoardBatch::LANES, Batch.Num - Base);
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			FTetrisBoardFeatures& Features = OutFeatures[Base + Lane];
+			Features.AggregateHeight = HeightAndHolesLanes[Lane] & 0xFFFF;
+			Features.Holes = HeightAndHolesLanes[Lane] >> 16;
+			Features.Bumpiness = BumpinessAndTransitionsLanes[Lane] & 0xFFFF;
+			Features.RowTransitions = (BumpinessAndTransitionsLanes[Lane] >> 16) + (WellsAndWallTransitionsLanes[Lane] >> 16);
+			Features.WellDepth = WellsAndWallTransitionsLanes[Lane] & 0xFFFF;
+			Features.MaxHeight = MaxHeightLanes[Lane];
+		}
+	}
+}
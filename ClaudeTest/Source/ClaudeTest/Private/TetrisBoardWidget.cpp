@@ -0,0 +1,101 @@
+#include "TetrisBoardWidget.h"
+#include "STetrisBoardView.h"
+#include "TetrisBoard.h"
+
+#define LOCTEXT_NAMESPACE "TetrisBoardWidget"
+
+UTetrisBoardWidget::UTetrisBoardWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	CellSize = 8.0f;
+	BoardSpacing = 8.0f;
+	Columns = 4;
+	BackgroundColor = FLinearColor(0.02f, 0.02f, 0.02f, 1.0f);
+}
+
+TSharedRef<SWidget> UTetrisBoardWidget::RebuildWidget()
+{
+	BoardView = SNew(STetrisBoardView)
+		.CellSize(CellSize)
+		.BoardSpacing(BoardSpacing)
+		.Columns(Columns)
+		.BackgroundColor(BackgroundColor);
+
+	BoardView->SetBoards(Boards);
+	BoardView->SetPreviewPieces(PreviewPieces);
+
+	return BoardView.ToSharedRef();
+}
+
+void UTetrisBoardWidget::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	if (BoardView.IsValid())
+	{
+		BoardView->SetCellSize(CellSize);
+		BoardView->SetBoardSpacing(BoardSpacing);
+		BoardView->SetColumns(Columns);
+		BoardView->SetBackgroundColor(BackgroundColor);
+	}
+}
+
+void UTetrisBoardWidget::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	BoardView.Reset();
+}
+
+void UTetrisBoardWidget::SetBoards(const TArray<ATetrisBoard*>& InBoards)
+{
+	Boards.Reset(InBoards.Num());
+	for (ATetrisBoard* Board : InBoards)
+	{
+		Boards.Add(Board);
+	}
+
+	if (BoardView.IsValid())
+	{
+		BoardView->SetBoards(Boards);
+	}
+}
+
+void UTetrisBoardWidget::AddBoard(ATetrisBoard* Board)
+{
+	Boards.Add(Board);
+
+	if (BoardView.IsValid())
+	{
+		BoardView->AddBoard(Board);
+	}
+}
+
+void UTetrisBoardWidget::ClearBoards()
+{
+	Boards.Reset();
+
+	if (BoardView.IsValid())
+	{
+		BoardView->ClearBoards();
+	}
+}
+
+void UTetrisBoardWidget::SetPreviewPieces(const TArray<EPieceType>& InPieces)
+{
+	PreviewPieces = InPieces;
+
+	if (BoardView.IsValid())
+	{
+		BoardView->SetPreviewPieces(PreviewPieces);
+	}
+}
+
+#if WITH_EDITOR
+const FText UTetrisBoardWidget::GetPaletteCategory()
+{
+	return LOCTEXT("Tetris", "Tetris");
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
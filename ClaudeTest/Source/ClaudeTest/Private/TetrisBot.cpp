@@ -0,0 +1,132 @@
+#include "TetrisBot.h"
+#include "TetrisSimulation.h"
+#include "TetrisPieceTables.h"
+#include "TetrisBoardEval.h"
+
+namespace
+{
+	// 評価待ちの候補（入力列の復元用）
+	struct FBotCandidate
+	{
+		int32 Rotations = 0;
+		int32 Shift = 0;
+		int32 LinesCleared = 0;
+	};
+}
+
+float TetrisBot::EvaluateBoard(const FTetrisSimBoard& Board, int32 LinesCleared, const FTetrisBotWeights& Weights)
+{
+	FTetrisBoardFeatures Features;
+	TetrisBoardEval::ComputeFeatures(Board, Features);
+	return ScoreFeatures(Features, LinesCleared, Weights);
+}
+
+float TetrisBot::ScoreFeatures(const FTetrisBoardFeatures& Features, int32 LinesCleared, const FTetrisBotWeights& Weights)
+{
+	return Weights.AggregateHeight * Features.AggregateHeight
+		+ Weights.CompleteLines * LinesCleared
+		+ Weights.Holes * Features.Holes
+		+ Weights.Bumpiness * Features.Bumpiness
+		+ Weights.RowTransitions * Features.RowTransitions
+		+ Weights.WellDepth * Features.WellDepth;
+}
+
+bool TetrisBot::FindBestPlacement(const FTetrisSimGame& Game, const FTetrisBotWeights& Weights, TArray<ETetrisInputCommand>& OutInputs)
+{
+	OutInputs.Reset();
+	if (!Game.HasActivePiece())
+	{
+		return false;
+	}
+
+	const FTetrisSimBoard& Board = Game.GetBoard();
+	const EPieceType PieceType = Game.GetActivePiece();
+
+	// 候補の盤面はバッチに並べて最後にまとめて評価する
+	TArray<FBotCandidate, TInlineAllocator<64>> Candidates;
+	FTetrisBoardBatch Batch;
+	Batch.Reset(Board.Width, Board.Height, 64);
+
+	// 回転はゲームの入力をそのまま使う（Wall Kick による位置ずれも反映される）
+	FTetrisSimGame Rotated = Game;
+	uint16 TriedShapes[TetrisPieceTables::NUM_ROTATIONS] = {};
+	for (int32 RotateCount = 0; RotateCount < TetrisPieceTables::NUM_ROTATIONS; RotateCount++)
+	{
+		if (RotateCount > 0 && !Rotated.ApplyInput(ETetrisInputCommand::Rotate))
+		{
+			break;
+		}
+
+		// 同じ形状の回転（O や S/Z の 2,3）は1回だけ試す
+		const int32 Rotation = Rotated.GetActiveRotation();
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Rotation);
+		bool bAlreadyTried = false;
+		for (int32 i = 0; i < RotateCount; i++)
+		{
+			bAlreadyTried |= TriedShapes[i] == ShapeMask;
+		}
+		TriedShapes[RotateCount] = ShapeMask;
+		if (bAlreadyTried)
+		{
+			continue;
+		}
+
+		const int32 StartX = Rotated.GetActiveX();
+		const int32 StartY = Rotated.GetActiveY();
+		for (int32 Direction = -1; Direction <= 1; Direction += 2)
+		{
+			// 左右に1マスずつ、壁や積まれたブロックに当たるまで
+			for (int32 Shift = (Direction < 0 ? 0 : 1); ; Shift++)
+			{
+				const int32 X = StartX + Shift * Direction;
+				if (!Board.CanPlace(PieceType, Rotation, X, StartY))
+				{
+					break;
+				}
+
+				FTetrisSimBoard Result = Board;
+				Result.Place(PieceType, Rotation, X, Board.GetDropY(PieceType, Rotation, X, StartY));
+				const int32 LinesCleared = Result.ClearFullRows();
+
+				Batch.Add(Result);
+				Candidates.Add({ RotateCount, Shift * Direction, LinesCleared });
+			}
+		}
+	}
+
+	if (Candidates.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<FTetrisBoardFeatures> Features;
+	TetrisBoardEval::ComputeFeaturesBatch(Batch, Features);
+
+	// 同点なら先に見つけた候補
+	float BestScore = -MAX_flt;
+	int32 BestIndex = 0;
+	for (int32 Index = 0; Index < Candidates.Num(); Index++)
+	{
+		const float Score = ScoreFeatures(Features[Index], Candidates[Index].LinesCleared, Weights);
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestIndex = Index;
+		}
+	}
+
+	const int32 BestRotations = Candidates[BestIndex].Rotations;
+	const int32 BestShift = Candidates[BestIndex].Shift;
+
+	for (int32 i = 0; i < BestRotations; i++)
+	{
+		OutInputs.Add(ETetrisInputCommand::Rotate);
+	}
+	const ETetrisInputCommand MoveCommand = BestShift < 0 ? ETetrisInputCommand::MoveLeft : ETetrisInputCommand::MoveRight;
+	for (int32 i = 0; i < FMath::Abs(BestShift); i++)
+	{
+		OutInputs.Add(MoveCommand);
+	}
+	OutInputs.Add(ETetrisInputCommand::HardDrop);
+	return true;
+}
@@ -0,0 +1,306 @@
+#include "TetrisDatasetExporter.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+namespace
+{
+	// ヘッダー（NumRecords は Close で書き直すので固定長）
+	void SerializeHeader(FArchive& Ar, uint32& Magic, uint32& Version, FTetrisDatasetHeader& Header)
+	{
+		Ar << Magic;
+		Ar << Version;
+		Ar << Header.BoardWidth;
+		Ar << Header.BoardHeight;
+		Ar << Header.PreviewCount;
+		Ar << Header.ChunkRecords;
+		Ar << Header.NumRecords;
+	}
+
+	template<typename ElementType>
+	void SerializeColumn(FArchive& Ar, TArray<ElementType>& Column, int32 NumElements)
+	{
+		if (Ar.IsLoading())
+		{
+			Column.SetNumUninitialized(NumElements);
+		}
+		Ar.Serialize(Column.GetData(), NumElements * sizeof(ElementType));
+	}
+}
+
+void FTetrisDatasetExporter::FChunk::Allocate(int32 ChunkRecords, int32 BoardHeight, int32 PreviewCount)
+{
+	Num = 0;
+	GameIds.SetNumZeroed(ChunkRecords);
+	PieceIndices.SetNumZeroed(ChunkRecords);
+	BoardRows.SetNumZeroed(ChunkRecords * BoardHeight);
+	Pieces.SetNumZeroed(ChunkRecords);
+	Queues.SetNumZeroed(ChunkRecords * PreviewCount);
+	Rotations.SetNumZeroed(ChunkRecords);
+	Xs.SetNumZeroed(ChunkRecords);
+	Ys.SetNumZeroed(ChunkRecords);
+	LinesCleared.SetNumZeroed(ChunkRecords);
+	Rewards.SetNumZeroed(ChunkRecords);
+}
+
+FTetrisDatasetExporter::FTetrisDatasetExporter()
+{
+	ChunkReadyEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	BackFreeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FTetrisDatasetExporter::~FTetrisDatasetExporter()
+{
+	Close();
+
+	FPlatformProcess::ReturnSynchEventToPool(ChunkReadyEvent);
+	FPlatformProcess::ReturnSynchEventToPool(BackFreeEvent);
+}
+
+bool FTetrisDatasetExporter::Open(const FString& InPath, int32 BoardWidth, int32 BoardHeight, int32 PreviewCount, int32 ChunkRecords)
+{
+	Close();
+
+	Header = FTetrisDatasetHeader();
+	Header.BoardWidth = FMath::Clamp(BoardWidth, 1, TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+	Header.BoardHeight = FMath::Clamp(BoardHeight, 1, FTetrisDecisionRecord::MAX_HEIGHT);
+	Header.PreviewCount = FMath::Clamp(PreviewCount, 0, FTetrisPieceQueue::MAX_PREVIEW);
+	Header.ChunkRecords = FMath::Max(ChunkRecords, 1);
+
+	Writer = IFileManager::Get().CreateFileWriter(*InPath);
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create dataset file %s"), *InPath);
+		return false;
+	}
+	Path = InPath;
+
+	uint32 Magic = FTetrisDatasetHeader::MAGIC;
+	uint32 Version = FTetrisDatasetHeader::VERSION;
+	SerializeHeader(*Writer, Magic, Version, Header);
+	BytesWritten.store(Writer->Tell(), std::memory_order_relaxed);
+
+	for (FChunk& Chunk : Chunks)
+	{
+		Chunk.Allocate(Header.ChunkRecords, Header.BoardHeight, Header.PreviewCount);
+	}
+	Front = &Chunks[0];
+	Back = &Chunks[1];
+	bBackPending.store(false);
+	bStopRequested.store(false);
+	NumRecords = 0;
+	NumStalls = 0;
+
+	Thread = FRunnableThread::Create(this, TEXT("TetrisDatasetWriter"), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create dataset writer thread"));
+		delete Writer;
+		Writer = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void FTetrisDatasetExporter::Close()
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	if (Front->Num > 0)
+	{
+		SubmitFrontChunk();
+	}
+
+	// 書き込みスレッドは渡されたチャンクを書き終えてから終わる
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	// 件数を確定
+	Header.NumRecords = NumRecords;
+	Writer->Seek(0);
+	uint32 Magic = FTetrisDatasetHeader::MAGIC;
+	uint32 Version = FTetrisDatasetHeader::VERSION;
+	SerializeHeader(*Writer, Magic, Version, Header);
+
+	const bool bError = Writer->IsError();
+	Writer->Close();
+	delete Writer;
+	Writer = nullptr;
+
+	if (bError)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write dataset file %s"), *Path);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Log, TEXT("Dataset %s: %lld records, %lld bytes, %lld stalls"), *Path, NumRecords, GetBytesWritten(), NumStalls);
+	}
+}
+
+void FTetrisDatasetExporter::Add(const FTetrisDecisionRecord& Record)
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	FChunk& Chunk = *Front;
+	const int32 Index = Chunk.Num;
+
+	Chunk.GameIds[Index] = Record.GameId;
+	Chunk.PieceIndices[Index] = Record.PieceIndex;
+	FMemory::Memcpy(&Chunk.BoardRows[Index * Header.BoardHeight], Record.BoardRows, Header.BoardHeight * sizeof(uint16));
+	Chunk.Pieces[Index] = static_cast<uint8>(Record.Piece);
+	FMemory::Memcpy(&Chunk.Queues[Index * Header.PreviewCount], Record.Queue, Header.PreviewCount * sizeof(uint8));
+	Chunk.Rotations[Index] = Record.Rotation;
+	Chunk.Xs[Index] = Record.X;
+	Chunk.Ys[Index] = Record.Y;
+	Chunk.LinesCleared[Index] = Record.LinesCleared;
+	Chunk.Rewards[Index] = Record.Reward;
+
+	NumRecords++;
+	if (++Chunk.Num == Header.ChunkRecords)
+	{
+		SubmitFrontChunk();
+	}
+}
+
+void FTetrisDatasetExporter::SubmitFrontChunk()
+{
+	// 裏のチャンクがまだ書き込み中なら空くまで待つ
+	if (bBackPending.load(std::memory_order_acquire))
+	{
+		NumStalls++;
+		while (bBackPending.load(std::memory_order_acquire))
+		{
+			BackFreeEvent->Wait();
+		}
+	}
+
+	Swap(Front, Back);
+	Front->Num = 0;
+	bBackPending.store(true, std::memory_order_release);
+	ChunkReadyEvent->Trigger();
+}
+
+uint32 FTetrisDatasetExporter::Run()
+{
+	for (;;)
+	{
+		if (bBackPending.load(std::memory_order_acquire))
+		{
+			WriteChunk(*Back);
+			bBackPending.store(false, std::memory_order_release);
+			BackFreeEvent->Trigger();
+			continue;
+		}
+
+		// 停止の前に渡された最後のチャンクは、上の確認の後に届いていることがあるので見直してから終わる
+		if (bStopRequested.load(std::memory_order_acquire))
+		{
+			if (!bBackPending.load(std::memory_order_acquire))
+			{
+				break;
+			}
+			continue;
+		}
+		ChunkReadyEvent->Wait(100);
+	}
+	return 0;
+}
+
+void FTetrisDatasetExporter::Stop()
+{
+	bStopRequested.store(true, std::memory_order_release);
+	ChunkReadyEvent->Trigger();
+}
+
+void FTetrisDatasetExporter::WriteChunk(FChunk& Columns)
+{
+	FArchive& Ar = *Writer;
+	int32 Num = Columns.Num;
+
+	Ar << Num;
+	SerializeColumn(Ar, Columns.GameIds, Num);
+	SerializeColumn(Ar, Columns.PieceIndices, Num);
+	SerializeColumn(Ar, Columns.BoardRows, Num * Header.BoardHeight);
+	SerializeColumn(Ar, Columns.Pieces, Num);
+	SerializeColumn(Ar, Columns.Queues, Num * Header.PreviewCount);
+	SerializeColumn(Ar, Columns.Rotations, Num);
+	SerializeColumn(Ar, Columns.Xs, Num);
+	SerializeColumn(Ar, Columns.Ys, Num);
+	SerializeColumn(Ar, Columns.LinesCleared, Num);
+	SerializeColumn(Ar, Columns.Rewards, Num);
+
+	BytesWritten.store(Ar.Tell(), std::memory_order_relaxed);
+}
+
+bool FTetrisDatasetExporter::ReadFile(const FString& FilePath, FTetrisDatasetHeader& OutHeader, TArray<FTetrisDecisionRecord>& OutRecords)
+{
+	OutRecords.Reset();
+
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	SerializeHeader(*Reader, Magic, Version, OutHeader);
+	if (Reader->IsError() || Magic != FTetrisDatasetHeader::MAGIC || Version != FTetrisDatasetHeader::VERSION
+		|| OutHeader.BoardHeight < 1 || OutHeader.BoardHeight > FTetrisDecisionRecord::MAX_HEIGHT
+		|| OutHeader.PreviewCount < 0 || OutHeader.PreviewCount > FTetrisPieceQueue::MAX_PREVIEW)
+	{
+		return false;
+	}
+
+	FChunk Chunk;
+	while (Reader->Tell() < Reader->TotalSize())
+	{
+		int32 Num = 0;
+		*Reader << Num;
+		if (Num <= 0 || Num > OutHeader.ChunkRecords)
+		{
+			return false;
+		}
+
+		SerializeColumn(*Reader, Chunk.GameIds, Num);
+		SerializeColumn(*Reader, Chunk.PieceIndices, Num);
+		SerializeColumn(*Reader, Chunk.BoardRows, Num * OutHeader.BoardHeight);
+		SerializeColumn(*Reader, Chunk.Pieces, Num);
+		SerializeColumn(*Reader, Chunk.Queues, Num * OutHeader.PreviewCount);
+		SerializeColumn(*Reader, Chunk.Rotations, Num);
+		SerializeColumn(*Reader, Chunk.Xs, Num);
+		SerializeColumn(*Reader, Chunk.Ys, Num);
+		SerializeColumn(*Reader, Chunk.LinesCleared, Num);
+		SerializeColumn(*Reader, Chunk.Rewards, Num);
+		if (Reader->IsError())
+		{
+			return false;
+		}
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			FTetrisDecisionRecord& Record = OutRecords.AddDefaulted_GetRef();
+			Record.GameId = Chunk.GameIds[Index];
+			Record.PieceIndex = Chunk.PieceIndices[Index];
+			FMemory::Memcpy(Record.BoardRows, &Chunk.BoardRows[Index * OutHeader.BoardHeight], OutHeader.BoardHeight * sizeof(uint16));
+			Record.Piece = static_cast<EPieceType>(Chunk.Pieces[Index]);
+			FMemory::Memcpy(Record.Queue, &Chunk.Queues[Index * OutHeader.PreviewCount], OutHeader.PreviewCount * sizeof(uint8));
+			Record.Rotation = Chunk.Rotations[Index];
+			Record.X = Chunk.Xs[Index];
+			Record.Y = Chunk.Ys[Index];
+			Record.LinesCleared = Chunk.LinesCleared[Index];
+			Record.Reward = Chunk.Rewards[Index];
+		}
+	}
+
+	return OutHeader.NumRecords == 0 || OutHeader.NumRecords == OutRecords.Num();
+}
@@ -0,0 +1,269 @@
+#include "TetrisFinesse.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "TetrisSimulation.h"
+
+namespace
+{
+	const int32 NUM_PIECE_TYPES = 8;	// None を含む
+
+	struct FFinesseTable
+	{
+		FTetrisFinesseEntry Entries[NUM_PIECE_TYPES][TetrisPieceTables::NUM_ROTATIONS][TetrisFinesse::NUM_COLUMNS];
+	};
+
+	// キー1回分の移動（ATetrisPiece::MovePiece / RotatePiece と同じ規則）。動けなければ false
+	bool ApplyKey(const FTetrisSimBoard& Board, EPieceType PieceType, ETetrisFinesseKey Key, int32& Rotation, int32& X, int32& Y)
+	{
+		switch (Key)
+		{
+		case ETetrisFinesseKey::Left:
+		case ETetrisFinesseKey::DasLeft:
+		case ETetrisFinesseKey::Right:
+		case ETetrisFinesseKey::DasRight:
+		{
+			const int32 Step = (Key == ETetrisFinesseKey::Left || Key == ETetrisFinesseKey::DasLeft) ? -1 : 1;
+			if (!Board.CanPlace(PieceType, Rotation, X + Step, Y))
+			{
+				return false;
+			}
+			X += Step;
+			if (Key == ETetrisFinesseKey::DasLeft || Key == ETetrisFinesseKey::DasRight)
+			{
+				while (Board.CanPlace(PieceType, Rotation, X + Step, Y))
+				{
+					X += Step;
+				}
+			}
+			return true;
+		}
+		case ETetrisFinesseKey::Rotate:
+		{
+			const int32 NewRotation = (Rotation + 1) % TetrisPieceTables::NUM_ROTATIONS;
+			if (Board.CanPlace(PieceType, NewRotation, X, Y))
+			{
+				Rotation = NewRotation;
+				return true;
+			}
+			for (const TetrisRules::FKickOffset& Kick : TetrisRules::GetWallKickOffsets(PieceType))
+			{
+				if (Board.CanPlace(PieceType, NewRotation, X + Kick.X, Y + Kick.Y))
+				{
+					Rotation = NewRotation;
+					X += Kick.X;
+					Y += Kick.Y;
+					return true;
+				}
+			}
+			return false;
+		}
+		}
+		return false;
+	}
+
+	// 真下に落として固定したセルの集合
+	uint64 GetLockedCellsKey(const FTetrisSimBoard& Board, EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+	{
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Rotation);
+		const int32 DropY = Board.GetDropY(PieceType, Rotation, X, Y);
+		uint64 Key = 0;
+		for (int32 CellY = 0; CellY < TetrisConstants::PIECE_SIZE; CellY++)
+		{
+			for (int32 CellX = 0; CellX < TetrisConstants::PIECE_SIZE; CellX++)
+			{
+				if (TetrisPieceTables::IsShapeCellSet(ShapeMask, CellX, CellY))
+				{
+					Key = (Key << 16) | (uint64(uint8(DropY + CellY)) << 8) | uint8(X + CellX);
+				}
+			}
+		}
+		return Key;
+	}
+
+	// 幅優先探索（1キー = 1手）で、各 (回転, X) に最初に届いたキー列を記録する
+	void BuildPieceEntries(const FTetrisSimBoard& Board, EPieceType PieceType, FTetrisFinesseEntry (&Entries)[TetrisPieceTables::NUM_ROTATIONS][TetrisFinesse::NUM_COLUMNS])
+	{
+		struct FNode
+		{
+			int32 Rotation = 0;
+			int32 X = 0;
+			int32 Y = 0;
+			int32 Parent = INDEX_NONE;
+			ETetrisFinesseKey Key = ETetrisFinesseKey::Left;
+			int32 Depth = 0;
+		};
+
+		const auto StateKey = [](int32 Rotation, int32 X, int32 Y)
+		{
+			return static_cast<uint32>(Rotation) | (static_cast<uint32>(X + 64) << 2) | (static_cast<uint32>(Y + 64) << 10);
+		};
+
+		TArray<FNode> Nodes;
+		TSet<uint32> Visited;
+		Nodes.Add({ 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y });
+		Visited.Add(StateKey(0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y));
+
+		const ETetrisFinesseKey AllKeys[] = { ETetrisFinesseKey::Left, ETetrisFinesseKey::Right,
+			ETetrisFinesseKey::DasLeft, ETetrisFinesseKey::DasRight, ETetrisFinesseKey::Rotate };
+
+		for (int32 Head = 0; Head < Nodes.Num(); Head++)
+		{
+			const FNode Node = Nodes[Head];
+			const int32 Column = Node.X - TetrisFinesse::MIN_X;
+			FTetrisFinesseEntry& Entry = Entries[Node.Rotation][Column];
+			if (!Entry.bReachable)
+			{
+				Entry.bReachable = true;
+				Entry.NumKeys = static_cast<uint8>(Node.Depth);
+				for (int32 Index = Head, Depth = Node.Depth; Nodes[Index].Parent != INDEX_NONE; Index = Nodes[Index].Parent)
+				{
+					Entry.Keys[--Depth] = Nodes[Index].Key;
+				}
+			}
+
+			if (Node.Depth >= FTetrisFinesseEntry::MAX_KEYS)
+			{
+				continue;
+			}
+			for (ETetrisFinesseKey Key : AllKeys)
+			{
+				int32 Rotation = Node.Rotation;
+				int32 X = Node.X;
+				int32 Y = Node.Y;
+				if (ApplyKey(Board, PieceType, Key, Rotation, X, Y))
+				{
+					bool bAlreadyVisited = false;
+					Visited.Add(StateKey(Rotation, X, Y), &bAlreadyVisited);
+					if (!bAlreadyVisited)
+					{
+						Nodes.Add({ Rotation, X, Y, Head, Key, Node.Depth + 1 });
+					}
+				}
+			}
+		}
+
+		// セルが同じ固定位置は少ない方のキー列にそろえる
+		TMap<uint64, FTetrisFinesseEntry> BestByCells;
+		uint64 CellsKeys[TetrisPieceTables::NUM_ROTATIONS][TetrisFinesse::NUM_COLUMNS] = {};
+		for (int32 Rotation = 0; Rotation < TetrisPieceTables::NUM_ROTATIONS; Rotation++)
+		{
+			for (int32 Column = 0; Column < TetrisFinesse::NUM_COLUMNS; Column++)
+			{
+				const FTetrisFinesseEntry& Entry = Entries[Rotation][Column];
+				if (!Entry.bReachable)
+				{
+					continue;
+				}
+				CellsKeys[Rotation][Column] = GetLockedCellsKey(Board, PieceType, Rotation, Column + TetrisFinesse::MIN_X, TetrisRules::SPAWN_Y);
+				FTetrisFinesseEntry* Best = BestByCells.Find(CellsKeys[Rotation][Column]);
+				if (!Best || Entry.NumKeys < Best->NumKeys)
+				{
+					BestByCells.Add(CellsKeys[Rotation][Column], Entry);
+				}
+			}
+		}
+		for (int32 Rotation = 0; Rotation < TetrisPieceTables::NUM_ROTATIONS; Rotation++)
+		{
+			for (int32 Column = 0; Column < TetrisFinesse::NUM_COLUMNS; Column++)
+			{
+				if (Entries[Rotation][Column].bReachable)
+				{
+					Entries[Rotation][Column] = BestByCells.FindChecked(CellsKeys[Rotation][Column]);
+				}
+			}
+		}
+	}
+
+	const FFinesseTable& GetTable()
+	{
+		static const TUniquePtr<FFinesseTable> Table = []()
+		{
+			TUniquePtr<FFinesseTable> NewTable = MakeUnique<FFinesseTable>();
+			FTetrisSimBoard Board;
+			Board.Reset(TetrisConstants::BOARD_WIDTH, TetrisConstants::BOARD_HEIGHT);
+			for (int32 TypeIndex = 1; TypeIndex < NUM_PIECE_TYPES; TypeIndex++)
+			{
+				BuildPieceEntries(Board, static_cast<EPieceType>(TypeIndex), NewTable->Entries[TypeIndex]);
+			}
+			return NewTable;
+		}();
+		return *Table;
+	}
+}
+
+const FTetrisFinesseEntry& TetrisFinesse::GetEntry(EPieceType PieceType, int32 Rotation, int32 X)
+{
+	static const FTetrisFinesseEntry Unreachable;
+
+	const int32 TypeIndex = static_cast<int32>(PieceType);
+	const int32 Column = X - MIN_X;
+	if (TypeIndex <= 0 || TypeIndex >= NUM_PIECE_TYPES || Column < 0 || Column >= NUM_COLUMNS)
+	{
+		return Unreachable;
+	}
+	return GetTable().Entries[TypeIndex][Rotation & (TetrisPieceTables::NUM_ROTATIONS - 1)][Column];
+}
+
+void TetrisFinesse::Prebuild()
+{
+	GetTable();
+}
+
+// 判定
+
+void FTetrisFinesseTracker::Reset()
+{
+	*this = FTetrisFinesseTracker();
+}
+
+void FTetrisFinesseTracker::BeginPiece(bool bInFromSpawn)
+{
+	KeysUsed = 0;
+	bFromSpawn = bInFromSpawn;
+	bSoftDropped = false;
+}
+
+void FTetrisFinesseTracker::AddKeyPress(ETetrisInputCommand Command)
+{
+	switch (Command)
+	{
+	case ETetrisInputCommand::MoveLeft:
+	case ETetrisInputCommand::MoveRight:
+	case ETetrisInputCommand::Rotate:
+		KeysUsed++;
+		break;
+	case ETetrisInputCommand::MoveDown:
+	case ETetrisInputCommand::SoftDropToFloor:
+		bSoftDropped = true;
+		break;
+	default:
+		break;
+	}
+}
+
+FTetrisFinesseResult FTetrisFinesseTracker::EndPiece(EPieceType PieceType, int32 Rotation, int32 X)
+{
+	FTetrisFinesseResult Result;
+	Result.PieceType = PieceType;
+	Result.Rotation = Rotation;
+	Result.X = X;
+	Result.KeysUsed = KeysUsed;
+
+	const FTetrisFinesseEntry& Entry = TetrisFinesse::GetEntry(PieceType, Rotation, X);
+	Result.KeysMinimal = Entry.NumKeys;
+	Result.bJudged = bFromSpawn && !bSoftDropped && Entry.bReachable;
+
+	if (Result.bJudged)
+	{
+		PiecesJudged++;
+		if (Result.IsFault())
+		{
+			Faults++;
+			ExtraKeys += Result.KeysUsed - Result.KeysMinimal;
+		}
+	}
+
+	// 次のピースは BeginPiece まで判定しない
+	BeginPiece(false);
+	return Result;
+}
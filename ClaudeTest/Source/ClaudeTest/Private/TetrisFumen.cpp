@@ -0,0 +1,612 @@
+#include "TetrisFumen.h"
+#include "Algo/Reverse.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+	constexpr int32 WIDTH = FTetrisFumenPage::WIDTH;
+	constexpr int32 FIELD_TOP = FTetrisFumenPage::FIELD_HEIGHT;
+	// 盤面 + 床下の1行
+	constexpr int32 FIELD_CELLS = (FIELD_TOP + 1) * WIDTH;
+	constexpr int32 PACKED_ROW_MASK_BITS = WIDTH * TetrisCellPacking::BITS_PER_CELL;
+	constexpr uint64 PACKED_ROW_MASK = (uint64(1) << PACKED_ROW_MASK_BITS) - 1;
+
+	// 盤面が前のページと同じ（差分 0 が 240 マス続く）
+	constexpr int32 UNCHANGED_FIELD_VALUE = 8 * FIELD_CELLS + FIELD_CELLS - 1;
+	constexpr int32 MAX_COMMENT_LENGTH = 64 * 64 - 1;
+
+	const TCHAR ENCODE_TABLE[] = TEXT("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+
+	struct FDecodeTable
+	{
+		int8 Values[128];
+
+		FDecodeTable()
+		{
+			FMemory::Memset(Values, -1, sizeof(Values));
+			for (int32 Index = 0; Index < 64; Index++)
+			{
+				Values[ENCODE_TABLE[Index]] = static_cast<int8>(Index);
+			}
+		}
+	};
+
+	// fumen のブロック番号（0 = 空, 1 I, 2 L, 3 O, 4 Z, 5 T, 6 J, 7 S, 8 灰色）と TetrisCellPacking のセル値
+	const uint8 FUMEN_TO_CELL[9] = { 0, 1, 7, 2, 5, 3, 6, 4, TetrisCellPacking::CELL_UNTYPED };
+	const uint8 CELL_TO_FUMEN[16] = { 0, 1, 3, 5, 7, 4, 6, 2, 8, 8, 8, 8, 8, 8, 8, 8 };
+
+	// 出現時の向きのブロック（fumen の回転中心から、Y は上向き）。添字は fumen のブロック番号
+	const int8 PIECE_BLOCKS[8][4][2] = {
+		{},
+		{ { 0, 0 }, { -1, 0 }, { 1, 0 }, { 2, 0 } },	// I
+		{ { 0, 0 }, { -1, 0 }, { 1, 0 }, { 1, 1 } },	// L
+		{ { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } },		// O
+		{ { 0, 0 }, { 1, 0 }, { 0, 1 }, { -1, 1 } },	// Z
+		{ { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, 1 } },	// T
+		{ { 0, 0 }, { -1, 0 }, { 1, 0 }, { -1, 1 } },	// J
+		{ { 0, 0 }, { -1, 0 }, { 0, 1 }, { 1, 1 } },	// S
+	};
+
+	// 回転の符号（0 = 逆向き, 1 = 右, 2 = 出現時, 3 = 左）と時計回りの回転数
+	const uint8 ROTATION_FROM_CODE[4] = { 2, 1, 0, 3 };
+	const uint8 ROTATION_TO_CODE[4] = { 2, 1, 0, 3 };
+
+	// 旧 fumen の座標（O・I・S・Z の一部の向きは中心がずれている）からの補正
+	void GetCoordinateAdjustment(uint8 FumenPiece, uint8 Rotation, int32& OutDX, int32& OutDY)
+	{
+		OutDX = 0;
+		OutDY = 0;
+		switch (FumenPiece)
+		{
+		case 3: // O
+			OutDX = (Rotation == 2 || Rotation == 3) ? 1 : 0;
+			OutDY = (Rotation == 0 || Rotation == 3) ? -1 : 0;
+			break;
+		case 1: // I
+			OutDX = Rotation == 2 ? 1 : 0;
+			OutDY = Rotation == 3 ? -1 : 0;
+			break;
+		case 7: // S
+			OutDX = Rotation == 1 ? -1 : 0;
+			OutDY = Rotation == 0 ? -1 : 0;
+			break;
+		case 4: // Z
+			OutDX = Rotation == 3 ? 1 : 0;
+			OutDY = Rotation == 0 ? -1 : 0;
+			break;
+		default:
+			break;
+		}
+	}
+
+	// 1ページ分の盤面（fumen のブロック番号。上の行から、最後の10マスが床下の行）
+	struct FField
+	{
+		uint8 Cells[FIELD_CELLS] = {};
+
+		static int32 GetIndex(int32 X, int32 Y)
+		{
+			return (FIELD_TOP - 1 - Y) * WIDTH + X;
+		}
+
+		void FromPage(const FTetrisFumenPage& Page)
+		{
+			for (int32 Y = -1; Y < FIELD_TOP; Y++)
+			{
+				const uint64 Row = Y < 0 ? Page.GarbageRow : Page.Rows[Y];
+				uint8* RowCells = Cells + GetIndex(0, Y);
+				for (int32 X = 0; X < WIDTH; X++)
+				{
+					RowCells[X] = CELL_TO_FUMEN[TetrisCellPacking::GetPackedCell(Row, X)];
+				}
+			}
+		}
+
+		void ToPage(FTetrisFumenPage& Page) const
+		{
+			for (int32 Y = -1; Y < FIELD_TOP; Y++)
+			{
+				const uint8* RowCells = Cells + GetIndex(0, Y);
+				uint64 Row = 0;
+				for (int32 X = 0; X < WIDTH; X++)
+				{
+					Row |= uint64(FUMEN_TO_CELL[RowCells[X]]) << (X * TetrisCellPacking::BITS_PER_CELL);
+				}
+				(Y < 0 ? Page.GarbageRow : Page.Rows[Y]) = Row;
+			}
+		}
+
+		// 次のページの元になる盤面：ピースを置く → ラインを消す → せり上がる → 反転する（fumen と同じ順）
+		bool ApplyLock(const FTetrisFumenPage& Page)
+		{
+			if (!Page.bLock)
+			{
+				return true;
+			}
+
+			if (Page.PieceType != EPieceType::None)
+			{
+				const uint8 FumenPiece = CELL_TO_FUMEN[static_cast<uint8>(Page.PieceType)];
+				for (const int8(&Block)[2] : PIECE_BLOCKS[FumenPiece])
+				{
+					// 右: (y, -x)、逆向き: (-x, -y)、左: (-y, x)
+					int32 DX = Block[0];
+					int32 DY = Block[1];
+					for (int32 Step = 0; Step < (Page.Rotation & 3); Step++)
+					{
+						const int32 OldDX = DX;
+						DX = DY;
+						DY = -OldDX;
+					}
+
+					const int32 X = Page.X + DX;
+					const int32 Y = Page.Y + DY;
+					if (X < 0 || X >= WIDTH || Y < -1 || Y >= FIELD_TOP)
+					{
+						return false;
+					}
+					Cells[GetIndex(X, Y)] = FumenPiece;
+				}
+			}
+
+			// 床下の行は消さない
+			int32 WriteY = 0;
+			for (int32 Y = 0; Y < FIELD_TOP; Y++)
+			{
+				const uint8* RowCells = Cells + GetIndex(0, Y);
+				bool bFull = true;
+				for (int32 X = 0; X < WIDTH; X++)
+				{
+					bFull &= RowCells[X] != 0;
+				}
+				if (bFull)
+				{
+					continue;
+				}
+				if (WriteY != Y)
+				{
+					FMemory::Memcpy(Cells + GetIndex(0, WriteY), RowCells, WIDTH);
+				}
+				WriteY++;
+			}
+			for (; WriteY < FIELD_TOP; WriteY++)
+			{
+				FMemory::Memzero(Cells + GetIndex(0, WriteY), WIDTH);
+			}
+
+			if (Page.bRise)
+			{
+				// 盤面は上の行から並んでいるので、1行ぶん前に詰めると床下の行が一番下に入る
+				FMemory::Memmove(Cells, Cells + WIDTH, FIELD_TOP * WIDTH);
+				FMemory::Memzero(Cells + GetIndex(0, -1), WIDTH);
+			}
+
+			if (Page.bMirror)
+			{
+				for (int32 Y = 0; Y < FIELD_TOP; Y++)
+				{
+					uint8* RowCells = Cells + GetIndex(0, Y);
+					Algo::Reverse(RowCells, WIDTH);
+				}
+			}
+			return true;
+		}
+	};
+
+	// 64 進の読み出し（下の桁から。'?' は飛ばす）
+	struct FReader
+	{
+		const TCHAR* Data = nullptr;
+		bool bError = false;
+
+		void SkipSeparators()
+		{
+			while (*Data == TEXT('?'))
+			{
+				Data++;
+			}
+		}
+
+		bool IsAtEnd()
+		{
+			SkipSeparators();
+			return *Data == TEXT('\0');
+		}
+
+		int32 Poll(int32 NumChars)
+		{
+			static const FDecodeTable DecodeTable;
+
+			int32 Value = 0;
+			int32 Scale = 1;
+			for (int32 Index = 0; Index < NumChars; Index++)
+			{
+				SkipSeparators();
+				const TCHAR Char = *Data;
+				const int32 Digit = (Char > 0 && Char < 128) ? DecodeTable.Values[Char] : -1;
+				if (Digit < 0)
+				{
+					bError = true;
+					return 0;
+				}
+				Data++;
+				Value += Digit * Scale;
+				Scale *= 64;
+			}
+			return Value;
+		}
+	};
+
+	// 64 進の書き込み
+	struct FWriter
+	{
+		TArray<uint8, TInlineAllocator<64>> Values;
+
+		void Push(int32 Value, int32 NumChars)
+		{
+			for (int32 Index = 0; Index < NumChars; Index++)
+			{
+				Values.Add(static_cast<uint8>(Value % 64));
+				Value /= 64;
+			}
+		}
+	};
+
+	// コメントは JavaScript の escape() をかけた ASCII
+	bool IsUnescapedChar(TCHAR Char)
+	{
+		return (Char >= TEXT('A') && Char <= TEXT('Z')) || (Char >= TEXT('a') && Char <= TEXT('z')) || (Char >= TEXT('0') && Char <= TEXT('9'))
+			|| Char == TEXT('@') || Char == TEXT('*') || Char == TEXT('_') || Char == TEXT('+') || Char == TEXT('-') || Char == TEXT('.') || Char == TEXT('/');
+	}
+
+	void EscapeComment(const FString& Comment, FString& OutEscaped)
+	{
+		OutEscaped.Reset(Comment.Len());
+		for (TCHAR Char : Comment)
+		{
+			if (IsUnescapedChar(Char))
+			{
+				OutEscaped.AppendChar(Char);
+			}
+			else if (static_cast<uint32>(Char) < 256)
+			{
+				OutEscaped.Appendf(TEXT("%%%02X"), static_cast<uint32>(Char));
+			}
+			else
+			{
+				OutEscaped.Appendf(TEXT("%%u%04X"), static_cast<uint32>(Char) & 0xFFFF);
+			}
+		}
+	}
+
+	void UnescapeComment(const FString& Escaped, FString& OutComment)
+	{
+		OutComment.Reset(Escaped.Len());
+		for (int32 Index = 0; Index < Escaped.Len(); Index++)
+		{
+			const TCHAR Char = Escaped[Index];
+			const bool bUnicode = Char == TEXT('%') && Index + 5 < Escaped.Len() && Escaped[Index + 1] == TEXT('u');
+			const int32 NumDigits = bUnicode ? 4 : 2;
+			const int32 DigitsStart = Index + (bUnicode ? 2 : 1);
+			if (Char != TEXT('%') || DigitsStart + NumDigits > Escaped.Len())
+			{
+				OutComment.AppendChar(Char);
+				continue;
+			}
+
+			uint32 Code = 0;
+			bool bValid = true;
+			for (int32 Digit = 0; Digit < NumDigits; Digit++)
+			{
+				const TCHAR HexChar = Escaped[DigitsStart + Digit];
+				bValid &= FChar::IsHexDigit(HexChar);
+				Code = Code * 16 + FParse::HexDigit(HexChar);
+			}
+			if (!bValid)
+			{
+				OutComment.AppendChar(Char);
+				continue;
+			}
+			OutComment.AppendChar(static_cast<TCHAR>(Code));
+			Index = DigitsStart + NumDigits - 1;
+		}
+	}
+
+	// "v115@" の後ろを指す（URL の途中でもよい）。無ければ nullptr
+	const TCHAR* FindData(const TCHAR* Data)
+	{
+		for (const TCHAR* Found = FCString::Strstr(Data, TEXT("115@")); Found; Found = FCString::Strstr(Found + 1, TEXT("115@")))
+		{
+			// v = 編集、m = モバイル、d = 表示だけ。データは同じ
+			if (Found > Data && (Found[-1] == TEXT('v') || Found[-1] == TEXT('m') || Found[-1] == TEXT('d')))
+			{
+				return Found + 4;
+			}
+		}
+		return nullptr;
+	}
+
+	// ページを1つ読むたびに OnPage を呼ぶ（false を返したら止める）
+	bool DecodePages(const TCHAR* Data, TFunctionRef<bool(const FTetrisFumenPage&)> OnPage)
+	{
+		const TCHAR* Start = Data ? FindData(Data) : nullptr;
+		if (!Start)
+		{
+			return false;
+		}
+
+		FReader Reader;
+		Reader.Data = Start;
+
+		FField Base;
+		FTetrisFumenPage Page;
+		FString Escaped;
+		int32 RepeatCount = 0;
+		while (!Reader.IsAtEnd())
+		{
+			FField Field = Base;
+			if (RepeatCount > 0)
+			{
+				RepeatCount--;
+			}
+			else
+			{
+				bool bChanged = false;
+				for (int32 Index = 0; Index < FIELD_CELLS;)
+				{
+					const int32 Value = Reader.Poll(2);
+					const int32 Diff = Value / FIELD_CELLS;
+					const int32 Run = Value % FIELD_CELLS + 1;
+					if (Reader.bError || Index + Run > FIELD_CELLS)
+					{
+						return false;
+					}
+					for (int32 Cell = Index; Cell < Index + Run; Cell++)
+					{
+						const int32 Block = Field.Cells[Cell] + Diff - 8;
+						if (Block < 0 || Block > 8)
+						{
+							return false;
+						}
+						Field.Cells[Cell] = static_cast<uint8>(Block);
+					}
+					bChanged |= Diff != 8;
+					Index += Run;
+				}
+				if (!bChanged)
+				{
+					RepeatCount = Reader.Poll(1);
+				}
+			}
+
+			// 操作：ブロック番号 + 8 × 回転 + 32 × 座標 + フラグ（せり上がり・反転・色・コメント・固定しない）
+			int32 Action = Reader.Poll(3);
+			const uint8 FumenPiece = static_cast<uint8>(Action % 8);
+			Action /= 8;
+			const uint8 Rotation = ROTATION_FROM_CODE[Action % 4];
+			Action /= 4;
+			const int32 Coordinate = Action % FIELD_CELLS;
+			Action /= FIELD_CELLS;
+			Page.bRise = (Action & 1) != 0;
+			Page.bMirror = (Action & 2) != 0;
+			const bool bComment = (Action & 8) != 0;
+			Page.bLock = (Action & 16) == 0;
+			if (Reader.bError || FumenPiece > 7)
+			{
+				return false;
+			}
+
+			Page.PieceType = FumenPiece != 0 ? static_cast<EPieceType>(FUMEN_TO_CELL[FumenPiece]) : EPieceType::None;
+			Page.Rotation = FumenPiece != 0 ? Rotation : 0;
+			int32 DX = 0;
+			int32 DY = 0;
+			GetCoordinateAdjustment(FumenPiece, Rotation, DX, DY);
+			Page.X = FumenPiece != 0 ? static_cast<int8>(Coordinate % WIDTH + DX) : 0;
+			Page.Y = FumenPiece != 0 ? static_cast<int8>(FIELD_TOP - 1 - Coordinate / WIDTH + DY) : 0;
+
+			// コメント：長さ（2文字）+ 4文字ずつ 96 進で5文字。無ければ前のページのまま
+			if (bComment)
+			{
+				const int32 Length = Reader.Poll(2);
+				Escaped.Reset(Length);
+				for (int32 Index = 0; Index < Length && !Reader.bError; Index += 4)
+				{
+					int32 Value = Reader.Poll(5);
+					for (int32 Char = Index; Char < FMath::Min(Index + 4, Length); Char++)
+					{
+						Escaped.AppendChar(static_cast<TCHAR>(Value % 96 + 32));
+						Value /= 96;
+					}
+				}
+				if (Reader.bError)
+				{
+					return false;
+				}
+				UnescapeComment(Escaped, Page.Comment);
+			}
+
+			Field.ToPage(Page);
+			if (!OnPage(Page))
+			{
+				return true;
+			}
+
+			Base = Field;
+			if (!Base.ApplyLock(Page))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+bool FTetrisFumenPage::ToPackedRows(uint64* OutRows, int32 Height) const
+{
+	bool bFits = true;
+	for (int32 Y = 0; Y < FIELD_HEIGHT; Y++)
+	{
+		bFits &= Y < Height || Rows[Y] == 0;
+	}
+	for (int32 RowIndex = 0; RowIndex < Height; RowIndex++)
+	{
+		const int32 Y = Height - 1 - RowIndex;
+		OutRows[RowIndex] = Y < FIELD_HEIGHT ? Rows[Y] : 0;
+	}
+	return bFits;
+}
+
+bool FTetrisFumenPage::FromPackedRows(const uint64* InRows, int32 Height)
+{
+	bool bFits = true;
+	FMemory::Memzero(Rows, sizeof(Rows));
+	GarbageRow = 0;
+	for (int32 RowIndex = 0; RowIndex < Height; RowIndex++)
+	{
+		const int32 Y = Height - 1 - RowIndex;
+		const uint64 Row = InRows[RowIndex] & PACKED_ROW_MASK;
+		bFits &= (Y < FIELD_HEIGHT || Row == 0) && Row == InRows[RowIndex];
+		if (Y < FIELD_HEIGHT)
+		{
+			Rows[Y] = Row;
+		}
+	}
+	return bFits;
+}
+
+bool TetrisFumen::Decode(const TCHAR* Data, TArray<FTetrisFumenPage>& OutPages)
+{
+	OutPages.Reset();
+	return DecodePages(Data, [&OutPages](const FTetrisFumenPage& Page)
+	{
+		OutPages.Add(Page);
+		return true;
+	});
+}
+
+bool TetrisFumen::DecodeFirstPage(const TCHAR* Data, FTetrisFumenPage& OutPage)
+{
+	bool bFound = false;
+	const bool bDecoded = DecodePages(Data, [&OutPage, &bFound](const FTetrisFumenPage& Page)
+	{
+		OutPage = Page;
+		bFound = true;
+		return false;
+	});
+	return bDecoded && bFound;
+}
+
+bool TetrisFumen::Encode(TArrayView<const FTetrisFumenPage> Pages, FString& OutData)
+{
+	OutData.Reset();
+
+	FWriter Writer;
+	FField Base;
+	FString PrevComment;
+	FString Escaped;
+	int32 LastRepeatIndex = INDEX_NONE;
+	for (int32 PageIndex = 0; PageIndex < Pages.Num(); PageIndex++)
+	{
+		const FTetrisFumenPage& Page = Pages[PageIndex];
+		FField Field;
+		Field.FromPage(Page);
+
+		// 盤面：同じなら前の「同じ盤面が続く数」を1つ増やす（63 まで）
+		if (FMemory::Memcmp(Field.Cells, Base.Cells, FIELD_CELLS) != 0)
+		{
+			int32 RunDiff = Field.Cells[0] - Base.Cells[0] + 8;
+			int32 RunLength = 0;
+			for (int32 Index = 0; Index < FIELD_CELLS; Index++)
+			{
+				const int32 Diff = Field.Cells[Index] - Base.Cells[Index] + 8;
+				if (Diff != RunDiff)
+				{
+					Writer.Push(RunDiff * FIELD_CELLS + RunLength - 1, 2);
+					RunDiff = Diff;
+					RunLength = 0;
+				}
+				RunLength++;
+			}
+			Writer.Push(RunDiff * FIELD_CELLS + RunLength - 1, 2);
+			LastRepeatIndex = INDEX_NONE;
+		}
+		else if (LastRepeatIndex == INDEX_NONE || Writer.Values[LastRepeatIndex] == 63)
+		{
+			Writer.Push(UNCHANGED_FIELD_VALUE, 2);
+			Writer.Push(0, 1);
+			LastRepeatIndex = Writer.Values.Num() - 1;
+		}
+		else
+		{
+			Writer.Values[LastRepeatIndex]++;
+		}
+
+		// 操作（色フラグは1ページ目だけ立てる。ピースが無ければ回転・座標とも 0）
+		const bool bComment = Page.Comment != PrevComment;
+		uint8 FumenPiece = 0;
+		int32 Coordinate = 0;
+		int32 RotationCode = 0;
+		if (Page.PieceType != EPieceType::None)
+		{
+			FumenPiece = CELL_TO_FUMEN[static_cast<uint8>(Page.PieceType)];
+			const uint8 Rotation = Page.Rotation & 3;
+			RotationCode = ROTATION_TO_CODE[Rotation];
+			int32 DX = 0;
+			int32 DY = 0;
+			GetCoordinateAdjustment(FumenPiece, Rotation, DX, DY);
+			const int32 X = Page.X - DX;
+			const int32 Y = Page.Y - DY;
+			if (FumenPiece > 7 || X < 0 || X >= WIDTH || Y < -1 || Y >= FIELD_TOP)
+			{
+				return false;
+			}
+			Coordinate = FField::GetIndex(X, Y);
+		}
+
+		int32 Flags = (Page.bRise ? 1 : 0) | (Page.bMirror ? 2 : 0) | (PageIndex == 0 ? 4 : 0) | (bComment ? 8 : 0) | (Page.bLock ? 0 : 16);
+		Writer.Push(((Flags * FIELD_CELLS + Coordinate) * 4 + RotationCode) * 8 + FumenPiece, 3);
+
+		if (bComment)
+		{
+			EscapeComment(Page.Comment, Escaped);
+			if (Escaped.Len() > MAX_COMMENT_LENGTH)
+			{
+				return false;
+			}
+			Writer.Push(Escaped.Len(), 2);
+			for (int32 Index = 0; Index < Escaped.Len(); Index += 4)
+			{
+				int32 Value = 0;
+				int32 Scale = 1;
+				for (int32 Char = Index; Char < FMath::Min(Index + 4, Escaped.Len()); Char++)
+				{
+					Value += FMath::Clamp<int32>(Escaped[Char] - 32, 0, 95) * Scale;
+					Scale *= 96;
+				}
+				Writer.Push(Value, 5);
+			}
+			PrevComment = Page.Comment;
+		}
+
+		Base = Field;
+		if (!Base.ApplyLock(Page))
+		{
+			return false;
+		}
+	}
+
+	// fumen と同じく、42 文字の後は 47 文字ごとに '?' を挟む
+	const int32 NumValues = Writer.Values.Num();
+	const int32 NumSeparators = NumValues < 41 ? 0 : FMath::DivideAndRoundUp(FMath::Max(NumValues - 42, 0), 47);
+	OutData.Reserve(5 + NumValues + NumSeparators);
+	OutData.Append(TEXT("v115@"));
+	for (int32 Index = 0; Index < NumValues; Index++)
+	{
+		if (NumValues >= 41 && Index >= 42 && (Index - 42) % 47 == 0)
+		{
+			OutData.AppendChar(TEXT('?'));
+		}
+		OutData.AppendChar(ENCODE_TABLE[Writer.Values[Index]]);
+	}
+	return true;
+}
@@ -1,13 +1,27 @@
 #include "TetrisGameMode.h"
 #include "TetrisBoard.h"
 #include "TetrisPiece.h"
+#include "TetrisZobrist.h"
+#include "TetrisRules.h"
+#include "TetrisRuleset.h"
+#include "TetrisWorldSubsystem.h"
+#include "TetrisSimulationThread.h"
+#include "TetrisDatasetExporter.h"
+#include "TetrisLatency.h"
+#include "TetrisPerfectClear.h"
+#include "TetrisPieceTables.h"
+#include "TetrisStats.h"
 #include "Engine/World.h"
 #include "Engine/Engine.h"
 #include "TimerManager.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 
 ATetrisGameMode::ATetrisGameMode()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// 更新は UTetrisWorldSubsystem が行う
+	PrimaryActorTick.bCanEverTick = false;
 
 	// 初期設定
 	CurrentGameState = ETetrisGameState::Menu;
@@ -21,33 +35,111 @@ ATetrisGameMode::ATetrisGameMode()
 	FallSpeed = BaseFallSpeed;
 	FallTimer = 0.0f;
 	bEnableGhost = true;
-	MaxLevel = 15;
+	bEnablePerfectClearHints = false;
+	bEnableFinesseAnalysis = false;
+	MaxLevel = TetrisRules::DEFAULT_MAX_LEVEL;
+	Ruleset = ETetrisRuleset::Modern;
+	LineClearDelay = 0.4f;
+	LineClearTimer = 0.0f;
+	RandomSeed = 0;
+	bOverrideRandomizerType = false;
+	RandomizerType = ETetrisRandomizerType::SevenBag;
+	PreviewCount = 6;
+	QueueHash = 0;
+
+	// イベント通知
+	PublishedGameState = CurrentGameState;
+	PublishedStats = GameStats;
+	PublishedNextPieceType = NextPieceType;
+	PendingLinesClearedEvent = 0;
+
+	// 練習モード
+	bEnableUndo = false;
+	MaxUndoSnapshots = 1000;
+	UndoHead = 0;
+	UndoCount = 0;
+	FinesseTracker.Reset();
+	PendingFinesseFaults.Reset();
+
+	// ワーカースレッド実行
+	bRunSimulationOnWorkerThread = false;
+	SimulationStepsPerSecond = 1000;
+
+	// データセット
+	bExportDataset = false;
+}
 
-	// バッグシステムの初期化
-	BagIndex = 0;
+ATetrisGameMode::~ATetrisGameMode()
+{
+	StopSimulationThread();
+	CloseDatasetExporter();
 }
 
 void ATetrisGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// ヒントの最初の問い合わせで止まらないよう、表は先にマップしておく
+	if (bEnablePerfectClearHints && UsesModernKicks())
+	{
+		FTetrisPerfectClearTable::GetShared();
+	}
+	if (bEnableFinesseAnalysis && UsesModernKicks())
+	{
+		TetrisFinesse::Prebuild();
+	}
+
 	InitializeGame();
+
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->RegisterGame(this);
+	}
+}
+
+void ATetrisGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->UnregisterGame(this);
+	}
+
+	StopSimulationThread();
+	CloseDatasetExporter();
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void ATetrisGameMode::Tick(float DeltaTime)
+void ATetrisGameMode::TickSimulation(float DeltaTime)
 {
-	Super::Tick(DeltaTime);
+	// ワーカースレッド実行中は最新の公開フレームを反映するだけ
+	if (SimulationThread)
+	{
+		if (const FTetrisSimFrame* Frame = SimulationThread->ConsumeLatestFrame())
+		{
+			ApplySimulationFrame(*Frame);
+		}
+		return;
+	}
 
 	if (CurrentGameState == ETetrisGameState::Playing)
 	{
-		HandleAutoFall(DeltaTime);
+		SCOPE_CYCLE_COUNTER(STAT_TetrisSimStep);
+		if (PendingClearLines.Num() > 0)
+		{
+			UpdateLineClear(DeltaTime);
+		}
+		else
+		{
+			HandleAutoFall(DeltaTime);
+		}
 	}
 }
 
 void ATetrisGameMode::InitializeGame()
 {
-	// ピースバッグの初期化
-	InitializePieceBag();
+	// ネクストキューの初期化
+	ResetPieceQueue();
 
 	// ボードのセットアップ
 	SetupBoard();
@@ -64,9 +156,11 @@ void ATetrisGameMode::SetupBoard()
 		FRotator BoardRotation = FRotator::ZeroRotator;
 
 		TetrisBoard = GetWorld()->SpawnActor<ATetrisBoard>(ATetrisBoard::StaticClass(), BoardLocation, BoardRotation);
+		INC_DWORD_STAT(STAT_TetrisActorsSpawned);
 		
 		if (TetrisBoard)
 		{
+			TetrisBoard->SetGhostEnabled(bEnableGhost);
 			UE_LOG(LogTemp, Warning, TEXT("Tetris Board created successfully"));
 		}
 	}
@@ -74,6 +168,9 @@ void ATetrisGameMode::SetupBoard()
 
 void ATetrisGameMode::StartNewGame()
 {
+	StopSimulationThread();
+	CloseDatasetExporter();
+
 	// ゲーム統計のリセット
 	GameStats = FTetrisGameStats();
 	
@@ -85,19 +182,34 @@ void ATetrisGameMode::StartNewGame()
 
 	// 現在のピースをクリア
 	CleanupCurrentPiece();
+	PendingClearLines.Reset();
+	LineClearTimer = 0.0f;
 
-	// ゲーム速度のリセット
-	FallSpeed = BaseFallSpeed;
+	// ゲーム速度のリセット（レベル1の落下間隔）
+	UpdateFallSpeed();
 	FallTimer = 0.0f;
 
-	// 次のピースを設定
-	NextPieceType = GenerateRandomPieceType();
+	// シードからキューを作り直す（同じシードなら同じ順序になる）
+	ResetPieceQueue();
+	UndoHead = 0;
+	UndoCount = 0;
 
-	// 最初のピースをスポーン
-	SpawnNewPiece();
+	if (bExportDataset)
+	{
+		OpenDatasetExporter();
+	}
 
-	// ゲーム状態を更新
+	// ワーカースレッド実行：ピースの生成以降はスレッド側で進める
+	if (bRunSimulationOnWorkerThread && StartSimulationThread())
+	{
+		CurrentGameState = ETetrisGameState::Playing;
+		UE_LOG(LogTemp, Warning, TEXT("New game started on simulation thread (%d steps/s)"), SimulationThread->GetStepsPerSecond());
+		return;
+	}
+
+	// ゲーム状態を先に Playing にして、最初のピースのスポーンでアンドゥ用スナップショットを1回だけ取る
 	CurrentGameState = ETetrisGameState::Playing;
+	SpawnNewPiece();
 
 	UE_LOG(LogTemp, Warning, TEXT("New game started"));
 }
@@ -107,6 +219,10 @@ void ATetrisGameMode::PauseGame()
 	if (CurrentGameState == ETetrisGameState::Playing)
 	{
 		CurrentGameState = ETetrisGameState::Paused;
+		if (SimulationThread)
+		{
+			SimulationThread->SetPaused(true);
+		}
 		UE_LOG(LogTemp, Warning, TEXT("Game paused"));
 	}
 }
@@ -116,6 +232,10 @@ void ATetrisGameMode::ResumeGame()
 	if (CurrentGameState == ETetrisGameState::Paused)
 	{
 		CurrentGameState = ETetrisGameState::Playing;
+		if (SimulationThread)
+		{
+			SimulationThread->SetPaused(false);
+		}
 		UE_LOG(LogTemp, Warning, TEXT("Game resumed"));
 	}
 }
@@ -123,6 +243,8 @@ void ATetrisGameMode::ResumeGame()
 void ATetrisGameMode::EndGame()
 {
 	CurrentGameState = ETetrisGameState::GameOver;
+	StopSimulationThread();
+	CloseDatasetExporter();
 	CleanupCurrentPiece();
 
 	UE_LOG(LogTemp, Warning, TEXT("Game Over! Final Score: %d"), GameStats.Score);
@@ -146,15 +268,15 @@ void ATetrisGameMode::SpawnNewPiece()
 	// 新しいピースを生成
 	FVector PieceLocation = FVector(0.0f, 0.0f, 100.0f);
 	CurrentPiece = GetWorld()->SpawnActor<ATetrisPiece>(ATetrisPiece::StaticClass(), PieceLocation, FRotator::ZeroRotator);
+	INC_DWORD_STAT(STAT_TetrisActorsSpawned);
 
 	if (CurrentPiece)
 	{
-		EPieceType PieceType = NextPieceType != EPieceType::None ? NextPieceType : GenerateRandomPieceType();
+		// キューの先頭を取り出す（空いたスロットは補充される）
+		EPieceType PieceType = GenerateRandomPieceType();
+		CurrentPiece->SetRuleset(Ruleset);
 		CurrentPiece->InitializePiece(PieceType, TetrisBoard);
 
-		// 次のピースを生成
-		NextPieceType = GenerateRandomPieceType();
-
 		// ゲームオーバー判定
 		if (IsGameOverConditionMet())
 		{
@@ -163,7 +285,12 @@ void ATetrisGameMode::SpawnNewPiece()
 		}
 
 		GameStats.PiecesPlaced++;
-		UpdateGameStats();
+		FinesseTracker.BeginPiece();
+
+		if (CurrentGameState == ETetrisGameState::Playing)
+		{
+			PushUndoSnapshot();
+		}
 
 		UE_LOG(LogTemp, Warning, TEXT("New piece spawned: %d"), (int32)PieceType);
 	}
@@ -171,7 +298,17 @@ void ATetrisGameMode::SpawnNewPiece()
 
 EPieceType ATetrisGameMode::GenerateRandomPieceType()
 {
-	return GetNextPieceFromBag();
+	const EPieceType PieceType = PieceQueue.Pop();
+	NextPieceType = PieceQueue.Peek(0);
+	RefreshQueueHash();
+	return PieceType;
+}
+
+TArray<EPieceType> ATetrisGameMode::GetPreviewPieces(int32 MaxCount) const
+{
+	TArray<EPieceType> Pieces;
+	PieceQueue.GetPreview(Pieces, MaxCount);
+	return Pieces;
 }
 
 void ATetrisGameMode::FixCurrentPiece()
@@ -181,14 +318,67 @@ void ATetrisGameMode::FixCurrentPiece()
 		return;
 	}
 
+	// 学習用データセット：固定前の状態を取っておき、消去の結果と合わせて書き出す
+	FTetrisDecisionRecord Record;
+	const int32 ScoreBefore = GameStats.Score;
+	const int32 LinesBefore = GameStats.LinesCleared;
+	if (DatasetExporter)
+	{
+		Record.GameId = static_cast<uint32>(PieceQueue.InitialSeed);
+		Record.PieceIndex = static_cast<uint32>(GameStats.PiecesPlaced - 1);
+		const int32 Height = FMath::Min(TetrisBoard->GetBoardHeight(), FTetrisDecisionRecord::MAX_HEIGHT);
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			Record.BoardRows[Y] = TetrisCellPacking::GetOccupancyBits(TetrisBoard->GetPackedRow(Y));
+		}
+		// 接地・ハードドロップではピース側で固定済み（セルが盤面に入っている）なので、ピースのセルを抜いて固定前の盤面にする
+		if (CurrentPiece->IsFixed())
+		{
+			for (const FTetrisCoordinate& BlockPos : CurrentPiece->GetCurrentBlockPositions())
+			{
+				if (BlockPos.Y >= 0 && BlockPos.Y < Height)
+				{
+					Record.BoardRows[BlockPos.Y] &= ~static_cast<uint16>(1u << BlockPos.X);
+				}
+			}
+		}
+		Record.Piece = CurrentPiece->GetPieceType();
+		for (int32 Slot = 0; Slot < PieceQueue.GetPreviewCount(); Slot++)
+		{
+			Record.Queue[Slot] = PieceQueue.Peek(Slot);
+		}
+		Record.Rotation = static_cast<uint8>(CurrentPiece->GetCurrentRotation());
+		Record.X = static_cast<int8>(CurrentPiece->GetBoardPosition().X);
+		Record.Y = static_cast<int8>(CurrentPiece->GetBoardPosition().Y);
+	}
+
+	if (bEnableFinesseAnalysis && UsesModernKicks())
+	{
+		const FTetrisFinesseResult Finesse = FinesseTracker.EndPiece(CurrentPiece->GetPieceType(), CurrentPiece->GetCurrentRotation(), CurrentPiece->GetBoardPosition().X);
+		if (Finesse.IsFault())
+		{
+			PendingFinesseFaults.Add(Finesse);
+		}
+	}
+
 	// ピースを固定
 	CurrentPiece->FixPiece();
 
 	// 完成したラインをチェック
 	ProcessCompletedLines();
 
-	// 新しいピースを生成
-	SpawnNewPiece();
+	if (DatasetExporter)
+	{
+		Record.LinesCleared = static_cast<uint8>(GameStats.LinesCleared - LinesBefore);
+		Record.Reward = GameStats.Score - ScoreBefore;
+		DatasetExporter->Add(Record);
+	}
+
+	// 新しいピースを生成（ライン消去演出中は演出終了後）
+	if (PendingClearLines.Num() == 0)
+	{
+		SpawnNewPiece();
+	}
 }
 
 void ATetrisGameMode::ProcessCompletedLines()
@@ -203,8 +393,18 @@ void ATetrisGameMode::ProcessCompletedLines()
 
 	if (LinesCleared > 0)
 	{
-		// ラインを削除
-		TetrisBoard->ClearLines(CompletedLines);
+		// ラインを削除（演出ありの場合は遅延時間の経過後に詰める）
+		if (LineClearDelay > 0.0f)
+		{
+			PendingClearLines = CompletedLines;
+			LineClearTimer = 0.0f;
+			CleanupCurrentPiece();
+			TetrisBoard->BeginLineClearAnimation(CompletedLines);
+		}
+		else
+		{
+			TetrisBoard->ClearLines(CompletedLines);
+		}
 
 		// スコアを追加
 		int32 LineScore = CalculateLineScore(LinesCleared);
@@ -216,7 +416,7 @@ void ATetrisGameMode::ProcessCompletedLines()
 		// レベルアップチェック
 		CheckLevelUp();
 
-		UpdateGameStats();
+		PendingLinesClearedEvent += LinesCleared;
 
 		UE_LOG(LogTemp, Warning, TEXT("Cleared %d lines, Score: %d"), LinesCleared, LineScore);
 	}
@@ -224,40 +424,17 @@ void ATetrisGameMode::ProcessCompletedLines()
 
 int32 ATetrisGameMode::CalculateLineScore(int32 LinesCleared)
 {
-	int32 BaseScore = 0;
-
-	switch (LinesCleared)
-	{
-	case 1:
-		BaseScore = TetrisConstants::SCORE_SINGLE_LINE;
-		break;
-	case 2:
-		BaseScore = TetrisConstants::SCORE_DOUBLE_LINE;
-		break;
-	case 3:
-		BaseScore = TetrisConstants::SCORE_TRIPLE_LINE;
-		break;
-	case 4:
-		BaseScore = TetrisConstants::SCORE_TETRIS;
-		break;
-	default:
-		BaseScore = TetrisConstants::SCORE_SINGLE_LINE * LinesCleared;
-		break;
-	}
-
-	return BaseScore * GameStats.Level;
+	return FTetrisRuleset::Get(Ruleset).GetLineClearScore(LinesCleared, GameStats.Level);
 }
 
 void ATetrisGameMode::AddScore(int32 Points)
 {
 	GameStats.Score += Points;
-	UpdateGameStats();
 }
 
 void ATetrisGameMode::CheckLevelUp()
 {
-	int32 NewLevel = (GameStats.LinesCleared / TetrisConstants::LINES_PER_LEVEL) + 1;
-	NewLevel = FMath::Min(NewLevel, MaxLevel);
+	const int32 NewLevel = TetrisRules::GetLevelForLines(GameStats.LinesCleared, MaxLevel);
 
 	if (NewLevel > GameStats.Level)
 	{
@@ -269,10 +446,7 @@ void ATetrisGameMode::CheckLevelUp()
 
 void ATetrisGameMode::UpdateFallSpeed()
 {
-	FallSpeed = FMath::Max(
-		BaseFallSpeed - (GameStats.Level - 1) * TetrisConstants::SPEED_INCREASE_PER_LEVEL,
-		TetrisConstants::MIN_FALL_SPEED
-	);
+	FallSpeed = FTetrisRuleset::Get(Ruleset).GetFallInterval(BaseFallSpeed, GameStats.Level);
 }
 
 float ATetrisGameMode::GetCurrentFallSpeed() const
@@ -299,6 +473,39 @@ void ATetrisGameMode::HandleAutoFall(float DeltaTime)
 	}
 }
 
+void ATetrisGameMode::UpdateLineClear(float DeltaTime)
+{
+	LineClearTimer += DeltaTime;
+
+	if (LineClearTimer >= LineClearDelay)
+	{
+		FinishLineClear();
+		return;
+	}
+
+	// 前半でフラッシュ、後半で落下
+	const float Alpha = LineClearTimer / LineClearDelay;
+	const float FlashAlpha = FMath::Clamp(Alpha * 2.0f, 0.0f, 1.0f);
+	const float FallAlpha = FMath::Clamp(Alpha * 2.0f - 1.0f, 0.0f, 1.0f);
+	if (TetrisBoard)
+	{
+		TetrisBoard->SetLineClearAnimationPhase(FlashAlpha, FallAlpha);
+	}
+}
+
+void ATetrisGameMode::FinishLineClear()
+{
+	if (TetrisBoard)
+	{
+		TetrisBoard->FinishLineClearAnimation(PendingClearLines);
+	}
+
+	PendingClearLines.Reset();
+	LineClearTimer = 0.0f;
+
+	SpawnNewPiece();
+}
+
 bool ATetrisGameMode::IsGameOverConditionMet()
 {
 	// ボードの最上行にブロックがある場合
@@ -310,6 +517,7 @@ bool ATetrisGameMode::IsGameOverConditionMet()
 	// 新しいピースが配置できない場合
 	if (CurrentPiece)
 	{
+		INC_DWORD_STAT(STAT_TetrisCollisionQueries);
 		TArray<FTetrisCoordinate> BlockPositions = CurrentPiece->GetCurrentBlockPositions();
 		for (const FTetrisCoordinate& Pos : BlockPositions)
 		{
@@ -329,49 +537,77 @@ void ATetrisGameMode::CleanupCurrentPiece()
 	{
 		CurrentPiece->Destroy();
 		CurrentPiece = nullptr;
+		INC_DWORD_STAT(STAT_TetrisActorsDestroyed);
+		INC_DWORD_STAT(STAT_TetrisGarbageTotal);
 	}
 }
 
-void ATetrisGameMode::InitializePieceBag()
+void ATetrisGameMode::ResetPieceQueue()
 {
-	PieceBag.Empty();
-	PieceBag.Add(EPieceType::I_Piece);
-	PieceBag.Add(EPieceType::O_Piece);
-	PieceBag.Add(EPieceType::T_Piece);
-	PieceBag.Add(EPieceType::S_Piece);
-	PieceBag.Add(EPieceType::Z_Piece);
-	PieceBag.Add(EPieceType::J_Piece);
-	PieceBag.Add(EPieceType::L_Piece);
+	const int32 Seed = RandomSeed != 0 ? RandomSeed : FMath::Rand();
+	PieceQueue.Initialize(GetEffectiveRandomizerType(), Seed, PreviewCount);
+	NextPieceType = PieceQueue.Peek(0);
+	RefreshQueueHash();
+}
 
-	// シャッフル
-	for (int32 i = PieceBag.Num() - 1; i > 0; i--)
+ETetrisRandomizerType ATetrisGameMode::GetEffectiveRandomizerType() const
+{
+	return bOverrideRandomizerType ? RandomizerType : FTetrisRuleset::Get(Ruleset).GetDefaultRandomizer();
+}
+
+void ATetrisGameMode::FlushEvents()
+{
+	// 値の比較だけなので変更がないフレームはほぼ無コスト
+	if (PublishedGameState != CurrentGameState)
 	{
-		int32 j = FMath::RandRange(0, i);
-		PieceBag.Swap(i, j);
+		PublishedGameState = CurrentGameState;
+		OnGameStateChanged.Broadcast(CurrentGameState);
 	}
 
-	BagIndex = 0;
-}
+	if (PublishedStats.Score != GameStats.Score)
+	{
+		OnScoreChanged.Broadcast(GameStats.Score);
+	}
 
-EPieceType ATetrisGameMode::GetNextPieceFromBag()
-{
-	if (BagIndex >= PieceBag.Num())
+	if (PublishedStats.Level != GameStats.Level)
 	{
-		InitializePieceBag();
+		OnLevelChanged.Broadcast(GameStats.Level);
 	}
 
-	return PieceBag[BagIndex++];
-}
+	if (PublishedStats.LinesCleared != GameStats.LinesCleared)
+	{
+		OnLinesChanged.Broadcast(GameStats.LinesCleared);
+	}
+	PublishedStats = GameStats;
 
-void ATetrisGameMode::UpdateGameStats()
-{
-	// ここでUIや他のシステムに統計更新を通知
-	// 実際の実装ではデリゲートやイベントを使用
+	if (PendingLinesClearedEvent > 0)
+	{
+		const int32 LinesCount = PendingLinesClearedEvent;
+		PendingLinesClearedEvent = 0;
+		OnLinesCleared.Broadcast(LinesCount);
+	}
+
+	if (PublishedNextPieceType != NextPieceType)
+	{
+		PublishedNextPieceType = NextPieceType;
+		OnNextPieceChanged.Broadcast(NextPieceType);
+	}
+
+	for (const FTetrisFinesseResult& Finesse : PendingFinesseFaults)
+	{
+		OnFinesseFault.Broadcast(Finesse.PieceType, Finesse.KeysUsed, Finesse.KeysMinimal);
+	}
+	PendingFinesseFaults.Reset();
 }
 
 // 入力処理関数
 void ATetrisGameMode::HandleMoveLeft()
 {
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::MoveLeft))
+	{
+		return;
+	}
+
 	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
 	{
 		return;
@@ -382,6 +618,11 @@ void ATetrisGameMode::HandleMoveLeft()
 
 void ATetrisGameMode::HandleMoveRight()
 {
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::MoveRight))
+	{
+		return;
+	}
+
 	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
 	{
 		return;
@@ -392,6 +633,11 @@ void ATetrisGameMode::HandleMoveRight()
 
 void ATetrisGameMode::HandleMoveDown()
 {
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::MoveDown))
+	{
+		return;
+	}
+
 	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
 	{
 		return;
@@ -400,12 +646,22 @@ void ATetrisGameMode::HandleMoveDown()
 	if (CurrentPiece->MovePiece(EMoveDirection::Down))
 	{
 		// ソフトドロップのスコア
-		AddScore(1);
+		AddScore(FTetrisRuleset::Get(Ruleset).GetSoftDropScore());
+	}
+	else if (CurrentPiece->IsFixed())
+	{
+		// 接地していた場合は自然落下と同じく固定して次のピースへ
+		FixCurrentPiece();
 	}
 }
 
 void ATetrisGameMode::HandleRotate()
 {
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::Rotate))
+	{
+		return;
+	}
+
 	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
 	{
 		return;
@@ -416,6 +672,11 @@ void ATetrisGameMode::HandleRotate()
 
 void ATetrisGameMode::HandleHardDrop()
 {
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::HardDrop))
+	{
+		return;
+	}
+
 	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
 	{
 		return;
@@ -424,12 +685,43 @@ void ATetrisGameMode::HandleHardDrop()
 	int32 DropDistance = CurrentPiece->HardDrop();
 	
 	// ハードドロップのスコア
-	AddScore(DropDistance * 2);
+	AddScore(DropDistance * FTetrisRuleset::Get(Ruleset).GetHardDropScorePerRow());
 
 	// ピースを即座に固定
 	FixCurrentPiece();
 }
 
+void ATetrisGameMode::HandleShift(EMoveDirection Direction)
+{
+	if (ForwardInputToSimulationThread(Direction == EMoveDirection::Left ? ETetrisInputCommand::ShiftLeft : ETetrisInputCommand::ShiftRight))
+	{
+		return;
+	}
+
+	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
+	{
+		return;
+	}
+
+	CurrentPiece->ShiftToWall(Direction);
+}
+
+void ATetrisGameMode::HandleSoftDropToFloor()
+{
+	if (ForwardInputToSimulationThread(ETetrisInputCommand::SoftDropToFloor))
+	{
+		return;
+	}
+
+	if (CurrentGameState != ETetrisGameState::Playing || !CurrentPiece)
+	{
+		return;
+	}
+
+	// ソフトドロップのスコアは落ちた行数分。接地しても固定は自然落下に任せる
+	AddScore(CurrentPiece->SoftDropToFloor() * FTetrisRuleset::Get(Ruleset).GetSoftDropScore());
+}
+
 void ATetrisGameMode::HandlePause()
 {
 	if (CurrentGameState == ETetrisGameState::Playing)
@@ -442,6 +734,514 @@ void ATetrisGameMode::HandlePause()
 	}
 }
 
+void ATetrisGameMode::HandleInputCommand(ETetrisInputCommand Command)
+{
+	INC_DWORD_STAT(STAT_TetrisInputEvents);
+
+	switch (Command)
+	{
+	case ETetrisInputCommand::MoveLeft:
+		HandleMoveLeft();
+		break;
+	case ETetrisInputCommand::MoveRight:
+		HandleMoveRight();
+		break;
+	case ETetrisInputCommand::MoveDown:
+		HandleMoveDown();
+		break;
+	case ETetrisInputCommand::Rotate:
+		HandleRotate();
+		break;
+	case ETetrisInputCommand::HardDrop:
+		HandleHardDrop();
+		break;
+	case ETetrisInputCommand::Pause:
+		HandlePause();
+		break;
+	case ETetrisInputCommand::Restart:
+		RestartGame();
+		break;
+	case ETetrisInputCommand::ShiftLeft:
+		HandleShift(EMoveDirection::Left);
+		break;
+	case ETetrisInputCommand::ShiftRight:
+		HandleShift(EMoveDirection::Right);
+		break;
+	case ETetrisInputCommand::SoftDropToFloor:
+		HandleSoftDropToFloor();
+		break;
+	}
+
+	TetrisLatency::MarkHandled();
+}
+
+void ATetrisGameMode::NotifyKeyPress(ETetrisInputCommand Command)
+{
+	if (bEnableFinesseAnalysis && UsesModernKicks() && !SimulationThread && CurrentGameState == ETetrisGameState::Playing && CurrentPiece && !CurrentPiece->IsFixed())
+	{
+		FinesseTracker.AddKeyPress(Command);
+	}
+}
+
+bool ATetrisGameMode::GetPerfectClearHint(TArray<FTetrisCoordinate>& OutCells, int32& OutPiecesToClear) const
+{
+	OutCells.Reset();
+	OutPiecesToClear = 0;
+	if (!bEnablePerfectClearHints || !UsesModernKicks() || !TetrisBoard || !CurrentPiece || CurrentPiece->IsFixed())
+	{
+		return false;
+	}
+	if (TetrisBoard->GetBoardWidth() > FTetrisSimBoard::MAX_WIDTH || TetrisBoard->GetBoardHeight() > FTetrisSimBoard::MAX_HEIGHT)
+	{
+		return false;
+	}
+
+	FTetrisSimBoard Board;
+	Board.Reset(TetrisBoard->GetBoardWidth(), TetrisBoard->GetBoardHeight());
+	for (int32 Y = 0; Y < Board.Height; Y++)
+	{
+		Board.SetPackedRow(Y, TetrisBoard->GetPackedRow(Y));
+	}
+
+	TArray<EPieceType, TInlineAllocator<16>> Pieces;
+	Pieces.Add(CurrentPiece->GetPieceType());
+	for (int32 Slot = 0; Slot < PieceQueue.GetPreviewCount(); Slot++)
+	{
+		Pieces.Add(PieceQueue.Peek(Slot));
+	}
+
+	const FTetrisPerfectClearSolver Solver(FTetrisPerfectClearSettings(), &FTetrisPerfectClearTable::GetShared());
+	FTetrisPerfectClearResult Result;
+	if (!Solver.Solve(Board, Pieces, CurrentPiece->GetCurrentRotation(), CurrentPiece->GetBoardPosition().X, CurrentPiece->GetBoardPosition().Y, Result))
+	{
+		return false;
+	}
+
+	const FTetrisSimPlacement& First = Result.Placements[0];
+	const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(First.PieceType, First.Rotation);
+	for (int32 Y = 0; Y < TetrisConstants::PIECE_SIZE; Y++)
+	{
+		for (int32 X = 0; X < TetrisConstants::PIECE_SIZE; X++)
+		{
+			if (TetrisPieceTables::IsShapeCellSet(ShapeMask, X, Y))
+			{
+				OutCells.Add(FTetrisCoordinate(First.X + X, First.Y + Y));
+			}
+		}
+	}
+	OutPiecesToClear = Result.Placements.Num();
+	return true;
+}
+
+uint64 ATetrisGameMode::GetStateHash() const
+{
+	uint64 Hash = QueueHash;
+	if (TetrisBoard)
+	{
+		Hash ^= TetrisBoard->GetBoardHash();
+	}
+	if (CurrentPiece)
+	{
+		Hash ^= CurrentPiece->GetStateHash();
+	}
+	return Hash;
+}
+
+void ATetrisGameMode::RefreshQueueHash()
+{
+	// キューは取り出しごとに全スロットがずれるので先読み数分を計算し直す
+	QueueHash = 0;
+	for (int32 Slot = 0; Slot < PieceQueue.GetPreviewCount(); Slot++)
+	{
+		QueueHash ^= TetrisZobrist::GetQueueKey(Slot, PieceQueue.Peek(Slot));
+	}
+}
+
+// ワーカースレッド実行
+bool ATetrisGameMode::StartSimulationThread()
+{
+	FTetrisSimConfig Config;
+	if (TetrisBoard)
+	{
+		Config.BoardWidth = TetrisBoard->GetBoardWidth();
+		Config.BoardHeight = TetrisBoard->GetBoardHeight();
+	}
+
+	if (Config.BoardWidth > FTetrisSimBoard::MAX_WIDTH || Config.BoardHeight > FTetrisSimBoard::MAX_HEIGHT)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Board %dx%d is too large for the simulation thread, running on the game thread"), Config.BoardWidth, Config.BoardHeight);
+		return false;
+	}
+
+	// ゲームスレッド実行と同じシード・設定（同じ入力なら同じ展開になる）
+	Config.RandomizerType = PieceQueue.RandomizerType;
+	Config.Seed = PieceQueue.InitialSeed;
+	Config.PreviewCount = PreviewCount;
+	Config.BaseFallMicroseconds = static_cast<int64>(BaseFallSpeed * 1000000.0);
+	Config.LineClearDelayMicroseconds = static_cast<int64>(LineClearDelay * 1000000.0);
+	Config.MaxLevel = MaxLevel;
+	Config.Ruleset = Ruleset;
+
+	SimulationThread = MakeUnique<FTetrisSimulationThread>(Config, SimulationStepsPerSecond);
+	SimulationInputsApplied = 0;
+	SimulationThread->SetDatasetExporter(DatasetExporter.Get());
+	if (!SimulationThread->Start())
+	{
+		SimulationThread.Reset();
+		return false;
+	}
+	return true;
+}
+
+void ATetrisGameMode::StopSimulationThread()
+{
+	if (SimulationThread)
+	{
+		SimulationThread->Shutdown();
+		SimulationThread.Reset();
+		TetrisLatency::DiscardDeferred();
+	}
+}
+
+void ATetrisGameMode::OpenDatasetExporter()
+{
+	if (!TetrisBoard)
+	{
+		return;
+	}
+
+	if (TetrisBoard->GetBoardWidth() > TetrisConstants::MAX_PACKED_BOARD_WIDTH || TetrisBoard->GetBoardHeight() > FTetrisDecisionRecord::MAX_HEIGHT)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Board %dx%d is too large for dataset export"), TetrisBoard->GetBoardWidth(), TetrisBoard->GetBoardHeight());
+		return;
+	}
+
+	const FString Directory = DatasetDirectory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TetrisDataset")) : DatasetDirectory;
+	const FString FilePath = FPaths::Combine(Directory, FString::Printf(TEXT("Game_%s_%d.tdset"),
+		*FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")), PieceQueue.InitialSeed));
+
+	DatasetExporter = MakeUnique<FTetrisDatasetExporter>();
+	if (!DatasetExporter->Open(FilePath, TetrisBoard->GetBoardWidth(), TetrisBoard->GetBoardHeight(), PieceQueue.GetPreviewCount()))
+	{
+		DatasetExporter.Reset();
+	}
+}
+
+void ATetrisGameMode::CloseDatasetExporter()
+{
+	if (DatasetExporter)
+	{
+		DatasetExporter->Close();
+		DatasetExporter.Reset();
+	}
+}
+
+bool ATetrisGameMode::ForwardInputToSimulationThread(ETetrisInputCommand Command)
+{
+	if (!SimulationThread)
+	{
+		return false;
+	}
+
+	if (CurrentGameState == ETetrisGameState::Playing)
+	{
+		SimulationThread->EnqueueInput(Command);
+		TetrisLatency::DeferToSimulation();
+	}
+	return true;
+}
+
+void ATetrisGameMode::ApplySimulationFrame(const FTetrisSimFrame& Frame)
+{
+	// 遅延計測：このフレームで新たに適用された入力は処理済み
+	TetrisLatency::MarkSimulationApplied(static_cast<int32>(Frame.InputsApplied - SimulationInputsApplied));
+	SimulationInputsApplied = Frame.InputsApplied;
+
+	// ボード：変わった行だけ書き換え、表示の作り直しは1回
+	if (TetrisBoard)
+	{
+		bool bBoardChanged = false;
+		const int32 Height = FMath::Min(TetrisBoard->GetBoardHeight(), Frame.BoardHeight);
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			if (TetrisBoard->GetPackedRow(Y) != Frame.PackedRows[Y])
+			{
+				TetrisBoard->SetPackedRow(Y, Frame.PackedRows[Y], false);
+				bBoardChanged = true;
+			}
+		}
+
+		if (bBoardChanged)
+		{
+			TetrisBoard->MarkDisplayDirty();
+		}
+	}
+
+	// 操作中のピース（消去待ちの間は無し）
+	if (Frame.ActivePiece == EPieceType::None)
+	{
+		CleanupCurrentPiece();
+	}
+	else
+	{
+		if (!CurrentPiece)
+		{
+			CurrentPiece = GetWorld()->SpawnActor<ATetrisPiece>(ATetrisPiece::StaticClass(), FVector(0.0f, 0.0f, 100.0f), FRotator::ZeroRotator);
+			INC_DWORD_STAT(STAT_TetrisActorsSpawned);
+			if (CurrentPiece)
+			{
+				CurrentPiece->SetRuleset(Ruleset);
+				CurrentPiece->InitializePiece(Frame.ActivePiece, TetrisBoard);
+			}
+		}
+
+		const FTetrisCoordinate Position(Frame.ActiveX, Frame.ActiveY);
+		if (CurrentPiece && (CurrentPiece->GetPieceType() != Frame.ActivePiece
+			|| CurrentPiece->GetCurrentRotation() != Frame.ActiveRotation
+			|| CurrentPiece->GetBoardPosition() != Position))
+		{
+			CurrentPiece->SetPieceState(Frame.ActivePiece, Frame.ActiveRotation, Position);
+		}
+	}
+
+	// キューと統計（イベントは FlushEvents で差分から通知される）
+	PieceQueue = Frame.Queue;
+	NextPieceType = PieceQueue.Peek(0);
+	RefreshQueueHash();
+
+	if (Frame.Stats.LinesCleared > GameStats.LinesCleared)
+	{
+		PendingLinesClearedEvent += Frame.Stats.LinesCleared - GameStats.LinesCleared;
+	}
+
+	const bool bLevelChanged = Frame.Stats.Level != GameStats.Level;
+	GameStats = Frame.Stats;
+	if (bLevelChanged)
+	{
+		UpdateFallSpeed();
+	}
+
+	// スレッドを止めるとフレームも破棄されるので最後に行う
+	if (Frame.bGameOver)
+	{
+		EndGame();
+	}
+}
+
+// スナップショット
+void ATetrisGameMode::CaptureSnapshot(FTetrisGameSnapshot& OutSnapshot) const
+{
+	OutSnapshot.BoardWidth = 0;
+	OutSnapshot.BoardHeight = 0;
+	OutSnapshot.PackedRows.Reset();
+	if (TetrisBoard)
+	{
+		const int32 Height = FMath::Min(TetrisBoard->GetBoardHeight(), FTetrisGameSnapshot::MAX_ROWS);
+		OutSnapshot.BoardWidth = static_cast<uint8>(TetrisBoard->GetBoardWidth());
+		OutSnapshot.BoardHeight = static_cast<uint8>(Height);
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			OutSnapshot.PackedRows.Add(TetrisBoard->GetPackedRow(Y));
+		}
+	}
+
+	OutSnapshot.ActivePieceType = EPieceType::None;
+	if (CurrentPiece && !CurrentPiece->IsFixed())
+	{
+		OutSnapshot.ActivePieceType = CurrentPiece->GetPieceType();
+		OutSnapshot.ActiveRotation = static_cast<uint8>(CurrentPiece->GetCurrentRotation());
+		OutSnapshot.ActiveX = static_cast<int8>(CurrentPiece->GetBoardPosition().X);
+		OutSnapshot.ActiveY = static_cast<int8>(CurrentPiece->GetBoardPosition().Y);
+	}
+
+	OutSnapshot.PieceQueue = PieceQueue;
+
+	OutSnapshot.Stats = GameStats;
+	OutSnapshot.FallSpeed = FallSpeed;
+	OutSnapshot.FallTimer = FallTimer;
+	OutSnapshot.GameState = CurrentGameState;
+}
+
+bool ATetrisGameMode::RestoreSnapshot(const FTetrisGameSnapshot& Snapshot)
+{
+	if (!TetrisBoard || Snapshot.BoardWidth != TetrisBoard->GetBoardWidth() || Snapshot.BoardHeight != TetrisBoard->GetBoardHeight())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Snapshot board size %dx%d does not match current board"), Snapshot.BoardWidth, Snapshot.BoardHeight);
+		return false;
+	}
+
+	// ワーカースレッド側の状態は外から書き換えない
+	if (SimulationThread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot restore a snapshot while the simulation runs on a worker thread"));
+		return false;
+	}
+
+	// 演出中のライン消去は破棄
+	if (PendingClearLines.Num() > 0)
+	{
+		PendingClearLines.Reset();
+		LineClearTimer = 0.0f;
+		TetrisBoard->CancelLineClearAnimation();
+	}
+
+	// ボード：表示更新は最後に1回だけ
+	for (int32 Y = 0; Y < Snapshot.PackedRows.Num(); Y++)
+	{
+		TetrisBoard->SetPackedRow(Y, Snapshot.PackedRows[Y], false);
+	}
+	TetrisBoard->MarkDisplayDirty();
+
+	// 操作中のピース（既存アクターがあれば再利用）
+	if (Snapshot.ActivePieceType == EPieceType::None)
+	{
+		CleanupCurrentPiece();
+	}
+	else
+	{
+		if (!CurrentPiece)
+		{
+			CurrentPiece = GetWorld()->SpawnActor<ATetrisPiece>(ATetrisPiece::StaticClass(), FVector(0.0f, 0.0f, 100.0f), FRotator::ZeroRotator);
+			INC_DWORD_STAT(STAT_TetrisActorsSpawned);
+			if (CurrentPiece)
+			{
+				CurrentPiece->SetRuleset(Ruleset);
+				CurrentPiece->InitializePiece(Snapshot.ActivePieceType, TetrisBoard);
+			}
+		}
+
+		if (CurrentPiece)
+		{
+			CurrentPiece->SetPieceState(Snapshot.ActivePieceType, Snapshot.ActiveRotation,
+				FTetrisCoordinate(Snapshot.ActiveX, Snapshot.ActiveY));
+
+			// 出現位置のまま（アンドゥ）ならそこから数え直す
+			FinesseTracker.BeginPiece(Snapshot.ActiveRotation == 0 && Snapshot.ActiveX == TetrisRules::SPAWN_X && Snapshot.ActiveY == TetrisRules::SPAWN_Y);
+		}
+	}
+
+	// ネクストキューと乱数
+	PieceQueue = Snapshot.PieceQueue;
+	NextPieceType = PieceQueue.Peek(0);
+	RefreshQueueHash();
+
+	// 統計とタイマー
+	GameStats = Snapshot.Stats;
+	FallSpeed = Snapshot.FallSpeed;
+	FallTimer = Snapshot.FallTimer;
+	CurrentGameState = Snapshot.GameState;
+
+	// ライン消去の演出中に取ったもの：消える行は盤面に残っているので演出からやり直し、終わったら次のピースを出す
+	if (Snapshot.ActivePieceType == EPieceType::None && CurrentGameState == ETetrisGameState::Playing)
+	{
+		const TArray<int32> CompletedLines = TetrisBoard->CheckCompleteLines();
+		if (CompletedLines.Num() > 0 && LineClearDelay > 0.0f)
+		{
+			PendingClearLines = CompletedLines;
+			LineClearTimer = 0.0f;
+			TetrisBoard->BeginLineClearAnimation(CompletedLines);
+		}
+		else
+		{
+			if (CompletedLines.Num() > 0)
+			{
+				TetrisBoard->ClearLines(CompletedLines);
+			}
+			SpawnNewPiece();
+		}
+	}
+
+	return true;
+}
+
+void ATetrisGameMode::SaveSnapshotAsync(const FString& SlotName)
+{
+	// 演出中の消去行は確定させてから保存する
+	if (PendingClearLines.Num() > 0)
+	{
+		FinishLineClear();
+	}
+
+	FTetrisGameSnapshot Snapshot;
+	CaptureSnapshot(Snapshot);
+
+	const FString FilePath = GetSnapshotFilePath(SlotName);
+	Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot), FilePath]()
+	{
+		TArray<uint8> Bytes;
+		Snapshot.ToBytes(Bytes);
+
+		if (!FFileHelper::SaveArrayToFile(Bytes, *FilePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write snapshot: %s"), *FilePath);
+		}
+	});
+}
+
+bool ATetrisGameMode::LoadSnapshot(const FString& SlotName)
+{
+	const FString FilePath = GetSnapshotFilePath(SlotName);
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read snapshot: %s"), *FilePath);
+		return false;
+	}
+
+	FTetrisGameSnapshot Snapshot;
+	if (!Snapshot.FromBytes(Bytes))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Corrupt snapshot: %s"), *FilePath);
+		return false;
+	}
+
+	return RestoreSnapshot(Snapshot);
+}
+
+bool ATetrisGameMode::UndoLastPiece()
+{
+	if (!bEnableUndo || UndoCount == 0)
+	{
+		return false;
+	}
+
+	// 最新は現在のピース開始時点なので、2つ以上あれば1つ前に戻る
+	if (UndoCount > 1)
+	{
+		UndoHead = (UndoHead + UndoSnapshots.Num() - 1) % UndoSnapshots.Num();
+		UndoCount--;
+	}
+
+	const int32 LatestIndex = (UndoHead + UndoSnapshots.Num() - 1) % UndoSnapshots.Num();
+	return RestoreSnapshot(UndoSnapshots[LatestIndex]);
+}
+
+void ATetrisGameMode::PushUndoSnapshot()
+{
+	if (!bEnableUndo || MaxUndoSnapshots <= 0)
+	{
+		return;
+	}
+
+	if (UndoSnapshots.Num() != MaxUndoSnapshots)
+	{
+		UndoSnapshots.SetNum(MaxUndoSnapshots);
+		UndoHead = 0;
+		UndoCount = 0;
+	}
+
+	// 古いものから上書き
+	CaptureSnapshot(UndoSnapshots[UndoHead]);
+	UndoHead = (UndoHead + 1) % UndoSnapshots.Num();
+	UndoCount = FMath::Min(UndoCount + 1, UndoSnapshots.Num());
+}
+
+FString ATetrisGameMode::GetSnapshotFilePath(const FString& SlotName)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TetrisSnapshots"), SlotName + TEXT(".tsnap"));
+}
+
 // デバッグ関数
 void ATetrisGameMode::DebugAddScore(int32 Points)
 {
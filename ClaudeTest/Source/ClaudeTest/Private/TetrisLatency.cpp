@@ -0,0 +1,329 @@
+#include "TetrisLatency.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "RenderingThread.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("TetrisLatency"), STATGROUP_TetrisLatency, STATCAT_Advanced);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Handled p50 (ms)"), STAT_TetrisLatency_HandledP50, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Handled p95 (ms)"), STAT_TetrisLatency_HandledP95, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Handled p99 (ms)"), STAT_TetrisLatency_HandledP99, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Display p50 (ms)"), STAT_TetrisLatency_DisplayP50, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Display p95 (ms)"), STAT_TetrisLatency_DisplayP95, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Display p99 (ms)"), STAT_TetrisLatency_DisplayP99, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Render p50 (ms)"), STAT_TetrisLatency_RenderP50, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Render p95 (ms)"), STAT_TetrisLatency_RenderP95, STATGROUP_TetrisLatency);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Render p99 (ms)"), STAT_TetrisLatency_RenderP99, STATGROUP_TetrisLatency);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Inputs Measured"), STAT_TetrisLatency_Inputs, STATGROUP_TetrisLatency);
+
+static TAutoConsoleVariable<bool> CVarTetrisLatencyEnable(
+	TEXT("Tetris.Latency.Enable"),
+	true,
+	TEXT("Measures Tetris input-to-render latency."));
+
+// ヒストグラム
+
+void FTetrisLatencyHistogram::Add(double Seconds)
+{
+	Seconds = FMath::Max(Seconds, 0.0);
+	const int32 Bucket = FMath::Min(static_cast<int32>(Seconds / BUCKET_SECONDS), NUM_BUCKETS - 1);
+	Buckets[Bucket]++;
+	Count++;
+	MaxSeconds = FMath::Max(MaxSeconds, Seconds);
+}
+
+void FTetrisLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	MaxSeconds = 0.0;
+}
+
+double FTetrisLatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const int64 Rank = FMath::Clamp<int64>(FMath::CeilToInt64(FMath::Clamp(Percentile, 0.0, 1.0) * Count), 1, Count);
+	int64 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NUM_BUCKETS - 1; Bucket++)
+	{
+		Seen += Buckets[Bucket];
+		if (Seen >= Rank)
+		{
+			return FMath::Min((Bucket + 1) * BUCKET_SECONDS, MaxSeconds);
+		}
+	}
+	return MaxSeconds;
+}
+
+// 計測
+
+namespace TetrisLatency
+{
+	// 今のフレームで読んだ入力（時刻の起点と、通過した最後の段階）
+	struct FStamp
+	{
+		uint64 OriginCycles = 0;
+		ETetrisLatencyStage Stage = ETetrisLatencyStage::Dispatch;
+	};
+
+	// ワーカースレッドへ渡した入力を溜めておける上限（超えたら古いものから捨てる）
+	static const int32 MAX_DEFERRED = 1024;
+
+	static const TCHAR* StageNames[] = { TEXT("Dispatch"), TEXT("Handled"), TEXT("Display"), TEXT("Render") };
+	static_assert(UE_ARRAY_COUNT(StageNames) == static_cast<int32>(ETetrisLatencyStage::Num), "Stage names out of date");
+
+	static TArray<FStamp> FrameStamps;
+	static TArray<uint64> DeferredOrigins;	// 渡した順。0 = スタンプの無い入力
+	static uint64 FrameBeginCycles = 0;
+	static bool bInitialized = false;
+
+	// Render の段階だけは描画スレッドが書く
+	static FTetrisLatencyHistogram Histograms[static_cast<int32>(ETetrisLatencyStage::Num)];
+	static FCriticalSection RenderHistogramLock;
+
+	static double CyclesToSeconds(uint64 OriginCycles, uint64 NowCycles)
+	{
+		return FPlatformTime::ToSeconds64(NowCycles > OriginCycles ? NowCycles - OriginCycles : 0);
+	}
+
+	static void Record(ETetrisLatencyStage Stage, uint64 OriginCycles, uint64 NowCycles)
+	{
+		Histograms[static_cast<int32>(Stage)].Add(CyclesToSeconds(OriginCycles, NowCycles));
+	}
+
+	// From の段階にいるスタンプを To に進める
+	static void Advance(ETetrisLatencyStage From, ETetrisLatencyStage To)
+	{
+		const uint64 Now = FPlatformTime::Cycles64();
+		for (FStamp& Stamp : FrameStamps)
+		{
+			if (Stamp.Stage == From)
+			{
+				Record(To, Stamp.OriginCycles, Now);
+				Stamp.Stage = To;
+			}
+		}
+	}
+
+	static void UpdateStats()
+	{
+#if STATS
+		if (!FThreadStats::IsCollectingData())
+		{
+			return;
+		}
+
+		const FTetrisLatencyHistogram Handled = GetHistogram(ETetrisLatencyStage::Handled);
+		const FTetrisLatencyHistogram Display = GetHistogram(ETetrisLatencyStage::Display);
+		const FTetrisLatencyHistogram Render = GetHistogram(ETetrisLatencyStage::Render);
+		SET_FLOAT_STAT(STAT_TetrisLatency_HandledP50, Handled.GetPercentile(0.50) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_HandledP95, Handled.GetPercentile(0.95) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_HandledP99, Handled.GetPercentile(0.99) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_DisplayP50, Display.GetPercentile(0.50) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_DisplayP95, Display.GetPercentile(0.95) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_DisplayP99, Display.GetPercentile(0.99) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_RenderP50, Render.GetPercentile(0.50) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_RenderP95, Render.GetPercentile(0.95) * 1000.0);
+		SET_FLOAT_STAT(STAT_TetrisLatency_RenderP99, Render.GetPercentile(0.99) * 1000.0);
+#endif
+	}
+
+	void Initialize()
+	{
+		if (bInitialized)
+		{
+			return;
+		}
+		bInitialized = true;
+
+		// メッセージの汲み出しより前に呼ばれるので、このフレームで読む入力はこの時刻以降に届いている
+		FCoreDelegates::OnBeginFrame.AddStatic([]()
+		{
+			FrameBeginCycles = FPlatformTime::Cycles64();
+		});
+		FCoreDelegates::OnEndFrame.AddStatic(&EndFrame);
+	}
+
+	void StampInput()
+	{
+		if (!CVarTetrisLatencyEnable.GetValueOnGameThread())
+		{
+			return;
+		}
+
+		const uint64 Now = FPlatformTime::Cycles64();
+		FStamp& Stamp = FrameStamps.AddDefaulted_GetRef();
+		Stamp.OriginCycles = (FrameBeginCycles != 0 && FrameBeginCycles <= Now) ? FrameBeginCycles : Now;
+		Record(ETetrisLatencyStage::Dispatch, Stamp.OriginCycles, Now);
+		INC_DWORD_STAT(STAT_TetrisLatency_Inputs);
+	}
+
+	void MarkHandled()
+	{
+		Advance(ETetrisLatencyStage::Dispatch, ETetrisLatencyStage::Handled);
+	}
+
+	void DeferToSimulation()
+	{
+		// ハンドラーから渡された入力なら、今処理中の（最後の）スタンプ
+		uint64 OriginCycles = 0;
+		if (FrameStamps.Num() > 0 && FrameStamps.Last().Stage == ETetrisLatencyStage::Dispatch)
+		{
+			OriginCycles = FrameStamps.Pop(EAllowShrinking::No).OriginCycles;
+		}
+
+		if (DeferredOrigins.Num() >= MAX_DEFERRED)
+		{
+			DeferredOrigins.RemoveAt(0, DeferredOrigins.Num() - MAX_DEFERRED + 1, EAllowShrinking::No);
+		}
+		DeferredOrigins.Add(OriginCycles);
+	}
+
+	void MarkSimulationApplied(int32 NumApplied)
+	{
+		NumApplied = FMath::Clamp(NumApplied, 0, DeferredOrigins.Num());
+		if (NumApplied == 0)
+		{
+			return;
+		}
+
+		const uint64 Now = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < NumApplied; Index++)
+		{
+			const uint64 OriginCycles = DeferredOrigins[Index];
+			if (OriginCycles != 0)
+			{
+				Record(ETetrisLatencyStage::Handled, OriginCycles, Now);
+				FrameStamps.Add({ OriginCycles, ETetrisLatencyStage::Handled });
+			}
+		}
+		DeferredOrigins.RemoveAt(0, NumApplied, EAllowShrinking::No);
+	}
+
+	void DiscardDeferred()
+	{
+		DeferredOrigins.Reset();
+	}
+
+	void MarkDisplayUpdated()
+	{
+		Advance(ETetrisLatencyStage::Handled, ETetrisLatencyStage::Display);
+	}
+
+	void EndFrame()
+	{
+		// 表示まで届いた入力だけ描画スレッドで時刻を取る（描画コマンドは積んだ順に実行される）
+		TArray<uint64> DisplayedOrigins;
+		for (const FStamp& Stamp : FrameStamps)
+		{
+			if (Stamp.Stage == ETetrisLatencyStage::Display)
+			{
+				DisplayedOrigins.Add(Stamp.OriginCycles);
+			}
+		}
+		FrameStamps.Reset();
+
+		if (DisplayedOrigins.Num() > 0)
+		{
+			ENQUEUE_RENDER_COMMAND(TetrisLatencyRender)([Origins = MoveTemp(DisplayedOrigins)](FRHICommandListImmediate& RHICmdList)
+			{
+				const uint64 Now = FPlatformTime::Cycles64();
+				FScopeLock Lock(&RenderHistogramLock);
+				for (uint64 OriginCycles : Origins)
+				{
+					Record(ETetrisLatencyStage::Render, OriginCycles, Now);
+				}
+			});
+		}
+
+		UpdateStats();
+	}
+
+	FTetrisLatencyHistogram GetHistogram(ETetrisLatencyStage Stage)
+	{
+		if (Stage == ETetrisLatencyStage::Render)
+		{
+			FScopeLock Lock(&RenderHistogramLock);
+			return Histograms[static_cast<int32>(Stage)];
+		}
+		return Histograms[static_cast<int32>(Stage)];
+	}
+
+	void Reset()
+	{
+		FrameStamps.Reset();
+		DeferredOrigins.Reset();
+
+		FScopeLock Lock(&RenderHistogramLock);
+		for (FTetrisLatencyHistogram& Histogram : Histograms)
+		{
+			Histogram.Reset();
+		}
+	}
+
+	bool WriteCsv(const FString& Path)
+	{
+		FString Csv = TEXT("Stage,Count,P50Ms,P95Ms,P99Ms,MaxMs\n");
+		for (int32 Stage = 0; Stage < static_cast<int32>(ETetrisLatencyStage::Num); Stage++)
+		{
+			const FTetrisLatencyHistogram Histogram = GetHistogram(static_cast<ETetrisLatencyStage>(Stage));
+			Csv += FString::Printf(TEXT("%s,%lld,%.2f,%.2f,%.2f,%.2f\n"), StageNames[Stage], Histogram.Count,
+				Histogram.GetPercentile(0.50) * 1000.0, Histogram.GetPercentile(0.95) * 1000.0,
+				Histogram.GetPercentile(0.99) * 1000.0, Histogram.MaxSeconds * 1000.0);
+		}
+
+		return FFileHelper::SaveStringToFile(Csv, *Path);
+	}
+
+	void DumpToLog()
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Tetris input latency (from the frame the input was read):"));
+		for (int32 Stage = 0; Stage < static_cast<int32>(ETetrisLatencyStage::Num); Stage++)
+		{
+			const FTetrisLatencyHistogram Histogram = GetHistogram(static_cast<ETetrisLatencyStage>(Stage));
+			UE_LOG(LogTemp, Warning, TEXT("  %-8s %6lld inputs, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms"),
+				StageNames[Stage], Histogram.Count,
+				Histogram.GetPercentile(0.50) * 1000.0, Histogram.GetPercentile(0.95) * 1000.0,
+				Histogram.GetPercentile(0.99) * 1000.0, Histogram.MaxSeconds * 1000.0);
+		}
+	}
+
+	static void WriteCsvCommand(const TArray<FString>& Args)
+	{
+		const FString Path = Args.Num() > 0 ? Args[0]
+			: FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TetrisLatency"), FString::Printf(TEXT("Latency_%s.csv"), *FDateTime::Now().ToString()));
+		if (WriteCsv(Path))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Tetris latency written to %s"), *Path);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *Path);
+		}
+	}
+
+	static FAutoConsoleCommand DumpLatencyCommand(
+		TEXT("Tetris.Latency.Dump"),
+		TEXT("Logs Tetris input latency percentiles per stage."),
+		FConsoleCommandDelegate::CreateStatic(&DumpToLog));
+
+	static FAutoConsoleCommand ResetLatencyCommand(
+		TEXT("Tetris.Latency.Reset"),
+		TEXT("Resets Tetris input latency histograms."),
+		FConsoleCommandDelegate::CreateStatic(&Reset));
+
+	static FAutoConsoleCommand WriteLatencyCsvCommand(
+		TEXT("Tetris.Latency.WriteCsv"),
+		TEXT("Writes Tetris input latency percentiles to a CSV file (default Saved/TetrisLatency/Latency_<time>.csv)."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&WriteCsvCommand));
+}
@@ -0,0 +1,192 @@
+#include "TetrisNetTypes.h"
+#include "TetrisBoard.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "HAL/IConsoleManager.h"
+
+bool FTetrisBoardRowItem::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedRowIndex = static_cast<uint32>(FMath::Max(RowIndex, 0));
+	Ar.SerializeIntPacked(PackedRowIndex);
+
+	// 占有マスク（幅10なら通常2バイト以下）
+	uint32 OccupancyMask = 0;
+	if (Ar.IsSaving())
+	{
+		for (int32 X = 0; X < TetrisConstants::MAX_PACKED_BOARD_WIDTH; X++)
+		{
+			if (TetrisCellPacking::IsCellOccupied(TetrisCellPacking::GetPackedCell(PackedCells, X)))
+			{
+				OccupancyMask |= 1u << X;
+			}
+		}
+	}
+	Ar.SerializeIntPacked(OccupancyMask);
+
+	// 占有セルごとに種類を3bitで送る（セル値1-8を0-7に詰める）
+	uint64 NewPackedCells = 0;
+	for (int32 X = 0; X < TetrisConstants::MAX_PACKED_BOARD_WIDTH; X++)
+	{
+		if ((OccupancyMask & (1u << X)) == 0)
+		{
+			continue;
+		}
+
+		uint8 TypeBits = Ar.IsSaving() ? static_cast<uint8>(TetrisCellPacking::GetPackedCell(PackedCells, X) - 1) : 0;
+		Ar.SerializeBits(&TypeBits, 3);
+		NewPackedCells = TetrisCellPacking::SetPackedCell(NewPackedCells, X, (TypeBits & 0x7) + 1);
+	}
+
+	if (Ar.IsLoading())
+	{
+		RowIndex = static_cast<int32>(PackedRowIndex);
+		PackedCells = NewPackedCells;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FTetrisBoardRowArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (OwnerBoard)
+	{
+		OwnerBoard->OnReplicatedRowsReceived();
+	}
+}
+
+bool FTetrisBoardRowArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const int64 BitsBefore = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+
+	const bool bResult = FFastArraySerializer::FastArrayDeltaSerialize<FTetrisBoardRowItem, FTetrisBoardRowArray>(Items, DeltaParms, *this);
+
+	if (DeltaParms.Writer)
+	{
+		const int64 BitsWritten = DeltaParms.Writer->GetNumBits() - BitsBefore;
+		if (BitsWritten > 0)
+		{
+			TetrisNetStats::RecordBoardBits(TetrisNetStats::GetConnectionFromMap(DeltaParms.Map), BitsWritten);
+		}
+	}
+
+	return bResult;
+}
+
+bool FTetrisNetPieceState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 TypeValue = Ar.IsSaving() ? static_cast<uint8>(PieceType) : 0;
+	uint8 RotationValue = Ar.IsSaving() ? Rotation : 0;
+	uint8 FixedValue = (Ar.IsSaving() && bFixed) ? 1 : 0;
+
+	Ar.SerializeBits(&TypeValue, 3);
+	Ar.SerializeBits(&RotationValue, 2);
+	Ar << X;
+	Ar << Y;
+	Ar.SerializeBits(&FixedValue, 1);
+
+	if (Ar.IsLoading())
+	{
+		PieceType = static_cast<EPieceType>(TypeValue & 0x7);
+		Rotation = RotationValue & 0x3;
+		bFixed = (FixedValue & 0x1) != 0;
+	}
+	else
+	{
+		TetrisNetStats::RecordPieceBits(TetrisNetStats::GetConnectionFromMap(Map), SERIALIZED_BITS);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+namespace TetrisNetStats
+{
+	static TMap<TWeakObjectPtr<UNetConnection>, FTetrisNetBandwidthStats> ConnectionStats;
+
+	static FTetrisNetBandwidthStats& FindOrAddStats(UNetConnection* Connection)
+	{
+		FTetrisNetBandwidthStats& Stats = ConnectionStats.FindOrAdd(Connection);
+		if (Stats.FirstSendTime <= 0.0)
+		{
+			Stats.FirstSendTime = FPlatformTime::Seconds();
+		}
+		return Stats;
+	}
+
+	UNetConnection* GetConnectionFromMap(UPackageMap* Map)
+	{
+		UPackageMapClient* PackageMapClient = Cast<UPackageMapClient>(Map);
+		return PackageMapClient ? PackageMapClient->GetConnection() : nullptr;
+	}
+
+	void RecordBoardBits(UNetConnection* Connection, int64 NumBits)
+	{
+		if (!Connection)
+		{
+			return;
+		}
+
+		FTetrisNetBandwidthStats& Stats = FindOrAddStats(Connection);
+		Stats.BoardBits += NumBits;
+		Stats.BoardUpdates++;
+	}
+
+	void RecordPieceBits(UNetConnection* Connection, int64 NumBits)
+	{
+		if (!Connection)
+		{
+			return;
+		}
+
+		FTetrisNetBandwidthStats& Stats = FindOrAddStats(Connection);
+		Stats.PieceBits += NumBits;
+		Stats.PieceUpdates++;
+	}
+
+	FTetrisNetBandwidthStats GetStats(const UNetConnection* Connection)
+	{
+		for (const TPair<TWeakObjectPtr<UNetConnection>, FTetrisNetBandwidthStats>& Pair : ConnectionStats)
+		{
+			if (Pair.Key.Get() == Connection)
+			{
+				return Pair.Value;
+			}
+		}
+		return FTetrisNetBandwidthStats();
+	}
+
+	void DumpToLog()
+	{
+		const double Now = FPlatformTime::Seconds();
+
+		UE_LOG(LogTemp, Warning, TEXT("Tetris replication bandwidth (%d clients):"), ConnectionStats.Num());
+		for (const TPair<TWeakObjectPtr<UNetConnection>, FTetrisNetBandwidthStats>& Pair : ConnectionStats)
+		{
+			UNetConnection* Connection = Pair.Key.Get();
+			const FTetrisNetBandwidthStats& Stats = Pair.Value;
+			const double Elapsed = FMath::Max(Now - Stats.FirstSendTime, 0.001);
+
+			UE_LOG(LogTemp, Warning, TEXT("  %s: board %lld bytes / %d updates, piece %lld bytes / %d updates, %.1f B/s"),
+				Connection ? *Connection->LowLevelGetRemoteAddress(true) : TEXT("(closed)"),
+				(Stats.BoardBits + 7) / 8, Stats.BoardUpdates,
+				(Stats.PieceBits + 7) / 8, Stats.PieceUpdates,
+				Stats.GetTotalBytes() / Elapsed);
+		}
+	}
+
+	void Reset()
+	{
+		ConnectionStats.Empty();
+	}
+
+	static FAutoConsoleCommand DumpBandwidthCommand(
+		TEXT("Tetris.Net.DumpBandwidth"),
+		TEXT("Logs per-client Tetris replication bandwidth."),
+		FConsoleCommandDelegate::CreateStatic(&DumpToLog));
+
+	static FAutoConsoleCommand ResetBandwidthCommand(
+		TEXT("Tetris.Net.ResetBandwidth"),
+		TEXT("Resets per-client Tetris replication bandwidth counters."),
+		FConsoleCommandDelegate::CreateStatic(&Reset));
+}
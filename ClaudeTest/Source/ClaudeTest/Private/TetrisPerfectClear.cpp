@@ -0,0 +1,624 @@
+#include "TetrisPerfectClear.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	const uint32 TABLE_MAGIC = 0x54435054;	// "TPCT"
+	const uint32 TABLE_VERSION = 1;
+
+	// ファイル先頭。続いてキー（uint64 × NumEntries、昇順）と手（uint16 × NumEntries）
+	struct FTableHeader
+	{
+		uint32 Magic = TABLE_MAGIC;
+		uint32 Version = TABLE_VERSION;
+		uint32 Width = 0;
+		uint32 Reserved = 0;
+		uint64 NumEntries = 0;
+	};
+
+	const int32 NUM_PIECE_TYPES = 7;
+	const int32 MAX_PC_HEIGHT = 4;
+
+	// キー = 盤面（40bit）| ピース列（3bit × 7）| 高さ - 1（2bit）
+	const int32 FIELD_BITS = 40;
+	const int32 PIECE_BITS = 3;
+	const int32 MAX_TABLE_PIECES = 7;
+
+	// 下から Height 行の占有ビット（下の行が下位）
+	uint64 GetFieldBits(const FTetrisSimBoard& Board, int32 Height)
+	{
+		uint64 Bits = 0;
+		for (int32 Row = 0; Row < Height; Row++)
+		{
+			Bits |= uint64(Board.Rows[Board.Height - 1 - Row]) << (Board.Width * Row);
+		}
+		return Bits;
+	}
+
+	int32 CountFieldCells(const FTetrisSimBoard& Board, int32 Height)
+	{
+		int32 Cells = 0;
+		for (int32 Row = 0; Row < Height; Row++)
+		{
+			Cells += FMath::CountBits(Board.Rows[Board.Height - 1 - Row]);
+		}
+		return Cells;
+	}
+
+	// 下から Height 行より上が空か
+	bool IsAboveFieldEmpty(const FTetrisSimBoard& Board, int32 Height)
+	{
+		for (int32 Y = 0; Y < Board.Height - Height; Y++)
+		{
+			if (Board.Rows[Y] != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// 全て埋まった列で左右に分かれた空きは、それぞれ4の倍数でないと埋まらない（列は消去後も埋まったまま）
+	bool HasValidColumnParity(const FTetrisSimBoard& Board, int32 Height)
+	{
+		uint16 FullColumns = Board.FullRowMask;
+		for (int32 Row = 0; Row < Height; Row++)
+		{
+			FullColumns &= Board.Rows[Board.Height - 1 - Row];
+		}
+		if (FullColumns == 0)
+		{
+			return true;
+		}
+
+		int32 EmptyCells = 0;
+		for (int32 X = 0; X < Board.Width; X++)
+		{
+			if ((FullColumns >> X) & 1)
+			{
+				if (EmptyCells % 4 != 0)
+				{
+					return false;
+				}
+				continue;
+			}
+			for (int32 Row = 0; Row < Height; Row++)
+			{
+				EmptyCells += ((Board.Rows[Board.Height - 1 - Row] >> X) & 1) ? 0 : 1;
+			}
+		}
+		return true;
+	}
+
+	bool MakeTableKey(const FTetrisSimBoard& Board, int32 Height, TArrayView<const EPieceType> Pieces, uint64& OutKey)
+	{
+		if (Board.Width * MAX_PC_HEIGHT > FIELD_BITS || Height < 1 || Height > MAX_PC_HEIGHT || Pieces.Num() > MAX_TABLE_PIECES)
+		{
+			return false;
+		}
+
+		OutKey = GetFieldBits(Board, Height);
+		for (int32 Index = 0; Index < Pieces.Num(); Index++)
+		{
+			OutKey |= uint64(static_cast<uint8>(Pieces[Index]) - 1) << (FIELD_BITS + PIECE_BITS * Index);
+		}
+		OutKey |= uint64(Height - 1) << (FIELD_BITS + PIECE_BITS * MAX_TABLE_PIECES);
+		return true;
+	}
+
+	// 手 = 種類（3bit）| 回転（2bit）| X + 4（4bit）| PC の範囲の最上行から測った Y + 4（4bit）
+	uint16 EncodeMove(const FTetrisSimPlacement& Placement, int32 FieldTop)
+	{
+		return static_cast<uint16>((static_cast<uint8>(Placement.PieceType) - 1)
+			| (Placement.Rotation << 3)
+			| ((Placement.X + 4) << 5)
+			| ((Placement.Y - FieldTop + 4) << 9));
+	}
+
+	FTetrisSimPlacement DecodeMove(uint16 Move, int32 FieldTop)
+	{
+		FTetrisSimPlacement Placement;
+		Placement.PieceType = static_cast<EPieceType>((Move & 7) + 1);
+		Placement.Rotation = static_cast<uint8>((Move >> 3) & 3);
+		Placement.X = static_cast<int8>(((Move >> 5) & 15) - 4);
+		Placement.Y = static_cast<int8>(((Move >> 9) & 15) - 4 + FieldTop);
+		return Placement;
+	}
+
+	// 置いたセルの集合（回転が違っても同じセルなら同じ値）
+	uint64 GetCellsKey(EPieceType PieceType, const FTetrisSimPlacement& Placement)
+	{
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Placement.Rotation);
+		uint64 Key = 0;
+		for (int32 Y = 0; Y < TetrisConstants::PIECE_SIZE; Y++)
+		{
+			for (int32 X = 0; X < TetrisConstants::PIECE_SIZE; X++)
+			{
+				if (TetrisPieceTables::IsShapeCellSet(ShapeMask, X, Y))
+				{
+					Key = (Key << 16) | (uint64(uint8(Placement.Y + Y)) << 8) | uint8(Placement.X + X);
+				}
+			}
+		}
+		return Key;
+	}
+
+	// 深さ優先の PC 探索。Pieces はちょうど必要な数
+	struct FPerfectClearSearch
+	{
+		TArrayView<const EPieceType> Pieces;
+		int32 StartRotation = 0;
+		int32 StartX = TetrisRules::SPAWN_X;
+		int32 StartY = TetrisRules::SPAWN_Y;
+		double Deadline = MAX_dbl;
+
+		int32 Nodes = 0;
+		bool bTimedOut = false;
+		TArray<FTetrisSimPlacement> Path;
+
+		// 解けないと分かった (盤面, ピース番号 * 8 + 高さ)
+		TSet<TPair<uint64, int32>> Failed;
+
+		bool Search(const FTetrisSimBoard& Board, int32 Height, int32 PieceIndex)
+		{
+			if (Height == 0)
+			{
+				return true;
+			}
+
+			const int32 EmptyCells = Height * Board.Width - CountFieldCells(Board, Height);
+			if (EmptyCells > (Pieces.Num() - PieceIndex) * 4 || !HasValidColumnParity(Board, Height))
+			{
+				return false;
+			}
+
+			const TPair<uint64, int32> StateKey(GetFieldBits(Board, Height), PieceIndex * 8 + Height);
+			if (Failed.Contains(StateKey))
+			{
+				return false;
+			}
+
+			if ((++Nodes & 15) == 0 && FPlatformTime::Seconds() >= Deadline)
+			{
+				bTimedOut = true;
+				return false;
+			}
+
+			const EPieceType PieceType = Pieces[PieceIndex];
+			TArray<FTetrisSimPlacement> Placements;
+			if (PieceIndex == 0)
+			{
+				TetrisMoveGen::GenerateLockPlacements(Board, PieceType, StartRotation, StartX, StartY, Placements);
+			}
+			else
+			{
+				TetrisMoveGen::GenerateLockPlacements(Board, PieceType, Placements);
+			}
+
+			for (const FTetrisSimPlacement& Placement : Placements)
+			{
+				FTetrisSimBoard Child = Board;
+				Child.Place(PieceType, Placement.Rotation, Placement.X, Placement.Y);
+				if (!IsAboveFieldEmpty(Child, Height))
+				{
+					continue;
+				}
+				const int32 Lines = Child.ClearFullRows();
+
+				Path.Push(Placement);
+				if (Search(Child, Height - Lines, PieceIndex + 1))
+				{
+					return true;
+				}
+				Path.Pop(EAllowShrinking::No);
+
+				if (bTimedOut)
+				{
+					return false;
+				}
+			}
+
+			Failed.Add(StateKey);
+			return false;
+		}
+	};
+}
+
+// 表
+
+FTetrisPerfectClearTable::FTetrisPerfectClearTable() = default;
+
+FTetrisPerfectClearTable::~FTetrisPerfectClearTable()
+{
+	Reset();
+}
+
+FString FTetrisPerfectClearTable::GetDefaultPath()
+{
+	return FPaths::Combine(FPaths::ProjectContentDir(), TEXT("Tetris"), TEXT("PerfectClear.tpct"));
+}
+
+const FTetrisPerfectClearTable& FTetrisPerfectClearTable::GetShared()
+{
+	static FTetrisPerfectClearTable SharedTable;
+	static const bool bMapped = []()
+	{
+		const FString Path = GetDefaultPath();
+		if (!FPaths::FileExists(Path))
+		{
+			UE_LOG(LogTemp, Log, TEXT("No perfect clear table at %s (generate it with -run=TetrisSimulation -PerfectClearTable), hints use search only"), *Path);
+			return false;
+		}
+		if (SharedTable.Map(Path))
+		{
+			return true;
+		}
+
+		// pak に入っているとマップできないので、メモリに読み込む
+		TArray<uint8> Bytes;
+		if (FFileHelper::LoadFileToArray(Bytes, *Path) && SharedTable.FromBytes(MoveTemp(Bytes)))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Loaded perfect clear table %s into memory; stage it as NonUFS to map it"), *Path);
+			return true;
+		}
+		UE_LOG(LogTemp, Error, TEXT("Failed to load perfect clear table %s, hints use search only"), *Path);
+		return false;
+	}();
+	(void)bMapped;
+	return SharedTable;
+}
+
+bool FTetrisPerfectClearTable::Map(const FString& Path)
+{
+	Reset();
+
+	FOpenMappedResult Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Path);
+	if (Result.HasError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to map perfect clear table %s"), *Path);
+		return false;
+	}
+
+	MappedFile = Result.StealValue();
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion || !Bind(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+	{
+		Reset();
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Mapped perfect clear table %s (%lld entries)"), *Path, NumEntries);
+	return true;
+}
+
+bool FTetrisPerfectClearTable::FromBytes(TArray<uint8>&& InBytes)
+{
+	Reset();
+	OwnedBytes = MoveTemp(InBytes);
+	if (!Bind(OwnedBytes.GetData(), OwnedBytes.Num()))
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+void FTetrisPerfectClearTable::Reset()
+{
+	// 領域はハンドルより先に閉じる
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	OwnedBytes.Empty();
+	Keys = nullptr;
+	Moves = nullptr;
+	NumEntries = 0;
+	Width = 0;
+}
+
+bool FTetrisPerfectClearTable::Bind(const uint8* Data, int64 Size)
+{
+	FTableHeader Header;
+	if (!Data || Size < static_cast<int64>(sizeof(FTableHeader)))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&Header, Data, sizeof(FTableHeader));
+
+	if (Header.Magic != TABLE_MAGIC || Header.Version != TABLE_VERSION)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unsupported perfect clear table (magic 0x%08x, version %u)"), Header.Magic, Header.Version);
+		return false;
+	}
+
+	const uint64 EntryBytes = sizeof(uint64) + sizeof(uint16);
+	if (Header.NumEntries > static_cast<uint64>(Size) / EntryBytes
+		|| sizeof(FTableHeader) + Header.NumEntries * EntryBytes > static_cast<uint64>(Size))
+	{
+		return false;
+	}
+
+	Keys = reinterpret_cast<const uint64*>(Data + sizeof(FTableHeader));
+	Moves = reinterpret_cast<const uint16*>(Keys + Header.NumEntries);
+	NumEntries = static_cast<int64>(Header.NumEntries);
+	Width = static_cast<int32>(Header.Width);
+	return true;
+}
+
+bool FTetrisPerfectClearTable::Find(const FTetrisSimBoard& Board, int32 Height, TArrayView<const EPieceType> Pieces, FTetrisSimPlacement& OutPlacement) const
+{
+	uint64 Key = 0;
+	if (!IsLoaded() || Board.Width != Width || !MakeTableKey(Board, Height, Pieces, Key))
+	{
+		return false;
+	}
+
+	const int64 Index = Algo::LowerBound(TArrayView<const uint64, int64>(Keys, NumEntries), Key);
+	if (Index >= NumEntries || Keys[Index] != Key)
+	{
+		return false;
+	}
+
+	OutPlacement = DecodeMove(Moves[Index], Board.Height - Height);
+	return true;
+}
+
+// 探索
+
+FTetrisPerfectClearSolver::FTetrisPerfectClearSolver(const FTetrisPerfectClearSettings& InSettings, const FTetrisPerfectClearTable* InTable)
+	: Settings(InSettings)
+	, Table(InTable)
+{
+}
+
+bool FTetrisPerfectClearSolver::Solve(const FTetrisSimGame& Game, FTetrisPerfectClearResult& OutResult) const
+{
+	OutResult = FTetrisPerfectClearResult();
+	if (!Game.HasActivePiece())
+	{
+		return false;
+	}
+
+	TArray<EPieceType, TInlineAllocator<16>> Pieces;
+	Pieces.Add(Game.GetActivePiece());
+	for (int32 Slot = 0; Slot < Game.GetQueue().GetPreviewCount(); Slot++)
+	{
+		Pieces.Add(Game.GetQueue().Peek(Slot));
+	}
+
+	return Solve(Game.GetBoard(), Pieces, Game.GetActiveRotation(), Game.GetActiveX(), Game.GetActiveY(), OutResult);
+}
+
+bool FTetrisPerfectClearSolver::Solve(const FTetrisSimBoard& Board, TArrayView<const EPieceType> Pieces, int32 StartRotation, int32 StartX, int32 StartY,
+	FTetrisPerfectClearResult& OutResult) const
+{
+	OutResult = FTetrisPerfectClearResult();
+	if (Pieces.Num() == 0)
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 MaxHeight = FMath::Clamp(Settings.MaxHeight, 1, MAX_PC_HEIGHT);
+
+	// 埋まっている一番上の行から下の行数
+	int32 FilledHeight = 0;
+	for (int32 Y = 0; Y < Board.Height; Y++)
+	{
+		if (Board.Rows[Y] != 0)
+		{
+			FilledHeight = Board.Height - Y;
+			break;
+		}
+	}
+
+	FPerfectClearSearch Search;
+	Search.StartRotation = StartRotation;
+	Search.StartX = StartX;
+	Search.StartY = StartY;
+	Search.Deadline = Settings.TimeBudgetSeconds > 0.0 ? StartTime + Settings.TimeBudgetSeconds : MAX_dbl;
+
+	// 低い PC（使うピースが少ない）から試す
+	for (int32 Height = FMath::Max(FilledHeight, 1); Height <= MaxHeight; Height++)
+	{
+		const int32 EmptyCells = Height * Board.Width - CountFieldCells(Board, Height);
+		if (EmptyCells <= 0 || EmptyCells % 4 != 0 || EmptyCells / 4 > Pieces.Num())
+		{
+			continue;
+		}
+		const TArrayView<const EPieceType> Needed = Pieces.Slice(0, EmptyCells / 4);
+
+		if (Table && SolveFromTable(Board, Height, Needed, StartRotation, StartX, StartY, OutResult.Placements))
+		{
+			OutResult.bFromTable = true;
+		}
+		else
+		{
+			Search.Pieces = Needed;
+			Search.Path.Reset();
+			Search.Failed.Reset();
+			if (!Search.Search(Board, Height, 0))
+			{
+				if (Search.bTimedOut)
+				{
+					break;
+				}
+				continue;
+			}
+			OutResult.Placements = Search.Path;
+		}
+
+		OutResult.Height = Height;
+		break;
+	}
+
+	OutResult.NodesSearched = Search.Nodes;
+	OutResult.bTimedOut = Search.bTimedOut;
+	if (OutResult.Placements.Num() == 0)
+	{
+		return false;
+	}
+
+	return TetrisMoveGen::FindInputPath(Board, Pieces[0], StartRotation, StartX, StartY, OutResult.Placements[0], OutResult.Inputs);
+}
+
+bool FTetrisPerfectClearSolver::SolveFromTable(const FTetrisSimBoard& Board, int32 Height, TArrayView<const EPieceType> Pieces,
+	int32 StartRotation, int32 StartX, int32 StartY, TArray<FTetrisSimPlacement>& OutPlacements) const
+{
+	OutPlacements.Reset();
+
+	FTetrisSimBoard Current = Board;
+	TArray<FTetrisSimPlacement> Reachable;
+	for (int32 PieceIndex = 0; PieceIndex < Pieces.Num(); PieceIndex++)
+	{
+		const EPieceType PieceType = Pieces[PieceIndex];
+		FTetrisSimPlacement Move;
+		if (!Table->Find(Current, Height, Pieces.Slice(PieceIndex, Pieces.Num() - PieceIndex), Move) || Move.PieceType != PieceType)
+		{
+			return false;
+		}
+
+		// 表の手が今の位置から届くか確かめる（届く位置のうちセルが同じものを使う）
+		if (PieceIndex == 0)
+		{
+			TetrisMoveGen::GenerateLockPlacements(Current, PieceType, StartRotation, StartX, StartY, Reachable);
+		}
+		else
+		{
+			TetrisMoveGen::GenerateLockPlacements(Current, PieceType, Reachable);
+		}
+		const uint64 MoveCells = GetCellsKey(PieceType, Move);
+		const FTetrisSimPlacement* Match = Reachable.FindByPredicate([&](const FTetrisSimPlacement& Candidate)
+		{
+			return GetCellsKey(PieceType, Candidate) == MoveCells;
+		});
+		if (!Match)
+		{
+			return false;
+		}
+
+		Current.Place(PieceType, Match->Rotation, Match->X, Match->Y);
+		if (!IsAboveFieldEmpty(Current, Height))
+		{
+			return false;
+		}
+		Height -= Current.ClearFullRows();
+		OutPlacements.Add(*Match);
+	}
+
+	return Height == 0;
+}
+
+// 表の生成
+
+int64 TetrisPerfectClear::BuildTable(int32 Width, int32 Height, TArray<uint8>& OutBytes, int32 MaxThreads)
+{
+	OutBytes.Reset();
+
+	const int32 NumPieces = Width * Height / 4;
+	if (Width < 4 || Width * MAX_PC_HEIGHT > FIELD_BITS || Height < 1 || Height > MAX_PC_HEIGHT
+		|| (Width * Height) % 4 != 0 || NumPieces > MAX_TABLE_PIECES)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot build a %d-line perfect clear table for width %d"), Height, Width);
+		return 0;
+	}
+
+	FTetrisSimBoard EmptyBoard;
+	EmptyBoard.Reset(Width, TetrisConstants::BOARD_HEIGHT);
+
+	// 先頭の2ピースごとに分けて並列に解く（ピース列は先頭が上位の7進数）
+	const int32 PrefixPieces = FMath::Min(NumPieces, 2);
+	int32 NumTasks = 1;
+	for (int32 Index = 0; Index < PrefixPieces; Index++)
+	{
+		NumTasks *= NUM_PIECE_TYPES;
+	}
+	int64 SequencesPerTask = 1;
+	for (int32 Index = PrefixPieces; Index < NumPieces; Index++)
+	{
+		SequencesPerTask *= NUM_PIECE_TYPES;
+	}
+
+	TArray<TArray<TPair<uint64, uint16>>> TaskEntries;
+	TaskEntries.SetNum(NumTasks);
+
+	ParallelFor(TEXT("TetrisPerfectClearTable"), NumTasks, 1, [&](int32 TaskIndex)
+	{
+		TArray<TPair<uint64, uint16>>& Entries = TaskEntries[TaskIndex];
+		TArray<EPieceType, TInlineAllocator<MAX_TABLE_PIECES>> Pieces;
+		Pieces.SetNum(NumPieces);
+
+		for (int64 Sequence = TaskIndex * SequencesPerTask; Sequence < (TaskIndex + 1) * SequencesPerTask; Sequence++)
+		{
+			int64 Rest = Sequence;
+			for (int32 Index = NumPieces - 1; Index >= 0; Index--)
+			{
+				Pieces[Index] = static_cast<EPieceType>(Rest % NUM_PIECE_TYPES + 1);
+				Rest /= NUM_PIECE_TYPES;
+			}
+
+			FPerfectClearSearch Search;
+			Search.Pieces = Pieces;
+			if (!Search.Search(EmptyBoard, Height, 0))
+			{
+				continue;
+			}
+
+			// 解の途中の状態も全て登録する
+			FTetrisSimBoard Board = EmptyBoard;
+			int32 FieldHeight = Height;
+			for (int32 Index = 0; Index < NumPieces; Index++)
+			{
+				uint64 Key = 0;
+				MakeTableKey(Board, FieldHeight, TArrayView<const EPieceType>(Pieces).Slice(Index, NumPieces - Index), Key);
+				Entries.Add({ Key, EncodeMove(Search.Path[Index], Board.Height - FieldHeight) });
+
+				Board.Place(Pieces[Index], Search.Path[Index].Rotation, Search.Path[Index].X, Search.Path[Index].Y);
+				FieldHeight -= Board.ClearFullRows();
+			}
+		}
+	}, MaxThreads == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	// キー順に並べ、同じキーは1つにまとめる（どの手でも解ける）
+	TArray<TPair<uint64, uint16>> AllEntries;
+	for (TArray<TPair<uint64, uint16>>& Entries : TaskEntries)
+	{
+		AllEntries.Append(MoveTemp(Entries));
+	}
+	Algo::Sort(AllEntries, [](const TPair<uint64, uint16>& A, const TPair<uint64, uint16>& B)
+	{
+		return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+	});
+
+	TArray<uint64> Keys;
+	TArray<uint16> Moves;
+	for (const TPair<uint64, uint16>& Entry : AllEntries)
+	{
+		if (Keys.Num() == 0 || Keys.Last() != Entry.Key)
+		{
+			Keys.Add(Entry.Key);
+			Moves.Add(Entry.Value);
+		}
+	}
+
+	FTableHeader Header;
+	Header.Width = static_cast<uint32>(Width);
+	Header.NumEntries = static_cast<uint64>(Keys.Num());
+
+	const int64 KeyBytes = Keys.Num() * sizeof(uint64);
+	const int64 MoveBytes = Moves.Num() * sizeof(uint16);
+	OutBytes.SetNumUninitialized(sizeof(FTableHeader) + KeyBytes + MoveBytes);
+	FMemory::Memcpy(OutBytes.GetData(), &Header, sizeof(FTableHeader));
+	FMemory::Memcpy(OutBytes.GetData() + sizeof(FTableHeader), Keys.GetData(), KeyBytes);
+	FMemory::Memcpy(OutBytes.GetData() + sizeof(FTableHeader) + KeyBytes, Moves.GetData(), MoveBytes);
+
+	return Keys.Num();
+}
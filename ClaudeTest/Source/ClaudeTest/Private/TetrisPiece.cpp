@@ -1,26 +1,26 @@
 #include "TetrisPiece.h"
 #include "TetrisBoard.h"
-#include "Components/InstancedStaticMeshComponent.h"
-#include "UObject/ConstructorHelpers.h"
 #include "Engine/Engine.h"
+#include "Net/UnrealNetwork.h"
+#include "TetrisZobrist.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "TetrisRuleset.h"
+#include "TetrisLatency.h"
+#include "TetrisStats.h"
 
 ATetrisPiece::ATetrisPiece()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// 状態はゲームモードが動かすので Tick しない
+	PrimaryActorTick.bCanEverTick = false;
 
-	// ルートコンポーネントの設定
-	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
-
-	// ブロック表示用のInstanced Static Mesh Component
-	BlockMeshComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BlockMeshComponent"));
-	BlockMeshComponent->SetupAttachment(RootComponent);
+	// サーバー権威でピース状態をレプリケート
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SetReplicateMovement(false);
 
-	// デフォルトメッシュの設定
-	static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMeshAsset(TEXT("/Engine/BasicShapes/Cube"));
-	if (CubeMeshAsset.Succeeded())
-	{
-		BlockMeshComponent->SetStaticMesh(CubeMeshAsset.Object);
-	}
+	// ルートコンポーネントの設定（ブロックはボードのインスタンスで描くのでメッシュは持たない）
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
 
 	// 初期値の設定
 	CurrentPieceType = EPieceType::None;
@@ -28,6 +28,7 @@ ATetrisPiece::ATetrisPiece()
 	BoardPosition = FTetrisCoordinate(0, 0);
 	PieceColor = FLinearColor::White;
 	bIsFixed = false;
+	Ruleset = ETetrisRuleset::Modern;
 	TetrisBoard = nullptr;
 
 	// ピースデータの初期化
@@ -39,9 +40,23 @@ void ATetrisPiece::BeginPlay()
 	Super::BeginPlay();
 }
 
-void ATetrisPiece::Tick(float DeltaTime)
+void ATetrisPiece::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	// ボードの予約済みインスタンスを隠す
+	if (!bIsFixed && IsValid(TetrisBoard))
+	{
+		TetrisBoard->ClearActivePieceCells();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATetrisPiece::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ATetrisPiece, TetrisBoard);
+	DOREPLIFETIME(ATetrisPiece, NetPieceState);
 }
 
 void ATetrisPiece::InitializePiece(EPieceType PieceType, ATetrisBoard* Board)
@@ -55,10 +70,11 @@ void ATetrisPiece::InitializePiece(EPieceType PieceType, ATetrisBoard* Board)
 	InitializePieceData();
 
 	// 初期位置の設定（ボード上部中央）
-	BoardPosition = FTetrisCoordinate(TetrisConstants::BOARD_WIDTH / 2 - 2, 0);
+	BoardPosition = FTetrisCoordinate(TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y);
 
 	// 表示の更新
 	UpdatePieceDisplay();
+	SyncNetPieceState();
 
 	UE_LOG(LogTemp, Warning, TEXT("Initialized Piece Type: %d at position (%d, %d)"), 
 		(int32)PieceType, BoardPosition.X, BoardPosition.Y);
@@ -97,6 +113,7 @@ bool ATetrisPiece::MovePieceBy(const FTetrisCoordinate& Delta)
 	{
 		BoardPosition = NewPosition;
 		UpdatePieceDisplay();
+		SyncNetPieceState();
 		return true;
 	}
 
@@ -130,6 +147,7 @@ bool ATetrisPiece::RotatePiece(bool bClockwise)
 	{
 		CurrentRotation = NewRotation;
 		UpdatePieceDisplay();
+		SyncNetPieceState();
 		return true;
 	}
 
@@ -138,25 +156,58 @@ bool ATetrisPiece::RotatePiece(bool bClockwise)
 	{
 		CurrentRotation = NewRotation;
 		UpdatePieceDisplay();
+		SyncNetPieceState();
 		return true;
 	}
 
 	return false;
 }
 
-int32 ATetrisPiece::HardDrop()
+int32 ATetrisPiece::ShiftToWall(EMoveDirection Direction)
+{
+	switch (Direction)
+	{
+	case EMoveDirection::Left:
+		return MoveUntilBlocked(FTetrisCoordinate(-1, 0));
+	case EMoveDirection::Right:
+		return MoveUntilBlocked(FTetrisCoordinate(1, 0));
+	default:
+		return SoftDropToFloor();
+	}
+}
+
+int32 ATetrisPiece::SoftDropToFloor()
+{
+	return MoveUntilBlocked(FTetrisCoordinate(0, 1));
+}
+
+int32 ATetrisPiece::MoveUntilBlocked(const FTetrisCoordinate& Step)
 {
 	if (bIsFixed || !TetrisBoard)
 	{
 		return 0;
 	}
 
-	int32 DropDistance = 0;
-	while (MovePiece(EMoveDirection::Down))
+	const int32 Distance = TetrisBoard->GetFreeDistance(GetCurrentBlockPositions(), Step.X, Step.Y);
+	if (Distance > 0)
 	{
-		DropDistance++;
+		BoardPosition = BoardPosition + FTetrisCoordinate(Step.X * Distance, Step.Y * Distance);
+		UpdatePieceDisplay();
+		SyncNetPieceState();
+	}
+	return Distance;
+}
+
+int32 ATetrisPiece::HardDrop()
+{
+	if (bIsFixed || !TetrisBoard)
+	{
+		return 0;
 	}
 
+	// 1行ずつ動かさず、床まで一度に落としてから固定する
+	const int32 DropDistance = SoftDropToFloor();
+	FixPiece();
 	return DropDistance;
 }
 
@@ -169,15 +220,15 @@ void ATetrisPiece::FixPiece()
 
 	bIsFixed = true;
 
-	// ボードにピースを固定
+	// ピースの表示を消してからボードに固定
+	TetrisBoard->ClearActivePieceCells();
 	TArray<FTetrisCoordinate> BlockPositions = GetCurrentBlockPositions();
 	for (const FTetrisCoordinate& BlockPos : BlockPositions)
 	{
 		TetrisBoard->SetBlock(BlockPos.X, BlockPos.Y, true, CurrentPieceType);
 	}
 
-	// 表示を非表示に
-	BlockMeshComponent->ClearInstances();
+	SyncNetPieceState();
 
 	UE_LOG(LogTemp, Warning, TEXT("Piece fixed at position (%d, %d)"), BoardPosition.X, BoardPosition.Y);
 }
@@ -249,6 +300,7 @@ bool ATetrisPiece::IsValidPositionOnBoard(const TArray<FTetrisCoordinate>& Block
 		return false;
 	}
 
+	INC_DWORD_STAT(STAT_TetrisCollisionQueries);
 	for (const FTetrisCoordinate& BlockPos : BlockPositions)
 	{
 		if (!TetrisBoard->IsPositionValid(BlockPos.X, BlockPos.Y))
@@ -262,292 +314,120 @@ bool ATetrisPiece::IsValidPositionOnBoard(const TArray<FTetrisCoordinate>& Block
 
 void ATetrisPiece::UpdatePieceDisplay()
 {
-	if (!BlockMeshComponent || bIsFixed)
+	if (!TetrisBoard || bIsFixed)
 	{
 		return;
 	}
 
-	// 既存のインスタンスをクリア
-	BlockMeshComponent->ClearInstances();
+	// ボードの予約済みインスタンス（ピース4個とゴースト4個）をその場で書き換える
+	TetrisBoard->SetActivePieceCells(GetCurrentBlockPositions(), CurrentPieceType);
 
-	// 現在のピースのブロック位置を取得
-	TArray<FTetrisCoordinate> BlockPositions = GetCurrentBlockPositions();
-
-	// 各ブロックを表示
-	for (const FTetrisCoordinate& BlockPos : BlockPositions)
-	{
-		FVector WorldPosition = GetWorldPositionFromBoard(BlockPos);
-		FTransform BlockTransform(FRotator::ZeroRotator, WorldPosition, FVector(1.0f));
-		BlockMeshComponent->AddInstance(BlockTransform);
-	}
+	TetrisLatency::MarkDisplayUpdated();
 }
 
-FVector ATetrisPiece::GetWorldPositionFromBoard(const FTetrisCoordinate& BoardPos) const
+void ATetrisPiece::SetPieceState(EPieceType PieceType, int32 Rotation, const FTetrisCoordinate& Position, bool bFixed)
 {
-	if (!TetrisBoard)
+	if (PieceType != CurrentPieceType)
 	{
-		return FVector::ZeroVector;
+		CurrentPieceType = PieceType;
+		InitializePieceData();
 	}
 
-	// ボードのブロックサイズを使用して世界座標を計算
-	float BlockSize = 100.0f; // TetrisBoard->GetBlockSize() if available
-	return FVector(BoardPos.X * BlockSize, BoardPos.Y * BlockSize, 50.0f);
-}
-
-bool ATetrisPiece::TryWallKick(int32 FromRotation, int32 ToRotation)
-{
-	TArray<FTetrisCoordinate> WallKickOffsets = GetWallKickOffsets(CurrentPieceType, FromRotation, ToRotation);
+	CurrentRotation = FMath::Clamp(Rotation, 0, 3);
+	BoardPosition = Position;
+	bIsFixed = bFixed;
 
-	for (const FTetrisCoordinate& Offset : WallKickOffsets)
+	if (bIsFixed)
 	{
-		FTetrisCoordinate TestPosition = BoardPosition + Offset;
-		if (CanMoveTo(TestPosition))
+		if (TetrisBoard)
 		{
-			BoardPosition = TestPosition;
-			return true;
+			TetrisBoard->ClearActivePieceCells();
 		}
 	}
+	else
+	{
+		UpdatePieceDisplay();
+	}
 
-	return false;
+	SyncNetPieceState();
 }
 
-TArray<FTetrisCoordinate> ATetrisPiece::GetWallKickOffsets(EPieceType PieceType, int32 FromRotation, int32 ToRotation) const
+uint64 ATetrisPiece::GetStateHash() const
 {
-	TArray<FTetrisCoordinate> Offsets;
-
-	// 簡単なWall Kick実装（SRS準拠ではないが基本的な機能を提供）
-	if (PieceType == EPieceType::I_Piece)
+	if (bIsFixed)
 	{
-		// I-Piece用の特別なWall Kick
-		Offsets.Add(FTetrisCoordinate(0, 0));
-		Offsets.Add(FTetrisCoordinate(-1, 0));
-		Offsets.Add(FTetrisCoordinate(1, 0));
-		Offsets.Add(FTetrisCoordinate(0, -1));
-	}
-	else if (PieceType != EPieceType::O_Piece)
-	{
-		// O-Piece以外の標準的なWall Kick
-		Offsets.Add(FTetrisCoordinate(0, 0));
-		Offsets.Add(FTetrisCoordinate(-1, 0));
-		Offsets.Add(FTetrisCoordinate(1, 0));
-		Offsets.Add(FTetrisCoordinate(0, -1));
-		Offsets.Add(FTetrisCoordinate(-1, -1));
-		Offsets.Add(FTetrisCoordinate(1, -1));
+		return 0;
 	}
-
-	return Offsets;
+	return TetrisZobrist::GetPieceKey(CurrentPieceType, CurrentRotation, BoardPosition.X, BoardPosition.Y);
 }
 
-void ATetrisPiece::InitializePieceData()
+void ATetrisPiece::SyncNetPieceState()
 {
-	// 各ピース形状の初期化
-	PieceRotations.SetNum(4);
-	for (int32 i = 0; i < 4; i++)
+	if (!HasAuthority())
 	{
-		PieceRotations[i] = FTetrisPieceShape();
+		return;
 	}
 
-	switch (CurrentPieceType)
-	{
-	case EPieceType::I_Piece:
-		CreateIPieceData();
-		PieceColor = TetrisPieceColors::I_COLOR;
-		break;
-	case EPieceType::O_Piece:
-		CreateOPieceData();
-		PieceColor = TetrisPieceColors::O_COLOR;
-		break;
-	case EPieceType::T_Piece:
-		CreateTPieceData();
-		PieceColor = TetrisPieceColors::T_COLOR;
-		break;
-	case EPieceType::S_Piece:
-		CreateSPieceData();
-		PieceColor = TetrisPieceColors::S_COLOR;
-		break;
-	case EPieceType::Z_Piece:
-		CreateZPieceData();
-		PieceColor = TetrisPieceColors::Z_COLOR;
-		break;
-	case EPieceType::J_Piece:
-		CreateJPieceData();
-		PieceColor = TetrisPieceColors::J_COLOR;
-		break;
-	case EPieceType::L_Piece:
-		CreateLPieceData();
-		PieceColor = TetrisPieceColors::L_COLOR;
-		break;
-	default:
-		break;
-	}
+	NetPieceState.PieceType = CurrentPieceType;
+	NetPieceState.Rotation = static_cast<uint8>(CurrentRotation);
+	NetPieceState.X = static_cast<int8>(BoardPosition.X);
+	NetPieceState.Y = static_cast<int8>(BoardPosition.Y);
+	NetPieceState.bFixed = bIsFixed;
 }
 
-void ATetrisPiece::CreateIPieceData()
+void ATetrisPiece::OnRep_NetPieceState()
 {
-	// I-Piece (■■■■)
-	// Rotation 0: Horizontal
-	PieceRotations[0].Shape[1][0] = true;
-	PieceRotations[0].Shape[1][1] = true;
-	PieceRotations[0].Shape[1][2] = true;
-	PieceRotations[0].Shape[1][3] = true;
-
-	// Rotation 1: Vertical
-	PieceRotations[1].Shape[0][2] = true;
-	PieceRotations[1].Shape[1][2] = true;
-	PieceRotations[1].Shape[2][2] = true;
-	PieceRotations[1].Shape[3][2] = true;
-
-	// Rotation 2: Horizontal
-	PieceRotations[2].Shape[2][0] = true;
-	PieceRotations[2].Shape[2][1] = true;
-	PieceRotations[2].Shape[2][2] = true;
-	PieceRotations[2].Shape[2][3] = true;
-
-	// Rotation 3: Vertical
-	PieceRotations[3].Shape[0][1] = true;
-	PieceRotations[3].Shape[1][1] = true;
-	PieceRotations[3].Shape[2][1] = true;
-	PieceRotations[3].Shape[3][1] = true;
+	SetPieceState(NetPieceState.PieceType, NetPieceState.Rotation,
+		FTetrisCoordinate(NetPieceState.X, NetPieceState.Y), NetPieceState.bFixed);
 }
 
-void ATetrisPiece::CreateOPieceData()
+bool ATetrisPiece::TryWallKick(int32 FromRotation, int32 ToRotation)
 {
-	// O-Piece (正方形) - 回転しても同じ
-	for (int32 Rotation = 0; Rotation < 4; Rotation++)
+	// ずらした位置で回転後の形状が置けるかを試す
+	const FTetrisCoordinate OriginalPosition = BoardPosition;
+	for (const FTetrisCoordinate& Offset : GetWallKickOffsets(CurrentPieceType, FromRotation, ToRotation))
 	{
-		PieceRotations[Rotation].Shape[0][1] = true;
-		PieceRotations[Rotation].Shape[0][2] = true;
-		PieceRotations[Rotation].Shape[1][1] = true;
-		PieceRotations[Rotation].Shape[1][2] = true;
+		BoardPosition = OriginalPosition + Offset;
+		if (CanRotateTo(ToRotation))
+		{
+			return true;
+		}
 	}
-}
 
-void ATetrisPiece::CreateTPieceData()
-{
-	// T-Piece
-	// Rotation 0: T shape upward
-	PieceRotations[0].Shape[0][1] = true;
-	PieceRotations[0].Shape[1][0] = true;
-	PieceRotations[0].Shape[1][1] = true;
-	PieceRotations[0].Shape[1][2] = true;
-
-	// Rotation 1: T shape right
-	PieceRotations[1].Shape[0][1] = true;
-	PieceRotations[1].Shape[1][1] = true;
-	PieceRotations[1].Shape[1][2] = true;
-	PieceRotations[1].Shape[2][1] = true;
-
-	// Rotation 2: T shape downward
-	PieceRotations[2].Shape[1][0] = true;
-	PieceRotations[2].Shape[1][1] = true;
-	PieceRotations[2].Shape[1][2] = true;
-	PieceRotations[2].Shape[2][1] = true;
-
-	// Rotation 3: T shape left
-	PieceRotations[3].Shape[0][1] = true;
-	PieceRotations[3].Shape[1][0] = true;
-	PieceRotations[3].Shape[1][1] = true;
-	PieceRotations[3].Shape[2][1] = true;
+	BoardPosition = OriginalPosition;
+	return false;
 }
 
-void ATetrisPiece::CreateSPieceData()
+TArray<FTetrisCoordinate> ATetrisPiece::GetWallKickOffsets(EPieceType PieceType, int32 FromRotation, int32 ToRotation) const
 {
-	// S-Piece
-	// Rotation 0: S shape
-	PieceRotations[0].Shape[0][1] = true;
-	PieceRotations[0].Shape[0][2] = true;
-	PieceRotations[0].Shape[1][0] = true;
-	PieceRotations[0].Shape[1][1] = true;
-
-	// Rotation 1: S shape rotated
-	PieceRotations[1].Shape[0][1] = true;
-	PieceRotations[1].Shape[1][1] = true;
-	PieceRotations[1].Shape[1][2] = true;
-	PieceRotations[1].Shape[2][2] = true;
-
-	// Rotation 2: Same as 0
-	PieceRotations[2] = PieceRotations[0];
-
-	// Rotation 3: Same as 1
-	PieceRotations[3] = PieceRotations[1];
+	// 簡易 Wall Kick（SRS準拠ではない）。オフセットはルールセットで共有
+	TArray<FTetrisCoordinate> Offsets;
+	for (const TetrisRules::FKickOffset& Kick : FTetrisRuleset::Get(Ruleset).GetWallKickOffsets(PieceType))
+	{
+		Offsets.Add(FTetrisCoordinate(Kick.X, Kick.Y));
+	}
+	return Offsets;
 }
 
-void ATetrisPiece::CreateZPieceData()
+void ATetrisPiece::InitializePieceData()
 {
-	// Z-Piece (S-Pieceの逆)
-	// Rotation 0: Z shape
-	PieceRotations[0].Shape[0][0] = true;
-	PieceRotations[0].Shape[0][1] = true;
-	PieceRotations[0].Shape[1][1] = true;
-	PieceRotations[0].Shape[1][2] = true;
-
-	// Rotation 1: Z shape rotated
-	PieceRotations[1].Shape[0][2] = true;
-	PieceRotations[1].Shape[1][1] = true;
-	PieceRotations[1].Shape[1][2] = true;
-	PieceRotations[1].Shape[2][1] = true;
-
-	// Rotation 2: Same as 0
-	PieceRotations[2] = PieceRotations[0];
-
-	// Rotation 3: Same as 1
-	PieceRotations[3] = PieceRotations[1];
-}
+	// 共有テーブルから各回転の形状を展開
+	PieceRotations.SetNum(4);
+	for (int32 Rotation = 0; Rotation < 4; Rotation++)
+	{
+		PieceRotations[Rotation] = FTetrisPieceShape();
 
-void ATetrisPiece::CreateJPieceData()
-{
-	// J-Piece
-	// Rotation 0: J shape
-	PieceRotations[0].Shape[0][0] = true;
-	PieceRotations[0].Shape[1][0] = true;
-	PieceRotations[0].Shape[1][1] = true;
-	PieceRotations[0].Shape[1][2] = true;
-
-	// Rotation 1: J shape rotated
-	PieceRotations[1].Shape[0][1] = true;
-	PieceRotations[1].Shape[0][2] = true;
-	PieceRotations[1].Shape[1][1] = true;
-	PieceRotations[1].Shape[2][1] = true;
-
-	// Rotation 2: J shape inverted
-	PieceRotations[2].Shape[1][0] = true;
-	PieceRotations[2].Shape[1][1] = true;
-	PieceRotations[2].Shape[1][2] = true;
-	PieceRotations[2].Shape[2][2] = true;
-
-	// Rotation 3: J shape rotated left
-	PieceRotations[3].Shape[0][1] = true;
-	PieceRotations[3].Shape[1][1] = true;
-	PieceRotations[3].Shape[2][0] = true;
-	PieceRotations[3].Shape[2][1] = true;
-}
+		const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(CurrentPieceType, Rotation);
+		for (int32 Y = 0; Y < 4; Y++)
+		{
+			for (int32 X = 0; X < 4; X++)
+			{
+				PieceRotations[Rotation].Shape[Y][X] = TetrisPieceTables::IsShapeCellSet(ShapeMask, X, Y);
+			}
+		}
+	}
 
-void ATetrisPiece::CreateLPieceData()
-{
-	// L-Piece (J-Pieceのミラー)
-	// Rotation 0: L shape
-	PieceRotations[0].Shape[0][2] = true;
-	PieceRotations[0].Shape[1][0] = true;
-	PieceRotations[0].Shape[1][1] = true;
-	PieceRotations[0].Shape[1][2] = true;
-
-	// Rotation 1: L shape rotated
-	PieceRotations[1].Shape[0][1] = true;
-	PieceRotations[1].Shape[1][1] = true;
-	PieceRotations[1].Shape[2][1] = true;
-	PieceRotations[1].Shape[2][2] = true;
-
-	// Rotation 2: L shape inverted
-	PieceRotations[2].Shape[1][0] = true;
-	PieceRotations[2].Shape[1][1] = true;
-	PieceRotations[2].Shape[1][2] = true;
-	PieceRotations[2].Shape[2][0] = true;
-
-	// Rotation 3: L shape rotated left
-	PieceRotations[3].Shape[0][0] = true;
-	PieceRotations[3].Shape[0][1] = true;
-	PieceRotations[3].Shape[1][1] = true;
-	PieceRotations[3].Shape[2][1] = true;
+	PieceColor = TetrisPieceTables::GetPieceColor(CurrentPieceType);
 }
 
 void ATetrisPiece::DebugPrintPiece() const
@@ -1,18 +1,30 @@
 #include "TetrisPlayerController.h"
 #include "TetrisGameMode.h"
+#include "TetrisBoard.h"
+#include "TetrisWorldSubsystem.h"
+#include "TetrisLatency.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
 #include "InputAction.h"
 #include "Engine/Engine.h"
 
+namespace
+{
+	// 長押しの移動をまだ送っていない
+	constexpr uint64 NO_SHIFT_REVISION = MAX_uint64;
+}
+
 ATetrisPlayerController::ATetrisPlayerController()
 {
+	// エンジンの入力処理（PlayerTick）のために Tick は残す
+	// キーリピートは UTetrisWorldSubsystem の入力フェーズで処理する
 	PrimaryActorTick.bCanEverTick = true;
 
 	// デフォルト設定
 	RepeatDelay = 0.3f;    // 最初のリピートまでの遅延
-	RepeatRate = 0.05f;    // リピート間隔
+	RepeatRate = 0.05f;    // リピート間隔（0 以下で ARR 0）
+	bInstantSoftDrop = false;
 	bInputEnabled = true;
 
 	// 入力状態の初期化
@@ -24,6 +36,13 @@ ATetrisPlayerController::ATetrisPlayerController()
 	RightMoveTimer = 0.0f;
 	DownMoveTimer = 0.0f;
 
+	LeftRepeatCount = 0;
+	RightRepeatCount = 0;
+
+	LeftShiftRevision = NO_SHIFT_REVISION;
+	RightShiftRevision = NO_SHIFT_REVISION;
+	DownShiftRevision = NO_SHIFT_REVISION;
+
 	TetrisGameMode = nullptr;
 }
 
@@ -42,6 +61,23 @@ void ATetrisPlayerController::BeginPlay()
 
 	// ゲームモードの参照を取得
 	CacheGameModeReference();
+
+	TetrisLatency::Initialize();
+
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->RegisterController(this);
+	}
+}
+
+void ATetrisPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTetrisWorldSubsystem* TetrisSubsystem = UTetrisWorldSubsystem::Get(this))
+	{
+		TetrisSubsystem->UnregisterController(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ATetrisPlayerController::SetupInputComponent()
@@ -98,10 +134,8 @@ void ATetrisPlayerController::SetupInputComponent()
 	}
 }
 
-void ATetrisPlayerController::Tick(float DeltaTime)
+void ATetrisPlayerController::TickInput(float DeltaTime)
 {
-	Super::Tick(DeltaTime);
-
 	if (bInputEnabled)
 	{
 		HandleRepeatInput(DeltaTime);
@@ -123,25 +157,7 @@ void ATetrisPlayerController::ProcessLeftMovement(float DeltaTime)
 		return;
 	}
 
-	LeftMoveTimer += DeltaTime;
-
-	// 最初の移動後、リピート処理
-	if (LeftMoveTimer >= RepeatDelay)
-	{
-		float TimeSinceFirstRepeat = LeftMoveTimer - RepeatDelay;
-		int32 RepeatCount = FMath::FloorToInt(TimeSinceFirstRepeat / RepeatRate);
-
-		// 前回のRepeatCountから変化があった場合のみ移動
-		static int32 LastLeftRepeatCount = -1;
-		if (RepeatCount > LastLeftRepeatCount)
-		{
-			LastLeftRepeatCount = RepeatCount;
-			if (TetrisGameMode)
-			{
-				TetrisGameMode->HandleMoveLeft();
-			}
-		}
-	}
+	ProcessHorizontalRepeat(LeftMoveTimer, LeftRepeatCount, LeftShiftRevision, DeltaTime, ETetrisInputCommand::MoveLeft, ETetrisInputCommand::ShiftLeft);
 }
 
 void ATetrisPlayerController::ProcessRightMovement(float DeltaTime)
@@ -152,22 +168,29 @@ void ATetrisPlayerController::ProcessRightMovement(float DeltaTime)
 		return;
 	}
 
-	RightMoveTimer += DeltaTime;
+	ProcessHorizontalRepeat(RightMoveTimer, RightRepeatCount, RightShiftRevision, DeltaTime, ETetrisInputCommand::MoveRight, ETetrisInputCommand::ShiftRight);
+}
 
-	if (RightMoveTimer >= RepeatDelay)
+void ATetrisPlayerController::ProcessHorizontalRepeat(float& MoveTimer, int32& RepeatCount, uint64& ShiftRevision, float DeltaTime, ETetrisInputCommand MoveCommand, ETetrisInputCommand ShiftCommand)
+{
+	MoveTimer += DeltaTime;
+	if (MoveTimer < RepeatDelay)
 	{
-		float TimeSinceFirstRepeat = RightMoveTimer - RepeatDelay;
-		int32 RepeatCount = FMath::FloorToInt(TimeSinceFirstRepeat / RepeatRate);
+		return;
+	}
 
-		static int32 LastRightRepeatCount = -1;
-		if (RepeatCount > LastRightRepeatCount)
-		{
-			LastRightRepeatCount = RepeatCount;
-			if (TetrisGameMode)
-			{
-				TetrisGameMode->HandleMoveRight();
-			}
-		}
+	// ARR 0：DAS が過ぎた後は壁まで（新しいピースや回転・落下の後も押している間は壁に付く）
+	if (RepeatRate <= 0.0f)
+	{
+		DispatchHeldShift(ShiftCommand, ShiftRevision, MoveTimer);
+		return;
+	}
+
+	// 前回から増えた分だけ1列ずつ（フレームが長くても遅れを取り戻す）
+	const int32 TargetCount = FMath::FloorToInt((MoveTimer - RepeatDelay) / RepeatRate) + 1;
+	for (; RepeatCount < TargetCount; RepeatCount++)
+	{
+		DispatchInputCommand(MoveCommand, false);
 	}
 }
 
@@ -181,57 +204,97 @@ void ATetrisPlayerController::ProcessDownMovement(float DeltaTime)
 
 	DownMoveTimer += DeltaTime;
 
+	// 床までのソフトドロップ：押している間は床まで（横に動かして段差から落ちた時も）
+	if (bInstantSoftDrop)
+	{
+		DispatchHeldShift(ETetrisInputCommand::SoftDropToFloor, DownShiftRevision, DownMoveTimer);
+		return;
+	}
+
 	if (DownMoveTimer >= RepeatRate) // 下移動は高速リピート
 	{
 		DownMoveTimer = 0.0f;
-		if (TetrisGameMode)
+		DispatchInputCommand(ETetrisInputCommand::MoveDown, false);
+	}
+}
+
+uint64 ATetrisPlayerController::GetShiftRevision() const
+{
+	const ATetrisBoard* Board = TetrisGameMode ? TetrisGameMode->GetTetrisBoard() : nullptr;
+	if (!Board)
+	{
+		return NO_SHIFT_REVISION;
+	}
+	return (uint64(Board->GetCellRevision()) << 32) | Board->GetActivePieceRevision();
+}
+
+void ATetrisPlayerController::DispatchHeldShift(ETetrisInputCommand Command, uint64& ShiftRevision, float& HeldTimer)
+{
+	const uint64 Revision = GetShiftRevision();
+	if (Revision == NO_SHIFT_REVISION)
+	{
+		// クライアントからはピースが見えないので、DAS ごとに送り直す（新しいピースも DAS 以内に壁・床に付く）
+		if (HeldTimer >= RepeatDelay)
 		{
-			TetrisGameMode->HandleMoveDown();
+			HeldTimer -= RepeatDelay;
+			DispatchInputCommand(Command, false);
 		}
+		return;
 	}
+
+	// 前回送ってからピース（出現・移動・回転・落下）も盤面も変わっていなければ、動ける先はない
+	if (Revision == ShiftRevision)
+	{
+		return;
+	}
+	DispatchInputCommand(Command, false);
+	ShiftRevision = GetShiftRevision();
 }
 
 // 入力アクション処理関数
 void ATetrisPlayerController::OnMoveLeft(const FInputActionValue& Value)
 {
-	if (!bInputEnabled || !TetrisGameMode) return;
-	TetrisGameMode->HandleMoveLeft();
+	if (!bInputEnabled) return;
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::MoveLeft);
 }
 
 void ATetrisPlayerController::OnMoveRight(const FInputActionValue& Value)
 {
-	if (!bInputEnabled || !TetrisGameMode) return;
-	TetrisGameMode->HandleMoveRight();
+	if (!bInputEnabled) return;
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::MoveRight);
 }
 
 void ATetrisPlayerController::OnMoveDown(const FInputActionValue& Value)
 {
-	if (!bInputEnabled || !TetrisGameMode) return;
-	TetrisGameMode->HandleMoveDown();
+	if (!bInputEnabled) return;
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::MoveDown);
 }
 
 void ATetrisPlayerController::OnRotate(const FInputActionValue& Value)
 {
-	if (!bInputEnabled || !TetrisGameMode) return;
-	TetrisGameMode->HandleRotate();
+	if (!bInputEnabled) return;
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::Rotate);
 }
 
 void ATetrisPlayerController::OnHardDrop(const FInputActionValue& Value)
 {
-	if (!bInputEnabled || !TetrisGameMode) return;
-	TetrisGameMode->HandleHardDrop();
+	if (!bInputEnabled) return;
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::HardDrop);
 }
 
 void ATetrisPlayerController::OnPause(const FInputActionValue& Value)
 {
-	if (!TetrisGameMode) return;
-	TetrisGameMode->HandlePause();
+	DispatchInputCommand(ETetrisInputCommand::Pause);
 }
 
 void ATetrisPlayerController::OnRestart(const FInputActionValue& Value)
 {
-	if (!TetrisGameMode) return;
-	TetrisGameMode->RestartGame();
+	DispatchInputCommand(ETetrisInputCommand::Restart);
 }
 
 // 入力開始/終了処理
@@ -241,12 +304,12 @@ void ATetrisPlayerController::OnMoveLeftStarted(const FInputActionValue& Value)
 	
 	bIsMovingLeft = true;
 	LeftMoveTimer = 0.0f;
+	LeftRepeatCount = 0;
+	LeftShiftRevision = NO_SHIFT_REVISION;
 	
 	// 即座に1回移動
-	if (TetrisGameMode)
-	{
-		TetrisGameMode->HandleMoveLeft();
-	}
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::MoveLeft);
 }
 
 void ATetrisPlayerController::OnMoveLeftCompleted(const FInputActionValue& Value)
@@ -261,11 +324,11 @@ void ATetrisPlayerController::OnMoveRightStarted(const FInputActionValue& Value)
 	
 	bIsMovingRight = true;
 	RightMoveTimer = 0.0f;
+	RightRepeatCount = 0;
+	RightShiftRevision = NO_SHIFT_REVISION;
 	
-	if (TetrisGameMode)
-	{
-		TetrisGameMode->HandleMoveRight();
-	}
+	TetrisLatency::StampInput();
+	DispatchInputCommand(ETetrisInputCommand::MoveRight);
 }
 
 void ATetrisPlayerController::OnMoveRightCompleted(const FInputActionValue& Value)
@@ -281,10 +344,9 @@ void ATetrisPlayerController::OnMoveDownStarted(const FInputActionValue& Value)
 	bIsMovingDown = true;
 	DownMoveTimer = 0.0f;
 	
-	if (TetrisGameMode)
-	{
-		TetrisGameMode->HandleMoveDown();
-	}
+	TetrisLatency::StampInput();
+	DispatchInputCommand(bInstantSoftDrop ? ETetrisInputCommand::SoftDropToFloor : ETetrisInputCommand::MoveDown);
+	DownShiftRevision = GetShiftRevision();
 }
 
 void ATetrisPlayerController::OnMoveDownCompleted(const FInputActionValue& Value)
@@ -303,4 +365,34 @@ void ATetrisPlayerController::CacheGameModeReference()
 			UE_LOG(LogTemp, Warning, TEXT("Tetris PlayerController connected to GameMode"));
 		}
 	}
-}
\ No newline at end of file
+}
+
+void ATetrisPlayerController::DispatchInputCommand(ETetrisInputCommand Command, bool bKeyPress)
+{
+	// サーバー（リッスンサーバーのホスト含む）は直接処理、クライアントはRPCで送信
+	if (TetrisGameMode)
+	{
+		if (bKeyPress)
+		{
+			TetrisGameMode->NotifyKeyPress(Command);
+		}
+		TetrisGameMode->HandleInputCommand(Command);
+	}
+	else if (!HasAuthority())
+	{
+		ServerSubmitInputCommand(Command);
+	}
+}
+
+void ATetrisPlayerController::ServerSubmitInputCommand_Implementation(ETetrisInputCommand Command)
+{
+	if (!TetrisGameMode)
+	{
+		CacheGameModeReference();
+	}
+
+	if (TetrisGameMode)
+	{
+		TetrisGameMode->HandleInputCommand(Command);
+	}
+}
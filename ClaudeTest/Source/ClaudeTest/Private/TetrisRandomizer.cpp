@@ -0,0 +1,252 @@
+#include "TetrisRandomizer.h"
+#include "TetrisSerialization.h"
+
+namespace
+{
+	const EPieceType AllPieceTypes[7] =
+	{
+		EPieceType::I_Piece,
+		EPieceType::O_Piece,
+		EPieceType::T_Piece,
+		EPieceType::S_Piece,
+		EPieceType::Z_Piece,
+		EPieceType::J_Piece,
+		EPieceType::L_Piece
+	};
+
+	void ResetStream(FTetrisRandomizerState& State, int32 Seed)
+	{
+		State.RandomStream.Initialize(Seed);
+		State.PoolCount = 0;
+		State.PoolIndex = 0;
+		State.bFirstPiece = true;
+		for (EPieceType& Piece : State.History)
+		{
+			Piece = EPieceType::None;
+		}
+	}
+
+	// Copies 組の7種類を詰めてシャッフル
+	void RefillBag(FTetrisRandomizerState& State, int32 Copies)
+	{
+		State.PoolCount = static_cast<uint8>(7 * Copies);
+		for (int32 i = 0; i < State.PoolCount; i++)
+		{
+			State.Pool[i] = AllPieceTypes[i % 7];
+		}
+
+		for (int32 i = State.PoolCount - 1; i > 0; i--)
+		{
+			const int32 j = State.RandomStream.RandRange(0, i);
+			Swap(State.Pool[i], State.Pool[j]);
+		}
+
+		State.PoolIndex = 0;
+	}
+
+	EPieceType NextFromBag(FTetrisRandomizerState& State, int32 Copies)
+	{
+		if (State.PoolIndex >= State.PoolCount)
+		{
+			RefillBag(State, Copies);
+		}
+		return State.Pool[State.PoolIndex++];
+	}
+}
+
+void FTetrisSevenBagPolicy::Reset(FTetrisRandomizerState& State, int32 Seed)
+{
+	ResetStream(State, Seed);
+}
+
+EPieceType FTetrisSevenBagPolicy::Next(FTetrisRandomizerState& State)
+{
+	return NextFromBag(State, 1);
+}
+
+void FTetrisFourteenBagPolicy::Reset(FTetrisRandomizerState& State, int32 Seed)
+{
+	ResetStream(State, Seed);
+}
+
+EPieceType FTetrisFourteenBagPolicy::Next(FTetrisRandomizerState& State)
+{
+	return NextFromBag(State, 2);
+}
+
+void FTetrisTGMHistoryPolicy::Reset(FTetrisRandomizerState& State, int32 Seed)
+{
+	ResetStream(State, Seed);
+
+	// 履歴は Z で埋めた状態から始まる
+	for (EPieceType& Piece : State.History)
+	{
+		Piece = EPieceType::Z_Piece;
+	}
+}
+
+EPieceType FTetrisTGMHistoryPolicy::Next(FTetrisRandomizerState& State)
+{
+	EPieceType Piece = EPieceType::None;
+
+	if (State.bFirstPiece)
+	{
+		// 最初のピースは S/Z/O 以外
+		static const EPieceType FirstPieces[4] = { EPieceType::I_Piece, EPieceType::T_Piece, EPieceType::J_Piece, EPieceType::L_Piece };
+		Piece = FirstPieces[State.RandomStream.RandRange(0, 3)];
+		State.bFirstPiece = false;
+	}
+	else
+	{
+		for (int32 Roll = 0; Roll < ROLLS; Roll++)
+		{
+			Piece = AllPieceTypes[State.RandomStream.RandRange(0, 6)];
+
+			bool bInHistory = false;
+			for (EPieceType HistoryPiece : State.History)
+			{
+				bInHistory |= HistoryPiece == Piece;
+			}
+
+			if (!bInHistory)
+			{
+				break;
+			}
+		}
+	}
+
+	// 履歴を1つずらす
+	for (int32 i = FTetrisRandomizerState::HISTORY_SIZE - 1; i > 0; i--)
+	{
+		State.History[i] = State.History[i - 1];
+	}
+	State.History[0] = Piece;
+
+	return Piece;
+}
+
+void FTetrisPureRandomPolicy::Reset(FTetrisRandomizerState& State, int32 Seed)
+{
+	ResetStream(State, Seed);
+}
+
+EPieceType FTetrisPureRandomPolicy::Next(FTetrisRandomizerState& State)
+{
+	return AllPieceTypes[State.RandomStream.RandRange(0, 6)];
+}
+
+const FTetrisRandomizer& FTetrisRandomizer::Get(ETetrisRandomizerType Type)
+{
+	static const TTetrisRandomizer<FTetrisSevenBagPolicy> SevenBag;
+	static const TTetrisRandomizer<FTetrisFourteenBagPolicy> FourteenBag;
+	static const TTetrisRandomizer<FTetrisTGMHistoryPolicy> TGMHistory;
+	static const TTetrisRandomizer<FTetrisPureRandomPolicy> PureRandom;
+
+	switch (Type)
+	{
+	case ETetrisRandomizerType::FourteenBag:
+		return FourteenBag;
+	case ETetrisRandomizerType::TGMHistory:
+		return TGMHistory;
+	case ETetrisRandomizerType::PureRandom:
+		return PureRandom;
+	default:
+		return SevenBag;
+	}
+}
+
+void FTetrisPieceQueue::Initialize(ETetrisRandomizerType InRandomizerType, int32 Seed, int32 InPreviewCount)
+{
+	RandomizerType = InRandomizerType;
+	InitialSeed = Seed;
+	PreviewCount = static_cast<uint8>(FMath::Clamp(InPreviewCount, 1, MAX_PREVIEW));
+	Head = 0;
+
+	const FTetrisRandomizer& Randomizer = FTetrisRandomizer::Get(RandomizerType);
+	Randomizer.Reset(RandomizerState, Seed);
+
+	// 先読み分を生成しておく
+	for (int32 i = 0; i < PreviewCount; i++)
+	{
+		Ring[i] = Randomizer.Next(RandomizerState);
+	}
+}
+
+EPieceType FTetrisPieceQueue::Pop()
+{
+	if (PreviewCount == 0)
+	{
+		return EPieceType::None;
+	}
+
+	const EPieceType Piece = Ring[Head];
+	Ring[Head] = FTetrisRandomizer::Get(RandomizerType).Next(RandomizerState);
+	Head = static_cast<uint8>((Head + 1) % PreviewCount);
+	return Piece;
+}
+
+EPieceType FTetrisPieceQueue::Peek(int32 Index) const
+{
+	if (Index < 0 || Index >= PreviewCount)
+	{
+		return EPieceType::None;
+	}
+	return Ring[(Head + Index) % PreviewCount];
+}
+
+void FTetrisPieceQueue::GetPreview(TArray<EPieceType>& OutPieces, int32 MaxCount) const
+{
+	const int32 Count = FMath::Min<int32>(MaxCount, PreviewCount);
+	OutPieces.SetNum(Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		OutPieces[i] = Peek(i);
+	}
+}
+
+void FTetrisPieceQueue::Serialize(FArchive& Ar)
+{
+	using namespace TetrisSerialization;
+
+	SerializeEnum8(Ar, RandomizerType, ETetrisRandomizerType::SevenBag, ETetrisRandomizerType::PureRandom);
+	Ar << InitialSeed;
+
+	// 乱数ストリームは現在のシードだけで再現できる
+	int32 CurrentSeed = RandomizerState.RandomStream.GetCurrentSeed();
+	Ar << CurrentSeed;
+	if (Ar.IsLoading())
+	{
+		RandomizerState.RandomStream.Initialize(CurrentSeed);
+	}
+
+	Ar << RandomizerState.PoolCount;
+	Ar << RandomizerState.PoolIndex;
+	if (RandomizerState.PoolCount > FTetrisRandomizerState::MAX_POOL)
+	{
+		Ar.SetError();
+		return;
+	}
+	for (int32 i = 0; i < RandomizerState.PoolCount; i++)
+	{
+		SerializePieceType(Ar, RandomizerState.Pool[i], false);
+	}
+	for (EPieceType& Piece : RandomizerState.History)
+	{
+		SerializePieceType(Ar, Piece, true);
+	}
+	uint8 FirstPieceValue = RandomizerState.bFirstPiece ? 1 : 0;
+	Ar << FirstPieceValue;
+	RandomizerState.bFirstPiece = FirstPieceValue != 0;
+
+	Ar << PreviewCount;
+	Ar << Head;
+	if (PreviewCount > MAX_PREVIEW || (PreviewCount > 0 && Head >= PreviewCount))
+	{
+		Ar.SetError();
+		return;
+	}
+	for (int32 i = 0; i < PreviewCount; i++)
+	{
+		SerializePieceType(Ar, Ring[i], false);
+	}
+}
@@ -0,0 +1,358 @@
+#include "TetrisReplay.h"
+#include "TetrisSerialization.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	const uint32 REPLAY_MAGIC = 0x4C505254;	// "TRPL"
+	const uint32 INDEX_MAGIC = 0x49505254;	// "TRPI"
+	const uint8 REPLAY_VERSION = 3;	// 2: ヘッダーにルールセット、3: コード 5-7 に ShiftLeft/ShiftRight/SoftDropToFloor
+
+	// 入力1つ = フレーム差とコマンド（下位3bit）
+	const int32 COMMAND_BITS = 3;
+
+	// 記録しない Pause/Restart の番号（5, 6）と空いていた 7 を後から足したコマンドに使う
+	// 版 2 までのファイルにはコード 5-7 は無いので、あれば壊れたファイルとして扱う
+	const uint8 SHIFTED_COMMAND_VERSION = 3;
+	const uint8 FIRST_SHIFTED_COMMAND = static_cast<uint8>(ETetrisInputCommand::ShiftLeft);
+	const uint8 SHIFTED_COMMAND_OFFSET = FIRST_SHIFTED_COMMAND - static_cast<uint8>(ETetrisInputCommand::Pause);
+
+	uint64 EncodeCommand(ETetrisInputCommand Command)
+	{
+		const uint8 Code = static_cast<uint8>(Command);
+		return Code >= FIRST_SHIFTED_COMMAND ? Code - SHIFTED_COMMAND_OFFSET : Code;
+	}
+
+	bool IsValidCommandCode(uint64 Code, uint8 Version)
+	{
+		return Version >= SHIFTED_COMMAND_VERSION || Code < static_cast<uint8>(ETetrisInputCommand::Pause);
+	}
+
+	ETetrisInputCommand DecodeCommand(uint64 Code)
+	{
+		return static_cast<ETetrisInputCommand>(Code >= static_cast<uint8>(ETetrisInputCommand::Pause) ? Code + SHIFTED_COMMAND_OFFSET : Code);
+	}
+
+	// フッター = 索引の位置（8バイト）+ INDEX_MAGIC
+	const int64 FOOTER_SIZE = sizeof(uint64) + sizeof(uint32);
+
+	void SerializeVarInt64(FArchive& Ar, int64& Value)
+	{
+		uint64 Unsigned = static_cast<uint64>(Value);
+		TetrisSerialization::SerializeVarUInt(Ar, Unsigned);
+		Value = static_cast<int64>(Unsigned);
+	}
+
+	void SerializeConfig(FArchive& Ar, FTetrisSimConfig& Config, uint8 Version)
+	{
+		using namespace TetrisSerialization;
+
+		SerializeVarInt(Ar, Config.BoardWidth);
+		SerializeVarInt(Ar, Config.BoardHeight);
+		SerializeEnum8(Ar, Config.RandomizerType, ETetrisRandomizerType::SevenBag, ETetrisRandomizerType::PureRandom);
+		SerializeVarInt(Ar, Config.Seed);
+		SerializeVarInt(Ar, Config.PreviewCount);
+		SerializeVarInt64(Ar, Config.BaseFallMicroseconds);
+		SerializeVarInt64(Ar, Config.LineClearDelayMicroseconds);
+		SerializeVarInt(Ar, Config.MaxLevel);
+		if (Version >= 2)
+		{
+			SerializeEnum8(Ar, Config.Ruleset, ETetrisRuleset::Modern, ETetrisRuleset::TGM);
+		}
+		else
+		{
+			Config.Ruleset = ETetrisRuleset::Modern;
+		}
+	}
+}
+
+// 記録
+
+void FTetrisReplayRecorder::Begin(const FTetrisSimGame& Game, int64 InFrameMicroseconds, int32 InKeyframeInterval)
+{
+	Config = Game.GetConfig();
+	FrameMicroseconds = FMath::Max<int64>(InFrameMicroseconds, 1);
+	KeyframeInterval = FMath::Max(InKeyframeInterval, 1);
+
+	Frame = 0;
+	LastInputFrame = 0;
+	NumInputs = 0;
+	InputStream.Reset();
+	Keyframes.Reset();
+
+	AddKeyframe(Game);
+}
+
+void FTetrisReplayRecorder::RecordInput(ETetrisInputCommand Command)
+{
+	if (Command == ETetrisInputCommand::Pause || Command == ETetrisInputCommand::Restart)
+	{
+		return;
+	}
+
+	FMemoryWriter Writer(InputStream, false, true);
+	uint64 Value = (static_cast<uint64>(Frame - LastInputFrame) << COMMAND_BITS) | EncodeCommand(Command);
+	TetrisSerialization::SerializeVarUInt(Writer, Value);
+
+	LastInputFrame = Frame;
+	NumInputs++;
+}
+
+void FTetrisReplayRecorder::EndFrame(const FTetrisSimGame& Game)
+{
+	Frame++;
+	if (Frame % KeyframeInterval == 0)
+	{
+		AddKeyframe(Game);
+	}
+}
+
+void FTetrisReplayRecorder::AddKeyframe(const FTetrisSimGame& Game)
+{
+	FKeyframe& Keyframe = Keyframes.AddDefaulted_GetRef();
+	Keyframe.Frame = Frame;
+	Keyframe.InputIndex = NumInputs;
+	Keyframe.LastInputFrame = LastInputFrame;
+	Keyframe.InputOffset = InputStream.Num();
+
+	FMemoryWriter Writer(Keyframe.State);
+	const_cast<FTetrisSimGame&>(Game).SerializeState(Writer);
+}
+
+void FTetrisReplayRecorder::Finish(TArray<uint8>& OutBytes) const
+{
+	using namespace TetrisSerialization;
+
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+
+	// ヘッダー
+	uint32 Magic = REPLAY_MAGIC;
+	uint8 Version = REPLAY_VERSION;
+	FTetrisSimConfig HeaderConfig = Config;
+	int64 HeaderFrameMicroseconds = FrameMicroseconds;
+	int32 HeaderKeyframeInterval = KeyframeInterval;
+	int64 NumFrames = Frame;
+	int32 HeaderNumInputs = NumInputs;
+	int64 InputStreamSize = InputStream.Num();
+	Writer << Magic;
+	Writer << Version;
+	SerializeConfig(Writer, HeaderConfig, Version);
+	SerializeVarInt64(Writer, HeaderFrameMicroseconds);
+	SerializeVarInt(Writer, HeaderKeyframeInterval);
+	SerializeVarInt64(Writer, NumFrames);
+	SerializeVarInt(Writer, HeaderNumInputs);
+	SerializeVarInt64(Writer, InputStreamSize);
+
+	// 入力列
+	Writer.Serialize(const_cast<uint8*>(InputStream.GetData()), InputStream.Num());
+
+	// キーフレーム
+	TArray<int64> Offsets;
+	for (const FKeyframe& Keyframe : Keyframes)
+	{
+		Offsets.Add(Writer.Tell());
+
+		int64 KeyframeFrame = Keyframe.Frame;
+		int32 InputIndex = Keyframe.InputIndex;
+		int64 KeyframeLastInputFrame = Keyframe.LastInputFrame;
+		int32 InputOffset = Keyframe.InputOffset;
+		SerializeVarInt64(Writer, KeyframeFrame);
+		SerializeVarInt(Writer, InputIndex);
+		SerializeVarInt64(Writer, KeyframeLastInputFrame);
+		SerializeVarInt(Writer, InputOffset);
+		Writer.Serialize(const_cast<uint8*>(Keyframe.State.GetData()), Keyframe.State.Num());
+	}
+
+	// シーク索引とフッター
+	uint64 IndexOffset = static_cast<uint64>(Writer.Tell());
+	int32 NumKeyframes = Keyframes.Num();
+	SerializeVarInt(Writer, NumKeyframes);
+	for (int32 Index = 0; Index < Keyframes.Num(); Index++)
+	{
+		int64 KeyframeFrame = Keyframes[Index].Frame;
+		SerializeVarInt64(Writer, KeyframeFrame);
+		SerializeVarInt64(Writer, Offsets[Index]);
+	}
+
+	uint32 FooterMagic = INDEX_MAGIC;
+	Writer << IndexOffset;
+	Writer << FooterMagic;
+}
+
+bool FTetrisReplayRecorder::SaveToFile(const FString& Path) const
+{
+	TArray<uint8> FileBytes;
+	Finish(FileBytes);
+	return FFileHelper::SaveArrayToFile(FileBytes, *Path);
+}
+
+// 再生
+
+bool FTetrisReplay::LoadFromFile(const FString& Path)
+{
+	TArray<uint8> FileBytes;
+	if (!FFileHelper::LoadFileToArray(FileBytes, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read replay %s"), *Path);
+		return false;
+	}
+	return FromBytes(MoveTemp(FileBytes));
+}
+
+bool FTetrisReplay::FromBytes(TArray<uint8>&& InBytes)
+{
+	using namespace TetrisSerialization;
+
+	Bytes = MoveTemp(InBytes);
+	KeyframeFrames.Reset();
+	KeyframeOffsets.Reset();
+
+	FMemoryReader Reader(Bytes);
+
+	// ヘッダー
+	uint32 Magic = 0;
+	Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Reader.IsError() || Magic != REPLAY_MAGIC || Version < 1 || Version > REPLAY_VERSION)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unsupported Tetris replay (magic 0x%08x, version %d)"), Magic, Version);
+		return false;
+	}
+
+	SerializeConfig(Reader, Config, Version);
+	SerializeVarInt64(Reader, FrameMicroseconds);
+	SerializeVarInt(Reader, KeyframeInterval);
+	SerializeVarInt64(Reader, NumFrames);
+	SerializeVarInt(Reader, NumInputs);
+	SerializeVarInt64(Reader, InputStreamSize);
+	InputStreamOffset = Reader.Tell();
+	if (Reader.IsError() || FrameMicroseconds <= 0 || InputStreamSize < 0 || InputStreamOffset + InputStreamSize + FOOTER_SIZE > Bytes.Num())
+	{
+		return false;
+	}
+
+	// フッターから索引へ
+	Reader.Seek(Bytes.Num() - FOOTER_SIZE);
+	uint64 IndexOffset = 0;
+	uint32 FooterMagic = 0;
+	Reader << IndexOffset;
+	Reader << FooterMagic;
+	if (Reader.IsError() || FooterMagic != INDEX_MAGIC || IndexOffset > static_cast<uint64>(Bytes.Num() - FOOTER_SIZE))
+	{
+		return false;
+	}
+
+	Reader.Seek(static_cast<int64>(IndexOffset));
+	int32 NumKeyframes = 0;
+	SerializeVarInt(Reader, NumKeyframes);
+	if (NumKeyframes <= 0 || NumKeyframes > Bytes.Num())
+	{
+		return false;
+	}
+	KeyframeFrames.SetNumUninitialized(NumKeyframes);
+	KeyframeOffsets.SetNumUninitialized(NumKeyframes);
+	// キーフレームは入力列の後ろ・索引の前にあり、フレームは 0 から増え続ける（壊れた索引で SeekToFrame が範囲外を読まないように）
+	const int64 KeyframesBegin = InputStreamOffset + InputStreamSize;
+	const int64 KeyframesEnd = static_cast<int64>(IndexOffset);
+	for (int32 Index = 0; Index < NumKeyframes; Index++)
+	{
+		SerializeVarInt64(Reader, KeyframeFrames[Index]);
+		SerializeVarInt64(Reader, KeyframeOffsets[Index]);
+		const bool bFrameValid = (Index == 0 ? KeyframeFrames[Index] == 0 : KeyframeFrames[Index] > KeyframeFrames[Index - 1])
+			&& KeyframeFrames[Index] <= NumFrames;
+		const bool bOffsetValid = KeyframeOffsets[Index] >= KeyframesBegin && KeyframeOffsets[Index] < KeyframesEnd;
+		if (Reader.IsError() || !bFrameValid || !bOffsetValid)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Corrupt Tetris replay keyframe index (entry %d)"), Index);
+			KeyframeFrames.Reset();
+			KeyframeOffsets.Reset();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FTetrisReplay::SeekToFrame(int64 TargetFrame, FTetrisSimGame& OutGame) const
+{
+	using namespace TetrisSerialization;
+
+	if (KeyframeFrames.Num() == 0)
+	{
+		return false;
+	}
+	TargetFrame = FMath::Clamp<int64>(TargetFrame, 0, NumFrames);
+
+	// TargetFrame 以前で最後のキーフレーム
+	const int32 KeyframeIndex = FMath::Max(Algo::UpperBound(KeyframeFrames, TargetFrame) - 1, 0);
+
+	FMemoryReader Reader(Bytes);
+	Reader.Seek(KeyframeOffsets[KeyframeIndex]);
+
+	int64 Frame = 0;
+	int32 InputIndex = 0;
+	int64 InputFrame = 0;
+	int32 InputOffset = 0;
+	SerializeVarInt64(Reader, Frame);
+	SerializeVarInt(Reader, InputIndex);
+	SerializeVarInt64(Reader, InputFrame);
+	SerializeVarInt(Reader, InputOffset);
+	if (Reader.IsError() || InputOffset < 0 || InputOffset > InputStreamSize)
+	{
+		return false;
+	}
+
+	OutGame.Reset(Config);
+	if (!OutGame.SerializeState(Reader))
+	{
+		return false;
+	}
+
+	// キーフレームの入力位置から目標のフレームまで進める
+	Reader.Seek(InputStreamOffset + InputOffset);
+	const int64 InputStreamEnd = InputStreamOffset + InputStreamSize;
+
+	int64 NextInputFrame = MAX_int64;
+	ETetrisInputCommand NextCommand = ETetrisInputCommand::MoveLeft;
+	auto ReadNextInput = [&]()
+	{
+		NextInputFrame = MAX_int64;
+		if (InputIndex >= NumInputs || Reader.Tell() >= InputStreamEnd)
+		{
+			return;
+		}
+
+		uint64 Value = 0;
+		SerializeVarUInt(Reader, Value);
+		const uint64 Code = Value & ((1 << COMMAND_BITS) - 1);
+		if (!IsValidCommandCode(Code, Version))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Tetris replay version %d has unknown input code %llu"), Version, Code);
+			Reader.SetError();
+			return;
+		}
+		NextInputFrame = InputFrame + static_cast<int64>(Value >> COMMAND_BITS);
+		NextCommand = DecodeCommand(Code);
+	};
+
+	ReadNextInput();
+	while (Frame < TargetFrame)
+	{
+		while (NextInputFrame == Frame)
+		{
+			OutGame.ApplyInput(NextCommand);
+			InputFrame = NextInputFrame;
+			InputIndex++;
+			ReadNextInput();
+		}
+
+		OutGame.Advance(FrameMicroseconds);
+		Frame++;
+	}
+
+	return !Reader.IsError();
+}
@@ -0,0 +1,350 @@
+#include "TetrisRollback.h"
+#include "TetrisSerialization.h"
+#include "TetrisStats.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// 対戦の状態
+
+void FTetrisVersusState::Reset(const FTetrisSimConfig& Config)
+{
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		Games[Player].Reset(Config);
+		PendingGarbage[Player] = 0;
+	}
+	Frame = 0;
+}
+
+void FTetrisVersusState::Step(const FTetrisFrameInput (&Inputs)[NUM_PLAYERS], int64 FrameMicroseconds)
+{
+	int32 LinesCleared[NUM_PLAYERS] = {};
+	bool bLocked[NUM_PLAYERS] = {};
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		FTetrisSimGame& Game = Games[Player];
+		const FTetrisGameStats Before = Game.GetStats();
+
+		const int32 NumCommands = Inputs[Player].Num();
+		for (int32 Index = 0; Index < NumCommands; Index++)
+		{
+			Game.ApplyInput(Inputs[Player].Get(Index));
+		}
+		Game.Advance(FrameMicroseconds);
+
+		LinesCleared[Player] = Game.GetStats().LinesCleared - Before.LinesCleared;
+		bLocked[Player] = Game.GetStats().PiecesPlaced != Before.PiecesPlaced;
+	}
+
+	// 送る行数は両者が進んでから決める（プレイヤーの順序に依存しない）
+	int32 Outgoing[NUM_PLAYERS] = {};
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		const int32 Sent = GARBAGE_FOR_LINES[FMath::Clamp(LinesCleared[Player], 0, 4)];
+		const int32 Cancelled = FMath::Min(Sent, PendingGarbage[Player]);
+		PendingGarbage[Player] -= Cancelled;
+		Outgoing[Player] = Sent - Cancelled;
+	}
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		PendingGarbage[NUM_PLAYERS - 1 - Player] += Outgoing[Player];
+	}
+
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		if (LinesCleared[Player] == 0 && bLocked[Player] && PendingGarbage[Player] > 0)
+		{
+			Games[Player].AddGarbageRows(PendingGarbage[Player], GetGarbageHoleX(Player));
+			PendingGarbage[Player] = 0;
+		}
+	}
+
+	Frame++;
+}
+
+uint32 FTetrisVersusState::GetChecksum() const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	for (int32 Player = 0; Player < NUM_PLAYERS; Player++)
+	{
+		// SerializeState は読み書き兼用なのでコピーから書く
+		FTetrisSimGame Game = Games[Player];
+		Game.SerializeState(Writer);
+
+		int32 Pending = PendingGarbage[Player];
+		TetrisSerialization::SerializeVarInt(Writer, Pending);
+	}
+	uint64 FrameValue = static_cast<uint64>(Frame);
+	TetrisSerialization::SerializeVarUInt(Writer, FrameValue);
+	return FCrc::MemCrc32(Bytes.GetData(), Bytes.Num());
+}
+
+int32 FTetrisVersusState::GetGarbageHoleX(int32 Player) const
+{
+	const uint32 Hash = HashCombine(GetTypeHash(Frame), GetTypeHash(Player));
+	return static_cast<int32>(Hash % static_cast<uint32>(FMath::Max(Games[Player].GetBoard().Width, 1)));
+}
+
+// パケット
+
+bool FTetrisRollbackPacket::Serialize(FArchive& Ar)
+{
+	using namespace TetrisSerialization;
+
+	// AckFrame は -1 から始まるので 1 足して符号なしで書く
+	uint64 Start = static_cast<uint64>(StartFrame);
+	uint64 Ack = static_cast<uint64>(AckFrame + 1);
+	uint32 NumInputs = static_cast<uint32>(Inputs.Num());
+	SerializeVarUInt(Ar, Start);
+	SerializeVarUInt(Ar, Ack);
+	SerializeVarUInt(Ar, NumInputs);
+	if (Ar.IsLoading())
+	{
+		if (NumInputs > static_cast<uint32>(FTetrisRollbackSession::INPUT_HISTORY) || Ar.IsError())
+		{
+			Ar.SetError();
+			return false;
+		}
+		StartFrame = static_cast<int64>(Start);
+		AckFrame = static_cast<int64>(Ack) - 1;
+		Inputs.SetNum(NumInputs);
+	}
+
+	// 入力の無いフレームは1バイト
+	for (FTetrisFrameInput& Input : Inputs)
+	{
+		SerializeVarUInt(Ar, Input.Packed);
+	}
+	return !Ar.IsError();
+}
+
+// セッション
+
+void FTetrisRollbackSession::Start(const FTetrisSimConfig& GameConfig, const FTetrisRollbackConfig& InConfig, int32 InLocalPlayer)
+{
+	// 予測・遅延ぶんの入力と状態が履歴に収まる範囲に制限する
+	Config = InConfig;
+	Config.MaxRollbackFrames = FMath::Clamp(Config.MaxRollbackFrames, 1, INPUT_HISTORY / 4);
+	Config.InputDelayFrames = FMath::Clamp(Config.InputDelayFrames, 0, INPUT_HISTORY / 4);
+	Config.FrameMicroseconds = FMath::Max<int64>(Config.FrameMicroseconds, 1);
+	LocalPlayer = FMath::Clamp(InLocalPlayer, 0, FTetrisVersusState::NUM_PLAYERS - 1);
+
+	State.Reset(GameConfig);
+	SavedStates.SetNum(Config.MaxRollbackFrames + 1);
+
+	for (int32 Player = 0; Player < FTetrisVersusState::NUM_PLAYERS; Player++)
+	{
+		for (FTetrisFrameInput& Input : Inputs[Player])
+		{
+			Input = FTetrisFrameInput();
+		}
+	}
+
+	// 入力遅延ぶんの最初のフレームは両者とも入力なしで確定している
+	LocalLastFrame = Config.InputDelayFrames - 1;
+	RemoteLastFrame = Config.InputDelayFrames - 1;
+	RemoteAckFrame = Config.InputDelayFrames - 1;
+	FirstMispredictedFrame = MAX_int64;
+	Stats = FTetrisRollbackStats();
+}
+
+bool FTetrisRollbackSession::CanAdvance() const
+{
+	return State.Frame - RemoteLastFrame <= Config.MaxRollbackFrames
+		&& GetLocalInputFrame() - RemoteAckFrame < INPUT_HISTORY;
+}
+
+bool FTetrisRollbackSession::AdvanceFrame(const FTetrisFrameInput& LocalInput)
+{
+	if (!CanAdvance())
+	{
+		return false;
+	}
+
+	ResolveRollback();
+
+	LocalLastFrame = GetLocalInputFrame();
+	Inputs[LocalPlayer][LocalLastFrame % INPUT_HISTORY] = LocalInput;
+
+	SimulateFrame();
+	Stats.FramesAdvanced++;
+	return true;
+}
+
+void FTetrisRollbackSession::ResolveRollback()
+{
+	if (FirstMispredictedFrame == MAX_int64)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_TetrisRollback);
+
+	const int64 TargetFrame = State.Frame;
+	State = SavedStates[FirstMispredictedFrame % SavedStates.Num()];
+	check(State.Frame == FirstMispredictedFrame);
+	FirstMispredictedFrame = MAX_int64;
+
+	const int32 Depth = static_cast<int32>(TargetFrame - State.Frame);
+	Stats.Rollbacks++;
+	Stats.FramesResimulated += Depth;
+	Stats.MaxRollbackDepth = FMath::Max(Stats.MaxRollbackDepth, Depth);
+
+	while (State.Frame < TargetFrame)
+	{
+		SimulateFrame();
+	}
+}
+
+void FTetrisRollbackSession::BuildPacket(FTetrisRollbackPacket& OutPacket) const
+{
+	OutPacket.AckFrame = RemoteLastFrame;
+	OutPacket.StartFrame = RemoteAckFrame + 1;
+	OutPacket.Inputs.Reset();
+	for (int64 Frame = OutPacket.StartFrame; Frame <= LocalLastFrame; Frame++)
+	{
+		OutPacket.Inputs.Add(Inputs[LocalPlayer][Frame % INPUT_HISTORY]);
+	}
+}
+
+void FTetrisRollbackSession::ReceivePacket(const FTetrisRollbackPacket& Packet)
+{
+	Stats.PacketsReceived++;
+	RemoteAckFrame = FMath::Clamp(Packet.AckFrame, RemoteAckFrame, LocalLastFrame);
+
+	const int32 RemotePlayer = FTetrisVersusState::NUM_PLAYERS - 1 - LocalPlayer;
+	const int64 OldestNeededFrame = State.Frame - Config.MaxRollbackFrames;
+	for (int32 Index = 0; Index < Packet.Inputs.Num(); Index++)
+	{
+		const int64 Frame = Packet.StartFrame + Index;
+		if (Frame <= RemoteLastFrame)
+		{
+			continue;
+		}
+
+		// 途中が抜けている・履歴に入りきらない入力は捨てる（再送される）
+		if (Frame != RemoteLastFrame + 1 || Frame - OldestNeededFrame >= INPUT_HISTORY)
+		{
+			break;
+		}
+
+		// 「入力なし」と予測して進めたフレームに入力があった
+		const FTetrisFrameInput& Input = Packet.Inputs[Index];
+		if (Frame < State.Frame && !Input.IsEmpty())
+		{
+			FirstMispredictedFrame = FMath::Min(FirstMispredictedFrame, Frame);
+		}
+
+		Inputs[RemotePlayer][Frame % INPUT_HISTORY] = Input;
+		RemoteLastFrame = Frame;
+	}
+}
+
+FTetrisFrameInput FTetrisRollbackSession::GetInput(int32 Player, int64 Frame) const
+{
+	if (Player != LocalPlayer && Frame > RemoteLastFrame)
+	{
+		return FTetrisFrameInput();
+	}
+	return Inputs[Player][Frame % INPUT_HISTORY];
+}
+
+void FTetrisRollbackSession::SimulateFrame()
+{
+	SavedStates[State.Frame % SavedStates.Num()] = State;
+
+	const FTetrisFrameInput FrameInputs[FTetrisVersusState::NUM_PLAYERS] = { GetInput(0, State.Frame), GetInput(1, State.Frame) };
+	State.Step(FrameInputs, Config.FrameMicroseconds);
+}
+
+// ローカル回線
+
+void FTetrisRollbackLoopback::Start(const FTetrisSimConfig& GameConfig, const FTetrisRollbackConfig& RollbackConfig, const FTetrisLoopbackConfig& InNetConfig)
+{
+	NetConfig = InNetConfig;
+	FrameMicroseconds = FMath::Max<int64>(RollbackConfig.FrameMicroseconds, 1);
+	NowMicroseconds = 0;
+	Random.Initialize(NetConfig.Seed);
+	InFlight.Reset();
+	Stats = FTetrisLoopbackStats();
+
+	for (int32 Player = 0; Player < FTetrisVersusState::NUM_PLAYERS; Player++)
+	{
+		Peers[Player].Start(GameConfig, RollbackConfig, Player);
+	}
+}
+
+void FTetrisRollbackLoopback::Tick(TFunctionRef<FTetrisFrameInput(int32 Player, int64 Frame)> GetInput, int64 MaxFrame)
+{
+	NowMicroseconds += FrameMicroseconds;
+
+	// 届いたパケット（送った順とは限らない）
+	for (int32 Index = 0; Index < InFlight.Num();)
+	{
+		if (InFlight[Index].DeliverMicroseconds > NowMicroseconds)
+		{
+			Index++;
+			continue;
+		}
+
+		FTetrisRollbackPacket Packet;
+		FMemoryReader Reader(InFlight[Index].Bytes);
+		if (Packet.Serialize(Reader))
+		{
+			Peers[InFlight[Index].ToPlayer].ReceivePacket(Packet);
+		}
+		InFlight.RemoveAt(Index);
+	}
+
+	for (int32 Player = 0; Player < FTetrisVersusState::NUM_PLAYERS; Player++)
+	{
+		FTetrisRollbackSession& Peer = Peers[Player];
+		if (Peer.GetCurrentFrame() >= MaxFrame)
+		{
+			Peer.ResolveRollback();
+		}
+		else if (!Peer.AdvanceFrame(GetInput(Player, Peer.GetLocalInputFrame())))
+		{
+			Peer.ResolveRollback();
+			Stats.StalledFrames++;
+		}
+	}
+
+	// 毎フレーム送る
+	for (int32 Player = 0; Player < FTetrisVersusState::NUM_PLAYERS; Player++)
+	{
+		FTetrisRollbackPacket Packet;
+		Peers[Player].BuildPacket(Packet);
+
+		FInFlightPacket Sent;
+		Sent.ToPlayer = FTetrisVersusState::NUM_PLAYERS - 1 - Player;
+		FMemoryWriter Writer(Sent.Bytes);
+		Packet.Serialize(Writer);
+
+		Stats.PacketsSent++;
+		Stats.BytesSent += Sent.Bytes.Num();
+		if (Random.FRand() < NetConfig.PacketLoss)
+		{
+			Stats.PacketsDropped++;
+			continue;
+		}
+
+		Sent.DeliverMicroseconds = NowMicroseconds + NetConfig.LatencyMicroseconds
+			+ (NetConfig.JitterMicroseconds > 0 ? static_cast<int64>(Random.FRand() * NetConfig.JitterMicroseconds) : 0);
+		InFlight.Add(MoveTemp(Sent));
+	}
+}
+
+bool FTetrisRollbackLoopback::IsSynchronized(int64 Frame) const
+{
+	for (const FTetrisRollbackSession& Peer : Peers)
+	{
+		if (Peer.GetCurrentFrame() != Frame || Peer.GetConfirmedFrame() < Frame - 1 || Peer.HasPendingRollback())
+		{
+			return false;
+		}
+	}
+	return true;
+}
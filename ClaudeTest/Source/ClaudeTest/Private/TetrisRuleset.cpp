@@ -0,0 +1,18 @@
+#include "TetrisRuleset.h"
+
+const FTetrisRuleset& FTetrisRuleset::Get(ETetrisRuleset Ruleset)
+{
+	static const TTetrisRuleset<FTetrisModernRules> Modern;
+	static const TTetrisRuleset<FTetrisClassicRules> Classic;
+	static const TTetrisRuleset<FTetrisTGMRules> TGM;
+
+	switch (Ruleset)
+	{
+	case ETetrisRuleset::Classic:
+		return Classic;
+	case ETetrisRuleset::TGM:
+		return TGM;
+	default:
+		return Modern;
+	}
+}
@@ -0,0 +1,485 @@
+#include "TetrisSimulation.h"
+#include "TetrisGameStep.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "TetrisRuleset.h"
+#include "TetrisSerialization.h"
+#include "Algo/Reverse.h"
+
+// 盤面
+
+void FTetrisSimBoard::Reset(int32 InWidth, int32 InHeight)
+{
+	Width = FMath::Clamp(InWidth, 4, MAX_WIDTH);
+	Height = FMath::Clamp(InHeight, 4, MAX_HEIGHT);
+	FullRowMask = static_cast<uint16>((1u << Width) - 1);
+	FMemory::Memzero(Rows);
+	FMemory::Memzero(PackedRows);
+}
+
+bool TetrisBoardRows::CanPlace(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+{
+	const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Rotation);
+	for (int32 ShapeY = 0; ShapeY < TetrisConstants::PIECE_SIZE; ShapeY++)
+	{
+		const uint32 RowBits = (ShapeMask >> (ShapeY * TetrisConstants::PIECE_SIZE)) & 0xF;
+		if (RowBits == 0)
+		{
+			continue;
+		}
+
+		const int32 BoardY = Y + ShapeY;
+		if (BoardY < 0 || BoardY >= Height)
+		{
+			return false;
+		}
+
+		// 左端からはみ出すビットがあれば不可
+		uint32 Shifted = 0;
+		if (X < 0)
+		{
+			if (X <= -TetrisConstants::PIECE_SIZE || (RowBits & ((1u << -X) - 1)) != 0)
+			{
+				return false;
+			}
+			Shifted = RowBits >> -X;
+		}
+		else
+		{
+			Shifted = RowBits << X;
+		}
+
+		if ((Shifted & ~uint32(FullRowMask)) != 0 || (Shifted & Rows[BoardY]) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void TetrisBoardRows::Place(uint16* Rows, uint64* PackedRows, int32 Width, int32 Height, EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+{
+	const uint16 ShapeMask = TetrisPieceTables::GetShapeMask(PieceType, Rotation);
+	const uint8 CellValue = TetrisCellPacking::PackCell(true, PieceType);
+	for (int32 ShapeY = 0; ShapeY < TetrisConstants::PIECE_SIZE; ShapeY++)
+	{
+		for (int32 ShapeX = 0; ShapeX < TetrisConstants::PIECE_SIZE; ShapeX++)
+		{
+			const int32 BoardX = X + ShapeX;
+			const int32 BoardY = Y + ShapeY;
+			if (!TetrisPieceTables::IsShapeCellSet(ShapeMask, ShapeX, ShapeY)
+				|| BoardX < 0 || BoardX >= Width || BoardY < 0 || BoardY >= Height)
+			{
+				continue;
+			}
+
+			Rows[BoardY] |= static_cast<uint16>(1u << BoardX);
+			PackedRows[BoardY] = TetrisCellPacking::SetPackedCell(PackedRows[BoardY], BoardX, CellValue);
+		}
+	}
+}
+
+int32 TetrisBoardRows::ClearFullRows(uint16* Rows, uint64* PackedRows, int32 Height, uint16 FullRowMask)
+{
+	// 下から上へ1パスで詰める（ATetrisBoard::ClearLines と同じ）
+	int32 WriteY = Height - 1;
+	for (int32 ReadY = Height - 1; ReadY >= 0; ReadY--)
+	{
+		if (Rows[ReadY] == FullRowMask)
+		{
+			continue;
+		}
+
+		if (WriteY != ReadY)
+		{
+			Rows[WriteY] = Rows[ReadY];
+			PackedRows[WriteY] = PackedRows[ReadY];
+		}
+		WriteY--;
+	}
+
+	const int32 Cleared = WriteY + 1;
+	for (; WriteY >= 0; WriteY--)
+	{
+		Rows[WriteY] = 0;
+		PackedRows[WriteY] = 0;
+	}
+	return Cleared;
+}
+
+bool FTetrisSimBoard::CanPlace(EPieceType PieceType, int32 Rotation, int32 X, int32 Y) const
+{
+	return TetrisBoardRows::CanPlace(Rows, Height, FullRowMask, PieceType, Rotation, X, Y);
+}
+
+void FTetrisSimBoard::Place(EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+{
+	TetrisBoardRows::Place(Rows, PackedRows, Width, Height, PieceType, Rotation, X, Y);
+}
+
+int32 FTetrisSimBoard::ClearFullRows()
+{
+	return TetrisBoardRows::ClearFullRows(Rows, PackedRows, Height, FullRowMask);
+}
+
+int32 TetrisBoardRows::GetDropY(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+{
+	while (CanPlace(Rows, Height, FullRowMask, PieceType, Rotation, X, Y + 1))
+	{
+		Y++;
+	}
+	return Y;
+}
+
+int32 TetrisBoardRows::GetShiftX(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y, int32 Direction)
+{
+	while (CanPlace(Rows, Height, FullRowMask, PieceType, Rotation, X + Direction, Y))
+	{
+		X += Direction;
+	}
+	return X;
+}
+
+int32 FTetrisSimBoard::GetDropY(EPieceType PieceType, int32 Rotation, int32 X, int32 Y) const
+{
+	return TetrisBoardRows::GetDropY(Rows, Height, FullRowMask, PieceType, Rotation, X, Y);
+}
+
+int32 FTetrisSimBoard::GetShiftX(EPieceType PieceType, int32 Rotation, int32 X, int32 Y, int32 Direction) const
+{
+	return TetrisBoardRows::GetShiftX(Rows, Height, FullRowMask, PieceType, Rotation, X, Y, Direction);
+}
+
+void FTetrisSimBoard::SetPackedRow(int32 Y, uint64 PackedCells)
+{
+	if (Y < 0 || Y >= Height)
+	{
+		return;
+	}
+
+	PackedRows[Y] = 0;
+	Rows[Y] = 0;
+	for (int32 X = 0; X < Width; X++)
+	{
+		const uint8 CellValue = TetrisCellPacking::GetPackedCell(PackedCells, X);
+		if (TetrisCellPacking::IsCellOccupied(CellValue))
+		{
+			Rows[Y] |= static_cast<uint16>(1u << X);
+			PackedRows[Y] = TetrisCellPacking::SetPackedCell(PackedRows[Y], X, CellValue);
+		}
+	}
+}
+
+// 到達可能な固定位置
+
+// 形状を左上に詰めたマスクと、その左上の位置から作るキー（回転が違っても同じセルなら同じ値）
+static uint32 MakeLockedCellsKey(uint16 ShapeMask, int32 X, int32 Y)
+{
+	while ((ShapeMask & 0x000F) == 0)
+	{
+		ShapeMask >>= TetrisConstants::PIECE_SIZE;
+		Y++;
+	}
+	while ((ShapeMask & 0x1111) == 0)
+	{
+		ShapeMask >>= 1;
+		X++;
+	}
+	return (uint32(ShapeMask) << 16) | (uint32(X) << 8) | uint32(Y);
+}
+
+// 1入力で移れる状態を FTetrisSimGame と同じ規則で列挙する（下移動は置ける時だけ）
+template<typename FuncType>
+static void ForEachMove(const FTetrisSimBoard& Board, EPieceType PieceType, const FTetrisSimPlacement& State, FuncType&& Func)
+{
+	if (Board.CanPlace(PieceType, State.Rotation, State.X - 1, State.Y))
+	{
+		Func(ETetrisInputCommand::MoveLeft, State.Rotation, State.X - 1, State.Y);
+	}
+	if (Board.CanPlace(PieceType, State.Rotation, State.X + 1, State.Y))
+	{
+		Func(ETetrisInputCommand::MoveRight, State.Rotation, State.X + 1, State.Y);
+	}
+
+	// 回転は FTetrisSimGame::TryRotate（既定のルールセット）と同じ順に試し、最初に置けた位置だけ
+	const int32 NewRotation = (State.Rotation + 1) % TetrisPieceTables::NUM_ROTATIONS;
+	if (Board.CanPlace(PieceType, NewRotation, State.X, State.Y))
+	{
+		Func(ETetrisInputCommand::Rotate, NewRotation, State.X, State.Y);
+	}
+	else
+	{
+		for (const TetrisRules::FKickOffset& Kick : TetrisRules::GetWallKickOffsets(PieceType))
+		{
+			if (Board.CanPlace(PieceType, NewRotation, State.X + Kick.X, State.Y + Kick.Y))
+			{
+				Func(ETetrisInputCommand::Rotate, NewRotation, State.X + Kick.X, State.Y + Kick.Y);
+				break;
+			}
+		}
+	}
+
+	if (Board.CanPlace(PieceType, State.Rotation, State.X, State.Y + 1))
+	{
+		Func(ETetrisInputCommand::MoveDown, State.Rotation, State.X, State.Y + 1);
+	}
+}
+
+// 状態 (回転, X, Y) の訪問済みフラグ。X/Y は形状の空き行・列の分だけ負になり得る
+namespace
+{
+	struct FMoveGenVisited
+	{
+		static constexpr int32 ORIGIN = TetrisConstants::PIECE_SIZE;
+		static constexpr int32 SPAN_X = FTetrisSimBoard::MAX_WIDTH + ORIGIN * 2;
+		static constexpr int32 SPAN_Y = FTetrisSimBoard::MAX_HEIGHT + ORIGIN * 2;
+
+		bool Flags[TetrisPieceTables::NUM_ROTATIONS][SPAN_X][SPAN_Y] = {};
+
+		// 初めての訪問なら true
+		bool Mark(int32 Rotation, int32 X, int32 Y)
+		{
+			bool& bVisited = Flags[Rotation][X + ORIGIN][Y + ORIGIN];
+			const bool bFirstVisit = !bVisited;
+			bVisited = true;
+			return bFirstVisit;
+		}
+	};
+}
+
+int32 TetrisMoveGen::GenerateLockPlacements(const FTetrisSimBoard& Board, EPieceType PieceType, TArray<FTetrisSimPlacement>& OutPlacements)
+{
+	return GenerateLockPlacements(Board, PieceType, 0, TetrisRules::SPAWN_X, TetrisRules::SPAWN_Y, OutPlacements);
+}
+
+int32 TetrisMoveGen::GenerateLockPlacements(const FTetrisSimBoard& Board, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY, TArray<FTetrisSimPlacement>& OutPlacements)
+{
+	OutPlacements.Reset();
+	if (!Board.CanPlace(PieceType, StartRotation, StartX, StartY))
+	{
+		return 0;
+	}
+
+	FMoveGenVisited Visited;
+	TArray<FTetrisSimPlacement, TInlineAllocator<256>> Open;
+	TSet<uint32> LockedCells;
+
+	auto Visit = [&](int32 Rotation, int32 X, int32 Y)
+	{
+		if (Visited.Mark(Rotation, X, Y))
+		{
+			Open.Add({ PieceType, static_cast<uint8>(Rotation), static_cast<int8>(X), static_cast<int8>(Y) });
+		}
+	};
+
+	Visit(StartRotation, StartX, StartY);
+	while (Open.Num() > 0)
+	{
+		const FTetrisSimPlacement State = Open.Pop(EAllowShrinking::No);
+
+		ForEachMove(Board, PieceType, State, [&](ETetrisInputCommand, int32 Rotation, int32 X, int32 Y)
+		{
+			Visit(Rotation, X, Y);
+		});
+
+		if (!Board.CanPlace(PieceType, State.Rotation, State.X, State.Y + 1))
+		{
+			// 接地：セルが同じ固定位置は1つにまとめる
+			const uint32 CellsKey = MakeLockedCellsKey(TetrisPieceTables::GetShapeMask(PieceType, State.Rotation),
+				State.X + FMoveGenVisited::ORIGIN, State.Y + FMoveGenVisited::ORIGIN);
+			bool bAlreadyLocked = false;
+			LockedCells.Add(CellsKey, &bAlreadyLocked);
+			if (!bAlreadyLocked)
+			{
+				OutPlacements.Add(State);
+			}
+		}
+	}
+
+	return OutPlacements.Num();
+}
+
+bool TetrisMoveGen::FindInputPath(const FTetrisSimBoard& Board, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY,
+	const FTetrisSimPlacement& Target, TArray<ETetrisInputCommand>& OutInputs)
+{
+	OutInputs.Reset();
+	if (Target.PieceType != PieceType || !Board.CanPlace(PieceType, StartRotation, StartX, StartY))
+	{
+		return false;
+	}
+
+	// 幅優先探索（入力数が最少の経路）。親をたどって入力列を復元する
+	struct FPathNode
+	{
+		FTetrisSimPlacement State;
+		int32 Parent = INDEX_NONE;
+		ETetrisInputCommand Command = ETetrisInputCommand::HardDrop;
+	};
+
+	FMoveGenVisited Visited;
+	TArray<FPathNode, TInlineAllocator<256>> Nodes;
+
+	Visited.Mark(StartRotation, StartX, StartY);
+	Nodes.Add({ { PieceType, static_cast<uint8>(StartRotation), static_cast<int8>(StartX), static_cast<int8>(StartY) }, INDEX_NONE });
+
+	for (int32 Head = 0; Head < Nodes.Num(); Head++)
+	{
+		const FTetrisSimPlacement State = Nodes[Head].State;
+
+		// 同じ回転・列から真下に落として目標の高さになれば、ハードドロップで終わり
+		if (State.Rotation == Target.Rotation && State.X == Target.X
+			&& Board.GetDropY(PieceType, State.Rotation, State.X, State.Y) == Target.Y)
+		{
+			OutInputs.Add(ETetrisInputCommand::HardDrop);
+			for (int32 Index = Head; Nodes[Index].Parent != INDEX_NONE; Index = Nodes[Index].Parent)
+			{
+				OutInputs.Add(Nodes[Index].Command);
+			}
+			Algo::Reverse(OutInputs);
+			return true;
+		}
+
+		ForEachMove(Board, PieceType, State, [&](ETetrisInputCommand Command, int32 Rotation, int32 X, int32 Y)
+		{
+			if (Visited.Mark(Rotation, X, Y))
+			{
+				Nodes.Add({ { PieceType, static_cast<uint8>(Rotation), static_cast<int8>(X), static_cast<int8>(Y) }, Head, Command });
+			}
+		});
+	}
+
+	return false;
+}
+
+// ゲーム
+
+void FTetrisSimGame::Reset(const FTetrisSimConfig& InConfig)
+{
+	Config = InConfig;
+	Board.Reset(Config.BoardWidth, Config.BoardHeight);
+	Queue.Initialize(Config.RandomizerType, Config.Seed, Config.PreviewCount);
+	State = FTetrisGameState();
+
+	TetrisGameStep::SpawnPiece(MakeStepContext(), State);
+}
+
+FTetrisGameStepContext FTetrisSimGame::MakeStepContext()
+{
+	return FTetrisGameStepContext{ Config, Board.Rows, Board.PackedRows, Board.Width, Board.Height, Board.FullRowMask, Queue, DatasetExporter.Exporter };
+}
+
+bool FTetrisSimGame::SerializeState(FArchive& Ar)
+{
+	using namespace TetrisSerialization;
+
+	// 盤面：空行は1バイト（占有ビットは読み込み時に作り直す）
+	int32 BoardHeight = Board.Height;
+	SerializeVarInt(Ar, BoardHeight);
+	if (BoardHeight != Board.Height)
+	{
+		Ar.SetError();
+		return false;
+	}
+	for (int32 Y = 0; Y < Board.Height; Y++)
+	{
+		uint64 PackedRow = Board.PackedRows[Y];
+		SerializeVarUInt(Ar, PackedRow);
+		if (Ar.IsLoading())
+		{
+			Board.SetPackedRow(Y, PackedRow);
+		}
+	}
+
+	Queue.Serialize(Ar);
+
+	SerializeVarInt(Ar, State.Stats.Score);
+	SerializeVarInt(Ar, State.Stats.Level);
+	SerializeVarInt(Ar, State.Stats.LinesCleared);
+	SerializeVarInt(Ar, State.Stats.PiecesPlaced);
+
+	SerializePieceType(Ar, State.ActivePiece, true);
+	SerializeVarInt(Ar, State.ActiveRotation);
+	SerializeVarInt(Ar, State.ActiveX);
+	SerializeVarInt(Ar, State.ActiveY);
+
+	uint64 Elapsed = static_cast<uint64>(State.ElapsedMicroseconds);
+	uint64 FallTimer = static_cast<uint64>(State.FallTimerMicroseconds);
+	uint64 LineClearTimer = static_cast<uint64>(State.LineClearTimerMicroseconds);
+	SerializeVarUInt(Ar, Elapsed);
+	SerializeVarUInt(Ar, FallTimer);
+	SerializeVarUInt(Ar, LineClearTimer);
+	State.ElapsedMicroseconds = static_cast<int64>(Elapsed);
+	State.FallTimerMicroseconds = static_cast<int64>(FallTimer);
+	State.LineClearTimerMicroseconds = static_cast<int64>(LineClearTimer);
+
+	uint8 Flags = (State.bLineClearPending ? 1 : 0) | (State.bGameOver ? 2 : 0);
+	Ar << Flags;
+	State.bLineClearPending = (Flags & 1) != 0;
+	State.bGameOver = (Flags & 2) != 0;
+
+	return !Ar.IsError();
+}
+
+bool FTetrisSimGame::ApplyInput(ETetrisInputCommand Command)
+{
+	if (State.bGameOver || !HasActivePiece())
+	{
+		return false;
+	}
+
+	const FTetrisGameStepContext Context = MakeStepContext();
+	return TetrisRuleset::Visit(Config.Ruleset, [&](auto Rules)
+	{
+		return TetrisGameStep::ApplyInput<decltype(Rules)>(Context, State, Command);
+	});
+}
+
+void FTetrisSimGame::Advance(int64 DeltaMicroseconds)
+{
+	const FTetrisGameStepContext Context = MakeStepContext();
+	TetrisRuleset::Visit(Config.Ruleset, [&](auto Rules)
+	{
+		TetrisGameStep::Advance<decltype(Rules)>(Context, State, DeltaMicroseconds);
+	});
+}
+
+void FTetrisSimGame::AddGarbageRows(int32 NumRows, int32 HoleX)
+{
+	NumRows = FMath::Min(NumRows, Board.Height);
+	if (State.bGameOver || NumRows <= 0)
+	{
+		return;
+	}
+
+	bool bOverflow = false;
+	for (int32 Y = 0; Y < NumRows; Y++)
+	{
+		bOverflow |= Board.Rows[Y] != 0;
+	}
+
+	const int32 KeptRows = Board.Height - NumRows;
+	FMemory::Memmove(Board.Rows, Board.Rows + NumRows, KeptRows * sizeof(uint16));
+	FMemory::Memmove(Board.PackedRows, Board.PackedRows + NumRows, KeptRows * sizeof(uint64));
+
+	// おじゃまブロックは種類なしの占有セル
+	const uint16 GarbageRow = Board.FullRowMask & ~static_cast<uint16>(1u << FMath::Clamp(HoleX, 0, Board.Width - 1));
+	uint64 PackedGarbageRow = 0;
+	for (int32 X = 0; X < Board.Width; X++)
+	{
+		if ((GarbageRow >> X) & 1)
+		{
+			PackedGarbageRow = TetrisCellPacking::SetPackedCell(PackedGarbageRow, X, TetrisCellPacking::CELL_UNTYPED);
+		}
+	}
+	for (int32 Y = KeptRows; Y < Board.Height; Y++)
+	{
+		Board.Rows[Y] = GarbageRow;
+		Board.PackedRows[Y] = PackedGarbageRow;
+	}
+
+	if (bOverflow || (HasActivePiece() && !Board.CanPlace(State.ActivePiece, State.ActiveRotation, State.ActiveX, State.ActiveY)))
+	{
+		State.ActivePiece = EPieceType::None;
+		State.bGameOver = true;
+	}
+}
@@ -0,0 +1,434 @@
+#include "TetrisSimulationCommandlet.h"
+#include "TetrisSimulation.h"
+#include "TetrisBot.h"
+#include "TetrisBeamSearch.h"
+#include "TetrisDatasetExporter.h"
+#include "TetrisArena.h"
+#include "TetrisPerfectClear.h"
+#include "TetrisRuleset.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// ボット対戦の1手ごとに進める時間（60fps 相当）
+	const int64 BOT_FRAME_MICROSECONDS = 16667;
+}
+
+UTetrisSimulationCommandlet::UTetrisSimulationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UTetrisSimulationCommandlet::Main(const FString& Params)
+{
+	int32 NumGames = 100;
+	int32 BaseSeed = 1;
+	int32 MaxPieces = 10000;
+	int32 LineClearDelayMs = 0;
+	FString RandomizerName = TEXT("SevenBag");
+	FString RulesetName = TEXT("Modern");
+	FString ReplayPath;
+	FString BotName = TEXT("Greedy");
+	FString DatasetDirectory;
+	FTetrisBeamSearchSettings BeamSettings;
+	int32 BotBudgetMs = FMath::RoundToInt(BeamSettings.TimeBudgetSeconds * 1000.0);
+	FString CsvPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TetrisSimulation"), TEXT("Summary.csv"));
+
+	FParse::Value(*Params, TEXT("Games="), NumGames);
+	FParse::Value(*Params, TEXT("Seed="), BaseSeed);
+	FParse::Value(*Params, TEXT("MaxPieces="), MaxPieces);
+	FParse::Value(*Params, TEXT("LineClearDelayMs="), LineClearDelayMs);
+	const bool bRandomizerGiven = FParse::Value(*Params, TEXT("Randomizer="), RandomizerName);
+	FParse::Value(*Params, TEXT("Ruleset="), RulesetName);
+	FParse::Value(*Params, TEXT("Replay="), ReplayPath);
+	FParse::Value(*Params, TEXT("Csv="), CsvPath);
+	FParse::Value(*Params, TEXT("Bot="), BotName);
+	FParse::Value(*Params, TEXT("Dataset="), DatasetDirectory);
+	FParse::Value(*Params, TEXT("BeamWidth="), BeamSettings.BeamWidth);
+	FParse::Value(*Params, TEXT("BeamDepth="), BeamSettings.MaxDepth);
+	FParse::Value(*Params, TEXT("BotBudgetMs="), BotBudgetMs);
+	FParse::Value(*Params, TEXT("BotThreads="), BeamSettings.MaxThreads);
+	BeamSettings.TimeBudgetSeconds = BotBudgetMs / 1000.0;
+	const bool bParallel = FParse::Param(*Params, TEXT("Parallel"));
+	const bool bArena = FParse::Param(*Params, TEXT("Arena"));
+	int32 ArenaSteps = 3600;
+	FParse::Value(*Params, TEXT("ArenaSteps="), ArenaSteps);
+	FString PerfectClearTablePath;
+	const bool bPerfectClearTable = FParse::Value(*Params, TEXT("PerfectClearTable="), PerfectClearTablePath) || FParse::Param(*Params, TEXT("PerfectClearTable"));
+	int32 PerfectClearHeight = 2;
+	FParse::Value(*Params, TEXT("PerfectClearHeight="), PerfectClearHeight);
+
+	if (bPerfectClearTable)
+	{
+		return BuildPerfectClearTable(PerfectClearTablePath.IsEmpty() ? FTetrisPerfectClearTable::GetDefaultPath() : PerfectClearTablePath,
+			TetrisConstants::BOARD_WIDTH, PerfectClearHeight);
+	}
+
+	const int64 RandomizerValue = StaticEnum<ETetrisRandomizerType>()->GetValueByNameString(RandomizerName);
+	if (RandomizerValue == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unknown randomizer '%s'"), *RandomizerName);
+		return 1;
+	}
+
+	const int64 RulesetValue = StaticEnum<ETetrisRuleset>()->GetValueByNameString(RulesetName);
+	if (RulesetValue == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unknown ruleset '%s'"), *RulesetName);
+		return 1;
+	}
+
+	const bool bBeamBot = BotName.Equals(TEXT("Beam"), ESearchCase::IgnoreCase);
+	if (!bBeamBot && !BotName.Equals(TEXT("Greedy"), ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unknown bot '%s'"), *BotName);
+		return 1;
+	}
+
+	FTetrisSimConfig BaseConfig;
+	BaseConfig.Ruleset = static_cast<ETetrisRuleset>(RulesetValue);
+	BaseConfig.RandomizerType = bRandomizerGiven ? static_cast<ETetrisRandomizerType>(RandomizerValue)
+		: FTetrisRuleset::Get(BaseConfig.Ruleset).GetDefaultRandomizer();
+	BaseConfig.LineClearDelayMicroseconds = int64(FMath::Max(LineClearDelayMs, 0)) * 1000;
+
+	if (bArena)
+	{
+		BaseConfig.Seed = BaseSeed;
+		return RunArena(BaseConfig, NumGames, ArenaSteps);
+	}
+
+	// 再生する入力ファイルを集める（指定がなければボット対戦）
+	TArray<FReplayFile> Replays;
+	if (!ReplayPath.IsEmpty())
+	{
+		TArray<FString> ReplayFiles;
+		if (IFileManager::Get().DirectoryExists(*ReplayPath))
+		{
+			IFileManager::Get().FindFiles(ReplayFiles, *FPaths::Combine(ReplayPath, TEXT("*.tinput")), true, false);
+			for (FString& File : ReplayFiles)
+			{
+				File = FPaths::Combine(ReplayPath, File);
+			}
+			ReplayFiles.Sort();
+		}
+		else
+		{
+			ReplayFiles.Add(ReplayPath);
+		}
+
+		for (const FString& File : ReplayFiles)
+		{
+			FReplayFile& Replay = Replays.AddDefaulted_GetRef();
+			Replay.RandomizerType = BaseConfig.RandomizerType;
+			Replay.Ruleset = BaseConfig.Ruleset;
+			if (!LoadReplayFile(File, Replay))
+			{
+				return 1;
+			}
+		}
+		NumGames = Replays.Num();
+	}
+
+	if (NumGames <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No games to run"));
+		return 1;
+	}
+
+	TArray<FGameResult> Results;
+	Results.SetNum(NumGames);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(NumGames, [&](int32 GameIndex)
+	{
+		const double GameStartTime = FPlatformTime::Seconds();
+		FGameResult& Result = Results[GameIndex];
+
+		FTetrisSimConfig Config = BaseConfig;
+		FTetrisSimGame Game;
+
+		// ゲームごとに1ファイル（書き込みスレッドは同時に走っているゲームの数だけ）
+		FTetrisDatasetExporter DatasetExporter;
+		auto OpenDataset = [&]()
+		{
+			if (!DatasetDirectory.IsEmpty())
+			{
+				const FString DatasetPath = FPaths::Combine(DatasetDirectory, FString::Printf(TEXT("Game_%d_%d.tdset"), GameIndex, Config.Seed));
+				if (DatasetExporter.Open(DatasetPath, Config.BoardWidth, Config.BoardHeight, Config.PreviewCount))
+				{
+					Game.SetDatasetExporter(&DatasetExporter);
+				}
+			}
+		};
+
+		if (Replays.Num() > 0)
+		{
+			// 入力ファイルの時刻どおりに入力し、最後の入力で終了
+			const FReplayFile& Replay = Replays[GameIndex];
+			Config.Seed = Replay.Seed;
+			Config.RandomizerType = Replay.RandomizerType;
+			Config.Ruleset = Replay.Ruleset;
+			Game.Reset(Config);
+			OpenDataset();
+
+			for (const FReplayInput& Input : Replay.Inputs)
+			{
+				if (Game.IsGameOver())
+				{
+					break;
+				}
+				Game.Advance(Input.TimeMicroseconds - Game.GetElapsedMicroseconds());
+				Game.ApplyInput(Input.Command);
+			}
+			Result.Source = FPaths::GetCleanFilename(Replay.Path);
+		}
+		else
+		{
+			// ボット：1フレームに1ピース置く
+			Config.Seed = BaseSeed + GameIndex;
+			Game.Reset(Config);
+			OpenDataset();
+
+			const FTetrisBotWeights Weights;
+			FTetrisBeamSearch BeamSearch(BeamSettings);
+			FTetrisBeamSearchResult BeamResult;
+			TArray<ETetrisInputCommand> Inputs;
+			while (!Game.IsGameOver() && Game.GetStats().PiecesPlaced < MaxPieces)
+			{
+				if (Game.HasActivePiece())
+				{
+					bool bFound = false;
+					if (bBeamBot)
+					{
+						bFound = BeamSearch.FindBestMove(Game, BeamResult);
+						Inputs = BeamResult.Inputs;
+					}
+					else
+					{
+						bFound = TetrisBot::FindBestPlacement(Game, Weights, Inputs);
+					}
+					if (!bFound)
+					{
+						Inputs.Reset();
+						Inputs.Add(ETetrisInputCommand::HardDrop);
+					}
+					for (ETetrisInputCommand Command : Inputs)
+					{
+						Game.ApplyInput(Command);
+					}
+				}
+				Game.Advance(BOT_FRAME_MICROSECONDS);
+			}
+			Result.Source = bBeamBot ? TEXT("beam") : TEXT("bot");
+		}
+
+		Game.SetDatasetExporter(nullptr);
+		DatasetExporter.Close();
+
+		Result.Seed = Config.Seed;
+		Result.Stats = Game.GetStats();
+		Result.bGameOver = Game.IsGameOver();
+		Result.SimulatedMicroseconds = Game.GetElapsedMicroseconds();
+		Result.WallSeconds = FPlatformTime::Seconds() - GameStartTime;
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	const double TotalWallSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-6);
+
+	// 集計
+	int64 TotalPieces = 0;
+	int64 TotalLines = 0;
+	int64 TotalScore = 0;
+	int64 TotalSimulatedMicroseconds = 0;
+	int32 GamesOver = 0;
+	for (const FGameResult& Result : Results)
+	{
+		TotalPieces += Result.Stats.PiecesPlaced;
+		TotalLines += Result.Stats.LinesCleared;
+		TotalScore += Result.Stats.Score;
+		TotalSimulatedMicroseconds += Result.SimulatedMicroseconds;
+		GamesOver += Result.bGameOver ? 1 : 0;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Tetris simulation: %d games (%d game over), %lld pieces, %lld lines, avg score %.1f"),
+		NumGames, GamesOver, TotalPieces, TotalLines, double(TotalScore) / NumGames);
+	UE_LOG(LogTemp, Display, TEXT("Throughput: %.3f s wall, %.1f games/s, %.0f pieces/s, %.0fx real time%s"),
+		TotalWallSeconds, NumGames / TotalWallSeconds, TotalPieces / TotalWallSeconds,
+		(TotalSimulatedMicroseconds / 1000000.0) / TotalWallSeconds, bParallel ? TEXT(" (parallel)") : TEXT(""));
+
+	if (!WriteSummaryCsv(CsvPath, Results))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *CsvPath);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Summary written to %s"), *CsvPath);
+
+	return 0;
+}
+
+int32 UTetrisSimulationCommandlet::RunArena(const FTetrisSimConfig& Config, int32 NumGames, int32 NumSteps)
+{
+	static const ETetrisInputCommand Commands[] =
+	{
+		ETetrisInputCommand::MoveLeft,
+		ETetrisInputCommand::MoveRight,
+		ETetrisInputCommand::Rotate,
+		ETetrisInputCommand::MoveDown,
+		ETetrisInputCommand::HardDrop
+	};
+
+	FTetrisArena Arena;
+	Arena.Initialize(Config, NumGames);
+
+	FRandomStream Random(Config.Seed);
+	double TotalStepSeconds = 0.0;
+	double SlowestStepSeconds = 0.0;
+	for (int32 StepIndex = 0; StepIndex < NumSteps; StepIndex++)
+	{
+		// 1ステップに1ゲーム1入力。終わったゲームはやり直して人数を保つ
+		for (int32 GameIndex = 0; GameIndex < NumGames; GameIndex++)
+		{
+			if (Arena.IsGameOver(GameIndex))
+			{
+				Arena.ResetGame(GameIndex, static_cast<int32>(Random.GetUnsignedInt()));
+			}
+			Arena.QueueInput(GameIndex, Commands[Random.RandRange(0, UE_ARRAY_COUNT(Commands) - 1)]);
+		}
+
+		Arena.Step(BOT_FRAME_MICROSECONDS);
+		const double StepSeconds = Arena.GetArenaStats().LastStepSeconds;
+		TotalStepSeconds += StepSeconds;
+		SlowestStepSeconds = FMath::Max(SlowestStepSeconds, StepSeconds);
+	}
+
+	const FTetrisArenaStats Stats = Arena.GetArenaStats();
+	const double AverageStepSeconds = TotalStepSeconds / FMath::Max(NumSteps, 1);
+	UE_LOG(LogTemp, Display, TEXT("Tetris arena: %d games, %d steps, %d bytes per game, %.1f KB allocated"),
+		Stats.NumGames, NumSteps, Stats.BytesPerGame, Stats.AllocatedBytes / 1024.0);
+	UE_LOG(LogTemp, Display, TEXT("Step time: avg %.3f ms, max %.3f ms, %.3f ms per 1000 games"),
+		AverageStepSeconds * 1000.0, SlowestStepSeconds * 1000.0, AverageStepSeconds * 1000.0 * 1000.0 / FMath::Max(NumGames, 1));
+	return 0;
+}
+
+int32 UTetrisSimulationCommandlet::BuildPerfectClearTable(const FString& Path, int32 Width, int32 Height)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<uint8> TableBytes;
+	const int64 NumEntries = TetrisPerfectClear::BuildTable(Width, Height, TableBytes);
+	if (NumEntries == 0)
+	{
+		return 1;
+	}
+
+	if (!FFileHelper::SaveArrayToFile(TableBytes, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write perfect clear table %s"), *Path);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Perfect clear table: %d lines, %lld entries, %.1f KB in %.1f s -> %s"),
+		Height, NumEntries, TableBytes.Num() / 1024.0, FPlatformTime::Seconds() - StartTime, *Path);
+	return 0;
+}
+
+bool UTetrisSimulationCommandlet::LoadReplayFile(const FString& Path, FReplayFile& OutReplay)
+{
+	// 形式: "seed=N" / "randomizer=Type" / "ruleset=Type" / "<時刻ms> <コマンド名>"、# 以降はコメント
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read replay %s"), *Path);
+		return false;
+	}
+
+	OutReplay.Path = Path;
+	const UEnum* CommandEnum = StaticEnum<ETetrisInputCommand>();
+	const UEnum* RandomizerEnum = StaticEnum<ETetrisRandomizerType>();
+	const UEnum* RulesetEnum = StaticEnum<ETetrisRuleset>();
+
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); LineIndex++)
+	{
+		FString Line = Lines[LineIndex];
+		int32 CommentIndex = INDEX_NONE;
+		if (Line.FindChar(TEXT('#'), CommentIndex))
+		{
+			Line.LeftInline(CommentIndex);
+		}
+		Line.TrimStartAndEndInline();
+		if (Line.IsEmpty())
+		{
+			continue;
+		}
+
+		FString Key;
+		FString Value;
+		if (Line.Split(TEXT("="), &Key, &Value))
+		{
+			if (Key.Equals(TEXT("seed"), ESearchCase::IgnoreCase))
+			{
+				OutReplay.Seed = FCString::Atoi(*Value);
+				continue;
+			}
+			if (Key.Equals(TEXT("randomizer"), ESearchCase::IgnoreCase))
+			{
+				const int64 RandomizerValue = RandomizerEnum->GetValueByNameString(Value);
+				if (RandomizerValue != INDEX_NONE)
+				{
+					OutReplay.RandomizerType = static_cast<ETetrisRandomizerType>(RandomizerValue);
+					continue;
+				}
+			}
+			if (Key.Equals(TEXT("ruleset"), ESearchCase::IgnoreCase))
+			{
+				const int64 RulesetValue = RulesetEnum->GetValueByNameString(Value);
+				if (RulesetValue != INDEX_NONE)
+				{
+					OutReplay.Ruleset = static_cast<ETetrisRuleset>(RulesetValue);
+					continue;
+				}
+			}
+		}
+		else if (Line.Split(TEXT(" "), &Key, &Value) && Key.IsNumeric())
+		{
+			const int64 CommandValue = CommandEnum->GetValueByNameString(Value.TrimStart());
+			if (CommandValue != INDEX_NONE)
+			{
+				FReplayInput& Input = OutReplay.Inputs.AddDefaulted_GetRef();
+				Input.TimeMicroseconds = FCString::Atoi64(*Key) * 1000;
+				Input.Command = static_cast<ETetrisInputCommand>(CommandValue);
+				continue;
+			}
+		}
+
+		UE_LOG(LogTemp, Error, TEXT("%s(%d): cannot parse '%s'"), *Path, LineIndex + 1, *Lines[LineIndex]);
+		return false;
+	}
+
+	// 時刻順に並べておく（同時刻は記述順）
+	Algo::StableSortBy(OutReplay.Inputs, &FReplayInput::TimeMicroseconds);
+	return true;
+}
+
+bool UTetrisSimulationCommandlet::WriteSummaryCsv(const FString& Path, const TArray<FGameResult>& Results)
+{
+	FString Csv = TEXT("Game,Source,Seed,Pieces,Lines,Score,Level,GameOver,SimulatedSeconds,WallMilliseconds\n");
+	for (int32 GameIndex = 0; GameIndex < Results.Num(); GameIndex++)
+	{
+		const FGameResult& Result = Results[GameIndex];
+		Csv += FString::Printf(TEXT("%d,%s,%d,%d,%d,%d,%d,%d,%.3f,%.3f\n"),
+			GameIndex, *Result.Source, Result.Seed,
+			Result.Stats.PiecesPlaced, Result.Stats.LinesCleared, Result.Stats.Score, Result.Stats.Level,
+			Result.bGameOver ? 1 : 0,
+			Result.SimulatedMicroseconds / 1000000.0, Result.WallSeconds * 1000.0);
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Path);
+}
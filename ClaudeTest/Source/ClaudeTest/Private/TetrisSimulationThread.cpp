@@ -0,0 +1,143 @@
+#include "TetrisSimulationThread.h"
+#include "TetrisStats.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+FTetrisSimulationThread::FTetrisSimulationThread(const FTetrisSimConfig& InConfig, int32 InStepsPerSecond)
+	: Config(InConfig)
+{
+	StepsPerSecond = FMath::Clamp(InStepsPerSecond, 60, 10000);
+	StepMicroseconds = 1000000 / StepsPerSecond;
+
+	Game.Reset(Config);
+}
+
+FTetrisSimulationThread::~FTetrisSimulationThread()
+{
+	Shutdown();
+}
+
+bool FTetrisSimulationThread::Start()
+{
+	if (Thread)
+	{
+		return true;
+	}
+
+	// 最初のフレームはスレッド起動前に公開（ゲームスレッドがすぐに読めるように）
+	PublishFrame();
+
+	bStopRequested.store(false);
+	Thread = FRunnableThread::Create(this, TEXT("TetrisSimulation"), 0, TPri_AboveNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create Tetris simulation thread"));
+		return false;
+	}
+	return true;
+}
+
+void FTetrisSimulationThread::Shutdown()
+{
+	if (Thread)
+	{
+		// Kill は Stop() を呼んでから終了を待つ
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FTetrisSimulationThread::EnqueueInput(ETetrisInputCommand Command)
+{
+	InputQueue.Enqueue(Command);
+}
+
+const FTetrisSimFrame* FTetrisSimulationThread::ConsumeLatestFrame()
+{
+	if (!Frames.IsDirty())
+	{
+		return nullptr;
+	}
+
+	Frames.SwapReadBuffers();
+	return &Frames.Read();
+}
+
+uint32 FTetrisSimulationThread::Run()
+{
+	const double StepSeconds = 1.0 / StepsPerSecond;
+	double NextStepTime = FPlatformTime::Seconds();
+
+	while (!bStopRequested.load(std::memory_order_relaxed))
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now < NextStepTime)
+		{
+			FPlatformProcess::SleepNoStats(static_cast<float>(NextStepTime - Now));
+			continue;
+		}
+
+		Step();
+		NextStepTime += StepSeconds;
+
+		// 大きく遅れた場合（デバッガ停止など）は追いつこうとせずに今から数え直す
+		if (Now - NextStepTime > 0.25)
+		{
+			NextStepTime = Now;
+		}
+	}
+	return 0;
+}
+
+void FTetrisSimulationThread::Stop()
+{
+	bStopRequested.store(true);
+}
+
+void FTetrisSimulationThread::Step()
+{
+	if (bPaused.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_TetrisSimStepWorker);
+
+	ETetrisInputCommand Command;
+	while (InputQueue.Dequeue(Command))
+	{
+		Game.ApplyInput(Command);
+		InputsApplied++;
+	}
+
+	if (!Game.IsGameOver())
+	{
+		Game.Advance(StepMicroseconds);
+	}
+	StepIndex++;
+
+	PublishFrame();
+}
+
+void FTetrisSimulationThread::PublishFrame()
+{
+	FTetrisSimFrame& Frame = Frames.GetWriteBuffer();
+	const FTetrisSimBoard& Board = Game.GetBoard();
+
+	Frame.StepIndex = StepIndex;
+	Frame.ElapsedMicroseconds = Game.GetElapsedMicroseconds();
+	Frame.BoardHeight = Board.Height;
+	FMemory::Memcpy(Frame.PackedRows, Board.PackedRows, sizeof(Frame.PackedRows));
+	Frame.ActivePiece = Game.GetActivePiece();
+	Frame.ActiveRotation = Game.GetActiveRotation();
+	Frame.ActiveX = Game.GetActiveX();
+	Frame.ActiveY = Game.GetActiveY();
+	Frame.Queue = Game.GetQueue();
+	Frame.Stats = Game.GetStats();
+	Frame.bGameOver = Game.IsGameOver();
+	Frame.InputsApplied = InputsApplied;
+
+	Frames.SwapWriteBuffers();
+}
@@ -0,0 +1,115 @@
+#include "TetrisSnapshot.h"
+#include "TetrisSerialization.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+bool FTetrisGameSnapshot::Serialize(FArchive& Ar)
+{
+	using namespace TetrisSerialization;
+
+	// ヘッダー
+	uint32 Magic = SNAPSHOT_MAGIC;
+	uint8 Version = CURRENT_VERSION;
+	Ar << Magic;
+	Ar << Version;
+
+	if (Ar.IsLoading() && (Magic != SNAPSHOT_MAGIC || Version == 0 || Version > CURRENT_VERSION))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unsupported Tetris snapshot (magic 0x%08x, version %d)"), Magic, Version);
+		Ar.SetError();
+		return false;
+	}
+
+	// ボード：空行は1バイト
+	Ar << BoardWidth;
+	Ar << BoardHeight;
+	if (Ar.IsLoading())
+	{
+		if (BoardHeight > MAX_ROWS || BoardWidth > TetrisConstants::MAX_PACKED_BOARD_WIDTH)
+		{
+			Ar.SetError();
+			return false;
+		}
+		PackedRows.SetNumZeroed(BoardHeight);
+	}
+	for (uint64& Row : PackedRows)
+	{
+		SerializeVarUInt(Ar, Row);
+	}
+
+	// 操作中のピース
+	SerializePieceType(Ar, ActivePieceType, true);
+	Ar << ActiveRotation;
+	Ar << ActiveX;
+	Ar << ActiveY;
+
+	// ネクストキューとランダマイザー状態
+	if (Version >= 2)
+	{
+		PieceQueue.Serialize(Ar);
+	}
+	else if (!SerializeVersion1Bag(Ar))
+	{
+		return false;
+	}
+
+	// 統計とタイマー
+	SerializeVarInt(Ar, Stats.Score);
+	SerializeVarInt(Ar, Stats.Level);
+	SerializeVarInt(Ar, Stats.LinesCleared);
+	SerializeVarInt(Ar, Stats.PiecesPlaced);
+	Ar << FallSpeed;
+	Ar << FallTimer;
+	SerializeEnum8(Ar, GameState, ETetrisGameState::Menu, ETetrisGameState::GameOver);
+
+	return !Ar.IsError();
+}
+
+bool FTetrisGameSnapshot::SerializeVersion1Bag(FArchive& Ar)
+{
+	using namespace TetrisSerialization;
+
+	// v1 は 7-bag の残りと次のピース1つだけを持っていた
+	uint8 BagCount = 0;
+	Ar << BagCount;
+	if (BagCount > 7)
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	FTetrisRandomizerState& State = PieceQueue.RandomizerState;
+	State.PoolCount = BagCount;
+	for (int32 i = 0; i < BagCount; i++)
+	{
+		SerializePieceType(Ar, State.Pool[i], false);
+	}
+	Ar << State.PoolIndex;
+
+	EPieceType NextPieceType = EPieceType::None;
+	int32 RandomSeed = 0;
+	SerializePieceType(Ar, NextPieceType, false);
+	Ar << RandomSeed;
+
+	State.RandomStream.Initialize(RandomSeed);
+	PieceQueue.RandomizerType = ETetrisRandomizerType::SevenBag;
+	PieceQueue.InitialSeed = RandomSeed;
+	PieceQueue.Ring[0] = NextPieceType;
+	PieceQueue.Head = 0;
+	PieceQueue.PreviewCount = 1;
+
+	return !Ar.IsError();
+}
+
+void FTetrisGameSnapshot::ToBytes(TArray<uint8>& OutBytes) const
+{
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+	const_cast<FTetrisGameSnapshot*>(this)->Serialize(Writer);
+}
+
+bool FTetrisGameSnapshot::FromBytes(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Reader(Bytes);
+	return Serialize(Reader);
+}
@@ -0,0 +1,24 @@
+#include "TetrisStats.h"
+
+DEFINE_STAT(STAT_TetrisInput);
+DEFINE_STAT(STAT_TetrisSimulation);
+DEFINE_STAT(STAT_TetrisDisplaySync);
+DEFINE_STAT(STAT_TetrisEvents);
+
+DEFINE_STAT(STAT_TetrisSimStep);
+DEFINE_STAT(STAT_TetrisSimStepWorker);
+DEFINE_STAT(STAT_TetrisArenaStep);
+DEFINE_STAT(STAT_TetrisRollback);
+
+DEFINE_STAT(STAT_TetrisInputEvents);
+DEFINE_STAT(STAT_TetrisCollisionQueries);
+DEFINE_STAT(STAT_TetrisInstancesUpdated);
+DEFINE_STAT(STAT_TetrisActorsSpawned);
+DEFINE_STAT(STAT_TetrisActorsDestroyed);
+
+DEFINE_STAT(STAT_TetrisGarbageTotal);
+DEFINE_STAT(STAT_TetrisPiecesPerSecond);
+
+DEFINE_STAT(STAT_TetrisArenaMemory);
+DEFINE_STAT(STAT_TetrisArenaBytesPerGame);
+DEFINE_STAT(STAT_TetrisArenaStepPer1000);
@@ -0,0 +1,137 @@
+#include "TetrisWorldSubsystem.h"
+#include "TetrisGameMode.h"
+#include "TetrisBoard.h"
+#include "TetrisPlayerController.h"
+#include "TetrisStats.h"
+#include "Engine/World.h"
+
+UTetrisWorldSubsystem* UTetrisWorldSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UTetrisWorldSubsystem>() : nullptr;
+}
+
+bool UTetrisWorldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UTetrisWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTetrisWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UTetrisWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// 1. 入力（キーリピート）
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TetrisInput);
+		for (int32 Index = 0; Index < Controllers.Num(); Index++)
+		{
+			if (IsValid(Controllers[Index]))
+			{
+				Controllers[Index]->TickInput(DeltaTime);
+			}
+		}
+	}
+
+	// 2. 全ゲームのシミュレーション
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TetrisSimulation);
+		for (int32 Index = 0; Index < Games.Num(); Index++)
+		{
+			if (IsValid(Games[Index]))
+			{
+				Games[Index]->TickSimulation(DeltaTime);
+			}
+		}
+	}
+
+	// 3. 表示同期（変更のあったボードだけ作り直す）
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TetrisDisplaySync);
+		for (int32 Index = 0; Index < Boards.Num(); Index++)
+		{
+			if (IsValid(Boards[Index]))
+			{
+				Boards[Index]->FlushDisplay();
+			}
+		}
+	}
+
+	// 4. イベント通知（UI は変更のあったフレームにだけ更新される）
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TetrisEvents);
+		for (int32 Index = 0; Index < Games.Num(); Index++)
+		{
+			if (IsValid(Games[Index]))
+			{
+				Games[Index]->FlushEvents();
+			}
+		}
+	}
+
+#if STATS
+	if (FThreadStats::IsCollectingData())
+	{
+		UpdatePiecesPerSecond(DeltaTime);
+	}
+#endif
+}
+
+void UTetrisWorldSubsystem::UpdatePiecesPerSecond(float DeltaTime)
+{
+	// 全ゲームの設置数の増分を約1秒ごとに集計する（リスタートで減った分は数えない）
+	int64 TotalPieces = 0;
+	for (int32 Index = 0; Index < Games.Num(); Index++)
+	{
+		if (IsValid(Games[Index]))
+		{
+			TotalPieces += Games[Index]->GetGameStats().PiecesPlaced;
+		}
+	}
+
+	PiecesInWindow += FMath::Max<int64>(TotalPieces - LastTotalPieces, 0);
+	LastTotalPieces = TotalPieces;
+	PiecesWindowSeconds += DeltaTime;
+
+	if (PiecesWindowSeconds >= 1.0f)
+	{
+		PiecesPerSecond = PiecesInWindow / PiecesWindowSeconds;
+		PiecesInWindow = 0;
+		PiecesWindowSeconds = 0.0f;
+	}
+	SET_FLOAT_STAT(STAT_TetrisPiecesPerSecond, PiecesPerSecond);
+}
+
+void UTetrisWorldSubsystem::RegisterController(ATetrisPlayerController* Controller)
+{
+	Controllers.AddUnique(Controller);
+}
+
+void UTetrisWorldSubsystem::UnregisterController(ATetrisPlayerController* Controller)
+{
+	Controllers.Remove(Controller);
+}
+
+void UTetrisWorldSubsystem::RegisterGame(ATetrisGameMode* Game)
+{
+	Games.AddUnique(Game);
+}
+
+void UTetrisWorldSubsystem::UnregisterGame(ATetrisGameMode* Game)
+{
+	Games.Remove(Game);
+}
+
+void UTetrisWorldSubsystem::RegisterBoard(ATetrisBoard* Board)
+{
+	Boards.AddUnique(Board);
+}
+
+void UTetrisWorldSubsystem::UnregisterBoard(ATetrisBoard* Board)
+{
+	Boards.Remove(Board);
+}
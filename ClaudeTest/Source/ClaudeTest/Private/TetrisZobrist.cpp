@@ -0,0 +1,130 @@
+#include "TetrisZobrist.h"
+
+namespace TetrisZobrist
+{
+	namespace
+	{
+		const int32 PIECE_X_RANGE = MAX_WIDTH + PIECE_POSITION_MARGIN * 2;
+		const int32 PIECE_Y_RANGE = MAX_HEIGHT + PIECE_POSITION_MARGIN * 2;
+
+		// 固定シードの SplitMix64 で生成（実行ごと・プラットフォーム間で同じキー）
+		struct FZobristTables
+		{
+			uint64 CellKeys[MAX_HEIGHT][MAX_WIDTH][CELL_VALUES];
+			uint64 PieceTypeRotationKeys[PIECE_TYPES][4];
+			uint64 PieceXKeys[PIECE_X_RANGE];
+			uint64 PieceYKeys[PIECE_Y_RANGE];
+			uint64 QueueKeys[MAX_QUEUE_SLOTS][PIECE_TYPES];
+
+			FZobristTables()
+			{
+				uint64 State = 0x54455452495321ull; // "TETRIS!"
+				auto Next = [&State]()
+				{
+					State += 0x9E3779B97F4A7C15ull;
+					uint64 Z = State;
+					Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+					Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+					return Z ^ (Z >> 31);
+				};
+
+				for (int32 Y = 0; Y < MAX_HEIGHT; Y++)
+				{
+					for (int32 X = 0; X < MAX_WIDTH; X++)
+					{
+						CellKeys[Y][X][0] = 0;
+						for (int32 Value = 1; Value < CELL_VALUES; Value++)
+						{
+							CellKeys[Y][X][Value] = Next();
+						}
+					}
+				}
+
+				for (int32 Type = 0; Type < PIECE_TYPES; Type++)
+				{
+					for (int32 Rotation = 0; Rotation < 4; Rotation++)
+					{
+						PieceTypeRotationKeys[Type][Rotation] = Type == 0 ? 0 : Next();
+					}
+				}
+
+				for (uint64& Key : PieceXKeys)
+				{
+					Key = Next();
+				}
+
+				for (uint64& Key : PieceYKeys)
+				{
+					Key = Next();
+				}
+
+				for (int32 Slot = 0; Slot < MAX_QUEUE_SLOTS; Slot++)
+				{
+					for (int32 Type = 0; Type < PIECE_TYPES; Type++)
+					{
+						QueueKeys[Slot][Type] = Type == 0 ? 0 : Next();
+					}
+				}
+			}
+		};
+
+		const FZobristTables& GetTables()
+		{
+			static const FZobristTables Tables;
+			return Tables;
+		}
+	}
+
+	uint64 GetCellKey(int32 X, int32 Y, uint8 CellValue)
+	{
+		if (X < 0 || X >= MAX_WIDTH || Y < 0 || Y >= MAX_HEIGHT || CellValue >= CELL_VALUES)
+		{
+			return 0;
+		}
+		return GetTables().CellKeys[Y][X][CellValue];
+	}
+
+	uint64 GetPieceKey(EPieceType PieceType, int32 Rotation, int32 X, int32 Y)
+	{
+		const int32 Type = static_cast<int32>(PieceType);
+		if (Type <= 0 || Type >= PIECE_TYPES)
+		{
+			return 0;
+		}
+
+		const FZobristTables& Tables = GetTables();
+		const int32 XIndex = FMath::Clamp(X + PIECE_POSITION_MARGIN, 0, PIECE_X_RANGE - 1);
+		const int32 YIndex = FMath::Clamp(Y + PIECE_POSITION_MARGIN, 0, PIECE_Y_RANGE - 1);
+		return Tables.PieceTypeRotationKeys[Type][Rotation & 3] ^ Tables.PieceXKeys[XIndex] ^ Tables.PieceYKeys[YIndex];
+	}
+
+	uint64 GetQueueKey(int32 Slot, EPieceType PieceType)
+	{
+		const int32 Type = static_cast<int32>(PieceType);
+		if (Slot < 0 || Slot >= MAX_QUEUE_SLOTS || Type < 0 || Type >= PIECE_TYPES)
+		{
+			return 0;
+		}
+		return GetTables().QueueKeys[Slot][Type];
+	}
+
+	uint64 GetRowTransitionKey(int32 Y, uint64 OldPackedRow, uint64 NewPackedRow)
+	{
+		uint64 Key = 0;
+		uint64 Changed = OldPackedRow ^ NewPackedRow;
+		while (Changed != 0)
+		{
+			// 変化したセルだけを処理
+			const int32 X = FMath::CountTrailingZeros64(Changed) / TetrisCellPacking::BITS_PER_CELL;
+			Key ^= GetCellKey(X, Y, TetrisCellPacking::GetPackedCell(OldPackedRow, X));
+			Key ^= GetCellKey(X, Y, TetrisCellPacking::GetPackedCell(NewPackedRow, X));
+			Changed &= ~(uint64(0xF) << (X * TetrisCellPacking::BITS_PER_CELL));
+		}
+		return Key;
+	}
+
+	uint64 HashPackedRow(int32 Y, uint64 PackedRow)
+	{
+		return GetRowTransitionKey(Y, 0, PackedRow);
+	}
+}
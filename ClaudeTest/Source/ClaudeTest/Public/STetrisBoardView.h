@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "TetrisTypes.h"
+
+class ATetrisBoard;
+class SBox;
+class SCanvas;
+class STetrisBoardViewEntry;
+
+// ボードを2Dの箱として描く軽量 Slate ウィジェット（複数のボードとネクスト/ホールドのプレビューを並べる）
+// 1枠ごとに子ウィジェットを作って SInvalidationPanel にまとめて入れる
+// 枠はセル番号（GetCellRevision）と操作中ピースの番号（GetActivePieceRevision）を覚えておき、変わった枠だけが描画データを作り直して再描画される
+// 変わっていない枠は前のフレームの描画をそのまま使う
+class CLAUDETEST_API STetrisBoardView : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(STetrisBoardView)
+		: _CellSize(8.0f)
+		, _BoardSpacing(8.0f)
+		, _Columns(4)
+		, _BackgroundColor(FLinearColor(0.02f, 0.02f, 0.02f, 1.0f))
+	{}
+		SLATE_ARGUMENT(float, CellSize)
+		SLATE_ARGUMENT(float, BoardSpacing)
+		SLATE_ARGUMENT(int32, Columns)
+		SLATE_ARGUMENT(FLinearColor, BackgroundColor)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	// 表示するボード（Columns 個ずつ折り返して並べる）
+	void SetBoards(const TArray<TWeakObjectPtr<ATetrisBoard>>& InBoards);
+	void AddBoard(ATetrisBoard* Board);
+	void ClearBoards();
+
+	// ネクスト/ホールドのプレビュー（ボードの後ろに 4x2 の枠で並べる）
+	void SetPreviewPieces(const TArray<EPieceType>& InPieces);
+
+	void SetCellSize(float InCellSize);
+	void SetBoardSpacing(float InBoardSpacing);
+	void SetColumns(int32 InColumns);
+	void SetBackgroundColor(const FLinearColor& InBackgroundColor);
+
+	// SWidget
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
+private:
+	// ボードの枠、続いてプレビューの枠
+	TArray<TSharedRef<STetrisBoardViewEntry>> Entries;
+	int32 NumBoardEntries = 0;
+
+	TSharedPtr<SBox> SizeBox;
+	TSharedPtr<SCanvas> Canvas;
+
+	float CellSize = 8.0f;
+	float BoardSpacing = 8.0f;
+	int32 Columns = 4;
+	FLinearColor BackgroundColor;
+
+	TSharedRef<STetrisBoardViewEntry> MakeEntry() const;
+
+	// 枠の配置を決め直してキャンバスのスロットを作り直す
+	void UpdateLayout();
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSimulation.h"
+
+// アリーナの計測値
+struct FTetrisArenaStats
+{
+	int32 NumGames = 0;
+	int32 NumAlive = 0;
+
+	// 1ゲーム分の状態（全ての列の合計）と、確保した領域全体
+	int32 BytesPerGame = 0;
+	int64 AllocatedBytes = 0;
+
+	// 直近の Step の所要時間と、1000 ゲームあたりに換算した値
+	double LastStepSeconds = 0.0;
+	double StepSecondsPer1000Games = 0.0;
+};
+
+// 多数のゲームを同時に進めるコンテナ（大人数の対戦ロビー・サーバー用）
+//
+// 全ゲームの状態を列（盤面・ピース・タイマー・統計・ネクストとバッグ）ごとの配列で1つの領域に持ち、
+// Step で CHUNK_GAMES ゲームずつ並列に進める。進め方は FTetrisSimGame と同じ TetrisGameStep なので、同じ設定・入力なら同じ結果になる
+// 盤面サイズ・落下速度などの設定は全ゲーム共通、シードだけゲームごと
+class CLAUDETEST_API FTetrisArena
+{
+public:
+	// 並列化の単位。1バイトの列でもチャンクの境界がキャッシュラインをまたがない
+	static constexpr int32 CHUNK_GAMES = 64;
+
+	// 1ゲームが次の Step までに溜められる入力数
+	static constexpr int32 MAX_PENDING_INPUTS = 8;
+
+	FTetrisArena() = default;
+	~FTetrisArena();
+
+	FTetrisArena(const FTetrisArena&) = delete;
+	FTetrisArena& operator=(const FTetrisArena&) = delete;
+
+	// NumGames ゲーム分を確保し、ゲーム i をシード Config.Seed + i で始める
+	void Initialize(const FTetrisSimConfig& InConfig, int32 InNumGames);
+
+	// 1ゲームだけシードを変えてやり直す
+	void ResetGame(int32 GameIndex, int32 Seed);
+
+	int32 GetNumGames() const { return NumGames; }
+	const FTetrisSimConfig& GetConfig() const { return Config; }
+
+	// 入力を次の Step の先頭で適用するよう積む（溢れたら false）。Pause/Restart は無視する
+	bool QueueInput(int32 GameIndex, ETetrisInputCommand Command);
+
+	// 積まれた入力を適用してから全ゲームの時間を進める。MaxThreads = 1 なら呼び出したスレッドだけで進める
+	void Step(int64 DeltaMicroseconds, int32 MaxThreads = 0);
+
+	// ゲームごとの状態
+	bool IsGameOver(int32 GameIndex) const { return (Flags[GameIndex] & FLAG_GAME_OVER) != 0; }
+	EPieceType GetActivePiece(int32 GameIndex) const { return ActivePieces[GameIndex]; }
+	int32 GetActiveRotation(int32 GameIndex) const { return ActiveRotations[GameIndex]; }
+	int32 GetActiveX(int32 GameIndex) const { return ActiveXs[GameIndex]; }
+	int32 GetActiveY(int32 GameIndex) const { return ActiveYs[GameIndex]; }
+	int64 GetElapsedMicroseconds(int32 GameIndex) const { return ElapsedTimes[GameIndex]; }
+	FTetrisGameStats GetStats(int32 GameIndex) const;
+	const FTetrisPieceQueue& GetQueue(int32 GameIndex) const { return Queues[GameIndex]; }
+
+	// 盤面の行（BoardHeight 行、Y = 0 が最上段）
+	const uint16* GetRows(int32 GameIndex) const { return &Rows[GameIndex * Config.BoardHeight]; }
+	const uint64* GetPackedRows(int32 GameIndex) const { return &PackedRows[GameIndex * Config.BoardHeight]; }
+
+	FTetrisArenaStats GetArenaStats() const;
+
+private:
+	static constexpr uint8 FLAG_GAME_OVER = 1 << 0;
+	static constexpr uint8 FLAG_LINE_CLEAR_PENDING = 1 << 1;
+
+	void Release();
+
+	// ルールセットごとにインスタンス化する（Config.Ruleset での選択は Step の入口で1回だけ）
+	template<typename RulesType> void StepChunk(int32 FirstGame, int32 LastGame, int64 DeltaMicroseconds);
+
+	// 1ゲーム分の列と TetrisGameStep の間の受け渡し
+	FTetrisGameStepContext MakeStepContext(int32 GameIndex);
+	FTetrisGameState LoadState(int32 GameIndex) const;
+	void StoreState(int32 GameIndex, const FTetrisGameState& State);
+
+	FTetrisSimConfig Config;
+	uint16 FullRowMask = 0;
+	int32 NumGames = 0;
+	int32 BytesPerGame = 0;
+	int64 AllocatedBytes = 0;
+	double LastStepSeconds = 0.0;
+
+	// 全ての列を置く1つの領域
+	uint8* Arena = nullptr;
+
+	// 盤面（ゲームごとに BoardHeight 行）
+	uint16* Rows = nullptr;
+	uint64* PackedRows = nullptr;
+
+	// ネクストとバッグ
+	FTetrisPieceQueue* Queues = nullptr;
+
+	// 操作中のピース
+	EPieceType* ActivePieces = nullptr;
+	uint8* ActiveRotations = nullptr;
+	int8* ActiveXs = nullptr;
+	int8* ActiveYs = nullptr;
+
+	// タイマー（落下・消去待ちは1間隔に収まるので32bit）
+	int64* ElapsedTimes = nullptr;
+	int32* FallTimers = nullptr;
+	int32* LineClearTimers = nullptr;
+
+	// 統計
+	int32* Scores = nullptr;
+	int32* Levels = nullptr;
+	int32* LinesCleared = nullptr;
+	int32* PiecesPlaced = nullptr;
+
+	uint8* Flags = nullptr;
+
+	// 次の Step で適用する入力（ゲームごとに MAX_PENDING_INPUTS 個）
+	uint8* PendingInputs = nullptr;
+	uint8* NumPendingInputs = nullptr;
+};
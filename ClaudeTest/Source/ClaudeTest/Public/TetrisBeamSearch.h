@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisBot.h"
+#include "TetrisSimulation.h"
+
+// ビームサーチの設定（インスタンスごと）
+// サーバーで1コアに複数のボットを載せる時は、時間予算とスレッド数をボットごとに絞る
+struct FTetrisBeamSearchSettings
+{
+	// 各深さで残す盤面の数
+	int32 BeamWidth = 128;
+
+	// 読むピース数（操作中のピース + ネクスト。ネクストの表示数で頭打ち）
+	int32 MaxDepth = 4;
+
+	// 1ピースあたりの思考時間（秒）。0 以下なら全深さを読み切る
+	double TimeBudgetSeconds = 0.01;
+
+	// 展開に使うスレッド数の上限（1 = 呼び出したスレッドだけ、0 = タスクシステムに任せる）
+	int32 MaxThreads = 1;
+
+	FTetrisBotWeights Weights;
+};
+
+// 探索結果
+struct FTetrisBeamSearchResult
+{
+	// 操作中のピースの固定位置と、そこまでの入力列（最後はハードドロップ）
+	FTetrisSimPlacement Placement;
+	TArray<ETetrisInputCommand> Inputs;
+
+	// 最良の葉の評価値
+	float Score = 0.0f;
+
+	// 読み切った深さ（1 = 操作中のピースだけ）と展開した盤面の数
+	int32 DepthCompleted = 0;
+	int32 NodesExpanded = 0;
+
+	// 時間切れで途中の深さの結果を返した
+	bool bTimedOut = false;
+};
+
+// ネクストを先読みするビームサーチのボット
+// 各深さで到達可能な全固定位置（TetrisMoveGen）を展開し、同じ盤面は1つにまとめて上位 BeamWidth 個を残す
+// 展開はビームを分割して ParallelFor で並列に行い、候補の評価は TetrisBoardEval のバッチ版を使う
+// 時間切れになったら、読み切った最も深い段の最良手を返す（最初の段は必ず読み切る）
+// ホールドはゲーム側にないので扱わない
+class CLAUDETEST_API FTetrisBeamSearch
+{
+public:
+	explicit FTetrisBeamSearch(const FTetrisBeamSearchSettings& InSettings = FTetrisBeamSearchSettings());
+
+	const FTetrisBeamSearchSettings& GetSettings() const { return Settings; }
+	void SetSettings(const FTetrisBeamSearchSettings& InSettings) { Settings = InSettings; }
+
+	// 操作中のピースの置き方を探す（操作中のピースがないか、置ける場所がなければ false）
+	bool FindBestMove(const FTetrisSimGame& Game, FTetrisBeamSearchResult& OutResult);
+
+private:
+	struct FNode
+	{
+		FTetrisSimBoard Board;
+
+		// 盤面の占有ビットのハッシュ（同じ深さの同じ盤面をまとめる）
+		uint64 Hash = 0;
+
+		// ここまでに消したラインの評価と、それに盤面の評価を足した値
+		float LineReward = 0.0f;
+		float Score = 0.0f;
+
+		// 最初の手（RootPlacements のインデックス）
+		int32 RootIndex = INDEX_NONE;
+	};
+
+	// 次のビームの候補（子の位置）
+	struct FCandidate
+	{
+		float Score = 0.0f;
+		int32 ParentIndex = 0;
+		int32 ChildIndex = 0;
+	};
+
+	// 1つの盤面にピースを置いた子を全て作って評価する（並列に呼ばれる）
+	void ExpandNode(const FNode& Parent, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY,
+		TArray<FNode>& OutChildren, TArray<FTetrisSimPlacement>* OutPlacements) const;
+
+	// 子を同一盤面でまとめ、評価順に BeamWidth 個を NextBeam に残す
+	void SelectBeam();
+
+	FTetrisBeamSearchSettings Settings;
+
+	// 呼び出しをまたいで使い回す作業領域
+	TArray<FNode> Beam;
+	TArray<FNode> NextBeam;
+	TArray<TArray<FNode>> ChildrenPerParent;
+	TArray<FCandidate> Candidates;
+	TArray<FTetrisSimPlacement> RootPlacements;
+	TMap<uint64, int32> Transpositions;
+};
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "TetrisTypes.h"
+#include "TetrisNetTypes.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "TetrisBoard.generated.h"
 
@@ -16,6 +17,8 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	// ボードのグリッド状態（true = 占有, false = 空）
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Board")
@@ -26,25 +29,56 @@ protected:
 	TArray<TArray<EPieceType>> BoardPieceTypes;
 
 	// ボードの寸法
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Board")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "Board")
 	int32 BoardWidth;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Board")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "Board")
 	int32 BoardHeight;
 
+	// サーバー → クライアントの行単位デルタレプリケーション
+	UPROPERTY(Replicated)
+	FTetrisBoardRowArray ReplicatedRows;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Board")
 	float BlockSize;
 
-	// ブロック表示用メッシュコンポーネント
+	// ブロック表示用メッシュコンポーネント（固定セル・操作中のピース・ゴーストを1つで描く）
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rendering")
 	UInstancedStaticMeshComponent* BlockMeshComponent;
 
+	// ゴーストを表示するか
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rendering")
+	bool bShowGhost;
+
 	// ボード背景メッシュ
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rendering")
 	UStaticMeshComponent* BoardBackgroundMesh;
 
+	// 各固定セルのインスタンスが表すセル（Y * BoardWidth + X）。インスタンス番号は RESERVED_INSTANCES + 添字
+	TArray<int32> InstanceCells;
+
+	// 操作中のピースのセル（空なら非表示）と種類
+	TArray<FTetrisCoordinate> ActivePieceCells;
+	EPieceType ActivePieceType;
+
+	// 操作中のピースが動く・消えるたびに増える番号（2D ビューのキャッシュ無効化用）
+	uint32 ActivePieceRevision;
+
+	// 全セルの Zobrist ハッシュ（セル変更時に差分更新）
+	uint64 BoardHash;
+
+	// セル内容が変わるたびに増える番号（2D ビューなどのキャッシュ無効化用）
+	uint32 CellRevision;
+
+	// 表示の作り直しが必要か（サブシステムの表示同期でまとめて反映）
+	bool bDisplayDirty;
+
 public:	
-	virtual void Tick(float DeltaTime) override;
+	// インスタンスの並び: [0, 4) 操作中のピース、[4, 8) ゴースト、以降が固定セル
+	// 予約分は常に存在し、使わない間はスケール 0 で隠す
+	static constexpr int32 ACTIVE_PIECE_INSTANCE = 0;
+	static constexpr int32 GHOST_INSTANCE = 4;
+	static constexpr int32 RESERVED_INSTANCES = 8;
 
 	// ボード初期化
 	UFUNCTION(BlueprintCallable, Category = "Board")
@@ -54,6 +88,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Board")
 	bool IsPositionValid(int32 X, int32 Y) const;
 
+	// セルを (StepX, StepY) ずつずらして置ける回数（着地位置の問い合わせ。ゴースト・ARR 0・床までのソフトドロップで使う）
+	int32 GetFreeDistance(TArrayView<const FTetrisCoordinate> Cells, int32 StepX, int32 StepY) const;
+
 	// ブロックを配置/削除
 	UFUNCTION(BlueprintCallable, Category = "Board")
 	void SetBlock(int32 X, int32 Y, bool bOccupied, EPieceType PieceType = EPieceType::None);
@@ -78,6 +115,41 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rendering")
 	void UpdateBoardDisplay();
 
+	// 表示の作り直しを予約（同じフレーム内の複数の変更は1回にまとまる）
+	void MarkDisplayDirty();
+
+	// 予約された表示更新を反映
+	void FlushDisplay();
+
+	// ライン消去アニメーション
+	// インスタンスごとのカスタムデータ: [0] = 消去行フラグ, [1] = 落下段数
+	// プリミティブのカスタムデータ: [0] = フラッシュ進行度, [1] = 落下進行度
+	UFUNCTION(BlueprintCallable, Category = "Rendering")
+	void BeginLineClearAnimation(const TArray<int32>& ClearedLines);
+
+	UFUNCTION(BlueprintCallable, Category = "Rendering")
+	void SetLineClearAnimationPhase(float FlashAlpha, float FallAlpha);
+
+	// アニメーション終了：行を実際に詰めて表示を作り直す
+	UFUNCTION(BlueprintCallable, Category = "Rendering")
+	void FinishLineClearAnimation(const TArray<int32>& ClearedLines);
+
+	UFUNCTION(BlueprintCallable, Category = "Rendering")
+	void CancelLineClearAnimation();
+
+	// 操作中のピースとゴーストを予約済みのインスタンスに書き込む（インスタンスの追加・削除はしない）
+	void SetActivePieceCells(const TArray<FTetrisCoordinate>& Cells, EPieceType PieceType = EPieceType::None);
+	void ClearActivePieceCells();
+
+	const TArray<FTetrisCoordinate>& GetActivePieceCells() const { return ActivePieceCells; }
+	EPieceType GetActivePieceType() const { return ActivePieceType; }
+	uint32 GetActivePieceRevision() const { return ActivePieceRevision; }
+
+	UFUNCTION(BlueprintCallable, Category = "Rendering")
+	void SetGhostEnabled(bool bEnabled);
+
+	UInstancedStaticMeshComponent* GetBlockMeshComponent() const { return BlockMeshComponent; }
+
 	// 特定位置の表示を更新
 	UFUNCTION(BlueprintCallable, Category = "Rendering")
 	void UpdateBlockDisplay(int32 X, int32 Y);
@@ -89,6 +161,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Board")
 	EPieceType GetBlockPieceType(int32 X, int32 Y) const;
 
+	UFUNCTION(BlueprintCallable, Category = "Board")
+	int32 GetBoardWidth() const { return BoardWidth; }
+
+	UFUNCTION(BlueprintCallable, Category = "Board")
+	int32 GetBoardHeight() const { return BoardHeight; }
+
 	// ゲームオーバー判定
 	UFUNCTION(BlueprintCallable, Category = "Board")
 	bool IsGameOver() const;
@@ -97,16 +175,51 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Debug")
 	void DebugPrintBoard() const;
 
+	// 1行 = 幅ぶんの文字 + 改行（'.' = 空、I/O/T/S/Z/J/L = ピース、'#' = 種類なし）。TetrisTestUtils::MakeSimBoard と同じ記法
+	UFUNCTION(BlueprintCallable, Category = "Debug")
+	FString ToAsciiString() const;
+
+	// fumen（v115）の PageIndex ページ目の盤面を読み込む（操作ピースは置かない。幅 10 のボードのみ）
+	UFUNCTION(BlueprintCallable, Category = "Board")
+	bool LoadFumen(const FString& Fumen, int32 PageIndex = 0);
+
+	// 盤面を1ページの fumen にする（幅 10 以外は空文字列）
+	UFUNCTION(BlueprintCallable, Category = "Board")
+	FString ToFumen() const;
+
+	// 1行分のセルを TetrisCellPacking 形式で取得/設定
+	uint64 GetPackedRow(int32 Y) const;
+	void SetPackedRow(int32 Y, uint64 PackedCells, bool bUpdateDisplay = true);
+
+	// ボードセルの Zobrist ハッシュ
+	uint64 GetBoardHash() const { return BoardHash; }
+
+	uint32 GetCellRevision() const { return CellRevision; }
+
+	// 全セルから計算し直したハッシュ（差分更新の検証用）
+	uint64 ComputeBoardHash() const;
+
+	// クライアント側：行データ受信時に呼ばれる
+	void OnReplicatedRowsReceived();
+
+	// サーバー側：レプリケーション用の行（変わった行だけ ReplicationKey が進む）
+	const FTetrisBoardRowArray& GetReplicatedRows() const { return ReplicatedRows; }
+
 private:
 	// 内部ヘルパー関数
 	void InitializeGridArrays();
+	void SyncReplicatedRow(int32 Y);
+	void SyncAllReplicatedRows();
+	void ApplyReplicatedRows(bool bUpdateDisplay);
 	void CreateBoardMesh();
 	void UpdateSingleBlockDisplay(int32 X, int32 Y, bool bVisible, EPieceType PieceType);
+	void UpdateReservedInstances();
+	void GetReservedInstanceTransforms(TArray<FTransform>& OutTransforms) const;
+	FTransform GetCellTransform(int32 X, int32 Y) const;
 	FLinearColor GetColorForPieceType(EPieceType PieceType) const;
 	FVector GetWorldPositionFromGrid(int32 X, int32 Y) const;
 };
 
 // ボード関連のデリゲート
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLinesCleared, int32, LinesCount);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnBoardCleared);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGameOver);
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+struct FTetrisSimBoard;
+
+// ボット用の盤面特徴量
+struct FTetrisBoardFeatures
+{
+	// 全列の高さの合計と最大
+	int32 AggregateHeight = 0;
+	int32 MaxHeight = 0;
+
+	// 上にブロックがある空セル
+	int32 Holes = 0;
+
+	// 隣り合う列の高さの差の合計
+	int32 Bumpiness = 0;
+
+	// 行内で空/埋まりが切り替わる回数（左右の壁は埋まり扱い）
+	int32 RowTransitions = 0;
+
+	// 井戸の深さの合計（上が開いていて左右が埋まった空セルの数）
+	int32 WellDepth = 0;
+
+	bool operator==(const FTetrisBoardFeatures& Other) const
+	{
+		return AggregateHeight == Other.AggregateHeight && MaxHeight == Other.MaxHeight && Holes == Other.Holes
+			&& Bumpiness == Other.Bumpiness && RowTransitions == Other.RowTransitions && WellDepth == Other.WellDepth;
+	}
+};
+
+// 候補盤面のバッチ（SoA：行ごとに全盤面の占有ビットを並べる）
+// 1つのベクタレジスタで4盤面の同じ行を同時に処理する
+struct CLAUDETEST_API FTetrisBoardBatch
+{
+	static constexpr int32 LANES = 4;
+
+	int32 Width = TetrisConstants::BOARD_WIDTH;
+	int32 Height = TetrisConstants::BOARD_HEIGHT;
+	int32 Num = 0;
+
+	// 1行あたりの盤面数（LANES の倍数。空きレーンは空の盤面）
+	int32 Stride = 0;
+
+	// Rows[Y * Stride + BoardIndex]
+	TArray<uint32> Rows;
+
+	// 盤面サイズが同じ候補を Capacity 個まで並べられるように確保
+	void Reset(int32 InWidth, int32 InHeight, int32 Capacity);
+
+	// 盤面を追加してインデックスを返す（容量を超えたら並べ直して広げる）
+	int32 Add(const FTetrisSimBoard& Board);
+
+	uint32 GetRow(int32 BoardIndex, int32 Y) const { return Rows[Y * Stride + BoardIndex]; }
+
+private:
+	void Grow(int32 NewStride);
+};
+
+namespace TetrisBoardEval
+{
+	// セル単位で数える参照実装。IsOccupied(X, Y) で盤面を読むので ATetrisBoard::GetBlockState でも使える
+	template<typename CellFuncType>
+	void ComputeFeaturesFromCells(int32 Width, int32 Height, CellFuncType&& IsOccupied, FTetrisBoardFeatures& OutFeatures)
+	{
+		check(Width <= TetrisConstants::MAX_PACKED_BOARD_WIDTH);
+		OutFeatures = FTetrisBoardFeatures();
+
+		// 各列の一番上のブロック（無ければ Height）
+		int32 ColumnTops[TetrisConstants::MAX_PACKED_BOARD_WIDTH];
+		for (int32 X = 0; X < Width; X++)
+		{
+			ColumnTops[X] = Height;
+			for (int32 Y = 0; Y < Height; Y++)
+			{
+				if (IsOccupied(X, Y))
+				{
+					ColumnTops[X] = Y;
+					break;
+				}
+			}
+		}
+
+		for (int32 X = 0; X < Width; X++)
+		{
+			const int32 ColumnHeight = Height - ColumnTops[X];
+			OutFeatures.AggregateHeight += ColumnHeight;
+			OutFeatures.MaxHeight = FMath::Max(OutFeatures.MaxHeight, ColumnHeight);
+			if (X > 0)
+			{
+				OutFeatures.Bumpiness += FMath::Abs(ColumnHeight - (Height - ColumnTops[X - 1]));
+			}
+
+			for (int32 Y = 0; Y < Height; Y++)
+			{
+				if (Y > ColumnTops[X])
+				{
+					OutFeatures.Holes += IsOccupied(X, Y) ? 0 : 1;
+				}
+				else if (Y < ColumnTops[X])
+				{
+					const bool bLeftFilled = X == 0 || IsOccupied(X - 1, Y);
+					const bool bRightFilled = X == Width - 1 || IsOccupied(X + 1, Y);
+					OutFeatures.WellDepth += (bLeftFilled && bRightFilled) ? 1 : 0;
+				}
+			}
+		}
+
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			bool bPreviousFilled = true;
+			for (int32 X = 0; X < Width; X++)
+			{
+				const bool bFilled = IsOccupied(X, Y);
+				OutFeatures.RowTransitions += bFilled != bPreviousFilled ? 1 : 0;
+				bPreviousFilled = bFilled;
+			}
+			OutFeatures.RowTransitions += bPreviousFilled ? 0 : 1;
+		}
+	}
+
+	// 1盤面の参照実装（バッチ版の検証用）
+	CLAUDETEST_API void ComputeFeatures(const FTetrisSimBoard& Board, FTetrisBoardFeatures& OutFeatures);
+
+	// バッチ内の全盤面をベクタ命令でまとめて計算（結果は参照実装と完全に一致する）
+	CLAUDETEST_API void ComputeFeaturesBatch(const FTetrisBoardBatch& Batch, TArray<FTetrisBoardFeatures>& OutFeatures);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "TetrisTypes.h"
+#include "TetrisBoardWidget.generated.h"
+
+class ATetrisBoard;
+class STetrisBoardView;
+
+// STetrisBoardView の UMG ラッパー（観戦グリッド・ネクスト/ホールド表示・軽量HUD用）
+UCLASS()
+class CLAUDETEST_API UTetrisBoardWidget : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	UTetrisBoardWidget(const FObjectInitializer& ObjectInitializer);
+
+	// 1セルの大きさ（スレートユニット）
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance", meta = (ClampMin = "1"))
+	float CellSize;
+
+	// ボード同士の間隔
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance", meta = (ClampMin = "0"))
+	float BoardSpacing;
+
+	// 1行に並べるボード数
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance", meta = (ClampMin = "1"))
+	int32 Columns;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor BackgroundColor;
+
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board View")
+	void SetBoards(const TArray<ATetrisBoard*>& InBoards);
+
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board View")
+	void AddBoard(ATetrisBoard* Board);
+
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board View")
+	void ClearBoards();
+
+	// ネクスト/ホールドのピースを並べて表示
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board View")
+	void SetPreviewPieces(const TArray<EPieceType>& InPieces);
+
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+#if WITH_EDITOR
+	virtual const FText GetPaletteCategory() override;
+#endif
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+private:
+	TSharedPtr<STetrisBoardView> BoardView;
+
+	// Slate ウィジェット作成前に設定された内容も保持する
+	TArray<TWeakObjectPtr<ATetrisBoard>> Boards;
+	TArray<EPieceType> PreviewPieces;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+struct FTetrisSimBoard;
+struct FTetrisBoardFeatures;
+class FTetrisSimGame;
+
+// 盤面評価の重み（高さ・消去ライン・穴・凹凸の線形和）
+// 行の切り替わりと井戸は既定では使わない
+struct FTetrisBotWeights
+{
+	float AggregateHeight = -0.510066f;
+	float CompleteLines = 0.760666f;
+	float Holes = -0.35663f;
+	float Bumpiness = -0.184483f;
+	float RowTransitions = 0.0f;
+	float WellDepth = 0.0f;
+};
+
+// 1手読みの貪欲ボット（ヘッドレスシミュレーション・回帰テスト用）
+namespace TetrisBot
+{
+	// 固定後の盤面の評価値（大きいほど良い）
+	CLAUDETEST_API float EvaluateBoard(const FTetrisSimBoard& Board, int32 LinesCleared, const FTetrisBotWeights& Weights);
+
+	// 計算済みの特徴量から評価値を求める
+	CLAUDETEST_API float ScoreFeatures(const FTetrisBoardFeatures& Features, int32 LinesCleared, const FTetrisBotWeights& Weights);
+
+	// 「回転 → 左右移動 → ハードドロップ」で届く配置を全て試し、最良の入力列を返す
+	// 候補の盤面はまとめて TetrisBoardEval::ComputeFeaturesBatch で評価する
+	// 置ける場所がなければ false
+	CLAUDETEST_API bool FindBestPlacement(const FTetrisSimGame& Game, const FTetrisBotWeights& Weights, TArray<ETetrisInputCommand>& OutInputs);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+#include "TetrisTypes.h"
+#include "TetrisRandomizer.h"
+
+class FArchive;
+class FEvent;
+class FRunnableThread;
+
+// 学習用データセットの1判断点（ピースを固定した時点）
+// 状態 = 固定前の盤面・ピース・ネクスト、行動 = 固定位置、報酬 = ライン消去の得点
+struct FTetrisDecisionRecord
+{
+	static constexpr int32 MAX_HEIGHT = TetrisConstants::BOARD_HEIGHT + TetrisConstants::BOARD_BUFFER_HEIGHT;
+
+	// ゲームの識別子（シード）と、ゲーム内で何個目のピースか（0 から）
+	uint32 GameId = 0;
+	uint32 PieceIndex = 0;
+
+	// 固定前の盤面の占有ビット（bit X = 列 X、Y = 0 が最上段）
+	uint16 BoardRows[MAX_HEIGHT] = {};
+
+	EPieceType Piece = EPieceType::None;
+	EPieceType Queue[FTetrisPieceQueue::MAX_PREVIEW] = {};
+
+	// 4x4 形状の左上と回転
+	uint8 Rotation = 0;
+	int8 X = 0;
+	int8 Y = 0;
+
+	uint8 LinesCleared = 0;
+	int32 Reward = 0;
+};
+
+// ファイル先頭のヘッダー
+struct FTetrisDatasetHeader
+{
+	static constexpr uint32 MAGIC = 0x31534454; // "TDS1"
+	static constexpr uint32 VERSION = 1;
+
+	int32 BoardWidth = 0;
+	int32 BoardHeight = 0;
+	int32 PreviewCount = 0;
+	int32 ChunkRecords = 0;
+
+	// Close で確定する（途中で止まったファイルは 0 のまま。チャンクは末尾まで読める）
+	int64 NumRecords = 0;
+};
+
+// (状態, 行動) の判断点を列指向のバイナリファイルに書き出す
+//
+// ファイル = ヘッダー + チャンクの並び。チャンク = 件数 + 列ごとに全件分の値
+// （GameId / PieceIndex / 盤面 / ピース / ネクスト / 回転 / X / Y / 消去ライン / 報酬）
+//
+// 生産者（ゲームスレッドやシミュレーションスレッド、1つだけ）は確保済みのチャンクの列に値を書くだけで、
+// 埋まったチャンクは裏のチャンクと入れ替えて書き込みスレッドに渡す（ダブルバッファ）。
+// 書き込みが前のチャンクに追いついていない時だけ生産者が待つ（GetNumStalls で数えられる）
+class CLAUDETEST_API FTetrisDatasetExporter : public FRunnable
+{
+public:
+	static constexpr int32 DEFAULT_CHUNK_RECORDS = 4096;
+
+	FTetrisDatasetExporter();
+	virtual ~FTetrisDatasetExporter() override;
+
+	// ファイルを作ってヘッダーを書き、書き込みスレッドを起動する
+	bool Open(const FString& InPath, int32 BoardWidth, int32 BoardHeight, int32 PreviewCount, int32 ChunkRecords = DEFAULT_CHUNK_RECORDS);
+
+	// 残りを書き出してスレッドを止め、ヘッダーの件数を確定する
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+	const FString& GetPath() const { return Path; }
+
+	// 判断点を1つ追加（生産者スレッドから）
+	void Add(const FTetrisDecisionRecord& Record);
+
+	int64 GetNumRecords() const { return NumRecords; }
+	int64 GetNumStalls() const { return NumStalls; }
+	int64 GetBytesWritten() const { return BytesWritten.load(std::memory_order_relaxed); }
+
+	// 書き出したファイルを全て読む（検証・ツール用）
+	static bool ReadFile(const FString& FilePath, FTetrisDatasetHeader& OutHeader, TArray<FTetrisDecisionRecord>& OutRecords);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	// 1チャンク分の列（Open で確保し、以後は確保し直さない）
+	struct FChunk
+	{
+		int32 Num = 0;
+		TArray<uint32> GameIds;
+		TArray<uint32> PieceIndices;
+		TArray<uint16> BoardRows;	// [Index * BoardHeight + Y]
+		TArray<uint8> Pieces;
+		TArray<uint8> Queues;		// [Index * PreviewCount + Slot]
+		TArray<uint8> Rotations;
+		TArray<int8> Xs;
+		TArray<int8> Ys;
+		TArray<uint8> LinesCleared;
+		TArray<int32> Rewards;
+
+		void Allocate(int32 ChunkRecords, int32 BoardHeight, int32 PreviewCount);
+	};
+
+	// 埋まった（または最後の）表のチャンクを書き込みスレッドに渡す
+	void SubmitFrontChunk();
+
+	// 書き込みスレッド：チャンクを列ごとにファイルへ
+	void WriteChunk(FChunk& Columns);
+
+	FString Path;
+	FTetrisDatasetHeader Header;
+
+	// 生産者が書く表と、書き込みスレッドが読む裏
+	FChunk Chunks[2];
+	FChunk* Front = &Chunks[0];
+	FChunk* Back = &Chunks[1];
+	std::atomic<bool> bBackPending { false };
+
+	FArchive* Writer = nullptr;
+	FRunnableThread* Thread = nullptr;
+	FEvent* ChunkReadyEvent = nullptr;
+	FEvent* BackFreeEvent = nullptr;
+	std::atomic<bool> bStopRequested { false };
+
+	int64 NumRecords = 0;
+	int64 NumStalls = 0;
+	std::atomic<int64> BytesWritten { 0 };
+};
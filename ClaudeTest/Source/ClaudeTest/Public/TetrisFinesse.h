@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+// フィネス（固定位置までの最少キー数）の判定
+// キーは押した回数で数える。長押しで壁まで動かすのも1回（キーリピートは数えない）。ハードドロップは数えない
+enum class ETetrisFinesseKey : uint8
+{
+	Left,
+	Right,
+	DasLeft,	// 壁まで長押し
+	DasRight,
+	Rotate
+};
+
+// 表の1項目：出現位置から (回転, X) に置く最少のキー列
+struct FTetrisFinesseEntry
+{
+	static constexpr int32 MAX_KEYS = 8;
+
+	bool bReachable = false;
+	uint8 NumKeys = 0;
+	ETetrisFinesseKey Keys[MAX_KEYS] = {};
+};
+
+// 1ピース分の判定
+struct FTetrisFinesseResult
+{
+	EPieceType PieceType = EPieceType::None;
+	int32 Rotation = 0;
+	int32 X = 0;
+	int32 KeysUsed = 0;
+	int32 KeysMinimal = 0;
+
+	// ソフトドロップを使った・出現位置から始めていない・表にない位置は判定しない
+	bool bJudged = false;
+
+	bool IsFault() const { return bJudged && KeysUsed > KeysMinimal; }
+};
+
+namespace TetrisFinesse
+{
+	// X の範囲（形状の空き列の分だけ負になる）
+	constexpr int32 MIN_X = 1 - TetrisConstants::PIECE_SIZE;
+	constexpr int32 NUM_COLUMNS = TetrisConstants::BOARD_WIDTH - MIN_X;
+
+	// 既定サイズの空の盤面で、出現位置から左右・長押し・回転（Wall Kick 込み）で作った表を引く
+	// 表はピースの移動・回転と同じ規則（TetrisRules・TetrisPieceTables）から初回の呼び出しで一度だけ作る
+	// セルが同じになる回転（S の 0 と 2 など）は少ない方のキー列を共有する
+	CLAUDETEST_API const FTetrisFinesseEntry& GetEntry(EPieceType PieceType, int32 Rotation, int32 X);
+
+	// 表を先に作っておく（ゲーム中の最初の判定で作らないように）
+	CLAUDETEST_API void Prebuild();
+}
+
+// ピースごとに押したキーを数え、固定した位置の表の値と比べる（探索はしない）
+class CLAUDETEST_API FTetrisFinesseTracker
+{
+public:
+	void Reset();
+
+	// ピースの操作開始。出現位置から始めていなければそのピースは判定しない
+	void BeginPiece(bool bFromSpawn = true);
+
+	// プレイヤーが押したキー（キーリピートは渡さない）
+	void AddKeyPress(ETetrisInputCommand Command);
+
+	// 固定した位置で判定する
+	FTetrisFinesseResult EndPiece(EPieceType PieceType, int32 Rotation, int32 X);
+
+	int32 GetPiecesJudged() const { return PiecesJudged; }
+	int32 GetFaults() const { return Faults; }
+	int32 GetExtraKeys() const { return ExtraKeys; }
+
+private:
+	int32 KeysUsed = 0;
+	bool bFromSpawn = false;
+	bool bSoftDropped = false;
+
+	int32 PiecesJudged = 0;
+	int32 Faults = 0;
+	int32 ExtraKeys = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+// fumen（テト譜、v115 形式）の読み書き
+//
+// 盤面は幅 10・高さ 23 行 + 床下のせり上がり1行。各ページの盤面は前のページ（の操作ピースを置いて消した後）との差分を
+// 「差分値 × 240 + 連続数」の連長で 64 進2文字ずつ書き、続けて操作ピースとフラグを3文字、コメントがあればその長さと本文を書く。
+// 読み書きは1ページあたり数 µs で、ヒープを使うのは出力の配列・文字列だけ
+
+// fumen の1ページ
+struct CLAUDETEST_API FTetrisFumenPage
+{
+	static constexpr int32 WIDTH = 10;
+	static constexpr int32 FIELD_HEIGHT = 23;
+
+	// 操作ピースを置く前の盤面。Rows[0] が一番下の行（TetrisCellPacking 形式、灰色のブロックは種類なしの占有セル）
+	uint64 Rows[FIELD_HEIGHT] = {};
+
+	// 床下のせり上がり行（bRise で盤面に入る）
+	uint64 GarbageRow = 0;
+
+	// 操作ピース（None なら無し）。回転は出現時から時計回りに 0〜3、(X, Y) は fumen の回転中心で Y は下から
+	EPieceType PieceType = EPieceType::None;
+	uint8 Rotation = 0;
+	int8 X = 0;
+	int8 Y = 0;
+
+	// 次のページへ進むとき：ピースを置いてラインを消す / せり上がる / 左右反転する
+	bool bLock = true;
+	bool bRise = false;
+	bool bMirror = false;
+
+	// コメント（前のページから変わらなければ同じ文字列）
+	FString Comment;
+
+	// 上から Height 行の盤面（Rows[0] が一番上。ATetrisBoard / FTetrisSimBoard と同じ並び）との変換
+	// 相手に収まらない行にブロックがあれば false（収まる行は書き込む）
+	bool ToPackedRows(uint64* OutRows, int32 Height) const;
+	bool FromPackedRows(const uint64* InRows, int32 Height);
+};
+
+namespace TetrisFumen
+{
+	// "v115@..."（URL ごとでもよい。途中の '?' は無視する）を読む。形式が違う・途中で壊れていれば false
+	CLAUDETEST_API bool Decode(const TCHAR* Data, TArray<FTetrisFumenPage>& OutPages);
+
+	// 1ページ目の盤面だけ読む（ページの配列を作らない）
+	CLAUDETEST_API bool DecodeFirstPage(const TCHAR* Data, FTetrisFumenPage& OutPage);
+
+	// "v115@..." を書く（47 文字ごとの '?' の区切りも fumen と同じ）
+	CLAUDETEST_API bool Encode(TArrayView<const FTetrisFumenPage> Pages, FString& OutData);
+}
@@ -3,10 +3,25 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "TetrisTypes.h"
+#include "TetrisSnapshot.h"
+#include "TetrisRandomizer.h"
+#include "TetrisFinesse.h"
 #include "TetrisGameMode.generated.h"
 
 class ATetrisBoard;
 class ATetrisPiece;
+class FTetrisSimulationThread;
+class FTetrisDatasetExporter;
+struct FTetrisSimFrame;
+
+// ゲームモード関連のデリゲート（1フレーム分の変更をまとめて1回だけ通知）
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameStateChanged, ETetrisGameState, NewState);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnScoreChanged, int32, NewScore);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLevelChanged, int32, NewLevel);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLinesChanged, int32, NewLines);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLinesCleared, int32, LinesCount);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNextPieceChanged, EPieceType, NextPiece);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnFinesseFault, EPieceType, PieceType, int32, KeysUsed, int32, KeysMinimal);
 
 UCLASS(BlueprintType, Blueprintable)
 class CLAUDETEST_API ATetrisGameMode : public AGameModeBase
@@ -15,10 +30,11 @@ class CLAUDETEST_API ATetrisGameMode : public AGameModeBase
 
 public:
 	ATetrisGameMode();
+	virtual ~ATetrisGameMode() override;
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// ゲーム状態
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game State")
@@ -57,6 +73,67 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings")
 	int32 MaxLevel;
 
+	// 得点・落下速度・Wall Kick のルールセット（ピース生成方式は bOverrideRandomizerType でなければ FTetrisRuleset::GetDefaultRandomizer）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings")
+	ETetrisRuleset Ruleset;
+
+	// ライン消去演出の時間（前半フラッシュ、後半落下）。0 で即時消去
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings")
+	float LineClearDelay;
+
+	// ライン消去演出中の行と経過時間
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game State")
+	TArray<int32> PendingClearLines;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Game State")
+	float LineClearTimer;
+
+	// ピース生成の乱数シード（0 の場合は新規ゲームごとにランダム）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings")
+	int32 RandomSeed;
+
+	// ピース生成方式（bOverrideRandomizerType の時だけ使い、それ以外はルールセットの既定）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings", meta = (InlineEditConditionToggle))
+	bool bOverrideRandomizerType;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings", meta = (EditCondition = "bOverrideRandomizerType"))
+	ETetrisRandomizerType RandomizerType;
+
+	// 先読みするネクストの数（1-8）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 PreviewCount;
+
+	// 練習モード：ピースごとにスナップショットを保持してアンドゥ可能にする
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Practice")
+	bool bEnableUndo;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Practice")
+	int32 MaxUndoSnapshots;
+
+	// 練習モード：パーフェクトクリアの手順をヒントとして出す（PC の表は BeginPlay でメモリマップする）。Modern ルールセットの時だけ
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Practice")
+	bool bEnablePerfectClearHints;
+
+	// 練習モード：ピースごとに押したキー数を最少のキー数と比べる（フィネス）。Modern ルールセットの時だけ。ワーカースレッド実行中は判定しない
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Practice")
+	bool bEnableFinesseAnalysis;
+
+	// シミュレーションをワーカースレッドで固定レート実行する（ボード・ピースは公開された状態の表示だけ行う）
+	// ライン消去演出とアンドゥ/スナップショット復元は使えない
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings")
+	bool bRunSimulationOnWorkerThread;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Settings", meta = (ClampMin = "60", ClampMax = "10000", EditCondition = "bRunSimulationOnWorkerThread"))
+	int32 SimulationStepsPerSecond;
+
+	// 学習用データセット：ピースを固定するたびに (状態, 行動, 報酬) を書き出す（ゲームごとに1ファイル）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dataset")
+	bool bExportDataset;
+
+	// 出力先（空なら Saved/TetrisDataset）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dataset", meta = (EditCondition = "bExportDataset"))
+	FString DatasetDirectory;
+
 public:
 	// ゲーム制御
 	UFUNCTION(BlueprintCallable, Category = "Game Control")
@@ -120,6 +197,60 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Game State")
 	EPieceType GetNextPieceType() const { return NextPieceType; }
 
+	// ネクストを先頭から最大 MaxCount 個取得（ボットは最大6個まで参照）
+	UFUNCTION(BlueprintCallable, Category = "Game State")
+	TArray<EPieceType> GetPreviewPieces(int32 MaxCount = 6) const;
+
+	// 現在のゲームのシード（同じ方式とシードでキューを再構築できる）
+	UFUNCTION(BlueprintCallable, Category = "Game State")
+	int32 GetPieceSeed() const { return PieceQueue.InitialSeed; }
+
+	// 今の盤面・ピース・ネクストでパーフェクトクリアできるなら、操作中のピースを置くセルと残りのピース数を返す（1フレーム内で返る）
+	UFUNCTION(BlueprintCallable, Category = "Practice")
+	bool GetPerfectClearHint(TArray<FTetrisCoordinate>& OutCells, int32& OutPiecesToClear) const;
+
+	// フィネス：判定したピース数・フィネスミスの数・余分に押したキーの合計
+	UFUNCTION(BlueprintCallable, Category = "Practice")
+	int32 GetFinessePiecesJudged() const { return FinesseTracker.GetPiecesJudged(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Practice")
+	int32 GetFinesseFaults() const { return FinesseTracker.GetFaults(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Practice")
+	int32 GetFinesseExtraKeys() const { return FinesseTracker.GetExtraKeys(); }
+
+	const FTetrisPieceQueue& GetPieceQueue() const { return PieceQueue; }
+
+	// 1フレーム分のシミュレーション（UTetrisWorldSubsystem から呼ばれる）
+	void TickSimulation(float DeltaTime);
+
+	// このフレームの変更をイベントとして通知（シミュレーションの後に呼ばれる）
+	void FlushEvents();
+
+	// UI・観戦者向けイベント（値が変わったフレームにだけ発火）
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnGameStateChanged OnGameStateChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnScoreChanged OnScoreChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnLevelChanged OnLevelChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnLinesChanged OnLinesChanged;
+
+	// 同じフレームで複数回消去した場合は合計行数で1回
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnLinesCleared OnLinesCleared;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnNextPieceChanged OnNextPieceChanged;
+
+	// フィネスミスしたピースごと（bEnableFinesseAnalysis の時だけ）
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnFinesseFault OnFinesseFault;
+
 	// 入力処理（PlayerControllerから呼び出される）
 	UFUNCTION(BlueprintCallable, Category = "Input")
 	void HandleMoveLeft();
@@ -136,9 +267,43 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Input")
 	void HandleHardDrop();
 
+	// ARR 0：壁・障害物まで一度に移動
+	UFUNCTION(BlueprintCallable, Category = "Input")
+	void HandleShift(EMoveDirection Direction);
+
+	// 床まで一度に落とす（固定しない）
+	UFUNCTION(BlueprintCallable, Category = "Input")
+	void HandleSoftDropToFloor();
+
 	UFUNCTION(BlueprintCallable, Category = "Input")
 	void HandlePause();
 
+	// 入力コマンドを対応するハンドラへ振り分け（クライアントのサーバーRPCからも使用）
+	UFUNCTION(BlueprintCallable, Category = "Input")
+	void HandleInputCommand(ETetrisInputCommand Command);
+
+	// プレイヤーがキーを押した（キーリピートは除く）。HandleInputCommand より前に呼ぶ
+	void NotifyKeyPress(ETetrisInputCommand Command);
+
+	// ボード・操作中ピース・キューを合わせた Zobrist ハッシュ
+	// ボトの置換表キー、リプレイとの同期ずれ検出、局面の重複除去に使う
+	uint64 GetStateHash() const;
+
+	// スナップショット（セーブ/レジューム）
+	void CaptureSnapshot(FTetrisGameSnapshot& OutSnapshot) const;
+	bool RestoreSnapshot(const FTetrisGameSnapshot& Snapshot);
+
+	// ゲームスレッドで状態を取得し、シリアライズとファイル書き込みはワーカースレッドで行う
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	void SaveSnapshotAsync(const FString& SlotName);
+
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	bool LoadSnapshot(const FString& SlotName);
+
+	// 練習モード：直前のピース開始時点に戻す
+	UFUNCTION(BlueprintCallable, Category = "Practice")
+	bool UndoLastPiece();
+
 	// デバッグ関数
 	UFUNCTION(BlueprintCallable, Category = "Debug")
 	void DebugAddScore(int32 Points);
@@ -154,22 +319,54 @@ private:
 	void InitializeGame();
 	void SetupBoard();
 	void HandleAutoFall(float DeltaTime);
+	void UpdateLineClear(float DeltaTime);
+	void FinishLineClear();
 	bool IsGameOverConditionMet();
 	void CleanupCurrentPiece();
 
-	// バッグシステム（テトリス標準のピース生成方式）
-	TArray<EPieceType> PieceBag;
-	int32 BagIndex;
-	void InitializePieceBag();
-	EPieceType GetNextPieceFromBag();
-
-	// ゲーム統計更新
-	void UpdateGameStats();
-};
-
-// ゲームモード関連のデリゲート
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameStateChanged, ETetrisGameState, NewState);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnScoreChanged, int32, NewScore);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLevelChanged, int32, NewLevel);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLinesChanged, int32, NewLines);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNextPieceChanged, EPieceType, NextPiece);
\ No newline at end of file
+	// ネクストキュー（方式ごとのシード付きランダマイザーで先読み生成）
+	FTetrisPieceQueue PieceQueue;
+	void ResetPieceQueue();
+
+	// 実際に使うピース生成方式（上書きしていなければルールセットの既定）
+	ETetrisRandomizerType GetEffectiveRandomizerType() const;
+
+	// キュー部分のハッシュ（キュー変更時に更新）
+	uint64 QueueHash;
+	void RefreshQueueHash();
+
+	// アンドゥ用スナップショットのリングバッファ
+	TArray<FTetrisGameSnapshot> UndoSnapshots;
+	int32 UndoHead;
+	int32 UndoCount;
+	void PushUndoSnapshot();
+	static FString GetSnapshotFilePath(const FString& SlotName);
+
+	// ワーカースレッドのシミュレーション（ゲーム中のみ）
+	TUniquePtr<FTetrisSimulationThread> SimulationThread;
+	bool StartSimulationThread();
+	void StopSimulationThread();
+	void ApplySimulationFrame(const FTetrisSimFrame& Frame);
+	bool ForwardInputToSimulationThread(ETetrisInputCommand Command);
+
+	// 反映済みのフレームまでにワーカースレッドが適用した入力の数
+	uint32 SimulationInputsApplied = 0;
+
+	// データセットの書き出し（ゲーム中のみ。シミュレーションスレッドより先に開き、後に閉じる）
+	TUniquePtr<FTetrisDatasetExporter> DatasetExporter;
+	void OpenDatasetExporter();
+	void CloseDatasetExporter();
+
+	// PC の表・探索とフィネスの表は Modern の Wall Kick（TetrisMoveGen）で作るので、他のルールセットでは使わない
+	bool UsesModernKicks() const { return Ruleset == ETetrisRuleset::Modern; }
+
+	// フィネスの判定（ゲームスレッドで進める時だけ）
+	FTetrisFinesseTracker FinesseTracker;
+	TArray<FTetrisFinesseResult> PendingFinesseFaults;
+
+	// 最後に通知した値（FlushEvents で現在値と比較して差分だけ通知）
+	ETetrisGameState PublishedGameState;
+	FTetrisGameStats PublishedStats;
+	EPieceType PublishedNextPieceType;
+	int32 PendingLinesClearedEvent;
+};
\ No newline at end of file
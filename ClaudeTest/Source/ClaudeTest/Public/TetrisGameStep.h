@@ -0,0 +1,252 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSimulation.h"
+#include "TetrisPieceTables.h"
+#include "TetrisRules.h"
+#include "TetrisDatasetExporter.h"
+
+// 1ゲームを進める手順（FTetrisSimGame と FTetrisArena で共有する）
+// 盤面の行とキューはそれぞれの置き場所（FTetrisSimBoard の配列 / アリーナの列）を指し、それ以外の状態は FTetrisGameState に持つ
+struct FTetrisGameStepContext
+{
+	const FTetrisSimConfig& Config;
+
+	// Height 行の盤面（TetrisBoardRows 形式）
+	uint16* Rows;
+	uint64* PackedRows;
+	int32 Width;
+	int32 Height;
+	uint16 FullRowMask;
+
+	FTetrisPieceQueue& Queue;
+
+	// ピースを固定するたびに判断点を書き出す先（無ければ nullptr）
+	FTetrisDatasetExporter* Exporter;
+};
+
+// RulesType は TetrisRuleset のルール（得点・落下速度・Wall Kick）。呼び出し側が TetrisRuleset::Visit で1回だけ選ぶ
+namespace TetrisGameStep
+{
+	inline bool CanPlace(const FTetrisGameStepContext& Context, const FTetrisGameState& State, int32 Rotation, int32 X, int32 Y)
+	{
+		return TetrisBoardRows::CanPlace(Context.Rows, Context.Height, Context.FullRowMask, State.ActivePiece, Rotation, X, Y);
+	}
+
+	inline void SpawnPiece(const FTetrisGameStepContext& Context, FTetrisGameState& State)
+	{
+		State.ActivePiece = Context.Queue.Pop();
+		State.ActiveRotation = 0;
+		State.ActiveX = TetrisRules::SPAWN_X;
+		State.ActiveY = TetrisRules::SPAWN_Y;
+
+		// ゲームオーバー判定（ATetrisGameMode::IsGameOverConditionMet と同じ）
+		if (Context.Rows[0] != 0 || !CanPlace(Context, State, State.ActiveRotation, State.ActiveX, State.ActiveY))
+		{
+			State.ActivePiece = EPieceType::None;
+			State.bGameOver = true;
+			return;
+		}
+
+		State.Stats.PiecesPlaced++;
+	}
+
+	inline bool TryMove(const FTetrisGameStepContext& Context, FTetrisGameState& State, int32 DeltaX, int32 DeltaY)
+	{
+		if (!CanPlace(Context, State, State.ActiveRotation, State.ActiveX + DeltaX, State.ActiveY + DeltaY))
+		{
+			return false;
+		}
+
+		State.ActiveX += DeltaX;
+		State.ActiveY += DeltaY;
+		return true;
+	}
+
+	template<typename RulesType>
+	bool TryRotate(const FTetrisGameStepContext& Context, FTetrisGameState& State)
+	{
+		// 時計回りのみ。その場で回せなければ Wall Kick を順に試す
+		const int32 NewRotation = (State.ActiveRotation + 1) % TetrisPieceTables::NUM_ROTATIONS;
+		if (CanPlace(Context, State, NewRotation, State.ActiveX, State.ActiveY))
+		{
+			State.ActiveRotation = NewRotation;
+			return true;
+		}
+
+		for (const TetrisRules::FKickOffset& Kick : RulesType::GetWallKickOffsets(State.ActivePiece))
+		{
+			if (CanPlace(Context, State, NewRotation, State.ActiveX + Kick.X, State.ActiveY + Kick.Y))
+			{
+				State.ActiveRotation = NewRotation;
+				State.ActiveX += Kick.X;
+				State.ActiveY += Kick.Y;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename RulesType>
+	void LockPiece(const FTetrisGameStepContext& Context, FTetrisGameState& State)
+	{
+		// 判断点：固定前の盤面・ネクストと固定位置は先に取り、消去の結果と合わせて書き出す
+		FTetrisDecisionRecord Record;
+		const int32 ScoreBefore = State.Stats.Score;
+		if (Context.Exporter)
+		{
+			Record.GameId = static_cast<uint32>(Context.Config.Seed);
+			Record.PieceIndex = static_cast<uint32>(State.Stats.PiecesPlaced - 1);
+			FMemory::Memcpy(Record.BoardRows, Context.Rows, FMath::Min(Context.Height, FTetrisDecisionRecord::MAX_HEIGHT) * sizeof(uint16));
+			Record.Piece = State.ActivePiece;
+			for (int32 Slot = 0; Slot < Context.Queue.GetPreviewCount(); Slot++)
+			{
+				Record.Queue[Slot] = Context.Queue.Peek(Slot);
+			}
+			Record.Rotation = static_cast<uint8>(State.ActiveRotation);
+			Record.X = static_cast<int8>(State.ActiveX);
+			Record.Y = static_cast<int8>(State.ActiveY);
+		}
+
+		TetrisBoardRows::Place(Context.Rows, Context.PackedRows, Context.Width, Context.Height,
+			State.ActivePiece, State.ActiveRotation, State.ActiveX, State.ActiveY);
+		State.ActivePiece = EPieceType::None;
+
+		const int32 LinesCleared = TetrisBoardRows::ClearFullRows(Context.Rows, Context.PackedRows, Context.Height, Context.FullRowMask);
+		if (LinesCleared > 0)
+		{
+			// 得点は消去前のレベルで計算してからレベルを上げる
+			State.Stats.Score += RulesType::GetLineClearScore(LinesCleared, State.Stats.Level);
+			State.Stats.LinesCleared += LinesCleared;
+			State.Stats.Level = FMath::Max(State.Stats.Level, TetrisRules::GetLevelForLines(State.Stats.LinesCleared, Context.Config.MaxLevel));
+		}
+
+		if (Context.Exporter)
+		{
+			Record.LinesCleared = static_cast<uint8>(LinesCleared);
+			Record.Reward = State.Stats.Score - ScoreBefore;
+			Context.Exporter->Add(Record);
+		}
+
+		if (LinesCleared > 0 && Context.Config.LineClearDelayMicroseconds > 0)
+		{
+			State.bLineClearPending = true;
+			State.LineClearTimerMicroseconds = 0;
+			return;
+		}
+
+		SpawnPiece(Context, State);
+	}
+
+	// 入力を1つ適用（移動・回転できたら true）。Pause/Restart は無視する
+	template<typename RulesType>
+	bool ApplyInput(const FTetrisGameStepContext& Context, FTetrisGameState& State, ETetrisInputCommand Command)
+	{
+		if (State.bGameOver || State.ActivePiece == EPieceType::None)
+		{
+			return false;
+		}
+
+		switch (Command)
+		{
+		case ETetrisInputCommand::MoveLeft:
+			return TryMove(Context, State, -1, 0);
+
+		case ETetrisInputCommand::MoveRight:
+			return TryMove(Context, State, 1, 0);
+
+		case ETetrisInputCommand::MoveDown:
+			if (TryMove(Context, State, 0, 1))
+			{
+				State.Stats.Score += RulesType::SOFT_DROP_SCORE;
+				return true;
+			}
+			// 接地していれば固定
+			LockPiece<RulesType>(Context, State);
+			return false;
+
+		case ETetrisInputCommand::Rotate:
+			return TryRotate<RulesType>(Context, State);
+
+		case ETetrisInputCommand::HardDrop:
+		{
+			const int32 DropY = TetrisBoardRows::GetDropY(Context.Rows, Context.Height, Context.FullRowMask,
+				State.ActivePiece, State.ActiveRotation, State.ActiveX, State.ActiveY);
+			State.Stats.Score += (DropY - State.ActiveY) * RulesType::HARD_DROP_SCORE_PER_ROW;
+			State.ActiveY = DropY;
+			LockPiece<RulesType>(Context, State);
+			return true;
+		}
+
+		case ETetrisInputCommand::ShiftLeft:
+		case ETetrisInputCommand::ShiftRight:
+		{
+			const int32 ShiftX = TetrisBoardRows::GetShiftX(Context.Rows, Context.Height, Context.FullRowMask,
+				State.ActivePiece, State.ActiveRotation, State.ActiveX, State.ActiveY, Command == ETetrisInputCommand::ShiftLeft ? -1 : 1);
+			const bool bMoved = ShiftX != State.ActiveX;
+			State.ActiveX = ShiftX;
+			return bMoved;
+		}
+
+		case ETetrisInputCommand::SoftDropToFloor:
+		{
+			// 接地しても固定しない（固定は自然落下かハードドロップ）
+			const int32 DropY = TetrisBoardRows::GetDropY(Context.Rows, Context.Height, Context.FullRowMask,
+				State.ActivePiece, State.ActiveRotation, State.ActiveX, State.ActiveY);
+			State.Stats.Score += (DropY - State.ActiveY) * RulesType::SOFT_DROP_SCORE;
+			const bool bMoved = DropY != State.ActiveY;
+			State.ActiveY = DropY;
+			return bMoved;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	// 時間を進める（自然落下・ライン消去の待ち時間）
+	template<typename RulesType>
+	void Advance(const FTetrisGameStepContext& Context, FTetrisGameState& State, int64 DeltaMicroseconds)
+	{
+		// 次のイベント（落下・消去待ちの終了）までずつ進める
+		while (DeltaMicroseconds > 0 && !State.bGameOver)
+		{
+			if (State.bLineClearPending)
+			{
+				const int64 Step = FMath::Min(DeltaMicroseconds, Context.Config.LineClearDelayMicroseconds - State.LineClearTimerMicroseconds);
+				State.LineClearTimerMicroseconds += Step;
+				State.ElapsedMicroseconds += Step;
+				DeltaMicroseconds -= Step;
+
+				if (State.LineClearTimerMicroseconds >= Context.Config.LineClearDelayMicroseconds)
+				{
+					State.bLineClearPending = false;
+					State.LineClearTimerMicroseconds = 0;
+					SpawnPiece(Context, State);
+				}
+				continue;
+			}
+
+			if (State.ActivePiece == EPieceType::None)
+			{
+				State.ElapsedMicroseconds += DeltaMicroseconds;
+				return;
+			}
+
+			const int64 FallInterval = RulesType::GetFallIntervalMicroseconds(Context.Config.BaseFallMicroseconds, State.Stats.Level);
+			const int64 Step = FMath::Min(DeltaMicroseconds, FMath::Max<int64>(FallInterval - State.FallTimerMicroseconds, 0));
+			State.FallTimerMicroseconds += Step;
+			State.ElapsedMicroseconds += Step;
+			DeltaMicroseconds -= Step;
+
+			if (State.FallTimerMicroseconds >= FallInterval)
+			{
+				State.FallTimerMicroseconds = 0;
+				if (!TryMove(Context, State, 0, 1))
+				{
+					LockPiece<RulesType>(Context, State);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 入力から画面に出るまでの遅延の段階（入力を読み込んだフレームの開始からの経過時間）
+enum class ETetrisLatencyStage : uint8
+{
+	Dispatch,	// Enhanced Input のハンドラー（OnMoveLeft など）に届いた
+	Handled,	// ゲームモードが処理した（ワーカースレッド実行中は、その入力を適用したフレームを反映した時点）
+	Display,	// 結果がピース/ボードのインスタンスに反映された（UpdatePieceDisplay / UpdateBoardDisplay）
+	Render,		// そのフレームの描画コマンドを描画スレッドが処理し終えた
+	Num
+};
+
+// 0.1 ms 刻みのヒストグラム（上限を超えた値は最後のバケットに入る）
+struct CLAUDETEST_API FTetrisLatencyHistogram
+{
+	static constexpr double BUCKET_SECONDS = 0.0001;
+	static constexpr int32 NUM_BUCKETS = 2000;
+
+	uint32 Buckets[NUM_BUCKETS] = {};
+	int64 Count = 0;
+	double MaxSeconds = 0.0;
+
+	void Add(double Seconds);
+	void Reset();
+
+	// Percentile（0〜1）以下に収まる最小のバケットの上端（秒）。空なら 0
+	double GetPercentile(double Percentile) const;
+};
+
+// 入力遅延の計測（描画スレッドの段階以外はゲームスレッド専用）
+//
+// ハンドラーで入力に時刻を付け、ゲームモード → 表示 → 描画スレッドの各段階を通過した時点の経過時間を集計する。
+// 表示が変わらなかった入力（壁に当たった移動など）はそのフレームの終わりで捨てる。
+// クライアントからサーバーへ送った入力は、クライアント側では Dispatch までしか計れない
+namespace TetrisLatency
+{
+	// フレームの開始・終了の通知を登録する（何度呼んでもよい）
+	CLAUDETEST_API void Initialize();
+
+	// 入力ハンドラーの入口で呼ぶ
+	CLAUDETEST_API void StampInput();
+
+	// ゲームモードが入力を処理し終えた
+	CLAUDETEST_API void MarkHandled();
+
+	// 入力をワーカースレッドへ渡した（スタンプの無いキーリピート入力でも呼ぶ）
+	CLAUDETEST_API void DeferToSimulation();
+
+	// ワーカースレッドが新たに NumApplied 個の入力を適用したフレームを反映する直前に呼ぶ
+	CLAUDETEST_API void MarkSimulationApplied(int32 NumApplied);
+
+	// ワーカースレッドを止めたので待っている入力を捨てる
+	CLAUDETEST_API void DiscardDeferred();
+
+	// ピースやボードのインスタンスを変えた
+	CLAUDETEST_API void MarkDisplayUpdated();
+
+	// フレームの終わり：表示まで届いた入力の描画スレッドでの計測を積む（通常は FCoreDelegates::OnEndFrame から）
+	CLAUDETEST_API void EndFrame();
+
+	CLAUDETEST_API FTetrisLatencyHistogram GetHistogram(ETetrisLatencyStage Stage);
+	CLAUDETEST_API void Reset();
+
+	// 段階ごとの件数・p50/p95/p99・最大（ミリ秒）
+	CLAUDETEST_API bool WriteCsv(const FString& Path);
+	CLAUDETEST_API void DumpToLog();
+}
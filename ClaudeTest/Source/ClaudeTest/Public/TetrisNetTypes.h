@@ -0,0 +1,133 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "TetrisTypes.h"
+#include "TetrisNetTypes.generated.h"
+
+class ATetrisBoard;
+class UNetConnection;
+class UPackageMap;
+
+// ボード1行分のレプリケーションアイテム
+// 占有マスク + 占有セルごとに3bitの種類だけを送る
+USTRUCT()
+struct FTetrisBoardRowItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 RowIndex = INDEX_NONE;
+
+	// TetrisCellPacking 形式の行データ
+	UPROPERTY()
+	uint64 PackedCells = 0;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FTetrisBoardRowItem> : public TStructOpsTypeTraitsBase2<FTetrisBoardRowItem>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// ボード全体の行配列（変更された行だけがデルタ送信される）
+USTRUCT()
+struct FTetrisBoardRowArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTetrisBoardRowItem> Items;
+
+	// 所有ボード（受信通知用）
+	UPROPERTY(NotReplicated)
+	ATetrisBoard* OwnerBoard = nullptr;
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FTetrisBoardRowArray> : public TStructOpsTypeTraitsBase2<FTetrisBoardRowArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+// レプリケーション用の圧縮ピース状態（22bit）
+USTRUCT()
+struct FTetrisNetPieceState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EPieceType PieceType = EPieceType::None;
+
+	UPROPERTY()
+	uint8 Rotation = 0;
+
+	UPROPERTY()
+	int8 X = 0;
+
+	UPROPERTY()
+	int8 Y = 0;
+
+	UPROPERTY()
+	bool bFixed = false;
+
+	static constexpr int32 SERIALIZED_BITS = 3 + 2 + 8 + 8 + 1;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FTetrisNetPieceState& Other) const
+	{
+		return PieceType == Other.PieceType && Rotation == Other.Rotation
+			&& X == Other.X && Y == Other.Y && bFixed == Other.bFixed;
+	}
+
+	bool operator!=(const FTetrisNetPieceState& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTetrisNetPieceState> : public TStructOpsTypeTraitsBase2<FTetrisNetPieceState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+// クライアントごとの送信量カウンタ
+struct FTetrisNetBandwidthStats
+{
+	int64 BoardBits = 0;
+	int64 PieceBits = 0;
+	int32 BoardUpdates = 0;
+	int32 PieceUpdates = 0;
+	double FirstSendTime = 0.0;
+
+	int64 GetTotalBytes() const { return (BoardBits + PieceBits + 7) / 8; }
+};
+
+// レプリケーション送信量の集計（ゲームスレッド専用）
+namespace TetrisNetStats
+{
+	CLAUDETEST_API UNetConnection* GetConnectionFromMap(UPackageMap* Map);
+	CLAUDETEST_API void RecordBoardBits(UNetConnection* Connection, int64 NumBits);
+	CLAUDETEST_API void RecordPieceBits(UNetConnection* Connection, int64 NumBits);
+	CLAUDETEST_API FTetrisNetBandwidthStats GetStats(const UNetConnection* Connection);
+	CLAUDETEST_API void DumpToLog();
+	CLAUDETEST_API void Reset();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSimulation.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// パーフェクトクリア（PC）の探索設定
+struct FTetrisPerfectClearSettings
+{
+	// 何ラインまでの PC を探すか（1〜4）。盤面がこれより高ければ探さない
+	int32 MaxHeight = 4;
+
+	// 表にない時の探索の時間予算（秒）。0 以下なら読み切る
+	double TimeBudgetSeconds = 0.004;
+};
+
+// 探索結果
+struct FTetrisPerfectClearResult
+{
+	// 操作中のピースから順の固定位置（最後の1つで盤面が空になる）
+	TArray<FTetrisSimPlacement> Placements;
+
+	// 最初の固定位置までの入力列（最後はハードドロップ）
+	TArray<ETetrisInputCommand> Inputs;
+
+	// 何ラインの PC か
+	int32 Height = 0;
+
+	// 表から引けた（false なら探索で見つけた）
+	bool bFromTable = false;
+
+	// 時間切れで探索を打ち切った
+	bool bTimedOut = false;
+
+	int32 NodesSearched = 0;
+};
+
+// オフラインで作った PC の表（.tpct）
+//
+// キー = 下から Height 行の占有ビット + 必要な数のピース列 + Height、値 = 最初の1手。
+// 解の途中の状態も全て入っているので、1手置くごとに引き直せば最後まで表だけで進める
+// ファイルはメモリマップしてそのまま二分探索する
+class CLAUDETEST_API FTetrisPerfectClearTable
+{
+public:
+	FTetrisPerfectClearTable();
+	~FTetrisPerfectClearTable();
+
+	FTetrisPerfectClearTable(const FTetrisPerfectClearTable&) = delete;
+	FTetrisPerfectClearTable& operator=(const FTetrisPerfectClearTable&) = delete;
+
+	// 既定の表（Content/Tetris/PerfectClear.tpct）。初回の呼び出しでメモリマップする
+	// 表はリポジトリに含めないので、コマンドレットで生成するまでは空のまま（ヒントは探索だけで返す）
+	// マップできない置き場所（pak の中など）なら読み込んで使う
+	static const FTetrisPerfectClearTable& GetShared();
+	static FString GetDefaultPath();
+
+	bool Map(const FString& Path);
+	bool FromBytes(TArray<uint8>&& InBytes);
+	void Reset();
+
+	bool IsLoaded() const { return NumEntries > 0; }
+	int32 GetWidth() const { return Width; }
+	int64 GetNumEntries() const { return NumEntries; }
+
+	// 盤面 Board の下 Height 行を Pieces（必要な数だけ）で消す最初の1手
+	bool Find(const FTetrisSimBoard& Board, int32 Height, TArrayView<const EPieceType> Pieces, FTetrisSimPlacement& OutPlacement) const;
+
+private:
+	bool Bind(const uint8* Data, int64 Size);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> OwnedBytes;
+
+	const uint64* Keys = nullptr;
+	const uint16* Moves = nullptr;
+	int64 NumEntries = 0;
+	int32 Width = 0;
+};
+
+// PC の手順を探す（練習モードのヒント用、1フレーム内で返る）
+// 表に状態があれば表を1手ずつたどり、無い時や表の手が置けない時は深さ優先で探す
+// ピースはネクストの順に使う（ホールドはゲーム側にないので扱わない）
+class CLAUDETEST_API FTetrisPerfectClearSolver
+{
+public:
+	explicit FTetrisPerfectClearSolver(const FTetrisPerfectClearSettings& InSettings = FTetrisPerfectClearSettings(),
+		const FTetrisPerfectClearTable* InTable = nullptr);
+
+	const FTetrisPerfectClearSettings& GetSettings() const { return Settings; }
+	void SetSettings(const FTetrisPerfectClearSettings& InSettings) { Settings = InSettings; }
+	void SetTable(const FTetrisPerfectClearTable* InTable) { Table = InTable; }
+
+	// 操作中のピース（今の位置から）+ ネクストで PC を探す
+	bool Solve(const FTetrisSimGame& Game, FTetrisPerfectClearResult& OutResult) const;
+
+	// Pieces[0] を (StartRotation, StartX, StartY) から、以降を出現位置から置く
+	bool Solve(const FTetrisSimBoard& Board, TArrayView<const EPieceType> Pieces, int32 StartRotation, int32 StartX, int32 StartY,
+		FTetrisPerfectClearResult& OutResult) const;
+
+private:
+	bool SolveFromTable(const FTetrisSimBoard& Board, int32 Height, TArrayView<const EPieceType> Pieces,
+		int32 StartRotation, int32 StartX, int32 StartY, TArray<FTetrisSimPlacement>& OutPlacements) const;
+
+	FTetrisPerfectClearSettings Settings;
+	const FTetrisPerfectClearTable* Table = nullptr;
+};
+
+namespace TetrisPerfectClear
+{
+	// 空の盤面から Height ライン PC になる全てのピース列を解いて表を作る（オフライン生成用）
+	// 必要なピース数が表のキーに収まらない高さ（幅 10 なら 4 ライン）は作れない。書いた項目数を返す
+	CLAUDETEST_API int64 BuildTable(int32 Width, int32 Height, TArray<uint8>& OutBytes, int32 MaxThreads = 0);
+}
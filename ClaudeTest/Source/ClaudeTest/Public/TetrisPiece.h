@@ -3,7 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "TetrisTypes.h"
-#include "Components/InstancedStaticMeshComponent.h"
+#include "TetrisNetTypes.h"
 #include "TetrisPiece.generated.h"
 
 UCLASS(BlueprintType, Blueprintable)
@@ -16,6 +16,8 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	// 現在のピースタイプ
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Piece")
@@ -37,21 +39,26 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Piece")
 	FLinearColor PieceColor;
 
-	// ブロック表示用メッシュコンポーネント
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rendering")
-	UInstancedStaticMeshComponent* BlockMeshComponent;
-
 	// ピースが固定されているか
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Piece")
 	bool bIsFixed;
 
+	// Wall Kick に使うルールセット
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Piece")
+	ETetrisRuleset Ruleset;
+
 	// 参照するボード
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Piece")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_NetPieceState, Category = "Piece")
 	class ATetrisBoard* TetrisBoard;
 
-public:	
-	virtual void Tick(float DeltaTime) override;
+	// レプリケーション用の圧縮ピース状態
+	UPROPERTY(ReplicatedUsing = OnRep_NetPieceState)
+	FTetrisNetPieceState NetPieceState;
 
+	UFUNCTION()
+	void OnRep_NetPieceState();
+
+public:	
 	// ピース初期化
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	void InitializePiece(EPieceType PieceType, ATetrisBoard* Board);
@@ -67,6 +74,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	bool RotatePiece(bool bClockwise = true);
 
+	// 壁・障害物まで一度に移動（ARR 0）。着地位置を1回問い合わせて表示は1回だけ更新する。動いた列数を返す
+	UFUNCTION(BlueprintCallable, Category = "Piece")
+	int32 ShiftToWall(EMoveDirection Direction);
+
+	// 床まで一度に落とすが固定はしない（床までのソフトドロップ）。落ちた行数を返す
+	UFUNCTION(BlueprintCallable, Category = "Piece")
+	int32 SoftDropToFloor();
+
 	// ハードドロップ
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	int32 HardDrop();
@@ -87,6 +102,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	bool CanRotateTo(int32 NewRotation) const;
 
+	// Wall Kick のルールセット（InitializePiece の前に設定する。既定は Modern）
+	void SetRuleset(ETetrisRuleset InRuleset) { Ruleset = InRuleset; }
+
 	// Getter関数
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	EPieceType GetPieceType() const { return CurrentPieceType; }
@@ -103,7 +121,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Piece")
 	bool IsFixed() const { return bIsFixed; }
 
-	// 表示更新
+	// 種類・回転・位置の Zobrist キー（固定済みなら 0）
+	uint64 GetStateHash() const;
+
+	// 表示更新（ボードの予約済みインスタンスに書き込む）
 	UFUNCTION(BlueprintCallable, Category = "Rendering")
 	void UpdatePieceDisplay();
 
@@ -111,21 +132,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Debug")
 	void DebugPrintPiece() const;
 
+	// ピース状態を直接設定（レプリケーション・状態復元用）
+	void SetPieceState(EPieceType PieceType, int32 Rotation, const FTetrisCoordinate& Position, bool bFixed = false);
+
 private:
 	// 内部ヘルパー関数
 	void InitializePieceData();
-	void CreateIPieceData();
-	void CreateOPieceData();
-	void CreateTPieceData();
-	void CreateSPieceData();
-	void CreateZPieceData();
-	void CreateJPieceData();
-	void CreateLPieceData();
 
 	TArray<FTetrisCoordinate> GetBlockPositionsForRotation(int32 Rotation) const;
-	FVector GetWorldPositionFromBoard(const FTetrisCoordinate& BoardPos) const;
 	void UpdateBlockDisplay();
 	bool IsValidPositionOnBoard(const TArray<FTetrisCoordinate>& BlockPositions) const;
+	void SyncNetPieceState();
+
+	// Step 方向へ置けるところまで一度に動かす（固定はしない）
+	int32 MoveUntilBlocked(const FTetrisCoordinate& Step);
 
 	// Wall Kick システム（回転時の位置調整）
 	bool TryWallKick(int32 FromRotation, int32 ToRotation);
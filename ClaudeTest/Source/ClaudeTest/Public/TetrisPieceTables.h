@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+// ピース形状とカラーの共有テーブル
+// 形状は 4x4 グリッドを16bitマスクで表す（bit = Y * 4 + X, Y=0 が上）
+namespace TetrisPieceTables
+{
+	const int32 NUM_ROTATIONS = 4;
+
+	// [EPieceType][Rotation]（None は空）
+	constexpr uint16 SHAPE_MASKS[8][NUM_ROTATIONS] =
+	{
+		{ 0x0000, 0x0000, 0x0000, 0x0000 }, // None
+		{ 0x00F0, 0x4444, 0x0F00, 0x2222 }, // I
+		{ 0x0066, 0x0066, 0x0066, 0x0066 }, // O
+		{ 0x0072, 0x0262, 0x0270, 0x0232 }, // T
+		{ 0x0036, 0x0462, 0x0036, 0x0462 }, // S
+		{ 0x0063, 0x0264, 0x0063, 0x0264 }, // Z
+		{ 0x0071, 0x0226, 0x0470, 0x0322 }, // J
+		{ 0x0074, 0x0622, 0x0170, 0x0223 }  // L
+	};
+
+	inline uint16 GetShapeMask(EPieceType PieceType, int32 Rotation)
+	{
+		const int32 TypeIndex = static_cast<int32>(PieceType);
+		if (TypeIndex < 0 || TypeIndex >= 8)
+		{
+			return 0;
+		}
+		return SHAPE_MASKS[TypeIndex][Rotation & (NUM_ROTATIONS - 1)];
+	}
+
+	inline bool IsShapeCellSet(uint16 ShapeMask, int32 X, int32 Y)
+	{
+		return (ShapeMask >> (Y * TetrisConstants::PIECE_SIZE + X)) & 1;
+	}
+
+	inline FLinearColor GetPieceColor(EPieceType PieceType)
+	{
+		switch (PieceType)
+		{
+		case EPieceType::I_Piece:
+			return TetrisPieceColors::I_COLOR;
+		case EPieceType::O_Piece:
+			return TetrisPieceColors::O_COLOR;
+		case EPieceType::T_Piece:
+			return TetrisPieceColors::T_COLOR;
+		case EPieceType::S_Piece:
+			return TetrisPieceColors::S_COLOR;
+		case EPieceType::Z_Piece:
+			return TetrisPieceColors::Z_COLOR;
+		case EPieceType::J_Piece:
+			return TetrisPieceColors::J_COLOR;
+		case EPieceType::L_Piece:
+			return TetrisPieceColors::L_COLOR;
+		default:
+			return FLinearColor::White;
+		}
+	}
+}
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h"
+#include "TetrisTypes.h"
 #include "TetrisPlayerController.generated.h"
 
 class UInputMappingContext;
@@ -19,6 +20,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void SetupInputComponent() override;
 
 	// Enhanced Input関連
@@ -54,9 +56,14 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Settings")
 	float RepeatDelay;
 
+	// 0 以下で ARR 0：RepeatDelay（DAS）が過ぎたら壁・障害物まで一度に動かす
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Settings")
 	float RepeatRate;
 
+	// 下キーを押している間、床まで一度に落とす（固定はしない）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Settings")
+	bool bInstantSoftDrop;
+
 	// リピート入力管理
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Input State")
 	bool bIsMovingLeft;
@@ -72,6 +79,15 @@ protected:
 	float RightMoveTimer;
 	float DownMoveTimer;
 
+	// 押してから送ったリピートの回数
+	int32 LeftRepeatCount;
+	int32 RightRepeatCount;
+
+	// 長押しの壁・床までの移動を最後に送った時の盤面とピースの番号（変わるまで送り直さない）
+	uint64 LeftShiftRevision;
+	uint64 RightShiftRevision;
+	uint64 DownShiftRevision;
+
 public:
 	// 入力処理関数
 	UFUNCTION(BlueprintCallable, Category = "Input")
@@ -121,13 +137,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Input Settings")
 	void SetRepeatRate(float NewRate) { RepeatRate = NewRate; }
 
+	UFUNCTION(BlueprintCallable, Category = "Input Settings")
+	void SetInstantSoftDrop(bool bEnabled) { bInstantSoftDrop = bEnabled; }
+
 	UFUNCTION(BlueprintCallable, Category = "Input Settings")
 	void EnableInput() { bInputEnabled = true; }
 
 	UFUNCTION(BlueprintCallable, Category = "Input Settings")
 	void DisableInput() { bInputEnabled = false; }
 
-	virtual void Tick(float DeltaTime) override;
+	// キーリピート処理（UTetrisWorldSubsystem の入力フェーズで呼ばれる）
+	void TickInput(float DeltaTime);
+
+	// クライアントからサーバーへ入力を送信
+	UFUNCTION(Server, Reliable)
+	void ServerSubmitInputCommand(ETetrisInputCommand Command);
 
 private:
 	// 内部状態
@@ -139,8 +163,22 @@ private:
 	void ProcessRightMovement(float DeltaTime);
 	void ProcessDownMovement(float DeltaTime);
 
+	// 左右のキーリピート（DAS の後、RepeatRate ごとに1列。ARR 0 なら壁まで）
+	void ProcessHorizontalRepeat(float& MoveTimer, int32& RepeatCount, uint64& ShiftRevision, float DeltaTime, ETetrisInputCommand MoveCommand, ETetrisInputCommand ShiftCommand);
+
+	// 盤面のセルと操作中のピースの番号。盤面が見えない（クライアント）なら NO_SHIFT_REVISION
+	uint64 GetShiftRevision() const;
+
+	// 長押しの壁・床までの移動（ShiftLeft/ShiftRight/SoftDropToFloor）を、前回送ってからピースか盤面が変わった時だけ送る
+	// 盤面が見えないクライアントでは HeldTimer が RepeatDelay を超えるごとに1回送る
+	void DispatchHeldShift(ETetrisInputCommand Command, uint64& ShiftRevision, float& HeldTimer);
+
 	// ゲームモード取得
 	void CacheGameModeReference();
+
+	// 入力をゲームモードへ（クライアントではサーバーへ）送る
+	// bKeyPress = キーを押した入力（キーリピートは false）。フィネスの判定で数える
+	void DispatchInputCommand(ETetrisInputCommand Command, bool bKeyPress = true);
 };
 
 // プレイヤーコントローラー関連のデリゲート
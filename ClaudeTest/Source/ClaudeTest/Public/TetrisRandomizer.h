@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "TetrisTypes.h"
+
+// ランダマイザーの状態（POD なのでスナップショットやロールバックでそのままコピーできる）
+struct FTetrisRandomizerState
+{
+	static constexpr int32 MAX_POOL = 14;
+	static constexpr int32 HISTORY_SIZE = 4;
+
+	// 専用の乱数ストリーム
+	FRandomStream RandomStream;
+
+	// バッグ方式の残りピース
+	EPieceType Pool[MAX_POOL] = {};
+	uint8 PoolCount = 0;
+	uint8 PoolIndex = 0;
+
+	// 履歴方式の直近ピース
+	EPieceType History[HISTORY_SIZE] = {};
+	bool bFirstPiece = true;
+};
+
+// ピース生成ポリシー：静的関数だけを持ち、コンパイル時にも選択できる
+struct CLAUDETEST_API FTetrisSevenBagPolicy
+{
+	static void Reset(FTetrisRandomizerState& State, int32 Seed);
+	static EPieceType Next(FTetrisRandomizerState& State);
+};
+
+struct CLAUDETEST_API FTetrisFourteenBagPolicy
+{
+	static void Reset(FTetrisRandomizerState& State, int32 Seed);
+	static EPieceType Next(FTetrisRandomizerState& State);
+};
+
+// TGM方式：直近4ピースの履歴と重複したら最大 ROLLS 回引き直す
+struct CLAUDETEST_API FTetrisTGMHistoryPolicy
+{
+	static constexpr int32 ROLLS = 6;
+
+	static void Reset(FTetrisRandomizerState& State, int32 Seed);
+	static EPieceType Next(FTetrisRandomizerState& State);
+};
+
+struct CLAUDETEST_API FTetrisPureRandomPolicy
+{
+	static void Reset(FTetrisRandomizerState& State, int32 Seed);
+	static EPieceType Next(FTetrisRandomizerState& State);
+};
+
+// 実行時に方式を選ぶためのインターフェース（状態は持たない）
+class CLAUDETEST_API FTetrisRandomizer
+{
+public:
+	virtual ~FTetrisRandomizer() = default;
+
+	virtual void Reset(FTetrisRandomizerState& State, int32 Seed) const = 0;
+	virtual EPieceType Next(FTetrisRandomizerState& State) const = 0;
+
+	// 方式ごとの共有インスタンス
+	static const FTetrisRandomizer& Get(ETetrisRandomizerType Type);
+};
+
+template<typename PolicyType>
+class TTetrisRandomizer final : public FTetrisRandomizer
+{
+public:
+	virtual void Reset(FTetrisRandomizerState& State, int32 Seed) const override { PolicyType::Reset(State, Seed); }
+	virtual EPieceType Next(FTetrisRandomizerState& State) const override { return PolicyType::Next(State); }
+};
+
+// 先読み済みのネクストキュー（リングバッファ）
+// 同じ方式とシードから Initialize すれば同じ順序を即座に再構築できる
+struct CLAUDETEST_API FTetrisPieceQueue
+{
+	static constexpr int32 MAX_PREVIEW = 8;
+
+	ETetrisRandomizerType RandomizerType = ETetrisRandomizerType::SevenBag;
+	FTetrisRandomizerState RandomizerState;
+	int32 InitialSeed = 0;
+
+	EPieceType Ring[MAX_PREVIEW] = {};
+	uint8 Head = 0;
+	uint8 PreviewCount = 0;
+
+	void Initialize(ETetrisRandomizerType InRandomizerType, int32 Seed, int32 InPreviewCount);
+
+	// 先頭を取り出し、空いたスロットを補充
+	EPieceType Pop();
+
+	// Index 番目の先読みピース（0 = 次のピース）
+	EPieceType Peek(int32 Index) const;
+
+	int32 GetPreviewCount() const { return PreviewCount; }
+	void GetPreview(TArray<EPieceType>& OutPieces, int32 MaxCount = MAX_PREVIEW) const;
+
+	void Serialize(FArchive& Ar);
+};
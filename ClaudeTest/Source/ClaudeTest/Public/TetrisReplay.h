@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSimulation.h"
+
+// 固定フレームのリプレイ（.trpl）
+//
+// 1フレーム = そのフレームの入力を全て適用してから FrameMicroseconds だけ Advance する（FTetrisSimGame は決定的）
+// ファイル構成:
+//   ヘッダー   : 設定・フレーム長・総フレーム数・入力数（可変長整数）
+//   入力列     : 1入力 = varuint((前の入力からのフレーム差 << 3) | コマンド)。同じフレームの入力は差 0
+//                コマンドの 5〜7 は ShiftLeft / ShiftRight / SoftDropToFloor（Pause/Restart は記録しないので番号を詰める）
+//   キーフレーム: KeyframeInterval フレームごとの全状態（FTetrisSimGame::SerializeState）と、入力列の続きの位置
+//   シーク索引 : キーフレームのフレーム番号とファイル内の位置
+//   フッター   : 索引の位置（ファイル末尾の固定長）
+// 任意のフレームへは、直前のキーフレームを復元してそこから最大 KeyframeInterval フレームだけ進めれば着く
+
+// 記録：ゲームを進める側が入力とフレームの区切りを知らせる
+class CLAUDETEST_API FTetrisReplayRecorder
+{
+public:
+	static constexpr int64 DEFAULT_FRAME_MICROSECONDS = 16667;
+	static constexpr int32 DEFAULT_KEYFRAME_INTERVAL = 600;
+
+	// Game は Reset 直後（フレーム 0）。以後 Game は1フレームにつき FrameMicroseconds ずつ進めること
+	void Begin(const FTetrisSimGame& Game, int64 InFrameMicroseconds = DEFAULT_FRAME_MICROSECONDS, int32 InKeyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+	// 今のフレームで適用した入力を記録（Pause/Restart はシミュレーションに影響しないので記録しない）
+	void RecordInput(ETetrisInputCommand Command);
+
+	// フレームを Advance し終えた後に呼ぶ（区切りではキーフレームを取る）
+	void EndFrame(const FTetrisSimGame& Game);
+
+	int64 GetFrame() const { return Frame; }
+	int32 GetNumInputs() const { return NumInputs; }
+
+	// ファイル全体のバイト列
+	void Finish(TArray<uint8>& OutBytes) const;
+	bool SaveToFile(const FString& Path) const;
+
+private:
+	struct FKeyframe
+	{
+		int64 Frame = 0;
+		int32 InputIndex = 0;
+		int64 LastInputFrame = 0;
+		int32 InputOffset = 0;
+		TArray<uint8> State;
+	};
+
+	void AddKeyframe(const FTetrisSimGame& Game);
+
+	FTetrisSimConfig Config;
+	int64 FrameMicroseconds = DEFAULT_FRAME_MICROSECONDS;
+	int32 KeyframeInterval = DEFAULT_KEYFRAME_INTERVAL;
+
+	int64 Frame = 0;
+	int64 LastInputFrame = 0;
+	int32 NumInputs = 0;
+	TArray<uint8> InputStream;
+	TArray<FKeyframe> Keyframes;
+};
+
+// 再生：ファイルを読み込み、任意のフレームの状態を作る
+class CLAUDETEST_API FTetrisReplay
+{
+public:
+	bool LoadFromFile(const FString& Path);
+	bool FromBytes(TArray<uint8>&& InBytes);
+
+	const FTetrisSimConfig& GetConfig() const { return Config; }
+	int64 GetFrameMicroseconds() const { return FrameMicroseconds; }
+	int64 GetNumFrames() const { return NumFrames; }
+	int32 GetNumInputs() const { return NumInputs; }
+	int32 GetNumKeyframes() const { return KeyframeFrames.Num(); }
+
+	// TargetFrame の開始時点（そのフレームの入力を適用する前）の状態を OutGame に作る
+	// TargetFrame = GetNumFrames() なら最後の状態
+	bool SeekToFrame(int64 TargetFrame, FTetrisSimGame& OutGame) const;
+
+private:
+	TArray<uint8> Bytes;
+
+	// ファイルの版（入力コードの読み方が変わる）
+	uint8 Version = 0;
+
+	FTetrisSimConfig Config;
+	int64 FrameMicroseconds = 0;
+	int32 KeyframeInterval = 0;
+	int64 NumFrames = 0;
+	int32 NumInputs = 0;
+
+	// 入力列の範囲
+	int64 InputStreamOffset = 0;
+	int64 InputStreamSize = 0;
+
+	// シーク索引（フレーム順）
+	TArray<int64> KeyframeFrames;
+	TArray<int64> KeyframeOffsets;
+};
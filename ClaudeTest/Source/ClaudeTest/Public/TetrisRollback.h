@@ -0,0 +1,229 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSimulation.h"
+
+// ロールバック方式の対戦（GGPO 風）
+//
+// 両方のピアが2人分の FTetrisSimGame を同じ入力で進める。相手の入力がまだ届いていないフレームは「入力なし」と予測して進め、
+// 予測と違う入力が届いたら、そのフレームの開始時点の状態に戻して現在まで進め直す。
+// 状態は値のコピーで保存・復元する（ヒープを使わないので1回 1µs よりずっと短い）
+
+// 1フレーム分の入力（4bit ごとに コマンド + 1、0 で終わり）
+// Pause / Restart は決定的な進行に入れない
+struct FTetrisFrameInput
+{
+	static constexpr int32 MAX_COMMANDS = 8;
+
+	uint32 Packed = 0;
+
+	bool IsEmpty() const { return Packed == 0; }
+
+	int32 Num() const
+	{
+		int32 Count = 0;
+		while (Count < MAX_COMMANDS && ((Packed >> (Count * 4)) & 0xF) != 0)
+		{
+			Count++;
+		}
+		return Count;
+	}
+
+	ETetrisInputCommand Get(int32 Index) const
+	{
+		return static_cast<ETetrisInputCommand>(((Packed >> (Index * 4)) & 0xF) - 1);
+	}
+
+	// 一杯か Pause / Restart なら false
+	bool Add(ETetrisInputCommand Command)
+	{
+		const int32 Count = Num();
+		if (Count >= MAX_COMMANDS || Command == ETetrisInputCommand::Pause || Command == ETetrisInputCommand::Restart)
+		{
+			return false;
+		}
+		Packed |= (static_cast<uint32>(Command) + 1) << (Count * 4);
+		return true;
+	}
+
+	bool operator==(const FTetrisFrameInput& Other) const { return Packed == Other.Packed; }
+	bool operator!=(const FTetrisFrameInput& Other) const { return Packed != Other.Packed; }
+};
+
+// 2人対戦の決定的な状態（盤面2つと届いたおじゃまブロック）。コピーがそのままスナップショットになる
+struct CLAUDETEST_API FTetrisVersusState
+{
+	static constexpr int32 NUM_PLAYERS = 2;
+
+	// 消したライン数ごとに相手へ送る行数
+	static constexpr int32 GARBAGE_FOR_LINES[] = { 0, 0, 1, 2, 4 };
+
+	FTetrisSimGame Games[NUM_PLAYERS];
+	int32 PendingGarbage[NUM_PLAYERS] = {};
+	int64 Frame = 0;
+
+	// 両者とも同じ設定（同じピース順）で始める
+	void Reset(const FTetrisSimConfig& Config);
+
+	// 1フレーム進める：入力 → 時間 → おじゃまブロックのやり取り
+	// ラインを消したら自分に届いているぶんを相殺してから残りを送り、消さずに固定したら届いているぶんがせり上がる
+	void Step(const FTetrisFrameInput (&Inputs)[NUM_PLAYERS], int64 FrameMicroseconds);
+
+	// 状態全体の CRC（ピア間の比較用。保存・復元より重い）
+	uint32 GetChecksum() const;
+
+	// せり上がり行の穴の列（フレームとプレイヤーで決まる）
+	int32 GetGarbageHoleX(int32 Player) const;
+};
+
+// ロールバックの設定（両方のピアで同じ値にする）
+struct FTetrisRollbackConfig
+{
+	// 予測で先に進めるフレーム数の上限（超えると相手の入力が届くまで止まる）
+	int32 MaxRollbackFrames = 8;
+
+	// 自分の入力を適用するまでの遅延フレーム（大きいほど巻き戻しが減り、操作が遅れる）
+	int32 InputDelayFrames = 2;
+
+	int64 FrameMicroseconds = 16667;
+};
+
+struct FTetrisRollbackStats
+{
+	int64 FramesAdvanced = 0;
+	int64 FramesResimulated = 0;
+	int32 Rollbacks = 0;
+	int32 MaxRollbackDepth = 0;
+	int32 PacketsReceived = 0;
+};
+
+// ピア間で送る入力パケット（相手がまだ受け取っていない自分の入力を毎回全部送るので、失われても次で届く）
+struct CLAUDETEST_API FTetrisRollbackPacket
+{
+	// Inputs[0] のフレーム
+	int64 StartFrame = 0;
+
+	// 送り手が受け取った相手の入力の最後のフレーム（受け手はここまで再送しなくてよい）
+	int64 AckFrame = -1;
+
+	TArray<FTetrisFrameInput, TInlineAllocator<16>> Inputs;
+
+	// 読み込みに失敗したら false
+	bool Serialize(FArchive& Ar);
+};
+
+// 1つのピアのロールバックセッション
+class CLAUDETEST_API FTetrisRollbackSession
+{
+public:
+	// 入力履歴の長さ（相手が受け取っていない自分の入力がこれを超えると止まる）
+	static constexpr int32 INPUT_HISTORY = 128;
+
+	void Start(const FTetrisSimConfig& GameConfig, const FTetrisRollbackConfig& InConfig, int32 InLocalPlayer);
+
+	// 予測するフレームが MaxRollbackFrames 以内に収まるか（false の間は相手の入力を待つ）
+	bool CanAdvance() const;
+
+	// 自分の入力を渡して1フレーム進める（入力は GetLocalInputFrame() のフレームで適用される）。進めなければ false
+	bool AdvanceFrame(const FTetrisFrameInput& LocalInput);
+
+	// 予測が外れていたら、外れたフレームの状態に戻して現在まで進め直す（AdvanceFrame の先頭でも呼ぶ）
+	void ResolveRollback();
+	bool HasPendingRollback() const { return FirstMispredictedFrame != MAX_int64; }
+
+	void BuildPacket(FTetrisRollbackPacket& OutPacket) const;
+	void ReceivePacket(const FTetrisRollbackPacket& Packet);
+
+	// 現在のフレームの開始時点の状態（予測を含む）
+	const FTetrisVersusState& GetState() const { return State; }
+	int64 GetCurrentFrame() const { return State.Frame; }
+
+	// 両者の入力が揃っている最後のフレーム（-1 = まだ無い）
+	int64 GetConfirmedFrame() const { return FMath::Min(RemoteLastFrame, State.Frame - 1); }
+
+	int64 GetLocalInputFrame() const { return State.Frame + Config.InputDelayFrames; }
+	int32 GetLocalPlayer() const { return LocalPlayer; }
+	const FTetrisRollbackStats& GetStats() const { return Stats; }
+
+private:
+	// 相手の入力は届いていなければ「入力なし」と予測する
+	FTetrisFrameInput GetInput(int32 Player, int64 Frame) const;
+
+	// 開始時点の状態を保存してから1フレーム進める
+	void SimulateFrame();
+
+	FTetrisRollbackConfig Config;
+	int32 LocalPlayer = 0;
+	FTetrisVersusState State;
+
+	// フレーム F の開始時点の状態は SavedStates[F % Num]（直近 MaxRollbackFrames + 1 フレーム）
+	TArray<FTetrisVersusState> SavedStates;
+
+	// フレーム F の入力は Inputs[Player][F % INPUT_HISTORY]
+	FTetrisFrameInput Inputs[FTetrisVersusState::NUM_PLAYERS][INPUT_HISTORY] = {};
+
+	// 自分の入力が入っている最後のフレーム / 相手の入力が連続して届いている最後のフレーム / 相手が受け取った自分の入力の最後のフレーム
+	int64 LocalLastFrame = -1;
+	int64 RemoteLastFrame = -1;
+	int64 RemoteAckFrame = -1;
+
+	// 予測と違う入力が届いた最初のフレーム（MAX_int64 = なし）
+	int64 FirstMispredictedFrame = MAX_int64;
+
+	FTetrisRollbackStats Stats;
+};
+
+// ローカルで2つのピアをつなぐテスト用の回線（遅延・揺らぎ・パケットロスを乱数で再現する）
+struct FTetrisLoopbackConfig
+{
+	// 片道の遅延と、それに足す揺らぎの最大（順序の入れ替わりも起きる）
+	int64 LatencyMicroseconds = 50000;
+	int64 JitterMicroseconds = 10000;
+
+	// 0〜1
+	float PacketLoss = 0.0f;
+
+	int32 Seed = 1;
+};
+
+struct FTetrisLoopbackStats
+{
+	int32 PacketsSent = 0;
+	int32 PacketsDropped = 0;
+	int64 BytesSent = 0;
+
+	// 相手の入力待ちで進めなかったフレーム（両ピアの合計）
+	int32 StalledFrames = 0;
+};
+
+class CLAUDETEST_API FTetrisRollbackLoopback
+{
+public:
+	void Start(const FTetrisSimConfig& GameConfig, const FTetrisRollbackConfig& RollbackConfig, const FTetrisLoopbackConfig& InNetConfig);
+
+	// 1フレーム分の時間を進める：届いたパケットを渡し、各ピアを MaxFrame まで1フレーム進め、パケットを送る
+	// GetInput(Player, Frame) はそのプレイヤーがフレーム Frame に適用する入力
+	void Tick(TFunctionRef<FTetrisFrameInput(int32 Player, int64 Frame)> GetInput, int64 MaxFrame = MAX_int64);
+
+	// 両ピアが Frame まで進み、そこまでの入力が全て揃って巻き戻しも済んでいるか
+	bool IsSynchronized(int64 Frame) const;
+
+	const FTetrisRollbackSession& GetPeer(int32 Player) const { return Peers[Player]; }
+	const FTetrisLoopbackStats& GetStats() const { return Stats; }
+
+private:
+	struct FInFlightPacket
+	{
+		int64 DeliverMicroseconds = 0;
+		int32 ToPlayer = 0;
+		TArray<uint8> Bytes;
+	};
+
+	FTetrisRollbackSession Peers[FTetrisVersusState::NUM_PLAYERS];
+	FTetrisLoopbackConfig NetConfig;
+	int64 FrameMicroseconds = 16667;
+	int64 NowMicroseconds = 0;
+	FRandomStream Random;
+	TArray<FInFlightPacket> InFlight;
+	FTetrisLoopbackStats Stats;
+};
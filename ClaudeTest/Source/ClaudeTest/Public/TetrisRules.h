@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+// ゲームモードとヘッドレスシミュレーションで共有するルール
+namespace TetrisRules
+{
+	// 出現位置（4x4 形状の左上）
+	const int32 SPAWN_X = TetrisConstants::BOARD_WIDTH / 2 - 2;
+	const int32 SPAWN_Y = 0;
+
+	const int32 SOFT_DROP_SCORE = 1;
+	const int32 HARD_DROP_SCORE_PER_ROW = 2;
+	const int32 DEFAULT_MAX_LEVEL = 15;
+
+	// 消去ライン数に応じた得点
+	inline int32 GetLineClearScore(int32 LinesCleared, int32 Level)
+	{
+		int32 BaseScore = 0;
+		switch (LinesCleared)
+		{
+		case 1:
+			BaseScore = TetrisConstants::SCORE_SINGLE_LINE;
+			break;
+		case 2:
+			BaseScore = TetrisConstants::SCORE_DOUBLE_LINE;
+			break;
+		case 3:
+			BaseScore = TetrisConstants::SCORE_TRIPLE_LINE;
+			break;
+		case 4:
+			BaseScore = TetrisConstants::SCORE_TETRIS;
+			break;
+		default:
+			BaseScore = TetrisConstants::SCORE_SINGLE_LINE * LinesCleared;
+			break;
+		}
+		return BaseScore * Level;
+	}
+
+	inline int32 GetLevelForLines(int32 TotalLines, int32 MaxLevel)
+	{
+		return FMath::Min(TotalLines / TetrisConstants::LINES_PER_LEVEL + 1, MaxLevel);
+	}
+
+	// 落下間隔（秒）
+	inline float GetFallInterval(float BaseFallSpeed, int32 Level)
+	{
+		return FMath::Max(BaseFallSpeed - (Level - 1) * TetrisConstants::SPEED_INCREASE_PER_LEVEL, TetrisConstants::MIN_FALL_SPEED);
+	}
+
+	// 落下間隔（マイクロ秒、シミュレーション用の整数版）
+	inline int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level)
+	{
+		const int64 StepMicroseconds = static_cast<int64>(TetrisConstants::SPEED_INCREASE_PER_LEVEL * 1000000.0f + 0.5f);
+		const int64 MinMicroseconds = static_cast<int64>(TetrisConstants::MIN_FALL_SPEED * 1000000.0f + 0.5f);
+		return FMath::Max(BaseFallMicroseconds - (Level - 1) * StepMicroseconds, MinMicroseconds);
+	}
+
+	// 回転できなかったときに試す位置のずれ（回転方向によらず共通）
+	struct FKickOffset
+	{
+		int8 X;
+		int8 Y;
+	};
+
+	const FKickOffset I_KICKS[] = { { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, -1 } };
+	const FKickOffset DEFAULT_KICKS[] = { { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, -1 }, { -1, -1 }, { 1, -1 } };
+
+	inline TArrayView<const FKickOffset> GetWallKickOffsets(EPieceType PieceType)
+	{
+		switch (PieceType)
+		{
+		case EPieceType::I_Piece:
+			return MakeArrayView(I_KICKS);
+		case EPieceType::O_Piece:
+		case EPieceType::None:
+			return TArrayView<const FKickOffset>();
+		default:
+			return MakeArrayView(DEFAULT_KICKS);
+		}
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+#include "TetrisRules.h"
+
+// ルールセットのポリシー：静的関数と定数だけを持つ型（ランダマイザーのポリシーと同じ形）
+// FTetrisSimGame / FTetrisArena の内側のループはポリシーごとにインスタンス化するので、ループの中に仮想呼び出しやモードの分岐はない
+// 出現位置・レベルの上がり方（10ライン）・回転方向（時計回りのみ）は全ルールセット共通
+
+// 既定のルール（TetrisRules そのもの。追加前と同じ結果になる）
+struct FTetrisModernRules
+{
+	static constexpr ETetrisRuleset RULESET = ETetrisRuleset::Modern;
+	static constexpr ETetrisRandomizerType RANDOMIZER = ETetrisRandomizerType::SevenBag;
+	static constexpr int32 SOFT_DROP_SCORE = TetrisRules::SOFT_DROP_SCORE;
+	static constexpr int32 HARD_DROP_SCORE_PER_ROW = TetrisRules::HARD_DROP_SCORE_PER_ROW;
+
+	static int32 GetLineClearScore(int32 LinesCleared, int32 Level)
+	{
+		return TetrisRules::GetLineClearScore(LinesCleared, Level);
+	}
+
+	static int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level)
+	{
+		return TetrisRules::GetFallIntervalMicroseconds(BaseFallMicroseconds, Level);
+	}
+
+	static TArrayView<const TetrisRules::FKickOffset> GetWallKickOffsets(EPieceType PieceType)
+	{
+		return TetrisRules::GetWallKickOffsets(PieceType);
+	}
+};
+
+// NES 風：40/100/300/1200 × レベル、フレーム数の表で決まる落下速度、Wall Kick なし、ハードドロップの得点なし
+// 落下速度は BaseFallMicroseconds によらない。NES の引き直し1回のランダマイザーは完全ランダムで代用する
+struct FTetrisClassicRules
+{
+	static constexpr ETetrisRuleset RULESET = ETetrisRuleset::Classic;
+	static constexpr ETetrisRandomizerType RANDOMIZER = ETetrisRandomizerType::PureRandom;
+	static constexpr int32 SOFT_DROP_SCORE = 1;
+	static constexpr int32 HARD_DROP_SCORE_PER_ROW = 0;
+
+	// NES の1フレーム（60.0988 Hz）
+	static constexpr int64 FRAME_MICROSECONDS = 16639;
+
+	// 1行落ちるまでのフレーム数（レベル1 = NES のレベル0。29以降は1）
+	static constexpr uint8 FRAMES_PER_ROW[] = { 48, 43, 38, 33, 28, 23, 18, 13, 8, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3,
+		2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1 };
+
+	static int32 GetLineClearScore(int32 LinesCleared, int32 Level)
+	{
+		static constexpr int32 BASE_SCORES[] = { 0, 40, 100, 300, 1200 };
+		return BASE_SCORES[FMath::Clamp(LinesCleared, 0, 4)] * Level;
+	}
+
+	static int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level)
+	{
+		return FRAMES_PER_ROW[FMath::Clamp(Level - 1, 0, int32(UE_ARRAY_COUNT(FRAMES_PER_ROW)) - 1)] * FRAME_MICROSECONDS;
+	}
+
+	static TArrayView<const TetrisRules::FKickOffset> GetWallKickOffsets(EPieceType PieceType)
+	{
+		return TArrayView<const TetrisRules::FKickOffset>();
+	}
+};
+
+// TGM 風：履歴ランダマイザー、1/256 行単位の重力表（最後は 20G）、右・左に1列ずらすだけの Wall Kick（I は蹴らない）
+// レベル1つを TGM の内部レベル 50 とみなす。得点は ceil((内部レベル + ライン数) / 4) × ライン数（コンボ・ボーナスなし）
+struct FTetrisTGMRules
+{
+	static constexpr ETetrisRuleset RULESET = ETetrisRuleset::TGM;
+	static constexpr ETetrisRandomizerType RANDOMIZER = ETetrisRandomizerType::TGMHistory;
+	static constexpr int32 SOFT_DROP_SCORE = 1;
+	static constexpr int32 HARD_DROP_SCORE_PER_ROW = 0;
+
+	static constexpr int64 FRAME_MICROSECONDS = 16667;
+	static constexpr int32 INTERNAL_LEVELS_PER_LEVEL = 50;
+
+	// レベル1から順の重力（1/256 行/フレーム。TGM の内部レベル 0, 50, 100, ... の値）
+	static constexpr int32 GRAVITY[] = { 4, 12, 80, 112, 4, 224, 512, 768, 1280, 768, 5120 };
+
+	static int32 GetInternalLevel(int32 Level)
+	{
+		return (Level - 1) * INTERNAL_LEVELS_PER_LEVEL;
+	}
+
+	static int32 GetLineClearScore(int32 LinesCleared, int32 Level)
+	{
+		return FMath::DivideAndRoundUp(GetInternalLevel(Level) + LinesCleared, 4) * LinesCleared;
+	}
+
+	static int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level)
+	{
+		const int32 Gravity = GRAVITY[FMath::Clamp(Level - 1, 0, int32(UE_ARRAY_COUNT(GRAVITY)) - 1)];
+		return FMath::Max<int64>(256 * FRAME_MICROSECONDS / Gravity, 1);
+	}
+
+	static TArrayView<const TetrisRules::FKickOffset> GetWallKickOffsets(EPieceType PieceType)
+	{
+		static constexpr TetrisRules::FKickOffset KICKS[] = { { 1, 0 }, { -1, 0 } };
+		switch (PieceType)
+		{
+		case EPieceType::I_Piece:
+		case EPieceType::O_Piece:
+		case EPieceType::None:
+			return TArrayView<const TetrisRules::FKickOffset>();
+		default:
+			return MakeArrayView(KICKS);
+		}
+	}
+};
+
+// 実行時にルールセットを選ぶためのインターフェース（ゲームモード・アクター用。状態は持たない）
+class CLAUDETEST_API FTetrisRuleset
+{
+public:
+	virtual ~FTetrisRuleset() = default;
+
+	virtual ETetrisRandomizerType GetDefaultRandomizer() const = 0;
+	virtual int32 GetSoftDropScore() const = 0;
+	virtual int32 GetHardDropScorePerRow() const = 0;
+	virtual int32 GetLineClearScore(int32 LinesCleared, int32 Level) const = 0;
+	virtual int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level) const = 0;
+	virtual TArrayView<const TetrisRules::FKickOffset> GetWallKickOffsets(EPieceType PieceType) const = 0;
+
+	// 落下間隔（秒）。既定のルールは TetrisRules::GetFallInterval と同じ値
+	virtual float GetFallInterval(float BaseFallSpeed, int32 Level) const = 0;
+
+	// ルールセットごとの共有インスタンス
+	static const FTetrisRuleset& Get(ETetrisRuleset Ruleset);
+};
+
+template<typename RulesType>
+class TTetrisRuleset final : public FTetrisRuleset
+{
+public:
+	virtual ETetrisRandomizerType GetDefaultRandomizer() const override { return RulesType::RANDOMIZER; }
+	virtual int32 GetSoftDropScore() const override { return RulesType::SOFT_DROP_SCORE; }
+	virtual int32 GetHardDropScorePerRow() const override { return RulesType::HARD_DROP_SCORE_PER_ROW; }
+	virtual int32 GetLineClearScore(int32 LinesCleared, int32 Level) const override { return RulesType::GetLineClearScore(LinesCleared, Level); }
+	virtual int64 GetFallIntervalMicroseconds(int64 BaseFallMicroseconds, int32 Level) const override { return RulesType::GetFallIntervalMicroseconds(BaseFallMicroseconds, Level); }
+	virtual TArrayView<const TetrisRules::FKickOffset> GetWallKickOffsets(EPieceType PieceType) const override { return RulesType::GetWallKickOffsets(PieceType); }
+
+	virtual float GetFallInterval(float BaseFallSpeed, int32 Level) const override
+	{
+		return RulesType::GetFallIntervalMicroseconds(static_cast<int64>(BaseFallSpeed * 1000000.0f + 0.5f), Level) / 1000000.0f;
+	}
+};
+
+template<>
+inline float TTetrisRuleset<FTetrisModernRules>::GetFallInterval(float BaseFallSpeed, int32 Level) const
+{
+	return TetrisRules::GetFallInterval(BaseFallSpeed, Level);
+}
+
+namespace TetrisRuleset
+{
+	// ポリシー型の値を1つ渡して Func を呼ぶ（ループの外で1回だけ選び、Func の中はポリシーごとにインスタンス化される）
+	// 例: Visit(Config.Ruleset, [&](auto Rules) { using RulesType = decltype(Rules); ... });
+	template<typename FuncType>
+	decltype(auto) Visit(ETetrisRuleset Ruleset, FuncType&& Func)
+	{
+		switch (Ruleset)
+		{
+		case ETetrisRuleset::Classic:
+			return Func(FTetrisClassicRules());
+		case ETetrisRuleset::TGM:
+			return Func(FTetrisTGMRules());
+		default:
+			return Func(FTetrisModernRules());
+		}
+	}
+}
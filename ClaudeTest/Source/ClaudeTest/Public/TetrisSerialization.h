@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/Archive.h"
+#include "TetrisTypes.h"
+
+// バイナリ保存形式で共通に使うシリアライズヘルパー
+namespace TetrisSerialization
+{
+	// LEB128 形式の可変長符号なし整数（小さい値ほど短い）
+	inline void SerializeVarUInt(FArchive& Ar, uint64& Value)
+	{
+		if (Ar.IsLoading())
+		{
+			Value = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				uint8 Byte = 0;
+				Ar << Byte;
+				Value |= uint64(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0 || Ar.IsError())
+				{
+					return;
+				}
+			}
+			Ar.SetError();
+		}
+		else
+		{
+			uint64 Remaining = Value;
+			do
+			{
+				uint8 Byte = static_cast<uint8>(Remaining & 0x7F);
+				Remaining >>= 7;
+				if (Remaining != 0)
+				{
+					Byte |= 0x80;
+				}
+				Ar << Byte;
+			}
+			while (Remaining != 0);
+		}
+	}
+
+	inline void SerializeVarUInt(FArchive& Ar, uint32& Value)
+	{
+		uint64 Wide = Value;
+		SerializeVarUInt(Ar, Wide);
+		Value = static_cast<uint32>(Wide);
+	}
+
+	// ZigZag 変換した可変長符号付き整数
+	inline void SerializeVarInt(FArchive& Ar, int32& Value)
+	{
+		uint32 ZigZag = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		SerializeVarUInt(Ar, ZigZag);
+		Value = static_cast<int32>(ZigZag >> 1) ^ -static_cast<int32>(ZigZag & 1);
+	}
+
+	// uint8 ベースの列挙型を1バイトで保存。読み込んだ値が MinValue〜MaxValue の外ならエラーにする（壊れたファイルの値をそのまま使わない）
+	template<typename EnumType>
+	inline void SerializeEnum8(FArchive& Ar, EnumType& Value, EnumType MinValue, EnumType MaxValue)
+	{
+		uint8 RawValue = static_cast<uint8>(Value);
+		Ar << RawValue;
+		if (Ar.IsLoading() && (RawValue < static_cast<uint8>(MinValue) || RawValue > static_cast<uint8>(MaxValue)))
+		{
+			Ar.SetError();
+			return;
+		}
+		Value = static_cast<EnumType>(RawValue);
+	}
+
+	// ピースの種類（bAllowNone でなければ7種類のどれか）
+	inline void SerializePieceType(FArchive& Ar, EPieceType& Value, bool bAllowNone)
+	{
+		SerializeEnum8(Ar, Value, bAllowNone ? EPieceType::None : EPieceType::I_Piece, EPieceType::L_Piece);
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+#include "TetrisRandomizer.h"
+#include "TetrisRules.h"
+
+class FTetrisDatasetExporter;
+struct FTetrisGameStepContext;
+
+// アクターを使わない純粋なシミュレーション（ヘッドレス実行・ボット・テスト用）
+// ルールは ATetrisGameMode / ATetrisPiece と同じ TetrisRuleset（既定は TetrisRules）・TetrisPieceTables・FTetrisPieceQueue を使う
+// 時間は整数マイクロ秒で進めるので、同じ設定と入力からは常に同じ結果になる
+
+// 行の配列に対する盤面操作（FTetrisSimBoard と FTetrisArena の列で共有する）
+// Rows = 占有ビット、PackedRows = TetrisCellPacking 形式のセル種類。どちらも Height 行
+namespace TetrisBoardRows
+{
+	CLAUDETEST_API bool CanPlace(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y);
+	CLAUDETEST_API void Place(uint16* Rows, uint64* PackedRows, int32 Width, int32 Height, EPieceType PieceType, int32 Rotation, int32 X, int32 Y);
+	CLAUDETEST_API int32 ClearFullRows(uint16* Rows, uint64* PackedRows, int32 Height, uint16 FullRowMask);
+
+	// (X, Y) から真下に落とした位置の Y / 左右（Direction = -1 / 1）に動かせるだけ動かした位置の X
+	CLAUDETEST_API int32 GetDropY(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y);
+	CLAUDETEST_API int32 GetShiftX(const uint16* Rows, int32 Height, uint16 FullRowMask, EPieceType PieceType, int32 Rotation, int32 X, int32 Y, int32 Direction);
+}
+
+// 盤面：1行 = 占有ビット（bit X）+ TetrisCellPacking 形式のセル種類
+struct CLAUDETEST_API FTetrisSimBoard
+{
+	static constexpr int32 MAX_HEIGHT = TetrisConstants::BOARD_HEIGHT + TetrisConstants::BOARD_BUFFER_HEIGHT;
+	static constexpr int32 MAX_WIDTH = TetrisConstants::MAX_PACKED_BOARD_WIDTH;
+
+	int32 Width = TetrisConstants::BOARD_WIDTH;
+	int32 Height = TetrisConstants::BOARD_HEIGHT;
+	uint16 FullRowMask = 0;
+	uint16 Rows[MAX_HEIGHT] = {};
+	uint64 PackedRows[MAX_HEIGHT] = {};
+
+	void Reset(int32 InWidth, int32 InHeight);
+
+	bool IsCellOccupied(int32 X, int32 Y) const
+	{
+		return X >= 0 && X < Width && Y >= 0 && Y < Height && (Rows[Y] >> X) & 1;
+	}
+
+	// 4x4 形状の左上を (X, Y) に置けるか
+	bool CanPlace(EPieceType PieceType, int32 Rotation, int32 X, int32 Y) const;
+
+	// 置いたセルを書き込む（範囲外は無視）
+	void Place(EPieceType PieceType, int32 Rotation, int32 X, int32 Y);
+
+	// 揃った行を消して詰める（消した行数を返す）
+	int32 ClearFullRows();
+
+	// (X, Y) から真下に落とした位置の Y
+	int32 GetDropY(EPieceType PieceType, int32 Rotation, int32 X, int32 Y) const;
+
+	// (X, Y) から左右（Direction = -1 / 1）に動かせるだけ動かした位置の X
+	int32 GetShiftX(EPieceType PieceType, int32 Rotation, int32 X, int32 Y, int32 Direction) const;
+
+	bool IsTopRowOccupied() const { return Height > 0 && Rows[0] != 0; }
+
+	void SetPackedRow(int32 Y, uint64 PackedCells);
+};
+
+// 固定位置（4x4 形状の左上と回転）
+struct FTetrisSimPlacement
+{
+	EPieceType PieceType = EPieceType::None;
+	uint8 Rotation = 0;
+	int8 X = 0;
+	int8 Y = 0;
+};
+
+// 到達可能な固定位置の列挙（Wall Kick は既定のルールセットのもの）
+namespace TetrisMoveGen
+{
+	// 出現位置から左右・下・回転（Wall Kick 込み）で到達でき、それ以上下がれない位置を全て列挙する
+	// 結果のセルが同じ位置（S の回転0と2など）は1つにまとめる。出現できない場合は 0
+	CLAUDETEST_API int32 GenerateLockPlacements(const FTetrisSimBoard& Board, EPieceType PieceType, TArray<FTetrisSimPlacement>& OutPlacements);
+
+	// 操作中の位置 (回転, X, Y) から探す版
+	CLAUDETEST_API int32 GenerateLockPlacements(const FTetrisSimBoard& Board, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY, TArray<FTetrisSimPlacement>& OutPlacements);
+
+	// 操作中の位置から Target に固定するまでの最短の入力列（最後はハードドロップ）。届かなければ false
+	CLAUDETEST_API bool FindInputPath(const FTetrisSimBoard& Board, EPieceType PieceType, int32 StartRotation, int32 StartX, int32 StartY,
+		const FTetrisSimPlacement& Target, TArray<ETetrisInputCommand>& OutInputs);
+}
+
+// シミュレーション設定
+struct CLAUDETEST_API FTetrisSimConfig
+{
+	int32 BoardWidth = TetrisConstants::BOARD_WIDTH;
+	int32 BoardHeight = TetrisConstants::BOARD_HEIGHT;
+	ETetrisRandomizerType RandomizerType = ETetrisRandomizerType::SevenBag;
+	int32 Seed = 1;
+	int32 PreviewCount = 6;
+	int64 BaseFallMicroseconds = static_cast<int64>(TetrisConstants::DEFAULT_FALL_SPEED * 1000000.0f);
+	int64 LineClearDelayMicroseconds = 0;
+	int32 MaxLevel = TetrisRules::DEFAULT_MAX_LEVEL;
+
+	// 得点・落下速度・Wall Kick（ピース生成方式は RandomizerType で別に選ぶ）
+	ETetrisRuleset Ruleset = ETetrisRuleset::Modern;
+};
+
+// 1ゲームの盤面とキュー以外の状態（ピース・タイマー・統計）
+// FTetrisSimGame はそのまま持ち、FTetrisArena は列から読み出して TetrisGameStep で進めてから書き戻す
+struct FTetrisGameState
+{
+	EPieceType ActivePiece = EPieceType::None;
+	int32 ActiveRotation = 0;
+	int32 ActiveX = 0;
+	int32 ActiveY = 0;
+
+	int64 ElapsedMicroseconds = 0;
+	int64 FallTimerMicroseconds = 0;
+	int64 LineClearTimerMicroseconds = 0;
+	bool bLineClearPending = false;
+	bool bGameOver = false;
+
+	FTetrisGameStats Stats;
+};
+
+// 1ゲーム分の状態
+class CLAUDETEST_API FTetrisSimGame
+{
+public:
+	void Reset(const FTetrisSimConfig& InConfig);
+
+	// 入力を1つ適用（移動・回転できたら true）。Pause/Restart は無視する
+	bool ApplyInput(ETetrisInputCommand Command);
+
+	// 時間を進める（自然落下・ライン消去の待ち時間）
+	void Advance(int64 DeltaMicroseconds);
+
+	// 盤面の下からせり上がり行を足す（HoleX の列だけ空き。対戦のおじゃまブロック用）
+	// 上にはみ出すか操作中のピースと重なったらゲームオーバー
+	void AddGarbageRows(int32 NumRows, int32 HoleX);
+
+	bool IsGameOver() const { return State.bGameOver; }
+	bool HasActivePiece() const { return State.ActivePiece != EPieceType::None; }
+
+	EPieceType GetActivePiece() const { return State.ActivePiece; }
+	int32 GetActiveRotation() const { return State.ActiveRotation; }
+	int32 GetActiveX() const { return State.ActiveX; }
+	int32 GetActiveY() const { return State.ActiveY; }
+
+	const FTetrisSimBoard& GetBoard() const { return Board; }
+	const FTetrisGameStats& GetStats() const { return State.Stats; }
+	const FTetrisPieceQueue& GetQueue() const { return Queue; }
+	const FTetrisSimConfig& GetConfig() const { return Config; }
+	int64 GetElapsedMicroseconds() const { return State.ElapsedMicroseconds; }
+
+	// 設定以外の全状態（盤面・キュー・統計・ピース・タイマー）を読み書きする
+	// 読み込みは同じ設定で Reset したゲームに対して行う。失敗したら false
+	bool SerializeState(FArchive& Ar);
+
+	// ピースを固定するたびに判断点を書き出す（nullptr で停止）
+	void SetDatasetExporter(FTetrisDatasetExporter* InExporter) { DatasetExporter.Exporter = InExporter; }
+
+private:
+	// 書き出し先はこのゲームだけのもの（ボットの試行用などのコピーには引き継がない）
+	struct FExporterRef
+	{
+		FTetrisDatasetExporter* Exporter = nullptr;
+
+		FExporterRef() = default;
+		FExporterRef(const FExporterRef&) {}
+		FExporterRef& operator=(const FExporterRef&) { return *this; }
+	};
+
+	FTetrisSimConfig Config;
+	FTetrisSimBoard Board;
+	FTetrisPieceQueue Queue;
+	FTetrisGameState State;
+	FExporterRef DatasetExporter;
+
+	// 盤面・キュー・書き出し先を TetrisGameStep に渡す形にまとめる
+	FTetrisGameStepContext MakeStepContext();
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TetrisTypes.h"
+#include "TetrisSimulationCommandlet.generated.h"
+
+struct FTetrisSimConfig;
+
+// ビューポートなしで N ゲームを一括実行するコマンドレット
+//
+//   UnrealEditor-Cmd ClaudeTest.uproject -run=TetrisSimulation -Games=1000 -Seed=1 -Parallel
+//   UnrealEditor-Cmd ClaudeTest.uproject -run=TetrisSimulation -Replay=Saved/TetrisReplays
+//
+// オプション:
+//   -Games=N             ボット対戦のゲーム数（既定 100）
+//   -Seed=S              先頭ゲームのシード（ゲーム i は S + i）
+//   -Randomizer=Type     SevenBag / FourteenBag / TGMHistory / PureRandom（既定はルールセットのもの）
+//   -Ruleset=Type        Modern（既定）/ Classic / TGM
+//   -MaxPieces=N         1ゲームの最大ピース数（既定 10000）
+//   -LineClearDelayMs=N  ライン消去の待ち時間
+//   -Replay=Path         入力ファイル（.tinput）またはそのディレクトリを再生する
+//   -Csv=Path            ゲームごとのサマリー（既定 Saved/TetrisSimulation/Summary.csv）
+//   -Parallel            ゲームをワーカースレッドで並列実行
+//   -Dataset=Dir         固定ごとの (状態, 行動, 報酬) を Dir/Game_<i>_<seed>.tdset に書き出す
+//   -Bot=Type            Greedy（1手読み、既定）/ Beam（ネクストを読むビームサーチ）
+//   -BeamWidth=N         ビームサーチの幅
+//   -BeamDepth=N         ビームサーチで読むピース数
+//   -BotBudgetMs=N       ビームサーチの1ピースあたりの思考時間
+//   -BotThreads=N        ビームサーチ1つあたりのスレッド数（0 = タスクシステムに任せる）
+//   -Arena               -Games 個のゲームを FTetrisArena でまとめて進め、メモリと1ステップの時間を出す（入力はランダム）
+//   -ArenaSteps=N        アリーナで進めるステップ数（既定 3600 = 60fps で1分）
+//   -PerfectClearTable[=Path]  空の盤面からの PC の表を作る（既定 Content/Tetris/PerfectClear.tpct）
+//   -PerfectClearHeight=N      表にする PC のライン数（既定 2）
+UCLASS()
+class CLAUDETEST_API UTetrisSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTetrisSimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	// 入力ファイル1本分
+	struct FReplayInput
+	{
+		int64 TimeMicroseconds = 0;
+		ETetrisInputCommand Command = ETetrisInputCommand::MoveLeft;
+	};
+
+	struct FReplayFile
+	{
+		FString Path;
+		int32 Seed = 1;
+		ETetrisRandomizerType RandomizerType = ETetrisRandomizerType::SevenBag;
+		ETetrisRuleset Ruleset = ETetrisRuleset::Modern;
+		TArray<FReplayInput> Inputs;
+	};
+
+	// 1ゲーム分の結果
+	struct FGameResult
+	{
+		FString Source;
+		int32 Seed = 0;
+		FTetrisGameStats Stats;
+		bool bGameOver = false;
+		int64 SimulatedMicroseconds = 0;
+		double WallSeconds = 0.0;
+	};
+
+	static int32 RunArena(const FTetrisSimConfig& Config, int32 NumGames, int32 NumSteps);
+	static int32 BuildPerfectClearTable(const FString& Path, int32 Width, int32 Height);
+	static bool LoadReplayFile(const FString& Path, FReplayFile& OutReplay);
+	static bool WriteSummaryCsv(const FString& Path, const TArray<FGameResult>& Results);
+};
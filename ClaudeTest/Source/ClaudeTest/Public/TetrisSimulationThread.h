@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "Containers/TripleBuffer.h"
+#include <atomic>
+#include "TetrisSimulation.h"
+
+class FRunnableThread;
+
+// ワーカースレッドが1ステップごとに公開する状態（公開後は書き換えない）
+struct FTetrisSimFrame
+{
+	uint64 StepIndex = 0;
+	int64 ElapsedMicroseconds = 0;
+
+	// 盤面（TetrisCellPacking 形式の行）
+	int32 BoardHeight = 0;
+	uint64 PackedRows[FTetrisSimBoard::MAX_HEIGHT] = {};
+
+	// 操作中のピース（None なら消去待ちかゲームオーバー）
+	EPieceType ActivePiece = EPieceType::None;
+	int32 ActiveRotation = 0;
+	int32 ActiveX = 0;
+	int32 ActiveY = 0;
+
+	FTetrisPieceQueue Queue;
+	FTetrisGameStats Stats;
+	bool bGameOver = false;
+
+	// このステップまでに適用した入力の数（入力から反映までの確認用）
+	uint32 InputsApplied = 0;
+};
+
+// FTetrisSimGame を固定レートで進めるワーカースレッド
+// 入力はゲームスレッド（1つの生産者）からロックなしキューで渡し、
+// 結果は三重バッファで公開する。ゲームスレッドは最新の1つだけを読むので描画フレームの長さに左右されない
+class CLAUDETEST_API FTetrisSimulationThread : public FRunnable
+{
+public:
+	FTetrisSimulationThread(const FTetrisSimConfig& InConfig, int32 InStepsPerSecond);
+	virtual ~FTetrisSimulationThread() override;
+
+	// スレッドを起動（初期状態のフレームは起動前に公開される）
+	bool Start();
+
+	// 停止を要求して終了を待つ
+	void Shutdown();
+
+	// ゲームスレッドから：入力を次のステップで適用
+	void EnqueueInput(ETetrisInputCommand Command);
+
+	// ゲームスレッドから：一時停止中は入力も時間も進めない
+	void SetPaused(bool bInPaused) { bPaused.store(bInPaused, std::memory_order_relaxed); }
+
+	// ゲームスレッドから：前回以降に新しいフレームがあれば最新を返す（次の呼び出しまで有効）
+	const FTetrisSimFrame* ConsumeLatestFrame();
+
+	int32 GetStepsPerSecond() const { return StepsPerSecond; }
+
+	// 起動前に呼ぶ：固定した判断点をワーカースレッドから書き出す（書き出し先はスレッドより長く生きること）
+	void SetDatasetExporter(FTetrisDatasetExporter* Exporter) { Game.SetDatasetExporter(Exporter); }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	void Step();
+	void PublishFrame();
+
+	// ワーカースレッドだけが触る
+	FTetrisSimGame Game;
+	uint64 StepIndex = 0;
+	uint32 InputsApplied = 0;
+
+	FTetrisSimConfig Config;
+	int32 StepsPerSecond = 1000;
+	int64 StepMicroseconds = 1000;
+
+	TQueue<ETetrisInputCommand, EQueueMode::Spsc> InputQueue;
+	TTripleBuffer<FTetrisSimFrame> Frames;
+
+	std::atomic<bool> bStopRequested { false };
+	std::atomic<bool> bPaused { false };
+
+	FRunnableThread* Thread = nullptr;
+};
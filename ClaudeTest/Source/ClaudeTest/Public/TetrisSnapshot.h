@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+#include "TetrisRandomizer.h"
+
+// ゲーム進行中の状態を丸ごと保持する圧縮スナップショット
+// メモリ上でも数百バイトに収まるため、アンドゥ履歴やサーバーのチェックポイントとして大量に保持できる
+struct CLAUDETEST_API FTetrisGameSnapshot
+{
+	// バイナリ形式のバージョン（フィールド追加時に上げる）
+	static constexpr uint32 SNAPSHOT_MAGIC = 0x504E5354; // "TSNP"
+	// 1: 7-bag のみ / 2: ランダマイザー状態とネクストキュー
+	static constexpr uint8 CURRENT_VERSION = 2;
+	static constexpr int32 MAX_ROWS = TetrisConstants::BOARD_HEIGHT + TetrisConstants::BOARD_BUFFER_HEIGHT;
+
+	// ボード（TetrisCellPacking 形式の行）
+	uint8 BoardWidth = 0;
+	uint8 BoardHeight = 0;
+	TArray<uint64, TInlineAllocator<MAX_ROWS>> PackedRows;
+
+	// 操作中のピース
+	EPieceType ActivePieceType = EPieceType::None;
+	uint8 ActiveRotation = 0;
+	int8 ActiveX = 0;
+	int8 ActiveY = 0;
+
+	// ネクストキューとランダマイザー状態
+	FTetrisPieceQueue PieceQueue;
+
+	// 統計とタイマー
+	FTetrisGameStats Stats;
+	float FallSpeed = 0.0f;
+	float FallTimer = 0.0f;
+	ETetrisGameState GameState = ETetrisGameState::Menu;
+
+	// FArchive 経由で読み書き（読み込み失敗時は false）
+	bool Serialize(FArchive& Ar);
+
+	// v1 形式のバッグを読み込んでキューに変換
+	bool SerializeVersion1Bag(FArchive& Ar);
+
+	// バイト列との変換
+	void ToBytes(TArray<uint8>& OutBytes) const;
+	bool FromBytes(const TArray<uint8>& Bytes);
+};
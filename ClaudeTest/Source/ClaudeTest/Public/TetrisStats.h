@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// テトリスの統計グループ（コンソールで `stat tetris`）
+// STATS が無効なビルドではマクロごと消え、有効でもグループを表示していない間はほぼ計測しない
+DECLARE_STATS_GROUP(TEXT("Tetris"), STATGROUP_Tetris, STATCAT_Advanced);
+
+// フレームの各段階（UTetrisWorldSubsystem::Tick）
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Input"), STAT_TetrisInput, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulation"), STAT_TetrisSimulation, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Display Sync"), STAT_TetrisDisplaySync, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Events"), STAT_TetrisEvents, STATGROUP_Tetris, CLAUDETEST_API);
+
+// シミュレーションの1ステップ（ゲームスレッドの落下処理・ワーカースレッドの Step・アリーナの Step）
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Step"), STAT_TetrisSimStep, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Step (Worker)"), STAT_TetrisSimStepWorker, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Arena Step"), STAT_TetrisArenaStep, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rollback Resimulate"), STAT_TetrisRollback, STATGROUP_Tetris, CLAUDETEST_API);
+
+// フレームごとの件数
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Input Events"), STAT_TetrisInputEvents, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Collision Queries"), STAT_TetrisCollisionQueries, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ISM Instances Updated"), STAT_TetrisInstancesUpdated, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actors Spawned"), STAT_TetrisActorsSpawned, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actors Destroyed (GC)"), STAT_TetrisActorsDestroyed, STATGROUP_Tetris, CLAUDETEST_API);
+
+// 累計・直近の値
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Garbage Actors (Total)"), STAT_TetrisGarbageTotal, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Pieces / s"), STAT_TetrisPiecesPerSecond, STATGROUP_Tetris, CLAUDETEST_API);
+
+// アリーナ
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Arena Memory"), STAT_TetrisArenaMemory, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Arena Bytes / Game"), STAT_TetrisArenaBytesPerGame, STATGROUP_Tetris, CLAUDETEST_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Arena Step / 1000 Games (ms)"), STAT_TetrisArenaStepPer1000, STATGROUP_Tetris, CLAUDETEST_API);
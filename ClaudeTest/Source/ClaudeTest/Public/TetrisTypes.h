@@ -37,6 +37,42 @@ enum class EMoveDirection : uint8
 	Down		UMETA(DisplayName = "Down")
 };
 
+// ピース生成方式
+UENUM(BlueprintType)
+enum class ETetrisRandomizerType : uint8
+{
+	SevenBag	UMETA(DisplayName = "7-Bag"),
+	FourteenBag	UMETA(DisplayName = "14-Bag"),
+	TGMHistory	UMETA(DisplayName = "TGM History"),
+	PureRandom	UMETA(DisplayName = "Pure Random")
+};
+
+// ルールセット（得点・落下速度・Wall Kick・既定のピース生成方式）
+UENUM(BlueprintType)
+enum class ETetrisRuleset : uint8
+{
+	Modern		UMETA(DisplayName = "Modern"),
+	Classic		UMETA(DisplayName = "Classic (NES)"),
+	TGM			UMETA(DisplayName = "TGM")
+};
+
+// プレイヤー入力コマンド（ネットワーク送信用）
+UENUM(BlueprintType)
+enum class ETetrisInputCommand : uint8
+{
+	MoveLeft	UMETA(DisplayName = "Move Left"),
+	MoveRight	UMETA(DisplayName = "Move Right"),
+	MoveDown	UMETA(DisplayName = "Move Down"),
+	Rotate		UMETA(DisplayName = "Rotate"),
+	HardDrop	UMETA(DisplayName = "Hard Drop"),
+	Pause		UMETA(DisplayName = "Pause"),
+	Restart		UMETA(DisplayName = "Restart"),
+	// ARR 0（DAS の後に壁・障害物まで一度に移動）と固定しないソフトドロップ（床まで一度に落とす）
+	ShiftLeft	UMETA(DisplayName = "Shift Left"),
+	ShiftRight	UMETA(DisplayName = "Shift Right"),
+	SoftDropToFloor	UMETA(DisplayName = "Soft Drop To Floor")
+};
+
 // ピースの形状データ（4x4グリッド）
 USTRUCT(BlueprintType)
 struct FTetrisPieceShape
@@ -163,6 +199,7 @@ namespace TetrisConstants
 	const int32 BOARD_VISIBLE_HEIGHT = 20;
 	const int32 BOARD_BUFFER_HEIGHT = 4;
 	const int32 PIECE_SIZE = 4;
+	const int32 MAX_PACKED_BOARD_WIDTH = 16; // 1行を uint64 にパックできる最大幅
 	
 	const float DEFAULT_FALL_SPEED = 1.0f;
 	const float MIN_FALL_SPEED = 0.1f;
@@ -185,4 +222,57 @@ namespace TetrisPieceColors
 	const FLinearColor Z_COLOR = FLinearColor(1.0f, 0.0f, 0.0f, 1.0f); // レッド
 	const FLinearColor J_COLOR = FLinearColor(0.0f, 0.0f, 1.0f, 1.0f); // ブルー
 	const FLinearColor L_COLOR = FLinearColor(1.0f, 0.5f, 0.0f, 1.0f); // オレンジ
-}
\ No newline at end of file
+}
+
+// ボード1行を1セル4bitで uint64 にパックするヘルパー
+// セル値: 0 = 空, 1-7 = ピース種類, 8 = 種類なしの占有セル
+namespace TetrisCellPacking
+{
+	const uint8 CELL_EMPTY = 0;
+	const uint8 CELL_UNTYPED = 8;
+	const int32 BITS_PER_CELL = 4;
+
+	inline uint8 PackCell(bool bOccupied, EPieceType PieceType)
+	{
+		if (!bOccupied)
+		{
+			return CELL_EMPTY;
+		}
+		return PieceType != EPieceType::None ? static_cast<uint8>(PieceType) : CELL_UNTYPED;
+	}
+
+	inline bool IsCellOccupied(uint8 CellValue)
+	{
+		return CellValue != CELL_EMPTY;
+	}
+
+	inline EPieceType GetCellPieceType(uint8 CellValue)
+	{
+		return CellValue < CELL_UNTYPED ? static_cast<EPieceType>(CellValue) : EPieceType::None;
+	}
+
+	inline uint8 GetPackedCell(uint64 PackedRow, int32 X)
+	{
+		return static_cast<uint8>((PackedRow >> (X * BITS_PER_CELL)) & 0xF);
+	}
+
+	inline uint64 SetPackedCell(uint64 PackedRow, int32 X, uint8 CellValue)
+	{
+		const int32 Shift = X * BITS_PER_CELL;
+		return (PackedRow & ~(uint64(0xF) << Shift)) | (uint64(CellValue & 0xF) << Shift);
+	}
+
+	// 行の占有ビット（bit X = セル X が空でない）
+	inline uint16 GetOccupancyBits(uint64 PackedRow)
+	{
+		uint16 Bits = 0;
+		for (int32 X = 0; X < 16; X++)
+		{
+			if (IsCellOccupied(GetPackedCell(PackedRow, X)))
+			{
+				Bits |= static_cast<uint16>(1u << X);
+			}
+		}
+		return Bits;
+	}
+}
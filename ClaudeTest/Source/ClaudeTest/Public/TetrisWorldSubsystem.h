@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TetrisWorldSubsystem.generated.h"
+
+class ATetrisGameMode;
+class ATetrisBoard;
+class ATetrisPlayerController;
+
+// ワールド内のテトリス更新をまとめて行うサブシステム
+// 1フレームに1回だけ Tick され、入力 → 全ゲームのシミュレーション → 表示同期 → イベント通知 の順で処理する
+// ボード・ピースのアクターは Tick しない
+UCLASS()
+class CLAUDETEST_API UTetrisWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UTetrisWorldSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// 登録（各アクターの BeginPlay / EndPlay から呼ぶ）
+	void RegisterController(ATetrisPlayerController* Controller);
+	void UnregisterController(ATetrisPlayerController* Controller);
+
+	void RegisterGame(ATetrisGameMode* Game);
+	void UnregisterGame(ATetrisGameMode* Game);
+
+	void RegisterBoard(ATetrisBoard* Board);
+	void UnregisterBoard(ATetrisBoard* Board);
+
+	int32 GetNumGames() const { return Games.Num(); }
+	int32 GetNumBoards() const { return Boards.Num(); }
+
+private:
+	// `stat tetris` の Pieces / s
+	void UpdatePiecesPerSecond(float DeltaTime);
+
+	UPROPERTY()
+	TArray<ATetrisPlayerController*> Controllers;
+
+	UPROPERTY()
+	TArray<ATetrisGameMode*> Games;
+
+	UPROPERTY()
+	TArray<ATetrisBoard*> Boards;
+
+	int64 LastTotalPieces = 0;
+	int64 PiecesInWindow = 0;
+	float PiecesWindowSeconds = 0.0f;
+	float PiecesPerSecond = 0.0f;
+};
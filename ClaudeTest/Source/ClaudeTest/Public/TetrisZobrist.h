@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisTypes.h"
+
+// ボード・ピース・キュー状態の Zobrist ハッシュ用キー
+// 状態ハッシュ = 各セルのキー XOR 操作中ピースのキー XOR キュー各スロットのキー
+// 変化した要素のキーだけを XOR し直せばよいので、更新は変化量に比例する
+namespace TetrisZobrist
+{
+	const int32 MAX_WIDTH = TetrisConstants::MAX_PACKED_BOARD_WIDTH;
+	const int32 MAX_HEIGHT = TetrisConstants::BOARD_HEIGHT + TetrisConstants::BOARD_BUFFER_HEIGHT;
+	const int32 CELL_VALUES = TetrisCellPacking::CELL_UNTYPED + 1;
+	const int32 PIECE_TYPES = 8;
+	const int32 PIECE_POSITION_MARGIN = 4;
+	const int32 MAX_QUEUE_SLOTS = 8;
+
+	// セル (X, Y) の値に対するキー（空セルは 0）
+	CLAUDETEST_API uint64 GetCellKey(int32 X, int32 Y, uint8 CellValue);
+
+	// 操作中ピース（種類・回転・位置）のキー（EPieceType::None は 0）
+	CLAUDETEST_API uint64 GetPieceKey(EPieceType PieceType, int32 Rotation, int32 X, int32 Y);
+
+	// キューの Slot 番目にあるピースのキー
+	CLAUDETEST_API uint64 GetQueueKey(int32 Slot, EPieceType PieceType);
+
+	// 行の変化分だけハッシュを更新（変化したセル数に比例）
+	CLAUDETEST_API uint64 GetRowTransitionKey(int32 Y, uint64 OldPackedRow, uint64 NewPackedRow);
+
+	// 行全体のハッシュ（検証・初期化用）
+	CLAUDETEST_API uint64 HashPackedRow(int32 Y, uint64 PackedRow);
+}